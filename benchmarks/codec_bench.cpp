@@ -0,0 +1,231 @@
+// 受信フレームの解析や制御計算など、制御周期ごとに呼ばれる処理の
+// マイクロベンチマーク（Google Benchmark）
+//
+// 入力は固定シードの乱数で事前に作り、実行ごとに同じ列を使う。CAN の解析は
+// ロボマス 8 台・VESC 4 台・コントローラが同じバスに載った構成を想定した
+// フレームの混在比で回す（各ドライバは自分宛てでないフレームも受け取る）。
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "chassis/mecanum.h"
+#include "cobs/cobs.h"
+#include "controller/controller_transport.h"
+#include "coordinate/coordinate.h"
+#include "dji/robomas_core.h"
+#include "pid/pid.h"
+#include "sensor/amt21/amt21_core.h"
+#include "vesc/vesc_core.h"
+
+namespace {
+
+constexpr uint32_t kSeed = 20240401U;
+constexpr std::size_t kSamples = 1024;  // 2 のべき乗
+constexpr std::size_t kSampleMask = kSamples - 1U;
+
+struct Frame {
+  uint32_t id;
+  uint8_t data[8];
+};
+
+// ロボマス 0x201〜0x208 のフィードバックが 7 割、VESC STATUS が 2 割、
+// コントローラ（50/51）とその他の ID が残り
+const std::vector<Frame>& FrameMix() {
+  static const std::vector<Frame> frames = [] {
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::vector<Frame> out(kSamples);
+    for (Frame& frame : out) {
+      const int kind = percent(rng);
+      if (kind < 70) {
+        frame.id = 0x201U + static_cast<uint32_t>(byte(rng) & 7);
+      } else if (kind < 90) {
+        frame.id = (VESC_CAN_PACKET_STATUS << 8) |
+                   (1U + static_cast<uint32_t>(byte(rng) & 3));
+      } else if (kind < 96) {
+        frame.id = (kind & 1) != 0 ? OM_CONTROLLER_CAN_ID_ANALOG
+                                   : OM_CONTROLLER_CAN_ID_BUTTONS;
+      } else {
+        frame.id = 0x300U + static_cast<uint32_t>(byte(rng));
+      }
+      for (uint8_t& value : frame.data) {
+        value = static_cast<uint8_t>(byte(rng));
+      }
+    }
+    return out;
+  }();
+  return frames;
+}
+
+// CAN の 8 バイトをまとめたようなデータ（0x00 を 1/8 程度含む）
+std::vector<uint8_t> Payload(std::size_t length) {
+  std::mt19937 rng(kSeed + static_cast<uint32_t>(length));
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::vector<uint8_t> data(length);
+  for (uint8_t& value : data) {
+    value = (byte(rng) & 7) == 0 ? 0U : static_cast<uint8_t>(byte(rng));
+  }
+  return data;
+}
+
+void BM_CobsEncode(benchmark::State& state) {
+  const std::vector<uint8_t> data =
+      Payload(static_cast<std::size_t>(state.range(0)));
+  std::vector<uint8_t> encoded(data.size() + data.size() / 254U + 2U);
+  for (auto _ : state) {
+    std::size_t encoded_length = encoded.size();
+    benchmark::DoNotOptimize(om_cobs_encode(data.data(), data.size(),
+                                            encoded.data(), &encoded_length));
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          state.range(0));
+}
+BENCHMARK(BM_CobsEncode)->Arg(8)->Arg(16)->Arg(66)->Arg(254);
+
+void BM_CobsDecode(benchmark::State& state) {
+  const std::vector<uint8_t> data =
+      Payload(static_cast<std::size_t>(state.range(0)));
+  std::vector<uint8_t> encoded(data.size() + data.size() / 254U + 2U);
+  std::size_t encoded_length = encoded.size();
+  om_cobs_encode(data.data(), data.size(), encoded.data(), &encoded_length);
+  std::vector<uint8_t> decoded(data.size());
+  for (auto _ : state) {
+    std::size_t decoded_length = decoded.size();
+    benchmark::DoNotOptimize(om_cobs_decode(encoded.data(), encoded_length,
+                                            decoded.data(), &decoded_length));
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          state.range(0));
+}
+BENCHMARK(BM_CobsDecode)->Arg(8)->Arg(16)->Arg(66)->Arg(254);
+
+void BM_RobomasCoreParse(benchmark::State& state) {
+  const std::vector<Frame>& frames = FrameMix();
+  RobomasCore core = om_rm_core_init();
+  std::size_t i = 0;
+  for (auto _ : state) {
+    const Frame& frame = frames[i++ & kSampleMask];
+    benchmark::DoNotOptimize(om_rm_core_parse(&core, frame.id, frame.data));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_RobomasCoreParse);
+
+void BM_VescCoreParse(benchmark::State& state) {
+  const std::vector<Frame>& frames = FrameMix();
+  static VescCore core;
+  om_vesc_core_init_in_place(&core);
+  std::size_t i = 0;
+  for (auto _ : state) {
+    const Frame& frame = frames[i++ & kSampleMask];
+    benchmark::DoNotOptimize(om_vesc_core_parse(&core, frame.id, frame.data));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_VescCoreParse);
+
+void BM_ControllerDataFromCan(benchmark::State& state) {
+  const std::vector<Frame>& frames = FrameMix();
+  std::size_t i = 0;
+  for (auto _ : state) {
+    const Frame& frame = frames[i++ & kSampleMask];
+    // アナログとボタンが交互に届く
+    const uint32_t id = (i & 1U) != 0U ? OM_CONTROLLER_CAN_ID_ANALOG
+                                       : OM_CONTROLLER_CAN_ID_BUTTONS;
+    benchmark::DoNotOptimize(om_ctrl_data_from_can(id, frame.data));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_ControllerDataFromCan);
+
+void BM_PidCalc(benchmark::State& state) {
+  std::mt19937 rng(kSeed);
+  std::uniform_real_distribution<float> rpm(-8000.0F, 8000.0F);
+  std::vector<float> goals(kSamples);
+  std::vector<float> actuals(kSamples);
+  for (std::size_t i = 0; i < kSamples; ++i) {
+    goals[i] = rpm(rng);
+    actuals[i] = goals[i] + rpm(rng) * 0.05F;
+  }
+
+  PidParameter parameter = {};
+  parameter.gain.kp = 1.2F;
+  parameter.gain.ki = 0.05F;
+  parameter.gain.kd = 0.01F;
+  parameter.min = -16384.0F;
+  parameter.max = 16384.0F;
+  PidController pid = om_pid_init(parameter);
+  std::size_t i = 0;
+  for (auto _ : state) {
+    const std::size_t n = i++ & kSampleMask;
+    benchmark::DoNotOptimize(om_pid_calc(&pid, goals[n], actuals[n], 0.001F));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_PidCalc);
+
+std::vector<Coordinate> RandomCoordinates(uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> speed(-2.0F, 2.0F);
+  std::uniform_real_distribution<float> angle(-3.14159F, 3.14159F);
+  std::vector<Coordinate> out(kSamples);
+  for (Coordinate& c : out) {
+    c = om_coordinate_init_value(speed(rng), speed(rng), angle(rng), 0.0F);
+  }
+  return out;
+}
+
+void BM_MecanumCalc(benchmark::State& state) {
+  const std::vector<Coordinate> velocities = RandomCoordinates(kSeed);
+  const Mecanum mecanum = om_mecanum_init_radius(0.3F);
+  float result[4];
+  std::size_t i = 0;
+  for (auto _ : state) {
+    om_mecanum_calc(&mecanum, &velocities[i++ & kSampleMask], result);
+    benchmark::DoNotOptimize(result);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_MecanumCalc);
+
+void BM_CoordinateConvertAng(benchmark::State& state) {
+  const std::vector<Coordinate> coordinates = RandomCoordinates(kSeed + 1U);
+  const std::vector<Coordinate> headings = RandomCoordinates(kSeed + 2U);
+  std::size_t i = 0;
+  for (auto _ : state) {
+    const std::size_t n = i++ & kSampleMask;
+    Coordinate c = coordinates[n];
+    om_coordinate_convert_ang(&c, &headings[n].ang);
+    benchmark::DoNotOptimize(c);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_CoordinateConvertAng);
+
+void BM_Amt21CalcChecksum(benchmark::State& state) {
+  std::mt19937 rng(kSeed);
+  std::uniform_int_distribution<int> word(0, 0xFFFF);
+  std::vector<uint16_t> responses(kSamples);
+  for (uint16_t& value : responses) {
+    value = static_cast<uint16_t>(word(rng));
+  }
+  std::size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        om_amt21_calc_checksum(responses[i++ & kSampleMask]));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_Amt21CalcChecksum);
+
+}  // namespace
+
+BENCHMARK_MAIN();
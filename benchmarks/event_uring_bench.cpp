@@ -0,0 +1,189 @@
+// io_uring エンジンと非ブロッキング read の受信コストを比べる
+//
+// CAN_RAW の代わりに can_frame 単位で届く SEQPACKET のソケット対を使い、
+// 同じスレッドで BATCH フレームずつ送っては受信側で全て取り出す。
+// 受信側のフレームあたりの時間とシステムコール数に加えて、送信を含めた時間も
+// 表示する（io_uring では受信バッファへの書き込みが送信側の send の中で
+// 行われるため、受信だけの時間は小さく出る）。
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  // recvmmsg
+#endif
+
+#include <linux/can.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "event/event_uring.h"
+
+namespace {
+
+constexpr int kFrames = 200000;
+constexpr int kBatch = 32;
+
+struct Result {
+  double ns_per_frame;
+  double total_ns_per_frame;
+  double syscalls_per_frame;
+};
+
+struct Pair {
+  int rx;
+  int tx;
+};
+
+bool OpenPair(Pair* pair) {
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK, 0, fds) != 0) {
+    return false;
+  }
+  const int size = 1 << 20;
+  setsockopt(fds[1], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+  pair->rx = fds[0];
+  pair->tx = fds[1];
+  return true;
+}
+
+void ClosePair(const Pair& pair) {
+  close(pair.rx);
+  close(pair.tx);
+}
+
+void SendBatch(int fd, int base) {
+  struct can_frame frame;
+  std::memset(&frame, 0, sizeof(frame));
+  frame.can_dlc = 8U;
+  for (int i = 0; i < kBatch; ++i) {
+    frame.can_id = 0x201U + static_cast<canid_t>((base + i) & 3);
+    frame.data[0] = static_cast<uint8_t>(base + i);
+    send(fd, &frame, sizeof(frame), 0);
+  }
+}
+
+template <typename Receive>
+Result Measure(const Pair& pair, Receive receive) {
+  std::chrono::nanoseconds elapsed(0);
+  uint64_t syscalls = 0;
+  const auto begin = std::chrono::steady_clock::now();
+  for (int sent = 0; sent < kFrames; sent += kBatch) {
+    SendBatch(pair.tx, sent);
+    const auto start = std::chrono::steady_clock::now();
+    syscalls += receive();
+    elapsed += std::chrono::steady_clock::now() - start;
+  }
+  const std::chrono::nanoseconds total =
+      std::chrono::steady_clock::now() - begin;
+  return {static_cast<double>(elapsed.count()) / kFrames,
+          static_cast<double>(total.count()) / kFrames,
+          static_cast<double>(syscalls) / kFrames};
+}
+
+// 1 フレームずつ read する素朴な経路（EAGAIN まで読む）
+Result BenchRead(const Pair& pair) {
+  return Measure(pair, [&pair]() -> uint64_t {
+    struct can_frame frame;
+    uint64_t calls = 0;
+    int received = 0;
+    do {
+      ++calls;
+      if (read(pair.rx, &frame, sizeof(frame)) ==
+          static_cast<ssize_t>(sizeof(frame))) {
+        ++received;
+      }
+    } while (received < kBatch);
+    return calls;
+  });
+}
+
+// can_socketcan と同じ recvmmsg でのまとめ読み
+Result BenchRecvmmsg(const Pair& pair) {
+  return Measure(pair, [&pair]() -> uint64_t {
+    struct can_frame frames[kBatch];
+    struct iovec iov[kBatch];
+    struct mmsghdr headers[kBatch];
+    std::memset(headers, 0, sizeof(headers));
+    for (int i = 0; i < kBatch; ++i) {
+      iov[i].iov_base = &frames[i];
+      iov[i].iov_len = sizeof(frames[i]);
+      headers[i].msg_hdr.msg_iov = &iov[i];
+      headers[i].msg_hdr.msg_iovlen = 1;
+    }
+    uint64_t calls = 0;
+    int received = 0;
+    while (received < kBatch) {
+      ++calls;
+      const int n = recvmmsg(pair.rx, &headers[received],
+                             static_cast<unsigned int>(kBatch - received),
+                             MSG_DONTWAIT, nullptr);
+      if (n > 0) {
+        received += n;
+      }
+    }
+    return calls;
+  });
+}
+
+int g_uring_received = 0;
+
+void OnCan(const ::CanMessage* msg, void* user_arg) {
+  (void)msg;
+  (void)user_arg;
+  ++g_uring_received;
+}
+
+bool BenchUring(const Pair& pair, Result* result) {
+  ::EventUring uring;
+  if (!event_uring_init(&uring) ||
+      event_uring_add_can(&uring, pair.rx, OnCan, nullptr) < 0) {
+    event_uring_close(&uring);
+    return false;
+  }
+  event_uring_run_once(&uring, false);
+
+  *result = Measure(pair, [&uring]() -> uint64_t {
+    const uint32_t enter_before = uring.enter_count;
+    g_uring_received = 0;
+    while (g_uring_received < kBatch) {
+      event_uring_run_once(&uring, true);
+    }
+    return uring.enter_count - enter_before;
+  });
+  event_uring_close(&uring);
+  return true;
+}
+
+void Print(const char* name, const Result& result) {
+  std::printf("%-10s rx %8.1f ns/frame  rx+tx %8.1f ns/frame  %6.3f "
+              "syscalls/frame\n",
+              name, result.ns_per_frame, result.total_ns_per_frame,
+              result.syscalls_per_frame);
+}
+
+}  // namespace
+
+int main() {
+  Pair pair;
+  if (!OpenPair(&pair)) {
+    std::perror("socketpair");
+    return 1;
+  }
+
+  std::printf("%d frames, %d frames per burst\n", kFrames, kBatch);
+  Print("read", BenchRead(pair));
+  Print("recvmmsg", BenchRecvmmsg(pair));
+
+  Result uring;
+  if (BenchUring(pair, &uring)) {
+    Print("io_uring", uring);
+  } else {
+    std::printf("io_uring   not available\n");
+  }
+
+  ClosePair(pair);
+  return 0;
+}
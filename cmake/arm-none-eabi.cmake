@@ -0,0 +1,24 @@
+# Cortex-M 向けのクロスコンパイル設定（arm-none-eabi-gcc）
+#
+# OMURAISU_CORTEX_M_FLAGS で CPU を変えられる（既定は Cortex-M4F）。
+
+set(CMAKE_SYSTEM_NAME Generic)
+set(CMAKE_SYSTEM_PROCESSOR arm)
+
+set(CMAKE_C_COMPILER arm-none-eabi-gcc)
+set(CMAKE_CXX_COMPILER arm-none-eabi-g++)
+
+# リンクにはスタートアップとリンカスクリプトが要るため、試しのビルドは
+# 静的ライブラリで済ませる
+set(CMAKE_TRY_COMPILE_TARGET_TYPE STATIC_LIBRARY)
+
+set(OMURAISU_CORTEX_M_FLAGS
+    "-mcpu=cortex-m4 -mthumb -mfloat-abi=hard -mfpu=fpv4-sp-d16"
+    CACHE STRING "CPU flags for the Cortex-M toolchain")
+
+set(CMAKE_C_FLAGS_INIT "${OMURAISU_CORTEX_M_FLAGS}")
+set(CMAKE_CXX_FLAGS_INIT "${OMURAISU_CORTEX_M_FLAGS}")
+
+set(CMAKE_FIND_ROOT_PATH_MODE_PROGRAM NEVER)
+set(CMAKE_FIND_ROOT_PATH_MODE_LIBRARY ONLY)
+set(CMAKE_FIND_ROOT_PATH_MODE_INCLUDE ONLY)
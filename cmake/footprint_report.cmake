@@ -0,0 +1,148 @@
+# ライブラリごとの flash/RAM 使用量を nm/size で集計し、予算と比べる
+#
+# cmake -DNM=<nm> -DSIZE=<size> -DPROFILE=<名前> -DLIBRARIES=<一覧ファイル>
+#       -DBUDGETS=<予算ファイル> -DOUTPUT=<出力先> -P footprint_report.cmake
+#
+# LIBRARIES は 1 行に「モジュール名 アーカイブのパス」。BUDGETS は 1 行に
+# 「モジュール名 flash ram」（バイト、# 以降はコメント）。flash は
+# text + data、RAM は data + bss（size の Berkeley 形式）。予算を超えた
+# モジュールがあれば表を書いた後に失敗する。
+
+cmake_minimum_required(VERSION 3.14)
+
+foreach(var NM SIZE PROFILE LIBRARIES BUDGETS OUTPUT)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "footprint_report: ${var} is not set")
+    endif()
+endforeach()
+
+# 右寄せ（string(REPEAT) は CMake 3.15 以降のため使わない）
+function(footprint_pad out value width)
+    set(text "${value}")
+    string(LENGTH "${text}" length)
+    while(length LESS width)
+        set(text " ${text}")
+        math(EXPR length "${length} + 1")
+    endwhile()
+    set(${out} "${text}" PARENT_SCOPE)
+endfunction()
+
+function(footprint_row out name flash ram flash_budget ram_budget status)
+    string(LENGTH "${name}" length)
+    while(length LESS 20)
+        set(name "${name} ")
+        math(EXPR length "${length} + 1")
+    endwhile()
+    footprint_pad(flash "${flash}" 8)
+    footprint_pad(ram "${ram}" 8)
+    footprint_pad(flash_budget "${flash_budget}" 8)
+    footprint_pad(ram_budget "${ram_budget}" 8)
+    set(${out} "| ${name} | ${flash} | ${ram} | ${flash_budget} | ${ram_budget} | ${status} |"
+        PARENT_SCOPE)
+endfunction()
+
+# 予算
+file(STRINGS "${BUDGETS}" budget_lines)
+foreach(line IN LISTS budget_lines)
+    string(REGEX REPLACE "#.*$" "" line "${line}")
+    if(line MATCHES "^[ \t]*([A-Za-z0-9_]+)[ \t]+([0-9]+)[ \t]+([0-9]+)")
+        set(budget_flash_${CMAKE_MATCH_1} ${CMAKE_MATCH_2})
+        set(budget_ram_${CMAKE_MATCH_1} ${CMAKE_MATCH_3})
+    endif()
+endforeach()
+
+set(summary "")
+set(details "")
+set(ram_symbols "")
+set(over_budget "")
+set(total_flash 0)
+set(total_ram 0)
+
+file(STRINGS "${LIBRARIES}" library_lines)
+foreach(line IN LISTS library_lines)
+    if(NOT line MATCHES "^([A-Za-z0-9_]+) (.+)$")
+        continue()
+    endif()
+    set(module ${CMAKE_MATCH_1})
+    set(archive "${CMAKE_MATCH_2}")
+
+    execute_process(COMMAND "${SIZE}" -t "${archive}"
+        OUTPUT_VARIABLE size_output
+        RESULT_VARIABLE size_result
+        ERROR_QUIET
+    )
+    if(NOT size_result EQUAL 0 OR NOT size_output MATCHES
+       "([0-9]+)[ \t]+([0-9]+)[ \t]+([0-9]+)[ \t]+[0-9]+[ \t]+[0-9a-fA-F]+[ \t]+\\(TOTALS\\)")
+        message(FATAL_ERROR "footprint_report: failed to run ${SIZE} on ${archive}")
+    endif()
+    math(EXPR flash "${CMAKE_MATCH_1} + ${CMAKE_MATCH_2}")
+    math(EXPR ram "${CMAKE_MATCH_2} + ${CMAKE_MATCH_3}")
+    math(EXPR total_flash "${total_flash} + ${flash}")
+    math(EXPR total_ram "${total_ram} + ${ram}")
+
+    set(flash_budget "-")
+    set(ram_budget "-")
+    set(status "")
+    if(DEFINED budget_flash_${module})
+        set(flash_budget ${budget_flash_${module}})
+        set(ram_budget ${budget_ram_${module}})
+        set(status "ok")
+        if(flash GREATER flash_budget OR ram GREATER ram_budget)
+            set(status "OVER")
+            list(APPEND over_budget ${module})
+        endif()
+    endif()
+    footprint_row(row ${module} ${flash} ${ram} ${flash_budget} ${ram_budget}
+                  "${status}")
+    string(APPEND summary "${row}\n")
+
+    # シンボルごと（大きい順）
+    execute_process(COMMAND "${NM}" -S -t d --size-sort "${archive}"
+        OUTPUT_VARIABLE nm_output
+        ERROR_QUIET
+    )
+    string(REPLACE "\n" ";" nm_lines "${nm_output}")
+    set(entries "")
+    foreach(nm_line IN LISTS nm_lines)
+        if(nm_line MATCHES "^[0-9]+ ([0-9]+) ([A-Za-z]) (.+)$")
+            list(APPEND entries "${CMAKE_MATCH_1} ${CMAKE_MATCH_2} ${CMAKE_MATCH_3}")
+        endif()
+    endforeach()
+    list(SORT entries)
+    list(REVERSE entries)
+
+    string(APPEND details "\n### ${module}\n\n| symbol | section | bytes |\n| --- | --- | ---: |\n")
+    foreach(entry IN LISTS entries)
+        string(REGEX MATCH "^0*([0-9]+) (.) (.+)$" _ "${entry}")
+        set(bytes ${CMAKE_MATCH_1})
+        set(type ${CMAKE_MATCH_2})
+        set(symbol ${CMAKE_MATCH_3})
+        if(type MATCHES "[BbCc]")
+            set(section "ram")
+        elseif(type MATCHES "[DdGgSsVv]")
+            set(section "flash+ram")
+        else()
+            set(section "flash")
+        endif()
+        string(APPEND details "| ${symbol} | ${section} | ${bytes} |\n")
+        if(NOT section STREQUAL "flash")
+            footprint_pad(padded "${bytes}" 8)
+            string(APPEND ram_symbols "${padded}  ${module}: ${symbol}\n")
+        endif()
+    endforeach()
+endforeach()
+
+footprint_row(total_row "total" ${total_flash} ${total_ram} "-" "-" "")
+set(header "| module | flash | ram | flash budget | ram budget | |\n| --- | ---: | ---: | ---: | ---: | --- |\n")
+set(report "# Footprint: ${PROFILE}\n\n${header}${summary}${total_row}\n")
+file(WRITE "${OUTPUT}" "${report}\n## Symbols\n${details}")
+
+message("${report}")
+if(NOT ram_symbols STREQUAL "")
+    message("RAM symbols (bytes):\n${ram_symbols}")
+endif()
+message("Full report: ${OUTPUT}")
+
+if(over_budget)
+    message(FATAL_ERROR "footprint_report: over budget on ${PROFILE}: ${over_budget}")
+endif()
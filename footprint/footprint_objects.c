@@ -0,0 +1,25 @@
+// アプリ側で確保する主な構造体を 1 つずつ置き、現在の設定マクロ
+// （CAN_CUBE_RX_QUEUE_SIZE / SERIAL_CUBE_RX_QUEUE_SIZE など）での RAM 使用量を
+// nm のシンボルサイズとして出す。リンクはしない。
+
+#include "can/can_cube.h"
+#include "can/can_dispatch.h"
+#include "can/can_gateway.h"
+#include "can/can_scheduler.h"
+#include "can/can_serial.h"
+#include "can/can_stm32.h"
+#include "dji/robomas.h"
+#include "serial/serial_cube.h"
+#include "serial/serial_stm32.h"
+#include "vesc/vesc_core.h"
+
+CanCube footprint_can_cube;
+CanStm32Context footprint_can_stm32_context;
+CanDispatcher footprint_can_dispatcher;
+CanScheduler footprint_can_scheduler;
+CanGateway footprint_can_gateway;
+CanSerial footprint_can_serial;
+SerialCube footprint_serial_cube;
+SerialStm32Context footprint_serial_stm32_context;
+Robomas footprint_robomas;
+VescCore footprint_vesc_core;
@@ -0,0 +1,149 @@
+#ifndef CAN_CAPTURE_H
+#define CAN_CAPTURE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "can/can_interface.h"
+#include "can/can_log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief 時刻インデックスに 1 エントリを置くレコード間隔
+#ifndef CAN_CAPTURE_TIME_INDEX_STRIDE
+#define CAN_CAPTURE_TIME_INDEX_STRIDE 1024U
+#endif
+
+#define CAN_CAPTURE_MAGIC "OMCAPT\0\0"
+#define CAN_CAPTURE_VERSION 1U
+
+/// @brief キャプチャファイルの先頭
+/// @details ファイルは「ヘッダ、レコード（CanMessage の配列）、時刻インデックス
+///          （uint32_t）、ID テーブル（CanCaptureIdEntry、ID 昇順）、ID ごとの
+///          レコード番号（uint32_t）」の順に並ぶ。レコードは時刻順で、
+///          timestamp_us は base_time_us からの経過時間 [us]。レコードは
+///          そのまま CanMessage として読めるため、マップしたまま om_rm_parse
+///          などに渡せる。書いた環境とエンディアン・構造体配置が同じ環境でだけ
+///          開ける。
+typedef struct {
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;  // sizeof(CanMessage)
+  uint32_t byte_order;   // 0x01020304
+  uint32_t time_index_stride;
+  uint64_t base_time_us;
+  uint64_t record_count;
+  uint64_t records_offset;
+  uint64_t time_index_offset;
+  uint64_t time_index_count;
+  uint64_t id_table_offset;
+  uint64_t id_count;
+  uint64_t postings_offset;
+} CanCaptureHeader;
+
+typedef struct {
+  uint32_t id;
+  uint32_t count;  // この ID のレコード数
+  uint64_t first;  // レコード番号表での先頭位置
+} CanCaptureIdEntry;
+
+/// @brief キャプチャファイルを作る
+/// @details レコードは時刻順に追加する。時刻が前のレコードより戻った場合は
+///          前のレコードと同じ時刻として記録する（clamped_count で数える）。
+///          1 ファイルに入る時間は先頭から 2^32 us（約 71 分）まで。
+typedef struct {
+  FILE* file;
+  uint64_t count;
+  uint64_t base_time_us;
+  uint32_t last_offset_us;
+
+  uint32_t* time_index;
+  size_t time_index_count;
+  size_t time_index_capacity;
+
+  uint32_t* ids;  // レコード番号ごとの ID
+  size_t ids_capacity;
+
+  uint32_t clamped_count;
+  bool error;
+} CanCaptureBuilder;
+
+bool can_capture_builder_open(CanCaptureBuilder* builder, const char* path);
+
+/// @return 時刻が範囲外の場合や書き込みに失敗した場合は false
+bool can_capture_builder_append(CanCaptureBuilder* builder,
+                                const CanLogRecord* record);
+
+/// @brief インデックスとヘッダを書いてファイルを閉じる
+bool can_capture_builder_finish(CanCaptureBuilder* builder);
+
+/// @brief candump のログ形式のテキストをキャプチャファイルに変換する
+/// @param count 変換したフレーム数（NULL 可）
+/// @return 読めない行があった場合も false（それまでの内容は書かれる）
+bool can_capture_import_candump(FILE* input, const char* path, size_t* count);
+
+/// @brief mmap で開いたキャプチャファイル
+/// @details OMURAISU_CAN_CAPTURE_ENABLE が未定義の環境では全ての操作が失敗する。
+typedef struct {
+  const uint8_t* base;
+  size_t size;
+
+  const CanCaptureHeader* header;
+  const CanMessage* records;
+  const uint32_t* time_index;
+  const CanCaptureIdEntry* ids;
+  const uint32_t* postings;
+} CanCapture;
+
+/// @brief キャプチャファイルをマップして開く
+/// @details 開くときに確かめるのはヘッダ・各領域の範囲・ID テーブルまでで、
+///          レコード番号表の中身は問い合わせで読むときに確かめる。
+/// @return 形式が違う場合や、インデックスがレコードの範囲外を指す（途中で
+///         切れた・壊れた）ファイルは false
+bool can_capture_open(CanCapture* capture, const char* path);
+
+void can_capture_close(CanCapture* capture);
+
+size_t can_capture_count(const CanCapture* capture);
+
+/// @brief マップされたレコード配列（コピーせずに読める）
+const CanMessage* can_capture_records(const CanCapture* capture);
+
+/// @brief レコードの時刻 [us]
+uint64_t can_capture_time_us(const CanCapture* capture, const CanMessage* msg);
+
+/// @brief 時刻が t_us 以降の最初のレコード番号
+size_t can_capture_lower_bound(const CanCapture* capture, uint64_t t_us);
+
+/// @brief 問い合わせ結果を順に返すカーソル
+typedef struct {
+  const CanCapture* capture;
+  const uint32_t* postings;  // ID 指定時のレコード番号表（NULL なら全レコード）
+  size_t pos;
+  size_t end;
+} CanCaptureCursor;
+
+/// @brief [t0_us, t1_us) の全フレームを問い合わせる
+void can_capture_query(const CanCapture* capture, CanCaptureCursor* cursor,
+                       uint64_t t0_us, uint64_t t1_us);
+
+/// @brief [t0_us, t1_us) の id のフレームを問い合わせる
+/// @return id のフレームが 1 つも無い場合は false（カーソルは空になる）
+bool can_capture_query_id(const CanCapture* capture, CanCaptureCursor* cursor,
+                          uint32_t id, uint64_t t0_us, uint64_t t1_us);
+
+/// @brief 次のフレーム（マップ内を直接指す）。終わりなら NULL
+/// @details レコード数を超えるレコード番号（壊れたファイル）は飛ばす。
+const CanMessage* can_capture_next(CanCaptureCursor* cursor);
+
+size_t can_capture_cursor_remaining(const CanCaptureCursor* cursor);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CAN_CAPTURE_H
@@ -2,53 +2,199 @@
 #define CAN_CUBE_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "can/can_interface.h"
+#include "ring/spsc_ring.h"
 
+/// @brief 受信キューの段数（2のべき乗）
 #ifndef CAN_CUBE_RX_QUEUE_SIZE
 #define CAN_CUBE_RX_QUEUE_SIZE 16
 #endif
 
+/// @brief 送信キューの段数
+#ifndef CAN_CUBE_TX_QUEUE_SIZE
+#define CAN_CUBE_TX_QUEUE_SIZE 16
+#endif
+
+/// @brief CAN FD 送信キューの段数（0 で無効）
+/// @details 1 段あたり約 70 バイトを使うため既定では無効。有効にすると、
+///          送信キューに先行フレームがある間や送信バッファが一杯のときに、
+///          8 バイトを超える FD フレームをここに溜めて送信割り込みから送る。
+///          0 では FD フレームは送信キューが空で送信バッファに空きがあるとき
+///          だけ送れ、送れなかった分は tx_overflows に数える。
+#ifndef CAN_CUBE_FD_TX_QUEUE_SIZE
+#define CAN_CUBE_FD_TX_QUEUE_SIZE 0
+#endif
+
+/// @brief CAN FD 受信キューの段数（2のべき乗、0 で無効）
+/// @details 1 段あたり約 70 バイトを使うため既定では無効。有効にすると
+///          ops.read_hw_fd で受けた 8 バイトを超える FD フレームをここに溜める。
+#ifndef CAN_CUBE_FD_RX_QUEUE_SIZE
+#define CAN_CUBE_FD_RX_QUEUE_SIZE 0
+#endif
+
+SPSC_RING_ASSERT_POW2(CAN_CUBE_RX_QUEUE_SIZE);
+#if CAN_CUBE_FD_RX_QUEUE_SIZE > 0
+SPSC_RING_ASSERT_POW2(CAN_CUBE_FD_RX_QUEUE_SIZE);
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef struct {
+  /// @brief ハードウェア送信バッファに 1 フレーム積む（空きがなければ false）
   bool (*write)(void* hal_context, const CanMessage* msg);
   bool (*read_hw)(void* hal_context, CanMessage* msg);
   void (*start_read)(void* hal_context);
   void (*stop_read)(void* hal_context);
+
+  /// @brief 送信バッファ空き割り込みの有効/無効を切り替える（任意）
+  /// @details 設定すると送信キューが有効になり、割り込みハンドラから
+  ///          can_cube_on_tx_ready() を呼ぶことでキューが送信される。
+  ///          メインループ側は無効化している間に送信キューを操作する。
+  ///          送信キューはアービトレーションと同じく ID の小さい順に送られ、
+  ///          CAN_MSG_FLAG_REPLACE 付きのフレームは同じ ID の未送信フレームを
+  ///          置き換える。
+  void (*set_tx_notify)(void* hal_context, bool enable);
+
+  /// @brief CAN FD フレームを送信バッファに 1 つ積む（任意）
+  bool (*write_fd)(void* hal_context, const CanFdMessage* msg);
+
+  /// @brief 受信フレームを FD 形式で 1 つ取り出す（任意）
+  /// @details CAN_CUBE_FD_RX_QUEUE_SIZE > 0 のとき read_hw の代わりに使われ、
+  ///          従来フレームは従来の受信キューへ、それ以外は FD 受信キューへ
+  ///          振り分けられる。
+  bool (*read_hw_fd)(void* hal_context, CanFdMessage* msg);
+
+  /// @brief エラーカウンタ（tec / rec / bus_off）を読む（任意）
+  void (*read_error_state)(void* hal_context, CanBusStats* stats);
 } CanCubeOps;
 
+/// @brief 受信フレームの渡し方
+typedef enum {
+  /// 受信キューに積み、コールバックにも渡す（既定）
+  CAN_CUBE_RX_QUEUE_AND_CALLBACK = 0,
+  /// コールバックが設定されていればキューに積まない
+  /// （can_cube_poll では取り出せなくなる）
+  CAN_CUBE_RX_CALLBACK_ONLY = 1,
+} CanCubeRxMode;
+
 typedef struct {
   CanBus bus;
 
   void* hal_context;
   CanCubeOps ops;
 
+  // 受信割り込み（プロデューサ）とメインループ（コンシューマ）で共有
   CanMessage rx_queue[CAN_CUBE_RX_QUEUE_SIZE];
-  uint8_t rx_head;
-  uint8_t rx_tail;
-  uint8_t rx_count;
+  SpscRing rx_ring;
 
   uint32_t rx_overflow_count;
 
+  // メインループ（送信割り込み無効中）と送信割り込みで共有
+  // ID の降順に並べ、末尾（最も優先度の高い ID）から送る
+  CanMessage tx_queue[CAN_CUBE_TX_QUEUE_SIZE];
+  uint16_t tx_count;
+
+  uint32_t tx_overflow_count;
+
+#if CAN_CUBE_FD_TX_QUEUE_SIZE > 0
+  // 送信キューと同じく送信割り込み無効中だけ操作する。FD フレーム同士は
+  // 積んだ順に、従来フレームとは ID の小さい方から送る。
+  CanFdMessage fd_tx_queue[CAN_CUBE_FD_TX_QUEUE_SIZE];
+  uint16_t fd_tx_head;
+  uint16_t fd_tx_count;
+#endif
+
+#if CAN_CUBE_FD_RX_QUEUE_SIZE > 0
+  CanFdMessage fd_rx_queue[CAN_CUBE_FD_RX_QUEUE_SIZE];
+  SpscRing fd_rx_ring;
+#endif
+
   CanRxCallback rx_callback;
   void* rx_callback_user_arg;
+  CanCubeRxMode rx_mode;
+
+  CanClockFn clock;
+  void* clock_user_arg;
+
+  // 統計（オーバーフロー数とエラー状態以外はここで数える）
+  CanBusStats stats;
+  uint32_t bitrate;
+  uint32_t rx_bits;  // 受信割り込み側で加算
+  uint32_t tx_bits;  // 送信側で加算
+  uint32_t load_last_bits;
+  uint32_t load_last_time_us;
+  bool load_window_started;
 } CanCube;
 
 void can_cube_init(CanCube* cube, void* hal_context, const CanCubeOps* ops);
 
 CanBus* can_cube_bus(CanCube* cube);
 
+/// @brief 受信割り込みの中で呼ばれるコールバックを設定する
+/// @details ops.read_hw は受信キューの空きスロットへ直接書き込み、コールバックには
+///          そのスロットを指すポインタが渡される（割り込み中のフレームのコピーは
+///          HAL からの 1 回だけ）。ポインタはコールバックから戻った後は使わないこと。
 void can_cube_set_rx_callback(CanCube* cube, CanRxCallback callback,
                               void* user_arg);
 
+/// @brief 受信フレームをキューにも積むかを切り替える
+/// @details 全フレームをコールバック（CanDispatcher など）で処理する構成では
+///          CAN_CUBE_RX_CALLBACK_ONLY にすると、キューの溢れを気にせずに済む。
+void can_cube_set_rx_mode(CanCube* cube, CanCubeRxMode mode);
+
+/// @brief 受信時刻を付けるための時計を設定する（任意）
+/// @details can_cube_on_rx_pending の開始時に読んだ値を、ハードウェア
+///          タイムスタンプの付いていないフレームに付ける。メインループと同じ
+///          時計を渡せば受信から制御までの遅延を測れる。終了時にも読み、
+///          割り込み処理時間の統計に使う。
+void can_cube_set_clock(CanCube* cube, CanClockFn clock, void* user_arg);
+
+/// @brief バス負荷の推定に使う公称ビットレート [bit/s]
+/// @details 負荷の推定には can_cube_set_clock の時計も必要。
+void can_cube_set_bitrate(CanCube* cube, uint32_t bitrate);
+
+/// @brief 統計情報のスナップショットを取る
+/// @details カウンタをコピーし、エラーカウンタを HAL から読むだけなので制御周期
+///          ごとに呼んでよい。バス負荷は前回の呼び出しからの平均になる。
+void can_cube_get_stats(CanCube* cube, CanBusStats* stats);
+
 bool can_cube_poll(CanCube* cube, CanMessage* msg);
 
+/// @brief 受信キューから最大 max_count 個のフレームをまとめて取り出す
+size_t can_cube_poll_batch(CanCube* cube, CanMessage* msgs, size_t max_count);
+
+/// @brief FD 受信キュー、空なら従来の受信キューから 1 フレーム取り出す
+/// @details FD 受信キューが無効な構成では従来フレームだけが返る。
+bool can_cube_poll_fd(CanCube* cube, CanFdMessage* msg);
+
 uint32_t can_cube_get_rx_overflow_count(const CanCube* cube);
 
+/// @brief 送信キュー（FD 送信キューを含む）に溢れて破棄したフレーム数
+uint32_t can_cube_get_tx_overflow_count(const CanCube* cube);
+
+/// @brief 送信キュー（FD 送信キューを含む）に残っているフレーム数
+uint32_t can_cube_get_tx_pending_count(const CanCube* cube);
+
+/// @brief 送信キューに残っているフレームを全て捨てる
+/// @return 捨てたフレーム数
+uint32_t can_cube_clear_tx(CanCube* cube);
+
 void can_cube_start_read(CanCube* cube);
 
 void can_cube_stop_read(CanCube* cube);
 
 void can_cube_on_rx_pending(CanCube* cube);
 
+/// @brief 送信バッファに空きができたとき（送信完了割り込み）に呼ぶ
+void can_cube_on_tx_ready(CanCube* cube);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
 #endif  // CAN_CUBE_H
@@ -0,0 +1,111 @@
+#ifndef CAN_DISPATCH_H
+#define CAN_DISPATCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can/can_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief 完全一致 ID 用ハッシュテーブルのスロット数（2のべき乗）
+#ifndef CAN_DISPATCH_TABLE_SIZE
+#define CAN_DISPATCH_TABLE_SIZE 32
+#endif
+
+/// @brief 登録できるルール（add_* 1 回につき 1 つ）の最大数
+#ifndef CAN_DISPATCH_MAX_RULES
+#define CAN_DISPATCH_MAX_RULES 8
+#endif
+
+/// @brief can_dispatcher_poll が 1 回の can_bus_read_batch で取り出す最大数
+#ifndef CAN_DISPATCH_POLL_BATCH_SIZE
+#define CAN_DISPATCH_POLL_BATCH_SIZE 8
+#endif
+
+typedef enum {
+  CAN_DISPATCH_RULE_RANGE = 0,  ///< id 〜 id_last の連続 ID（完全一致を含む）
+  CAN_DISPATCH_RULE_MASK = 1,   ///< (msg.id & mask) == (id & mask)
+} CanDispatchRuleKind;
+
+typedef struct {
+  CanDispatchRuleKind kind;
+  uint32_t id;
+  uint32_t id_last;
+  uint32_t mask;
+
+  CanRxCallback callback;
+  void* user_arg;
+} CanDispatchRule;
+
+typedef struct {
+  uint32_t id;
+  uint8_t rule;  // ルール番号 + 1（0 は空きスロット）
+} CanDispatchSlot;
+
+/// @brief 受信 ID からハンドラを引く振り分けテーブル
+/// @details RANGE ルールは ID ごとにハッシュテーブルへ展開され O(1) で引ける。
+///          ハッシュに無い ID は MASK ルールを登録順に照合する（VESC の
+///          拡張 ID のようにテーブルへ展開できないパターン向け）。
+///          各フレームは最初に一致した 1 つのハンドラだけに渡される。
+typedef struct {
+  CanDispatchRule rules[CAN_DISPATCH_MAX_RULES];
+  uint8_t rule_count;
+
+  CanDispatchSlot table[CAN_DISPATCH_TABLE_SIZE];
+  uint16_t table_count;
+
+  CanRxCallback default_callback;
+  void* default_user_arg;
+
+  uint32_t unmatched_count;
+} CanDispatcher;
+
+void can_dispatcher_init(CanDispatcher* dispatcher);
+
+/// @brief 1 つの ID にハンドラを登録する
+/// @return 登録済みの ID と重なる場合やテーブルが一杯の場合は false
+bool can_dispatcher_add_id(CanDispatcher* dispatcher, uint32_t id,
+                           CanRxCallback callback, void* user_arg);
+
+/// @brief first_id 〜 last_id（両端含む）にハンドラを登録する
+bool can_dispatcher_add_range(CanDispatcher* dispatcher, uint32_t first_id,
+                              uint32_t last_id, CanRxCallback callback,
+                              void* user_arg);
+
+/// @brief ID/マスクのパターンにハンドラを登録する
+bool can_dispatcher_add_mask(CanDispatcher* dispatcher, uint32_t id,
+                             uint32_t mask, CanRxCallback callback,
+                             void* user_arg);
+
+/// @brief どのルールにも一致しなかったフレームの受け取り先（任意）
+void can_dispatcher_set_default(CanDispatcher* dispatcher,
+                                CanRxCallback callback, void* user_arg);
+
+/// @brief 1 フレームを対応するハンドラに渡す
+/// @return ハンドラ（既定ハンドラを除く）が見つかった場合 true
+bool can_dispatcher_dispatch(CanDispatcher* dispatcher, const CanMessage* msg);
+
+/// @brief バスの受信フレームを全て取り出して振り分ける
+/// @return 処理したフレーム数
+size_t can_dispatcher_poll(CanDispatcher* dispatcher, CanBus* bus);
+
+uint32_t can_dispatcher_get_unmatched_count(const CanDispatcher* dispatcher);
+
+/// @brief 登録済みルールを受け付けるハードウェアフィルタを求める
+/// @details ルール 1 つにつき 1 つのフィルタを filters に書き込む（最大 max_count
+///          個）。ID 範囲はそれを含む最小の ID/マスクに広げるため、余分に通った
+///          フレームは dispatch で一致なしとして捨てられる。既定ハンドラが
+///          設定されている場合は全フレームが必要なため 0 を返す。
+/// @return 必要なフィルタ数（max_count を超える場合は書き込みが途中で止まる）
+size_t can_dispatcher_get_filters(const CanDispatcher* dispatcher,
+                                  CanFilter* filters, size_t max_count);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CAN_DISPATCH_H
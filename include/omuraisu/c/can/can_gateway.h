@@ -0,0 +1,114 @@
+#ifndef CAN_GATEWAY_H
+#define CAN_GATEWAY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can/can_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief 接続できるバスの最大数
+#ifndef CAN_GATEWAY_MAX_BUSES
+#define CAN_GATEWAY_MAX_BUSES 4
+#endif
+
+/// @brief 登録できる経路の最大数
+#ifndef CAN_GATEWAY_MAX_ROUTES
+#define CAN_GATEWAY_MAX_ROUTES 16
+#endif
+
+/// @brief 1 回の can_bus_read_batch で取り出す最大数
+#ifndef CAN_GATEWAY_BATCH_SIZE
+#define CAN_GATEWAY_BATCH_SIZE 16
+#endif
+
+/// @brief 中継の経路
+/// @details 受信元 src_bus で (msg.id & mask) == (id & mask) のフレームを
+///          dst_bus へ送る。rewrite_mask が 0 でなければ送信 ID を
+///          (msg.id & ~rewrite_mask) | (rewrite_id & rewrite_mask) に書き換える
+///          （rewrite_mask = 0x7FF で ID の置き換え、上位ビットだけで
+///          0x200 番台 → 0x300 番台のような付け替え）。
+typedef struct {
+  uint8_t src_bus;
+  uint8_t dst_bus;
+  uint32_t id;
+  uint32_t mask;
+  uint32_t rewrite_id;
+  uint32_t rewrite_mask;
+} CanGatewayRoute;
+
+typedef struct {
+  CanBus* bus;
+
+  /// @brief このバスで受信した全フレームの受け取り先（任意）
+  CanRxCallback local_callback;
+  void* local_user_arg;
+
+  uint32_t rx_frames;
+  uint32_t forwarded;   ///< このバスへ送ったフレーム数
+  uint32_t tx_dropped;  ///< 送信を受け付けられず捨てたフレーム数
+  uint32_t unrouted;    ///< どの経路にも一致しなかった受信フレーム数
+} CanGatewayPort;
+
+/// @brief 複数の CanBus をつなぎ、経路表に従ってフレームを中継する
+/// @details can_gateway_poll は各バスの受信キューから CAN_GATEWAY_BATCH_SIZE
+///          個ずつ取り出し、経路表を引いて宛先ごとにまとめ、宛先 1 つにつき
+///          1 回の can_bus_write_batch で送る。1 つのフレームが複数の経路に
+///          一致した場合は全ての宛先へ送る。受信元と宛先が同じ経路は登録
+///          できない。中継したフレームの flags は 0 になる。
+typedef struct {
+  CanGatewayPort ports[CAN_GATEWAY_MAX_BUSES];
+  uint8_t port_count;
+
+  CanGatewayRoute routes[CAN_GATEWAY_MAX_ROUTES];
+  uint8_t route_count;
+
+  // 宛先ごとの送信待ち（poll の中でだけ使う）
+  CanMessage tx_batch[CAN_GATEWAY_MAX_BUSES][CAN_GATEWAY_BATCH_SIZE];
+  uint8_t tx_count[CAN_GATEWAY_MAX_BUSES];
+} CanGateway;
+
+void can_gateway_init(CanGateway* gateway);
+
+/// @brief バスを接続する
+/// @param local_callback 受信した全フレームを中継とは別に渡す先（NULL 可）
+/// @return バス番号（接続できない場合は -1）
+int can_gateway_add_bus(CanGateway* gateway, CanBus* bus,
+                        CanRxCallback local_callback, void* user_arg);
+
+/// @brief ID/マスクで選んだフレームを別のバスへ送る経路を登録する
+bool can_gateway_add_route(CanGateway* gateway, uint8_t src_bus, uint32_t id,
+                           uint32_t mask, uint8_t dst_bus);
+
+/// @brief 送信 ID を書き換える経路を登録する
+bool can_gateway_add_route_rewrite(CanGateway* gateway, uint8_t src_bus,
+                                   uint32_t id, uint32_t mask, uint8_t dst_bus,
+                                   uint32_t rewrite_id, uint32_t rewrite_mask);
+
+/// @brief src_bus で受信した msgs を経路表に従って中継する
+/// @details can_bus_read_batch 以外の経路（割り込みで受けたフレームなど）から
+///          中継したい場合に使う。local_callback は呼ばれない。
+/// @return 宛先のバスが受け付けたフレーム数
+size_t can_gateway_forward(CanGateway* gateway, uint8_t src_bus,
+                           const CanMessage* msgs, size_t count);
+
+/// @brief 全バスの受信フレームを取り出して中継する
+/// @return 取り出したフレーム数
+size_t can_gateway_poll(CanGateway* gateway);
+
+/// @brief bus に届く必要のあるフレームを通すハードウェアフィルタを求める
+/// @details bus を受信元とする経路 1 つにつき 1 つのフィルタを書き込む。
+///          local_callback が設定されたバスは全フレームが必要なため 0 を返す。
+/// @return 必要なフィルタ数（max_count を超える場合は書き込みが途中で止まる）
+size_t can_gateway_get_filters(const CanGateway* gateway, uint8_t bus,
+                               CanFilter* filters, size_t max_count);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CAN_GATEWAY_H
@@ -2,32 +2,123 @@
 #define CAN_INTERFACE_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/// @brief CanMessage::flags / CanFdMessage::flags 共通
+#define CAN_MSG_FLAG_TIMESTAMP 0x80U  ///< timestamp_us が有効
+
+/// @brief CanMessage::flags（送信時）
+/// @details 送信キューに同じ ID の未送信フレームが残っていれば、新しい
+///          フレームで置き換える（指令値のように最新の値だけ送ればよいもの向け）。
+///          送信キューを持たないバスでは無視される。
+#define CAN_MSG_FLAG_REPLACE 0x40U
+
 /// @brief プラットフォーム非依存のCANメッセージ構造体
 typedef struct {
   uint32_t id;
   uint8_t data[8];
   uint8_t len;
+  uint8_t flags;
+
+  /// @brief 受信時刻 [us]（32bit で一周する）
+  /// @details 受信側が CAN_MSG_FLAG_TIMESTAMP を立てたときだけ有効。
+  ///          送信時は無視される。
+  uint32_t timestamp_us;
 } CanMessage;
 
+/// @brief CAN FD の最大ペイロード長
+#define CAN_FD_MAX_DATA_LEN 64U
+
+/// @brief CanFdMessage::flags
+#define CAN_FD_FLAG_FDF 0x01U  ///< FD フォーマット（未設定なら従来 CAN）
+#define CAN_FD_FLAG_BRS 0x02U  ///< データフェーズでビットレートを切り替える
+
+/// @brief CAN FD フレーム（最大 64 バイト）
+/// @details 従来の 8 バイト経路（CanMessage）を太らせないよう別の型として扱う。
+///          FD フレームの len は 0〜8, 12, 16, 20, 24, 32, 48, 64 のいずれか。
+typedef struct {
+  uint32_t id;
+  uint8_t data[CAN_FD_MAX_DATA_LEN];
+  uint8_t len;
+  uint8_t flags;
+  uint32_t timestamp_us;
+} CanFdMessage;
+
+/// @brief ID が 0x7FF を超えるフレームは拡張 ID として扱う
+#define CAN_STD_ID_MAX 0x7FFU
+#define CAN_EXT_ID_MAX 0x1FFFFFFFU
+
+/// @brief ハードウェア受信フィルタの汎用表現
+/// @details (受信 ID & mask) == id のフレームを受け付ける。
+///          id が CAN_STD_ID_MAX を超える場合は拡張 ID のフィルタとなる。
+typedef struct {
+  uint32_t id;
+  uint32_t mask;
+} CanFilter;
+
+/// @brief バスの統計情報のスナップショット
+/// @details 対応していない項目は 0 のまま。
+typedef struct {
+  uint32_t rx_frames;
+  uint32_t tx_frames;    ///< ハードウェアに渡したフレーム数
+  uint32_t tx_failures;  ///< 送信を受け付けられず呼び出し元に失敗を返した回数
+  uint32_t rx_overflows;
+  uint32_t tx_overflows;
+  uint16_t rx_queue_high_water;
+  uint16_t tx_queue_high_water;
+
+  uint32_t isr_count;        ///< 受信割り込み処理の回数
+  uint32_t isr_time_us;      ///< 受信割り込み処理の累計時間
+  uint32_t isr_time_max_us;  ///< 受信割り込み処理 1 回の最大時間
+
+  /// @brief 前回のスナップショットからの推定バス負荷 [%]
+  /// @details 送受信したフレームのビット数（スタッフビットを除く）から求める。
+  float bus_load_percent;
+
+  uint8_t tec;  ///< 送信エラーカウンタ
+  uint8_t rec;  ///< 受信エラーカウンタ
+  bool bus_off;
+  uint32_t bus_off_count;  ///< バスオフへの遷移回数
+} CanBusStats;
+
 typedef void (*CanRxCallback)(const CanMessage* msg, void* user_arg);
 
+/// @brief 受信時刻を付けるための時計 [us]
+typedef uint32_t (*CanClockFn)(void* user_arg);
+
 /// @brief CANバスの抽象インターフェース
 /// @details 各プラットフォーム（mbed, Arduino, Linux SocketCANなど）で
 ///          このインターフェースを実装する。
 typedef struct {
   bool (*write)(void* self, const CanMessage* msg);
 
+  /// @brief count 個のフレームを先頭から順にまとめて送信する（任意）
+  /// @return 受け付けたフレーム数（送信済みまたは送信キュー投入済み）
+  size_t (*write_batch)(void* self, const CanMessage* msgs, size_t count);
+
   bool (*read)(void* self, CanMessage* msg);
 
+  /// @brief 最大 max_count 個の受信フレームを msgs にまとめて取り出す（任意）
+  /// @return 取り出したフレーム数
+  size_t (*read_batch)(void* self, CanMessage* msgs, size_t max_count);
+
+  /// @brief CAN FD フレームを 1 つ送信する（任意）
+  bool (*write_fd)(void* self, const CanFdMessage* msg);
+
+  /// @brief CAN FD フレームを 1 つ取り出す（任意）
+  bool (*read_fd)(void* self, CanFdMessage* msg);
+
   void (*start_read)(void* self);
   void (*stop_read)(void* self);
 
+  /// @brief 統計情報のスナップショットを取る（任意）
+  bool (*get_stats)(void* self, CanBusStats* stats);
+
   void (*destroy)(void* self);
 
   void* impl;
@@ -35,8 +126,45 @@ typedef struct {
 
 bool can_bus_write(CanBus* bus, const CanMessage* msg);
 
+/// @brief 複数フレームを順にまとめて送信する
+/// @details write_batch 未実装のバスでは失敗するまで write を繰り返す。
+size_t can_bus_write_batch(CanBus* bus, const CanMessage* msgs, size_t count);
+
 bool can_bus_read(CanBus* bus, CanMessage* msg);
 
+/// @brief 受信フレームをまとめて取り出す
+/// @details read_batch 未実装のバスでは read を繰り返す。
+size_t can_bus_read_batch(CanBus* bus, CanMessage* msgs, size_t max_count);
+
+/// @brief CAN FD フレームを送信する
+/// @details write_fd 未実装のバスでは FDF なし・8 バイト以下のフレームに限り
+///          write で従来フレームとして送る。
+bool can_bus_write_fd(CanBus* bus, const CanFdMessage* msg);
+
+/// @brief CAN FD フレームを取り出す
+/// @details read_fd 未実装のバスでは read で受けた従来フレームを変換して返す。
+bool can_bus_read_fd(CanBus* bus, CanFdMessage* msg);
+
+/// @brief ペイロード長を FD の DLC（0〜15）に変換する（端数は切り上げ）
+uint8_t can_fd_len_to_dlc(uint8_t len);
+
+/// @brief FD の DLC（0〜15）をペイロード長に変換する
+uint8_t can_fd_dlc_to_len(uint8_t dlc);
+
+/// @brief len を FD フレームで送れる長さに切り上げる（最大 64）
+uint8_t can_fd_round_len(uint8_t len);
+
+/// @brief 従来フレームを CanFdMessage に詰め替える（受信時刻以外の flags は 0）
+void can_fd_message_from_classic(CanFdMessage* dst, const CanMessage* src);
+
+/// @brief FDF なし・8 バイト以下の CanFdMessage を従来フレームに詰め替える
+/// @return 従来フレームで表せない場合は false
+bool can_fd_message_to_classic(CanMessage* dst, const CanFdMessage* src);
+
+/// @brief 統計情報のスナップショットを取る
+/// @return get_stats 未実装のバスでは stats を 0 で埋めて false
+bool can_bus_get_stats(CanBus* bus, CanBusStats* stats);
+
 void can_bus_start_read(CanBus* bus);
 
 void can_bus_stop_read(CanBus* bus);
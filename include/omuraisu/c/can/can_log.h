@@ -0,0 +1,194 @@
+#ifndef CAN_LOG_H
+#define CAN_LOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can/can_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief ログの先頭に置く識別子とバージョン
+#define CAN_LOG_MAGIC "OMCL"
+#define CAN_LOG_VERSION 1U
+#define CAN_LOG_HEADER_SIZE 8U
+
+/// @brief 1 レコードの最大バイト数（時刻差 10 + 情報 1 + ID 4 + データ 8）
+#define CAN_LOG_MAX_RECORD_SIZE 23U
+
+/// @brief 書き込み/読み込みバッファのバイト数
+#ifndef CAN_LOG_BUFFER_SIZE
+#define CAN_LOG_BUFFER_SIZE 256
+#endif
+
+#if CAN_LOG_BUFFER_SIZE < 32
+#error "CAN_LOG_BUFFER_SIZE must be at least 32"
+#endif
+
+/// @brief 記録されたフレーム 1 つ
+typedef struct {
+  CanMessage msg;
+  uint64_t time_us;  // ログ内の時刻（msg.timestamp_us はこの下位 32bit）
+  bool tx;           // 送信したフレームなら true、受信なら false
+} CanLogRecord;
+
+/// @brief 書き込み先（size バイトすべてを書けた場合に size を返す）
+typedef size_t (*CanLogSinkFn)(void* user_arg, const uint8_t* data,
+                               size_t size);
+
+/// @brief 読み込み元（最大 size バイトを data に読み、0 で終端）
+typedef size_t (*CanLogSourceFn)(void* user_arg, uint8_t* data, size_t size);
+
+/// @brief バイナリログを順に書き出すライタ
+/// @details 1 レコードは「前のレコードからの時刻差（zigzag varint）、
+///          長さ・拡張 ID・方向の 1 バイト、ID（標準 2 / 拡張 4 バイト LE）、
+///          データ」の形で、8 バイトの標準フレームなら 12 バイト前後に収まる。
+///          レコードはバッファに溜め、一杯になるか can_log_writer_flush を
+///          呼んだときにまとめて sink に渡す。
+typedef struct {
+  CanLogSinkFn sink;
+  void* sink_user_arg;
+
+  uint8_t buffer[CAN_LOG_BUFFER_SIZE];
+  size_t used;
+
+  uint64_t last_time_us;
+  uint32_t record_count;
+  uint32_t dropped_count;  // 書き込み先のエラーで失ったレコード数
+  bool error;
+} CanLogWriter;
+
+/// @brief ヘッダをバッファに積んで初期化する
+void can_log_writer_init(CanLogWriter* writer, CanLogSinkFn sink,
+                         void* user_arg);
+
+/// @brief レコードを 1 つ追加する（必要ならその前にフラッシュする）
+/// @return 書き込み先がエラーになっている場合は false
+bool can_log_writer_append(CanLogWriter* writer, const CanLogRecord* record);
+
+/// @brief バッファの内容を書き込み先に渡す
+bool can_log_writer_flush(CanLogWriter* writer);
+
+/// @brief バイナリログを順に読み出すリーダ
+typedef struct {
+  CanLogSourceFn source;
+  void* source_user_arg;
+
+  uint8_t buffer[CAN_LOG_BUFFER_SIZE];
+  size_t pos;
+  size_t len;
+
+  uint64_t last_time_us;
+  bool header_checked;
+  bool eof;
+  bool error;  // ヘッダ不一致または途中で切れたレコード
+} CanLogReader;
+
+void can_log_reader_init(CanLogReader* reader, CanLogSourceFn source,
+                         void* user_arg);
+
+/// @brief 次のレコードを読む
+/// @return ログの終端またはエラーの場合は false（can_log_reader_has_error で区別）
+bool can_log_reader_next(CanLogReader* reader, CanLogRecord* record);
+
+bool can_log_reader_has_error(const CanLogReader* reader);
+
+/// @brief メモリ上のバッファを書き込み先/読み込み元にする
+typedef struct {
+  uint8_t* data;
+  size_t size;
+  size_t pos;
+} CanLogMemory;
+
+void can_log_memory_init(CanLogMemory* memory, uint8_t* data, size_t size);
+
+/// @param user_arg CanLogMemory*（容量を超える分は書かれない）
+size_t can_log_memory_sink(void* user_arg, const uint8_t* data, size_t size);
+
+/// @param user_arg CanLogMemory*（size バイトまで読む）
+size_t can_log_memory_source(void* user_arg, uint8_t* data, size_t size);
+
+/// @param user_arg FILE*
+size_t can_log_file_sink(void* user_arg, const uint8_t* data, size_t size);
+
+/// @param user_arg FILE*
+size_t can_log_file_source(void* user_arg, uint8_t* data, size_t size);
+
+/// @brief 任意の CanBus に被せて送受信したフレームを記録するデコレータ
+/// @details 送受信はそのまま inner に渡し、成功したフレームを記録する。受信時刻
+///          の付いたフレームはその時刻を、それ以外は時計の値を使う。FD フレーム
+///          は記録せずに素通しする。
+typedef struct {
+  CanBus bus;
+  CanBus* inner;
+  CanLogWriter* writer;
+
+  CanClockFn clock;
+  void* clock_user_arg;
+
+  // 32bit の時刻を 64bit に伸ばす
+  uint32_t last_raw_us;
+  uint64_t time_us;
+  bool time_started;
+} CanLogRecorder;
+
+void can_log_recorder_init(CanLogRecorder* recorder, CanBus* inner,
+                           CanLogWriter* writer);
+
+void can_log_recorder_set_clock(CanLogRecorder* recorder, CanClockFn clock,
+                                void* user_arg);
+
+CanBus* can_log_recorder_bus(CanLogRecorder* recorder);
+
+/// @brief ログのフレームを元の間隔（またはその speed 倍の速さ）で CanBus に送る
+typedef struct {
+  CanLogReader* reader;
+  CanBus* target;
+  uint32_t speed;  // 0 なら待たずに送る
+  bool include_tx;
+
+  CanLogRecord pending;
+  bool has_pending;
+  bool started;
+  bool finished;
+  uint64_t log_start_us;
+  uint32_t wall_start_us;
+
+  uint32_t sent_count;
+} CanLogReplayer;
+
+/// @param speed 1 で記録時と同じ速さ、100 で 100 倍速、0 で待たずに送る
+/// @details 既定では受信フレームだけを送る（記録した機体の入力を再現する）。
+void can_log_replayer_init(CanLogReplayer* replayer, CanLogReader* reader,
+                           CanBus* target, uint32_t speed);
+
+/// @brief 記録した送信フレームも送るかどうか
+void can_log_replayer_set_include_tx(CanLogReplayer* replayer, bool include);
+
+/// @brief 現在時刻までに送るべきフレームを target に送る
+/// @details 最初の呼び出しの now_us をログ先頭の時刻に対応させる。target が
+///          受け付けなかったフレームは次の呼び出しで再送する。
+/// @return 送ったフレーム数
+size_t can_log_replayer_poll(CanLogReplayer* replayer, uint32_t now_us);
+
+/// @brief ログを最後まで送り終えたか
+bool can_log_replayer_done(const CanLogReplayer* replayer);
+
+/// @brief candump のログ形式 "(秒.マイクロ秒) ifname ID#データ" の 1 行を作る
+/// @return 書き込んだ文字数（終端を除く）。size が足りない場合は 0
+size_t can_log_format_candump(const CanLogRecord* record, const char* ifname,
+                              char* out, size_t size);
+
+/// @brief candump のログ形式の 1 行を読む
+/// @details 拡張 ID は 8 桁の 16 進数で書かれたもの。方向は記録されない
+///          ため tx は false になる。
+bool can_log_parse_candump(const char* line, CanLogRecord* record);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CAN_LOG_H
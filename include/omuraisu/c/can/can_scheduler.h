@@ -0,0 +1,92 @@
+#ifndef CAN_SCHEDULER_H
+#define CAN_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can/can_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief 登録できる周期送信スロットの最大数
+#ifndef CAN_SCHEDULER_MAX_SLOTS
+#define CAN_SCHEDULER_MAX_SLOTS 16
+#endif
+
+/// @brief 1 tick に送信するフレーム数の既定上限（bxCAN の送信メールボックス数）
+#ifndef CAN_SCHEDULER_DEFAULT_MAX_PER_TICK
+#define CAN_SCHEDULER_DEFAULT_MAX_PER_TICK 3
+#endif
+
+/// @brief 自動で位相を選ぶときに重なりを調べる最大の長さ [tick]
+/// @details 周期の最小公倍数がこれを超える場合は、これと最長周期の大きい方
+///          までで打ち切る。
+#ifndef CAN_SCHEDULER_PHASE_SCAN_LIMIT
+#define CAN_SCHEDULER_PHASE_SCAN_LIMIT 1000U
+#endif
+
+/// @brief can_scheduler_add の phase に渡すと空いている位相を自動で選ぶ
+#define CAN_SCHEDULER_AUTO_PHASE UINT32_MAX
+
+/// @brief 送信直前に呼ばれ、msg を送信内容で埋める
+/// @return false ならこの周期は送信しない
+typedef bool (*CanScheduleFillFn)(CanMessage* msg, void* user_arg);
+
+typedef struct {
+  uint32_t period;    // 送信周期 [tick]
+  uint32_t phase;     // 周期内の送信位置 [tick]
+  uint32_t next_due;  // 次に送信する tick
+  bool enabled;
+
+  CanScheduleFillFn fill;
+  void* user_arg;
+} CanScheduleSlot;
+
+/// @brief 周期送信フレームを 1 つの tick 関数から送り出すスケジューラ
+/// @details 各スロットは tick % period == phase の tick に送信される。
+///          位相をずらして登録すれば同じ tick にフレームが集中せず、送信
+///          メールボックスの溢れとモーター指令のジッタを抑えられる。
+///          1 tick に送るフレーム数が上限を超えた分と、バスが受け付けな
+///          かった分は次の tick に回す。
+typedef struct {
+  CanBus* bus;
+
+  CanScheduleSlot slots[CAN_SCHEDULER_MAX_SLOTS];
+  uint8_t slot_count;
+
+  uint32_t now;  // 次の can_scheduler_tick で処理する tick
+  uint8_t max_per_tick;
+
+  uint32_t deferred_count;  // 上限またはバスの都合で次の tick に回した回数
+  uint32_t skipped_count;   // 送れないまま次の周期に入り捨てた回数
+} CanScheduler;
+
+void can_scheduler_init(CanScheduler* scheduler, CanBus* bus);
+
+/// @brief 1 tick に送信するフレーム数の上限（0 で無制限）
+void can_scheduler_set_max_per_tick(CanScheduler* scheduler,
+                                    uint8_t max_per_tick);
+
+/// @brief 周期送信スロットを登録する
+/// @param phase 周期内の送信位置（CAN_SCHEDULER_AUTO_PHASE で自動選択）
+/// @return スロット番号（登録できない場合は -1）
+int can_scheduler_add(CanScheduler* scheduler, uint32_t period,
+                      uint32_t phase, CanScheduleFillFn fill, void* user_arg);
+
+void can_scheduler_set_enabled(CanScheduler* scheduler, int slot,
+                               bool enabled);
+
+/// @brief 1 tick 進め、送信時刻になったフレームを送る
+/// @details タイマ割り込みから呼ぶ場合、同じバスへの送信をメインループと
+///          重ねないこと。
+/// @return 送信したフレーム数
+size_t can_scheduler_tick(CanScheduler* scheduler);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CAN_SCHEDULER_H
@@ -0,0 +1,96 @@
+#ifndef CAN_SERIAL_H
+#define CAN_SERIAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can/can_interface.h"
+#include "ring/spsc_ring.h"
+#include "serial/serial_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief 受信キューの段数（2のべき乗）
+#ifndef CAN_SERIAL_RX_QUEUE_SIZE
+#define CAN_SERIAL_RX_QUEUE_SIZE 32
+#endif
+
+SPSC_RING_ASSERT_POW2(CAN_SERIAL_RX_QUEUE_SIZE);
+
+/// @brief 1 レコードの最大バイト数（情報 1 + ID 4 + データ 8）
+#define CAN_SERIAL_MAX_RECORD_SIZE 13U
+
+/// @brief 1 パケットのペイロード（レコード列 + CRC-8）の最大バイト数
+/// @details COBS で符号化して区切りの 0x00 を付けても 1 つの SerialMessage
+///          に収まる長さ。
+#define CAN_SERIAL_MAX_PAYLOAD \
+  (SERIAL_MESSAGE_MAX_LEN - 2 - SERIAL_MESSAGE_MAX_LEN / 254)
+
+#if SERIAL_MESSAGE_MAX_LEN < 16
+#error "SERIAL_MESSAGE_MAX_LEN must be at least 16 for CAN over serial"
+#endif
+
+/// @brief シリアル回線越しに CAN フレームをやり取りする CanBus
+/// @details 送信したフレームは「情報 1 バイト（長さ・拡張 ID）、ID（標準 2 /
+///          拡張 4 バイト LE）、データ」のレコードとしてバッファに溜め、
+///          CRC-8 を付けて COBS で符号化し、1 回の serial_port_write で
+///          まとめて送る（8 バイトの標準フレームなら 1 パケットに 5 つ）。
+///          送るのはバッファが一杯になったとき、write_batch の終わり、
+///          can_serial_flush / can_serial_poll を呼んだとき。
+///          回線の両端で同じものを使い、機体側では can_serial_relay で
+///          実際の CAN バスとつなぐ。
+typedef struct {
+  CanBus bus;
+  SerialPort* port;
+
+  uint8_t tx_payload[CAN_SERIAL_MAX_PAYLOAD];
+  size_t tx_used;
+  uint32_t tx_pending;  // バッファ内のフレーム数
+
+  // 区切りの 0x00 までの受信バイト
+  uint8_t rx_encoded[SERIAL_MESSAGE_MAX_LEN];
+  size_t rx_used;
+  bool rx_discarding;  // 長すぎるパケットを次の区切りまで読み捨てる
+
+  // can_serial_feed（プロデューサ）と read（コンシューマ）で共有
+  CanMessage rx_queue[CAN_SERIAL_RX_QUEUE_SIZE];
+  SpscRing rx_ring;
+
+  uint32_t tx_packets;
+  uint32_t rx_packets;
+  uint32_t rx_errors;  // CRC 不一致・符号化の誤り・長すぎるパケット
+  CanBusStats stats;
+} CanSerial;
+
+void can_serial_init(CanSerial* link, SerialPort* port);
+
+CanBus* can_serial_bus(CanSerial* link);
+
+/// @brief 溜めたフレームを 1 パケットにして送る
+/// @return 送るものが無い場合は true、書き込みに失敗した場合は false
+///         （フレームは残り、次の呼び出しで再送する）
+bool can_serial_flush(CanSerial* link);
+
+/// @brief 受信したバイト列を渡す
+/// @details serial_port_read を使わず受信コールバックでバイトを受け取る場合に
+///          呼ぶ。パケットが揃うたびにフレームを受信キューに積む。
+void can_serial_feed(CanSerial* link, const uint8_t* data, size_t size);
+
+/// @brief 送信バッファを送り、ポートから読めるだけ読んで受信キューに積む
+void can_serial_poll(CanSerial* link);
+
+/// @brief 回線と実際の CAN バスの間でフレームを中継する
+/// @details 回線から届いたフレームを local に、local で受信したフレームを
+///          回線に、それぞれ最大 max_frames 個ずつ送ってから can_serial_poll
+///          と同じく送受信する。local が受け付けなかったフレームは捨てる。
+/// @return 中継したフレーム数
+size_t can_serial_relay(CanSerial* link, CanBus* local, size_t max_frames);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CAN_SERIAL_H
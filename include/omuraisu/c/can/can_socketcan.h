@@ -0,0 +1,73 @@
+#ifndef CAN_SOCKETCAN_H
+#define CAN_SOCKETCAN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can/can_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief recvmmsg / sendmmsg 1 回あたりに扱う最大フレーム数
+#ifndef CAN_SOCKETCAN_BATCH_SIZE
+#define CAN_SOCKETCAN_BATCH_SIZE 32
+#endif
+
+/// @brief can_socketcan_set_filters で設定できる最大フィルタ数
+#ifndef CAN_SOCKETCAN_MAX_FILTERS
+#define CAN_SOCKETCAN_MAX_FILTERS 16
+#endif
+
+/// @brief Linux SocketCAN 向けの CanBus 実装
+/// @details ノンブロッキングの CAN_RAW ソケットを使用し、受信は recvmmsg で
+///          まとめて取り込んだフレームを rx_buffer から順に返す。
+///          OMURAISU_CAN_SOCKETCAN_ENABLE が未定義の環境では全ての操作が失敗する。
+typedef struct {
+  CanBus bus;
+
+  int fd;
+
+  CanMessage rx_buffer[CAN_SOCKETCAN_BATCH_SIZE];
+  uint16_t rx_head;
+  uint16_t rx_count;
+} CanSocketCan;
+
+void can_socketcan_init(CanSocketCan* socketcan);
+
+/// @brief インターフェース（例: "can0", "vcan0"）に bind してソケットを開く
+/// @details 受信フレームには SO_TIMESTAMP によるカーネルの受信時刻
+///          （CLOCK_REALTIME の [us] 下位 32bit）が付く。
+bool can_socketcan_open(CanSocketCan* socketcan, const char* ifname);
+
+void can_socketcan_close(CanSocketCan* socketcan);
+
+bool can_socketcan_is_open(const CanSocketCan* socketcan);
+
+CanBus* can_socketcan_bus(CanSocketCan* socketcan);
+
+/// @brief epoll などに登録するためのファイルディスクリプタ（未オープン時は -1）
+int can_socketcan_fd(const CanSocketCan* socketcan);
+
+/// @brief カーネルの受信フィルタ（CAN_RAW_FILTER）を設定する
+/// @details count が 0 の場合は全フレームを受け付ける。ソケットを開いた後に呼ぶこと。
+bool can_socketcan_set_filters(CanSocketCan* socketcan,
+                               const CanFilter* filters, size_t count);
+
+/// @brief 受信済みフレームを最大 max_count 個まとめて取り出す
+/// @return 取り出したフレーム数
+size_t can_socketcan_read_batch(CanSocketCan* socketcan, CanMessage* msgs,
+                                size_t max_count);
+
+/// @brief 複数フレームを sendmmsg でまとめて送信する
+/// @return 送信キューに積めたフレーム数（先頭から連続）
+size_t can_socketcan_write_batch(CanSocketCan* socketcan,
+                                 const CanMessage* msgs, size_t count);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CAN_SOCKETCAN_H
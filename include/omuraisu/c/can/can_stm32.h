@@ -2,32 +2,273 @@
 #define CAN_STM32_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "can/can_cube.h"
+#include "can/can_dispatch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief コンテキストごとに保持できる受信フィルタ（bxCAN のバンク）の最大数
+#ifndef CAN_STM32_MAX_FILTERS
+#define CAN_STM32_MAX_FILTERS 8
+#endif
 
 typedef enum {
   CAN_STM32_KIND_CAN = 0,
   CAN_STM32_KIND_FDCAN = 1,
 } CanStm32Kind;
 
+typedef enum {
+  CAN_STM32_FILTER_MASK = 0,  ///< ID とマスクの組
+  CAN_STM32_FILTER_LIST = 1,  ///< ID の完全一致リスト
+} CanStm32FilterMode;
+
+typedef enum {
+  CAN_STM32_FILTER_SCALE_32 = 0,  ///< 標準/拡張 ID（1 バンクに MASK 1 組 / LIST 2 個）
+  CAN_STM32_FILTER_SCALE_16 = 1,  ///< 標準 ID のみ（1 バンクに MASK 2 組 / LIST 4 個）
+} CanStm32FilterScale;
+
+/// @brief 受信フィルタ 1 バンク分の設定
+/// @details values の意味は mode / scale による。
+///          - MASK, 32bit: [0]=ID, [1]=マスク
+///          - LIST, 32bit: [0], [1]=ID
+///          - MASK, 16bit: [0]=ID, [1]=マスク, [2]=ID, [3]=マスク
+///          - LIST, 16bit: [0]〜[3]=ID
+///          ID が 0x7FF を超える場合は拡張 ID として扱う（16bit は標準 ID のみ）。
+///          FDCAN ではフィルタ要素（MASK / DUAL）に展開される。
+typedef struct {
+  CanStm32FilterMode mode;
+  CanStm32FilterScale scale;
+  uint32_t values[4];
+  uint32_t fifo;  ///< 振り分け先の受信 FIFO（0 または 1）
+} CanStm32Filter;
+
+/// @brief CAN コントローラのエラー状態（TEC/REC による）
+typedef enum {
+  CAN_STM32_ERROR_ACTIVE = 0,
+  CAN_STM32_ERROR_WARNING = 1,  ///< TEC または REC が 96 以上
+  CAN_STM32_ERROR_PASSIVE = 2,  ///< TEC または REC が 128 以上
+  CAN_STM32_ERROR_BUS_OFF = 3,  ///< TEC が 256 に達して送受信を止めた
+} CanStm32ErrorState;
+
+/// @brief 最後に検出したプロトコルエラー（bxCAN ESR.LEC / FDCAN PSR.LEC と同じ値）
+typedef enum {
+  CAN_STM32_LEC_NONE = 0,
+  CAN_STM32_LEC_STUFF = 1,
+  CAN_STM32_LEC_FORM = 2,
+  CAN_STM32_LEC_ACK = 3,  ///< 応答するノードがいない（断線・終端抵抗なしなど）
+  CAN_STM32_LEC_BIT_RECESSIVE = 4,
+  CAN_STM32_LEC_BIT_DOMINANT = 5,
+  CAN_STM32_LEC_CRC = 6,
+} CanStm32LastError;
+
+struct CanStm32Context;
+
+/// @brief エラー状態が変わったときに呼ばれる
+/// @details can_stm32_process_errors の中（メインループ）から呼ばれる。
+typedef void (*CanStm32ErrorCallback)(struct CanStm32Context* context,
+                                      CanStm32ErrorState state,
+                                      void* user_arg);
+
+/// @brief バスオフからの自動復帰の設定
+/// @details バスオフになってから backoff_ms 待ってコントローラを再起動する。
+///          復帰から stable_ms 以内に再びバスオフになった場合は待ち時間を
+///          倍にし（最大 backoff_max_ms）、安定していれば初期値に戻す。
 typedef struct {
+  bool auto_recover;
+  uint32_t backoff_initial_ms;
+  uint32_t backoff_max_ms;
+  uint32_t stable_ms;
+} CanStm32RecoveryPolicy;
+
+typedef struct CanStm32Context {
   CanCube* cube;
   void* handle;
   CanStm32Kind kind;
-  uint32_t rx_fifo;
+  uint32_t rx_fifo;  ///< 受信 FIFO（0 / 1、HAL の CAN_RX_FIFOx・FDCAN_RX_FIFOx も可）
+
+  CanStm32Filter filters[CAN_STM32_MAX_FILTERS];
+  uint8_t filter_count;
+  // フィルタがハードウェアに収まらないか、HAL がフィルタ・タイムスタンプの
+  // 設定を拒んだため、start_read が受信を開始しなかった
+  bool filter_error;
+
+  // ハードウェアタイムスタンプ（timestamp_ns_per_tick が 0 なら無効）
+  uint32_t timestamp_ns_per_tick;
+  uint16_t timestamp_last_raw;
+  uint64_t timestamp_ticks;
+
+  // エラー状態（can_stm32_process_errors だけが更新する）
+  CanStm32ErrorState error_state;
+  CanStm32LastError last_error;
+  uint32_t bus_off_count;
+  uint32_t recovery_count;  ///< バスオフからの再起動回数
+
+  CanStm32RecoveryPolicy recovery;
+  uint32_t backoff_ms;       // 次の再起動までの待ち時間
+  uint32_t bus_off_time_ms;  // バスオフになった（再起動を試みた）時刻
+  uint32_t recovered_time_ms;
+
+  // エラー割り込みで見つけたバスオフの回数（割り込みだけが書く）と、
+  // can_stm32_process_errors が処理済みの回数
+  volatile uint32_t bus_off_irq_count;
+  uint32_t bus_off_irq_seen;
+
+  // 送信キューの補充を割り込みに任せている間だけ true。キューを書き換える間は
+  // false にして、もう一方の FIFO のコンテキストの割り込みからも守る
+  volatile bool tx_notify;
+
+  // read_hw（従来フレームの受信）が CanMessage に入らず読み捨てた FD フレーム数
+  uint32_t rx_fd_dropped;
+
+  CanStm32ErrorCallback error_callback;
+  void* error_user_arg;
+
+  // 受信割り込みの NVIC 優先度（has_rx_irq のときだけ start_read で設定）
+  bool has_rx_irq;
+  int32_t rx_irqn;
+  uint32_t rx_irq_priority;
 } CanStm32Context;
 
 void can_stm32_context_init(CanStm32Context* context, CanCube* cube,
                             void* handle, CanStm32Kind kind,
                             uint32_t rx_fifo);
 
+/// @brief 受信フレームにハードウェアタイムスタンプを付ける
+/// @details ns_per_tick はカウンタ 1 カウントの長さ（1 Mbps なら 1000）。
+///          FDCAN は start_read で内部タイムスタンプカウンタ（プリスケーラ 1）を
+///          有効にする。bxCAN は CubeMX で Time Triggered Communication Mode を
+///          有効にしておく。16bit カウンタはフレームごとに 32bit [us] へ延長する
+///          ため、カウンタが一周する間（1 Mbps で約 65 ms）に 1 フレームは受信
+///          している必要がある。
+void can_stm32_enable_timestamp(CanStm32Context* context,
+                                uint32_t ns_per_tick);
+
+/// @brief 16bit のハードウェアタイムスタンプを延長して [us] に換算する
+uint32_t can_stm32_extend_timestamp(CanStm32Context* context, uint16_t raw);
+
+/// @brief エラー状態が変わったときのコールバックを設定する
+void can_stm32_set_error_callback(CanStm32Context* context,
+                                  CanStm32ErrorCallback callback,
+                                  void* user_arg);
+
+/// @brief start_read で受信割り込みの NVIC 優先度を設定する（任意）
+/// @details FIFO を分けた場合に、レイテンシの厳しい側（ロボマスのフィードバック
+///          など）の割り込みを高い優先度にする。設定しなければ CubeMX の設定の
+///          まま。
+/// @param irqn この FIFO の割り込み番号（CAN1_RX0_IRQn / CAN1_RX1_IRQn、
+///             FDCAN1_IT0_IRQn / FDCAN1_IT1_IRQn など）
+/// @param priority プリエンプション優先度（小さいほど優先）
+void can_stm32_set_rx_irq_priority(CanStm32Context* context, int32_t irqn,
+                                   uint32_t priority);
+
+/// @brief バスオフからの復帰方法を設定する
+/// @details 既定は自動復帰あり、待ち時間 10 ms〜1 s、安定判定 1 s。
+void can_stm32_set_recovery_policy(CanStm32Context* context,
+                                   const CanStm32RecoveryPolicy* policy);
+
+/// @brief エラー状態を記録し、変化があればコールバックを呼ぶ
+/// @details HAL に依存しない部分。can_stm32_process_errors から呼ばれる。
+///          バスオフへの遷移で次の再起動までの待ち時間を決める。
+void can_stm32_update_error_state(CanStm32Context* context,
+                                  CanStm32ErrorState state,
+                                  CanStm32LastError last_error,
+                                  uint32_t now_ms);
+
+/// @brief バスオフからの再起動を試みる時刻なら記録して true を返す
+/// @details HAL に依存しない部分。true を返した場合、呼び出し側はコントローラを
+///          再起動する。まだバスオフのままなら backoff_ms 後に再び true になる。
+bool can_stm32_begin_recovery(CanStm32Context* context, uint32_t now_ms);
+
+/// @brief エラー状態をハードウェアから読み直し、必要ならバスオフから復帰させる
+/// @details メインループから定期的に呼ぶ。エラー状態の更新とコールバックは
+///          この関数だけが行う。エラー割り込み（bxCAN は CubeMX で SCE 割り込み、
+///          FDCAN は IT0/IT1 のうち Bus_Off などを含む方）を有効にしておくと、
+///          次の呼び出しまでにハードウェアが自動で復帰した短いバスオフも
+///          数えられる。再起動の際は送信キューと送信メールボックスの
+///          未送信フレームを捨てる（復帰後に古い指令値を送らないため）。
+///          CubeMX で AutoBusOff を有効にした bxCAN はハードウェアが自分で
+///          復帰するため、auto_recover を false にする。
+void can_stm32_process_errors(CanStm32Context* context);
+
+/// @brief CanCube 用の操作テーブルを作る
+/// @details FD フレームを送受信するには CubeMX で FrameFormat を FD_NO_BRS /
+///          FD_BRS にしておく。bxCAN では write_fd / read_hw_fd は従来フレーム
+///          だけを扱う。FDCAN の read_hw は従来フレームだけを返し、FD フレームは
+///          rx_fd_dropped に数えて読み捨てる。
 void can_stm32_make_ops(CanCubeOps* ops);
 
+CanStm32Filter can_stm32_filter_mask(uint32_t id, uint32_t mask, uint32_t fifo);
+
+CanStm32Filter can_stm32_filter_list(uint32_t id1, uint32_t id2, uint32_t fifo);
+
+CanStm32Filter can_stm32_filter_mask16(uint32_t id1, uint32_t mask1,
+                                       uint32_t id2, uint32_t mask2,
+                                       uint32_t fifo);
+
+CanStm32Filter can_stm32_filter_list16(uint32_t id1, uint32_t id2,
+                                       uint32_t id3, uint32_t id4,
+                                       uint32_t fifo);
+
+/// @brief 受信フィルタを追加する（start_read 前に設定すること）
+/// @details フィルタが 1 つも無い場合は全フレームを受け付ける。同じ周辺機能に
+///          FIFO ごとのコンテキストを登録した場合は、両方のフィルタがまとめて
+///          設定され、フィルタの無い側はどのフィルタにも一致しなかったフレームを
+///          受け取る。bxCAN は周辺機能 1 台に 14 バンクで、両方の FIFO の
+///          フィルタと全受信の 1 バンクがここに収まる必要がある。FDCAN は
+///          両方の FIFO のフィルタ要素が CubeMX で確保した Std/Ext Filters Nbr
+///          に収まる必要がある。
+/// @return 収まらない場合は false（登録済みのもう一方の FIFO の分も数える）。
+///         登録前に追加して超えた場合は start_read が受信を開始せず、
+///         filter_error を true にする。
+bool can_stm32_add_filter(CanStm32Context* context,
+                          const CanStm32Filter* filter);
+
+void can_stm32_clear_filters(CanStm32Context* context);
+
+/// @brief ディスパッチャに登録されたドライバの ID から受信フィルタを設定する
+/// @details 標準 ID は 16bit スケールで 2 組ずつ 1 バンクにまとめる。
+///          バンクが足りない場合は何も変更せず false を返す（全受信のまま）。
+bool can_stm32_set_filters_from_dispatcher(CanStm32Context* context,
+                                           const CanDispatcher* dispatcher);
+
+/// @brief 割り込みから引けるようにコンテキストを登録する
+/// @details 周辺機能（CAN1〜3 / FDCAN1〜3）と受信 FIFO の組ごとに 1 つ登録でき、
+///          割り込みからは HAL ハンドルの Instance で直接引く。同じ周辺機能に
+///          rx_fifo 0 と 1 の 2 つのコンテキストを登録すると、FIFO ごとに別の
+///          CanCube で受信できる（送信完了とエラーは両方に通知される）。
+/// @return 未対応の周辺機能、またはその FIFO に別のコンテキストが登録済みなら
+///         false
 bool can_stm32_register(CanStm32Context* context);
 
 void can_stm32_unregister(CanStm32Context* context);
 
+/// @brief 受信 FIFO fifo（0 または 1）に登録されたコンテキストで受信する
+/// @details HAL_CAN_RxFifoNMsgPendingCallback / HAL_FDCAN_RxFifoNCallback からは
+///          自動で呼ばれる。
+void can_stm32_dispatch_rx_fifo(void* handle, uint32_t fifo);
+
+/// @brief 両方の受信 FIFO に登録されたコンテキストで受信する
 void can_stm32_dispatch_rx(void* handle);
 
+/// @brief 送信完了割り込みから CanCube の送信キューを送り出す
+/// @details HAL_CAN_TxMailboxNCompleteCallback /
+///          HAL_FDCAN_TxBufferCompleteCallback からは自動で呼ばれる（CAN TX
+///          割り込みを NVIC で有効にしておくこと）。
+void can_stm32_dispatch_tx(void* handle);
+
+/// @brief エラー割り込みでバスオフを記録する
+/// @details HAL_CAN_ErrorCallback / HAL_FDCAN_ErrorStatusCallback からは自動で
+///          呼ばれる。メインループと競合しないよう、状態の更新とコールバックは
+///          次の can_stm32_process_errors に任せる。
+void can_stm32_dispatch_error(void* handle);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
 #endif  // CAN_STM32_H
\ No newline at end of file
@@ -0,0 +1,127 @@
+#ifndef CAN_VIRTUAL_H
+#define CAN_VIRTUAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can/can_interface.h"
+#include "ring/spsc_ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief 1 つの媒体に接続できるノードの最大数
+#ifndef CAN_VIRTUAL_MAX_NODES
+#define CAN_VIRTUAL_MAX_NODES 8
+#endif
+
+/// @brief ノードごとの送信待ちフレーム数（2のべき乗）
+#ifndef CAN_VIRTUAL_TX_QUEUE_SIZE
+#define CAN_VIRTUAL_TX_QUEUE_SIZE 16
+#endif
+
+/// @brief ノードごとの受信キューの段数（2のべき乗）
+#ifndef CAN_VIRTUAL_RX_QUEUE_SIZE
+#define CAN_VIRTUAL_RX_QUEUE_SIZE 32
+#endif
+
+SPSC_RING_ASSERT_POW2(CAN_VIRTUAL_TX_QUEUE_SIZE);
+SPSC_RING_ASSERT_POW2(CAN_VIRTUAL_RX_QUEUE_SIZE);
+
+typedef struct CanVirtualMedium CanVirtualMedium;
+
+typedef struct {
+  CanMessage msg;
+  uint32_t deliver_at_us;  // この時刻以降に読める
+} CanVirtualRxEntry;
+
+/// @brief 仮想バスに接続された 1 ノード（CanBus として使える）
+typedef struct {
+  CanBus bus;
+  CanVirtualMedium* medium;
+
+  CanMessage tx_queue[CAN_VIRTUAL_TX_QUEUE_SIZE];
+  SpscRing tx_ring;
+
+  CanVirtualRxEntry rx_queue[CAN_VIRTUAL_RX_QUEUE_SIZE];
+  SpscRing rx_ring;
+
+  CanBusStats stats;
+  uint32_t load_last_busy_us;
+  uint32_t load_last_time_us;
+} CanVirtualNode;
+
+/// @brief ノード間で共有するメモリ上の CAN 媒体
+/// @details 時間は can_virtual_medium_advance でだけ進む。バスが空いている間に
+///          送信待ちのフレームがあれば、各ノードの先頭フレームのうち調停
+///          フィールドの最も小さいものが勝ち（実際のバスと同じく、まず ID の
+///          上位 11 bit、同じなら標準 ID が拡張 ID に勝つ）、ビットレートから
+///          求めた時間だけバスを占有したあと送信元以外の全ノードへ届く。
+///          1 ノード内のフレームは書き込んだ順（送信 FIFO）に調停へ参加する。
+struct CanVirtualMedium {
+  CanVirtualNode* nodes[CAN_VIRTUAL_MAX_NODES];
+  uint8_t node_count;
+
+  uint32_t bitrate;
+  uint32_t latency_us;  // 送信完了から受信側で読めるまでの追加遅延
+  uint16_t loss_permille;
+  uint32_t loss_state;  // 損失判定用の疑似乱数
+
+  uint32_t now_us;
+  uint32_t busy_us;  // バスが占有されていた累積時間
+
+  // 送信中のフレーム
+  bool transmitting;
+  CanMessage frame;
+  CanVirtualNode* sender;
+  uint32_t frame_end_us;
+
+  uint32_t delivered_count;
+  uint32_t lost_count;
+};
+
+void can_virtual_medium_init(CanVirtualMedium* medium, uint32_t bitrate);
+
+/// @brief 送信完了から受信側で読めるまでの遅延を加える
+void can_virtual_medium_set_latency(CanVirtualMedium* medium,
+                                    uint32_t latency_us);
+
+/// @brief フレームを permille / 1000 の確率で失わせる
+/// @details seed が同じなら同じフレームが失われるため、結果は再現できる。
+///          失われたフレームもバス時間は消費する。
+void can_virtual_medium_set_loss(CanVirtualMedium* medium,
+                                 uint16_t permille, uint32_t seed);
+
+/// @brief 1 フレームがバスを占有する時間 [us]
+uint32_t can_virtual_medium_frame_time_us(const CanVirtualMedium* medium,
+                                          const CanMessage* msg);
+
+/// @brief シミュレーション時間を dt_us 進め、その間の送受信を処理する
+void can_virtual_medium_advance(CanVirtualMedium* medium, uint32_t dt_us);
+
+/// @brief 送信待ちのフレームが無くなり、全フレームが読めるまで時間を進める
+/// @return 進めた時間 [us]
+uint32_t can_virtual_medium_run_until_idle(CanVirtualMedium* medium);
+
+uint32_t can_virtual_medium_now(const CanVirtualMedium* medium);
+
+/// @brief can_cube_set_clock などに渡せるシミュレーション時計
+/// @param user_arg CanVirtualMedium*
+uint32_t can_virtual_medium_clock(void* user_arg);
+
+/// @brief ノードを初期化して媒体に接続する
+/// @return 接続数が上限に達している場合は false
+bool can_virtual_node_init(CanVirtualNode* node, CanVirtualMedium* medium);
+
+CanBus* can_virtual_node_bus(CanVirtualNode* node);
+
+/// @brief 送信待ちのフレーム数
+uint32_t can_virtual_node_tx_pending(const CanVirtualNode* node);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CAN_VIRTUAL_H
@@ -4,6 +4,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "can/can_dispatch.h"
 #include "controller_core.h"
 
 #ifdef __cplusplus
@@ -62,6 +63,12 @@ SerialPacket om_ctrl_serial_packet_from_data(const ControllerData* data);
 ControllerData om_ctrl_serial_packet_to_data(const SerialPacket* packet);
 ControllerData om_ctrl_data_from_serial(const SerialPacket* packet);
 ControllerData om_ctrl_data_from_can(uint32_t id, const uint8_t data[8]);
+/// @brief 受信フレームの ID に対応する項目（アナログ/ボタン）だけを更新する
+bool om_ctrl_data_update_from_can(ControllerData* controller, uint32_t id,
+                                  const uint8_t data[8]);
+/// @brief ID 50/51 のフレームで controller を更新するよう登録する
+bool om_ctrl_can_attach(ControllerData* controller,
+                        CanDispatcher* dispatcher);
 bool om_ctrl_data_to_can_analog(const ControllerData* data, uint8_t out[8]);
 bool om_ctrl_data_to_can_buttons(const ControllerData* data, uint8_t out[8]);
 ControllerData om_ctrl_data_from_ros_joy(const float* axes, size_t axes_size,
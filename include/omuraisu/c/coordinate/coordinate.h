@@ -8,7 +8,9 @@ extern "C" {
 #endif
 
 
+#ifndef _DEFAULT_SOURCE
 #define _DEFAULT_SOURCE
+#endif
 
 #ifdef __cplusplus
 }
@@ -1,7 +1,9 @@
 #ifndef ROBOMAS_H
 #define ROBOMAS_H
 
+#include "can/can_dispatch.h"
 #include "can/can_interface.h"
+#include "can/can_scheduler.h"
 #include "robomas_core.h"
 
 #include <stddef.h>
@@ -10,6 +12,11 @@
 extern "C" {
 #endif
 
+/// @brief om_rm_read_all が 1 回の can_bus_read_batch で取り出す最大フレーム数
+#ifndef OM_RM_READ_BATCH_SIZE
+#define OM_RM_READ_BATCH_SIZE 8
+#endif
+
 typedef struct {
   CanBus* can;
   RobomasCore core;
@@ -21,6 +28,20 @@ void om_rm_set_max_output(Robomas* rm, int16_t max);
 
 int om_rm_read(Robomas* rm);
 
+/// @brief 受信済みフレームを全て取り出して解析する
+/// @return 解析したモーターフィードバックの数
+int om_rm_read_all(Robomas* rm);
+
+/// @brief 0x201〜0x208 のフィードバックを rm に振り分けるよう登録する
+/// @details rm はディスパッチャを使う間、同じアドレスに置いておくこと。
+bool om_rm_attach(Robomas* rm, CanDispatcher* dispatcher);
+
+/// @brief 2 つの指令フレーム（0x200/0x1FF）を period tick ごとに送るよう登録する
+/// @details 2 フレームは自動選択された別々の位相に置かれる。フレームは
+///          スケジューラのバスへ送られ、rm の CanBus は使われない。
+/// @return 両方のスロットを登録できた場合 true
+bool om_rm_schedule(Robomas* rm, CanScheduler* scheduler, uint32_t period);
+
 int om_rm_parse(Robomas* rm, uint32_t id, const uint8_t data[8]);
 
 void om_rm_set_output(Robomas* rm, int16_t current, int id);
@@ -37,6 +58,11 @@ int16_t om_rm_get_rpm(const Robomas* rm, int id);
 
 uint8_t om_rm_get_temp(const Robomas* rm, int id);
 
+/// @brief 最後に受信したフィードバックの受信時刻 [us]
+/// @details バスが受信時刻を付けない場合は 0 のまま。角度の差分から速度を
+///          求めるときの dt に使う。
+uint32_t om_rm_get_timestamp(const Robomas* rm, int id);
+
 RobomasData om_rm_get_data(const Robomas* rm, int id);
 
 const RobomasData* om_rm_get_data_const(const Robomas* rm, int id);
@@ -14,6 +14,9 @@ extern const uint16_t ANGLE_MAX_VALUE;
 extern const uint32_t TX_ID_GROUP1;
 extern const uint32_t TX_ID_GROUP2;
 
+extern const uint32_t RX_ID_MIN;
+extern const uint32_t RX_ID_MAX;
+
 
 
 /// @brief Robomasから受信したモーターデータ
@@ -22,6 +25,7 @@ typedef struct {
   int16_t rpm;
   int16_t current;
   uint8_t temp;
+  uint32_t timestamp_us;  // 受信時刻 [us]（受信時刻付きのフレームで更新）
 } RobomasData;
 
 RobomasData om_rm_data_init();
@@ -56,6 +60,11 @@ int16_t om_rm_core_get_rpm(const RobomasCore* core, int id);
 
 uint8_t om_rm_core_get_temp(const RobomasCore* core, int id);
 
+void om_rm_core_set_timestamp(RobomasCore* core, int id,
+                              uint32_t timestamp_us);
+
+uint32_t om_rm_core_get_timestamp(const RobomasCore* core, int id);
+
 RobomasData om_rm_core_get_data(const RobomasCore* core, int id);
 
 #ifdef __cplusplus
@@ -0,0 +1,118 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can/can_interface.h"
+#include "can/can_socketcan.h"
+#include "serial/serial_posix.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief 1 つのループに登録できる最大ソース数
+#ifndef EVENT_LOOP_MAX_SOURCES
+#define EVENT_LOOP_MAX_SOURCES 16
+#endif
+
+/// @brief epoll_wait 1 回で受け取る最大イベント数
+#ifndef EVENT_LOOP_MAX_EVENTS
+#define EVENT_LOOP_MAX_EVENTS 16
+#endif
+
+/// @brief 任意の fd が読める/書けるようになったときに呼ばれる
+/// @param events EPOLLIN などの epoll イベント
+typedef void (*EventFdFn)(int fd, uint32_t events, void* user_arg);
+
+/// @brief 周期タイマの満了時に呼ばれる
+/// @param expirations 前回の呼び出しから満了した回数（遅れた場合は 2 以上）
+typedef void (*EventTimerFn)(uint64_t expirations, void* user_arg);
+
+typedef enum {
+  EVENT_SOURCE_NONE = 0,
+  EVENT_SOURCE_FD,
+  EVENT_SOURCE_TIMER,
+  EVENT_SOURCE_SOCKETCAN,
+  EVENT_SOURCE_SERIAL,
+} EventSourceKind;
+
+typedef struct {
+  EventSourceKind kind;
+  int fd;
+  uint16_t generation;  // 削除済みソースへの古いイベントを見分ける
+
+  union {
+    EventFdFn fd;
+    EventTimerFn timer;
+    CanRxCallback can;
+  } callback;
+  void* user_arg;
+
+  CanSocketCan* socketcan;
+  SerialPosix* serial;
+} EventSource;
+
+/// @brief epoll と timerfd による単一スレッドのイベントループ（Linux 専用）
+/// @details CAN ソケット・tty・任意の fd・周期タイマを 1 つの epoll で待ち、
+///          読めるようになったソースの受信データをその場でコールバックへ渡す。
+///          スレッドをまたがないため、起床からコールバックまでの遅延は
+///          epoll_wait の復帰と read の分だけになる。さらに遅延を詰めたい
+///          場合は event_loop_run_once(loop, 0) を回し続けてビジーポーリングする。
+///          コールバックの中からソースの追加・削除や event_loop_stop を
+///          呼んでよい。
+///          OMURAISU_EVENT_LOOP_ENABLE が未定義の環境では全ての操作が失敗する。
+typedef struct {
+  int epoll_fd;
+  EventSource sources[EVENT_LOOP_MAX_SOURCES];
+  bool running;
+
+  uint32_t dispatch_count;
+} EventLoop;
+
+bool event_loop_init(EventLoop* loop);
+
+/// @brief 登録したタイマを閉じ、epoll を閉じる（登録した CAN/tty は閉じない）
+void event_loop_close(EventLoop* loop);
+
+/// @brief fd を登録する
+/// @param events EPOLLIN / EPOLLOUT など
+/// @return ソース番号（登録できない場合は -1）
+int event_loop_add_fd(EventLoop* loop, int fd, uint32_t events,
+                      EventFdFn callback, void* user_arg);
+
+/// @brief period_us ごとに呼ばれる周期タイマを登録する（CLOCK_MONOTONIC）
+int event_loop_add_timer(EventLoop* loop, uint32_t period_us,
+                         EventTimerFn callback, void* user_arg);
+
+/// @brief 開いた CanSocketCan を登録する
+/// @details 読めるようになるたびに recvmmsg でまとめて取り込み、
+///          1 フレームずつ callback に渡す。
+int event_loop_add_socketcan(EventLoop* loop, CanSocketCan* socketcan,
+                             CanRxCallback callback, void* user_arg);
+
+/// @brief 開いた SerialPosix を登録する
+/// @details 読めるようになるたびに serial_posix_on_readable を呼ぶ
+///          （callback は SerialPosix の受信コールバックとして設定される）。
+int event_loop_add_serial(EventLoop* loop, SerialPosix* serial,
+                          SerialRxCallback callback, void* user_arg);
+
+bool event_loop_remove(EventLoop* loop, int source);
+
+/// @brief イベントを 1 回待って処理する
+/// @param timeout_ms -1 で無期限、0 で待たない
+/// @return 処理したイベント数（エラーの場合は -1）
+int event_loop_run_once(EventLoop* loop, int timeout_ms);
+
+/// @brief event_loop_stop が呼ばれるかエラーになるまで処理を続ける
+void event_loop_run(EventLoop* loop);
+
+void event_loop_stop(EventLoop* loop);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // EVENT_LOOP_H
@@ -0,0 +1,168 @@
+#ifndef EVENT_URING_H
+#define EVENT_URING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can/can_interface.h"
+#include "serial/serial_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief 投入キューの段数（2のべき乗）
+#ifndef EVENT_URING_QUEUE_DEPTH
+#define EVENT_URING_QUEUE_DEPTH 64
+#endif
+
+/// @brief 登録できる受信ソースの最大数
+#ifndef EVENT_URING_MAX_SOURCES
+#define EVENT_URING_MAX_SOURCES 8
+#endif
+
+/// @brief CAN ソースごとの受信バッファ数（2のべき乗）
+#ifndef EVENT_URING_CAN_BUFFERS
+#define EVENT_URING_CAN_BUFFERS 64
+#endif
+
+/// @brief シリアルソースごとの受信バッファ数（2のべき乗）
+#ifndef EVENT_URING_SERIAL_BUFFERS
+#define EVENT_URING_SERIAL_BUFFERS 16
+#endif
+
+/// @brief 完了待ちにできる送信の最大数
+#ifndef EVENT_URING_TX_SLOTS
+#define EVENT_URING_TX_SLOTS 64
+#endif
+
+typedef enum {
+  EVENT_URING_SOURCE_NONE = 0,
+  EVENT_URING_SOURCE_CAN,
+  EVENT_URING_SOURCE_SERIAL,
+} EventUringSourceKind;
+
+typedef struct {
+  EventUringSourceKind kind;
+  int fd;
+  bool multishot;  // 複数回完了する受信を使っているか
+  bool armed;      // 受信要求がカーネルにあるか
+  bool failed;     // 回復できないエラーで止まった
+
+  union {
+    CanRxCallback can;
+    SerialRxCallback serial;
+  } callback;
+  void* user_arg;
+
+  // カーネルに渡す受信バッファのリング（io_uring_buf_ring）と、その置き場
+  // （CAN: struct can_frame の配列、シリアル: SerialMessage の配列）
+  void* buf_ring;
+  size_t buf_ring_size;
+  void* buffers;
+  uint16_t buf_count;
+  uint16_t buf_tail;
+} EventUringSource;
+
+typedef union {
+  uint64_t can_frame[2];  // struct can_frame（8 バイト境界に置く）
+  SerialMessage serial;
+} EventUringTxSlot;
+
+/// @brief io_uring による CAN/シリアルの送受信エンジン（Linux 専用）
+/// @details 受信は「複数回完了する recv/read」と「カーネルに渡した受信バッファ
+///          のリング」を使い、1 度要求を出せばフレームが届くたびにカーネルが
+///          バッファへ直接書き込んで完了を積む。event_uring_run_once は
+///          1 回のシステムコールで溜まった送信をまとめて投入し、積まれた完了を
+///          全て処理するため、フレームごとのシステムコールが無くなる。
+///          シリアルの受信バッファは SerialMessage::data そのもので、届いた
+///          バイトはコピーされずにコールバックへ渡る。CAN は struct can_frame
+///          で届くため CanMessage に詰め替えて渡す（受信時刻は付かない）。
+///          複数回完了する recv（Linux 6.0 以降）/ read（6.7 以降）が使えない
+///          カーネルでは、1 回ずつの recv / read を投入し直す。
+///          OMURAISU_EVENT_URING_ENABLE が未定義の環境では全ての操作が失敗する。
+typedef struct {
+  int ring_fd;
+
+  // カーネルと共有するリング
+  void* sq_ring;
+  size_t sq_ring_size;
+  void* cq_ring;
+  size_t cq_ring_size;
+  void* sqes;
+  size_t sqes_size;
+  uint32_t* sq_head;
+  uint32_t* sq_tail;
+  uint32_t sq_mask;
+  uint32_t sq_entries;
+  uint32_t* sq_array;
+  uint32_t* cq_head;
+  uint32_t* cq_tail;
+  uint32_t cq_mask;
+  void* cqes;
+  uint32_t sq_pending;  // 投入待ちの要求数
+
+  EventUringSource sources[EVENT_URING_MAX_SOURCES];
+
+  EventUringTxSlot tx_slots[EVENT_URING_TX_SLOTS];
+  uint16_t tx_free[EVENT_URING_TX_SLOTS];
+  uint16_t tx_free_count;
+  uint16_t tx_len[EVENT_URING_TX_SLOTS];  // 送信スロットごとに投入したバイト数
+
+  // 直前に積んだ送信（同じ fd への次の送信をこれにつなぐ）
+  int tx_link_fd;
+  uint32_t tx_link_tail;
+
+  uint32_t enter_count;  // io_uring_enter の呼び出し回数
+  uint32_t rx_count;     // コールバックに渡したフレーム/チャンク数
+  uint32_t rx_overflows;  // 受信バッファが尽きた回数
+  uint32_t tx_count;
+  uint32_t tx_errors;  // 失敗・書ききれなかった・取り消された送信の数
+} EventUring;
+
+/// @return io_uring を使えない（カーネルが古い、無効化されている）場合は false
+bool event_uring_init(EventUring* uring);
+
+/// @brief リングを閉じて受信要求を取り消し、バッファを解放する
+void event_uring_close(EventUring* uring);
+
+/// @brief CAN_RAW ソケット（can_socketcan_fd）の受信を登録する
+/// @details 登録は event_uring_close まで解除できない。
+/// @return ソース番号（登録できない場合は -1）
+int event_uring_add_can(EventUring* uring, int fd, CanRxCallback callback,
+                        void* user_arg);
+
+/// @brief tty（serial_posix_fd）の受信を登録する
+/// @details 受信コールバックに渡る SerialMessage はコールバックの中でだけ有効。
+///          read が 0 を返すと EOF とみなすため、tty は VMIN >= 1 にしておく
+///          （serial_posix_open はそう設定する）。
+int event_uring_add_serial(EventUring* uring, int fd,
+                           SerialRxCallback callback, void* user_arg);
+
+/// @brief CAN フレームの送信を積む（次の event_uring_run_once で投入される）
+/// @details 同じ event_uring_run_once で投入される同じ fd への送信は
+///          IOSQE_IO_LINK でつなぎ、積んだ順に送る。1 つが失敗するか
+///          書ききれなければ、つながった後ろの送信は取り消され、どちらも
+///          tx_errors に数える。別の event_uring_run_once で投入した送信どうしの
+///          順序は保証しない（前の送信が EAGAIN で待つ間に後の送信が先に出うる）。
+/// @return 積めたフレーム数（先頭から連続）
+size_t event_uring_write_can(EventUring* uring, int fd, const CanMessage* msgs,
+                             size_t count);
+
+/// @brief シリアルの送信を積む
+/// @details 順序と失敗の扱いは event_uring_write_can と同じ。tty が一部しか
+///          受け取らなかった送信は残りを出し直さず tx_errors に数える。
+bool event_uring_write_serial(EventUring* uring, int fd,
+                              const SerialMessage* msg);
+
+/// @brief 積んだ要求を投入し、完了した受信をコールバックに渡す
+/// @param wait true なら完了が 1 つ以上届くまで待つ
+/// @return コールバックに渡したフレーム/チャンク数（エラーの場合は -1）
+int event_uring_run_once(EventUring* uring, bool wait);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // EVENT_URING_H
@@ -0,0 +1,125 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief 登録できる区間の最大数（ライブラリ内の区間を含む）
+#ifndef OM_PROFILE_MAX_REGIONS
+#define OM_PROFILE_MAX_REGIONS 16
+#endif
+
+/// @brief 実行時間のヒストグラムのビン数
+/// @details ビン 0 は 1 µs 未満、ビン i は [2^(i-1), 2^i) µs、最後のビンは
+///          それ以上。既定の 10 ビンで 256 µs 以上までを分ける。
+#ifndef OM_PROFILE_HIST_BINS
+#define OM_PROFILE_HIST_BINS 10
+#endif
+
+/// @brief ライブラリ内で計測する区間
+/// @details OMURAISU_PROFILE_ENABLE を定義してビルドした場合だけ記録される。
+///          入れ子の区間（割り込みに割り込まれた時間を含む）はそれぞれに
+///          計上されるため、合計は重複しうる。
+typedef enum {
+  OM_PROFILE_CAN_CUBE_RX = 0,   ///< can_cube_on_rx_pending
+  OM_PROFILE_CAN_CUBE_TX,       ///< can_cube_on_tx_ready
+  OM_PROFILE_SERIAL_STM32_RX,   ///< serial_stm32_dispatch_rx
+  OM_PROFILE_CAN_DISPATCH,      ///< can_dispatcher_poll
+  OM_PROFILE_CAN_SCHEDULER,     ///< can_scheduler_tick
+  OM_PROFILE_RM_READ,           ///< om_rm_read_all
+  OM_PROFILE_RM_WRITE,          ///< om_rm_write
+  OM_PROFILE_USER_FIRST,        ///< om_profile_register が返す最初の番号
+} ProfileRegionId;
+
+/// @brief 区間ごとの計測結果（時間の単位はすべて tick）
+typedef struct {
+  const char* name;  ///< NULL なら未登録
+  uint32_t calls;
+  uint32_t min_ticks;
+  uint32_t max_ticks;
+  uint64_t total_ticks;
+  uint32_t hist[OM_PROFILE_HIST_BINS];
+} ProfileRegion;
+
+// tick の取得元。Cortex-M3 以降は DWT のサイクルカウンタ、x86 は rdtsc を
+// インラインで読む。それ以外の環境では profile.c の clock_gettime（ns）を
+// 使う。DWT を持たないコア（Cortex-M0 など）では om_profile_now を
+// アプリ側で定義する。
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || \
+    defined(__ARM_ARCH_8M_MAIN__) || defined(__ARM_ARCH_8_1M_MAIN__)
+#define OM_PROFILE_HAS_DWT 1
+#define OM_PROFILE_DWT_CYCCNT (*(volatile uint32_t*)0xE0001004UL)
+
+static inline uint32_t om_profile_now(void) { return OM_PROFILE_DWT_CYCCNT; }
+#elif (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define OM_PROFILE_HAS_RDTSC 1
+
+static inline uint32_t om_profile_now(void) {
+  return (uint32_t)__builtin_ia32_rdtsc();
+}
+#else
+uint32_t om_profile_now(void);
+#endif
+
+/// @brief 計測を初期化し、全区間の結果とユーザ区間の登録を消す
+/// @param ticks_per_us 1 µs あたりの tick 数。Cortex-M では
+///        SystemCoreClock / 1000000 を渡す（DWT のカウンタもここで動かす）。
+///        0 の場合、x86 では rdtsc を CLOCK_MONOTONIC で 10 ms かけて較正し、
+///        clock_gettime を使う環境では 1000 になる。
+void om_profile_init(uint32_t ticks_per_us);
+
+uint32_t om_profile_ticks_per_us(void);
+
+/// @brief アプリ側の区間を登録する（割り込みが動く前に呼ぶ）
+/// @param name 区間名（文字列はそのまま保持される）
+/// @return 区間番号（空きが無い場合は -1）
+int om_profile_register(const char* name);
+
+/// @brief 区間の実行時間を 1 回分記録する
+/// @details 1 つの区間は 1 つの実行コンテキスト（同じ割り込み優先度）から
+///          だけ記録する。異なる優先度から同じ区間を記録すると値が壊れうる。
+void om_profile_record(int id, uint32_t ticks);
+
+/// @brief 制御周期の区切りを数える
+/// @details 制御周期ごとに 1 回呼ぶと、om_profile_format が区間ごとの
+///          1 周期あたりの平均時間を出す。
+void om_profile_mark_period(void);
+
+uint32_t om_profile_period_count(void);
+
+/// @brief 全区間の結果と周期の数を消す（登録は残す）
+void om_profile_reset(void);
+
+/// @return 区間の結果（範囲外なら NULL）
+const ProfileRegion* om_profile_get(int id);
+
+/// @brief tick を µs に変換する
+float om_profile_ticks_to_us(uint64_t ticks);
+
+/// @brief 登録済みの全区間の結果を表にして書き込む
+/// @details 呼び出し回数、1 回あたりの最小/平均/最大 [µs]、1 周期あたりの
+///          平均 [µs] を 1 区間 1 行で出し、最後の行に 1 周期あたりの合計を
+///          出す。1 度も記録されていない区間は省く。
+/// @return 書き込んだ文字数（末尾の '\0' を除く。切り詰めた場合は size - 1）
+size_t om_profile_format(char* buf, size_t size);
+
+// 計測マクロ。OMURAISU_PROFILE_ENABLE が無い場合は何も生成しない。
+#ifdef OMURAISU_PROFILE_ENABLE
+#define OM_PROFILE_BEGIN(start) const uint32_t start = om_profile_now()
+#define OM_PROFILE_END(id, start) \
+  om_profile_record((id), om_profile_now() - (start))
+#else
+#define OM_PROFILE_BEGIN(start) ((void)0)
+#define OM_PROFILE_END(id, start) ((void)0)
+#endif
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // PROFILE_H
@@ -0,0 +1,138 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief 2のべき乗かどうか（コンパイル時定数にも使用可能）
+#define SPSC_RING_IS_POW2(size) \
+  ((size) != 0U && (((size) & ((size) - 1U)) == 0U))
+
+/// @brief リングサイズが2のべき乗であることをコンパイル時に検査する
+#ifdef __cplusplus
+#define SPSC_RING_ASSERT_POW2(size) \
+  static_assert(SPSC_RING_IS_POW2(size), #size " must be a power of two")
+#else
+#define SPSC_RING_ASSERT_POW2(size) \
+  _Static_assert(SPSC_RING_IS_POW2(size), #size " must be a power of two")
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SPSC_RING_LOAD_RELAXED(ptr) __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#define SPSC_RING_LOAD_ACQUIRE(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define SPSC_RING_STORE_RELEASE(ptr, value) \
+  __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#else
+#define SPSC_RING_LOAD_RELAXED(ptr) (*(volatile const uint32_t*)(ptr))
+#define SPSC_RING_LOAD_ACQUIRE(ptr) (*(volatile const uint32_t*)(ptr))
+#define SPSC_RING_STORE_RELEASE(ptr, value) \
+  (*(volatile uint32_t*)(ptr) = (value))
+#endif
+
+/// @brief 単一プロデューサ/単一コンシューマのロックフリーリングのインデックス
+/// @details 要素の格納先は呼び出し側が持ち、このリングはスロット番号のみを管理する。
+///          head はプロデューサ（ISRなど）だけが、tail はコンシューマ（メインループなど）
+///          だけが更新するため、両者の間で排他は不要。
+///          head / tail は折り返さずに増加させ、mask でスロット番号に変換する。
+typedef struct {
+  uint32_t head;
+  uint32_t tail;
+  uint32_t mask;
+} SpscRing;
+
+/// @param capacity スロット数（2のべき乗）
+static inline void spsc_ring_init(SpscRing* ring, uint32_t capacity) {
+  ring->head = 0;
+  ring->tail = 0;
+  ring->mask = capacity - 1U;
+}
+
+static inline uint32_t spsc_ring_capacity(const SpscRing* ring) {
+  return ring->mask + 1U;
+}
+
+/// @brief 格納済み要素数（並行動作中は参考値）
+static inline uint32_t spsc_ring_count(const SpscRing* ring) {
+  return SPSC_RING_LOAD_ACQUIRE(&ring->head) -
+         SPSC_RING_LOAD_ACQUIRE(&ring->tail);
+}
+
+// ---- プロデューサ側 ----
+
+/// @brief 書き込み可能なスロット数
+static inline uint32_t spsc_ring_writable(const SpscRing* ring) {
+  return spsc_ring_capacity(ring) -
+         (SPSC_RING_LOAD_RELAXED(&ring->head) -
+          SPSC_RING_LOAD_ACQUIRE(&ring->tail));
+}
+
+/// @brief 次に書き込むスロット番号を取得する（満杯なら false）
+static inline bool spsc_ring_write_slot(const SpscRing* ring,
+                                        uint32_t* index) {
+  const uint32_t head = SPSC_RING_LOAD_RELAXED(&ring->head);
+  if (head - SPSC_RING_LOAD_ACQUIRE(&ring->tail) > ring->mask) {
+    return false;
+  }
+  *index = head & ring->mask;
+  return true;
+}
+
+/// @brief 先頭から offset 番目の書き込みスロット番号
+static inline uint32_t spsc_ring_write_index(const SpscRing* ring,
+                                             uint32_t offset) {
+  return (SPSC_RING_LOAD_RELAXED(&ring->head) + offset) & ring->mask;
+}
+
+/// @brief 書き込んだ count 個のスロットをコンシューマに公開する
+static inline void spsc_ring_commit_write_n(SpscRing* ring, uint32_t count) {
+  SPSC_RING_STORE_RELEASE(&ring->head,
+                          SPSC_RING_LOAD_RELAXED(&ring->head) + count);
+}
+
+static inline void spsc_ring_commit_write(SpscRing* ring) {
+  spsc_ring_commit_write_n(ring, 1U);
+}
+
+// ---- コンシューマ側 ----
+
+/// @brief 読み出し可能なスロット数
+static inline uint32_t spsc_ring_readable(const SpscRing* ring) {
+  return SPSC_RING_LOAD_ACQUIRE(&ring->head) -
+         SPSC_RING_LOAD_RELAXED(&ring->tail);
+}
+
+/// @brief 次に読み出すスロット番号を取得する（空なら false）
+static inline bool spsc_ring_read_slot(const SpscRing* ring, uint32_t* index) {
+  const uint32_t tail = SPSC_RING_LOAD_RELAXED(&ring->tail);
+  if (SPSC_RING_LOAD_ACQUIRE(&ring->head) == tail) {
+    return false;
+  }
+  *index = tail & ring->mask;
+  return true;
+}
+
+/// @brief 先頭から offset 番目の読み出しスロット番号
+static inline uint32_t spsc_ring_read_index(const SpscRing* ring,
+                                            uint32_t offset) {
+  return (SPSC_RING_LOAD_RELAXED(&ring->tail) + offset) & ring->mask;
+}
+
+/// @brief 読み終えた count 個のスロットをプロデューサに返却する
+static inline void spsc_ring_commit_read_n(SpscRing* ring, uint32_t count) {
+  SPSC_RING_STORE_RELEASE(&ring->tail,
+                          SPSC_RING_LOAD_RELAXED(&ring->tail) + count);
+}
+
+static inline void spsc_ring_commit_read(SpscRing* ring) {
+  spsc_ring_commit_read_n(ring, 1U);
+}
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // SPSC_RING_H
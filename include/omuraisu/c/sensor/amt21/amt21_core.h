@@ -5,6 +5,10 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #define AMT21_12BIT_RESOLUTION 0
 #define AMT21_14BIT_RESOLUTION 1
 
@@ -38,4 +42,9 @@ void om_amt21_build_read_turn_cmd(uint8_t cmd[2], size_t* len, uint8_t address);
 void om_amt21_build_reset_cmd(uint8_t cmd[2], size_t* len, uint8_t address);
 void om_amt21_build_set_zero_pos_cmd(uint8_t cmd[2], size_t* len,
                                      uint8_t address);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
 #endif  // OMURAISU_C_SENSOR_AMT21_AMT21_CORE_H
\ No newline at end of file
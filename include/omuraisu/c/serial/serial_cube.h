@@ -4,12 +4,20 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "ring/spsc_ring.h"
 #include "serial/serial_interface.h"
 
+/// @brief 受信キューの段数（2のべき乗）
 #ifndef SERIAL_CUBE_RX_QUEUE_SIZE
 #define SERIAL_CUBE_RX_QUEUE_SIZE 16
 #endif
 
+SPSC_RING_ASSERT_POW2(SERIAL_CUBE_RX_QUEUE_SIZE);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef struct {
   bool (*open)(void* hal_context);
   void (*close)(void* hal_context);
@@ -25,10 +33,9 @@ typedef struct {
   void* hal_context;
   SerialCubeOps ops;
 
+  // 受信割り込み（プロデューサ）とメインループ（コンシューマ）で共有
   SerialMessage rx_queue[SERIAL_CUBE_RX_QUEUE_SIZE];
-  uint8_t rx_head;
-  uint8_t rx_tail;
-  uint8_t rx_count;
+  SpscRing rx_ring;
 
   uint32_t rx_overflow_count;
 
@@ -58,4 +65,8 @@ void serial_cube_stop_read(SerialCube* cube);
 
 void serial_cube_on_rx_pending(SerialCube* cube);
 
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
 #endif  // SERIAL_CUBE_H
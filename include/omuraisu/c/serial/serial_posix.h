@@ -0,0 +1,72 @@
+#ifndef SERIAL_POSIX_H
+#define SERIAL_POSIX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "serial/serial_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief デバイスパスの最大長（終端を含む）
+#ifndef SERIAL_POSIX_DEVICE_MAX_LEN
+#define SERIAL_POSIX_DEVICE_MAX_LEN 64
+#endif
+
+/// @brief 書き始めたメッセージの残りを送り切るまでに待つ時間 [ms]
+/// @details 送信バッファが一杯で途中まで書けた場合、残りは空くのを待って
+///          送る（メッセージが途中で切れないように）。これを超えて空かない
+///          場合は write が false を返す。
+#ifndef SERIAL_POSIX_WRITE_TIMEOUT_MS
+#define SERIAL_POSIX_WRITE_TIMEOUT_MS 100
+#endif
+
+/// @brief POSIX の tty（/dev/ttyUSB0 など）向けの SerialPort 実装
+/// @details ノンブロッキング・raw モード（8N1、フロー制御なし）で開く。
+///          read は届いているバイトを最大 SERIAL_MESSAGE_MAX_LEN まで返す。
+///          write は送信バッファが一杯で 1 バイトも書けなければ false を返し、
+///          書き始めたメッセージは残りを待って送り切る。
+///          受信コールバックは serial_posix_on_readable（イベントループが
+///          呼ぶ）から呼ばれる。
+///          OMURAISU_SERIAL_POSIX_ENABLE が未定義の環境では全ての操作が失敗する。
+typedef struct {
+  SerialPort port;
+
+  int fd;
+  char device[SERIAL_POSIX_DEVICE_MAX_LEN];
+  uint32_t baudrate;
+
+  SerialRxCallback rx_callback;
+  void* rx_callback_user_arg;
+} SerialPosix;
+
+void serial_posix_init(SerialPosix* serial, const char* device,
+                       uint32_t baudrate);
+
+/// @return 開けない場合や baudrate に対応していない場合は false
+bool serial_posix_open(SerialPosix* serial);
+
+void serial_posix_close(SerialPosix* serial);
+
+bool serial_posix_is_open(const SerialPosix* serial);
+
+SerialPort* serial_posix_port(SerialPosix* serial);
+
+/// @brief epoll などに登録するためのファイルディスクリプタ（未オープン時は -1）
+int serial_posix_fd(const SerialPosix* serial);
+
+void serial_posix_set_rx_callback(SerialPosix* serial,
+                                  SerialRxCallback callback, void* user_arg);
+
+/// @brief 届いているバイトを全て読み、SerialMessage ごとに受信コールバックに渡す
+/// @return 読んだバイト数
+size_t serial_posix_on_readable(SerialPosix* serial);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // SERIAL_POSIX_H
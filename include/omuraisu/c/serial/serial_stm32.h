@@ -4,17 +4,23 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "ring/spsc_ring.h"
 #include "serial/serial_cube.h"
 
+/// @brief 受信バイトバッファのサイズ（2のべき乗）
+#ifndef SERIAL_STM32_RX_BUFFER_SIZE
+#define SERIAL_STM32_RX_BUFFER_SIZE (SERIAL_MESSAGE_MAX_LEN * 2U)
+#endif
+
+SPSC_RING_ASSERT_POW2(SERIAL_STM32_RX_BUFFER_SIZE);
+
 typedef struct {
   SerialCube* cube;
   void* handle;
 
   uint8_t rx_byte;
-  uint8_t rx_buffer[SERIAL_MESSAGE_MAX_LEN * 2U];
-  uint16_t rx_head;
-  uint16_t rx_tail;
-  uint16_t rx_count;
+  uint8_t rx_buffer[SERIAL_STM32_RX_BUFFER_SIZE];
+  SpscRing rx_ring;
 } SerialStm32Context;
 
 void serial_stm32_context_init(SerialStm32Context* context, SerialCube* cube,
@@ -22,6 +28,10 @@ void serial_stm32_context_init(SerialStm32Context* context, SerialCube* cube,
 
 void serial_stm32_make_ops(SerialCubeOps* ops);
 
+/// @brief 割り込みから引けるようにコンテキストを登録する
+/// @details USART/UART ごとに 1 つ登録でき、割り込みからは HAL ハンドルの
+///          Instance で直接引く。
+/// @return 未対応の周辺機能、または別のコンテキストが登録済みなら false
 bool serial_stm32_register(SerialStm32Context* context);
 
 void serial_stm32_unregister(SerialStm32Context* context);
@@ -1,8 +1,11 @@
 #ifndef VESC_CORE_H
 #define VESC_CORE_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
+#include "can/can_dispatch.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -51,6 +54,10 @@ void om_vesc_core_set_max_duty(VescCore* core, float max);
 
 int om_vesc_core_parse(VescCore* core, uint32_t id, const uint8_t data[8]);
 
+/// @brief STATUS パケット（全 VESC ID）を core に振り分けるよう登録する
+/// @details core はディスパッチャを使う間、同じアドレスに置いておくこと。
+bool om_vesc_core_attach(VescCore* core, CanDispatcher* dispatcher);
+
 void om_vesc_core_set_current(VescCore* core, float current, uint8_t id);
 
 void om_vesc_core_set_current_percent(VescCore* core, float percent,
@@ -0,0 +1,44 @@
+#ifndef OMURAISU_CPP_CAN_CAN_DISPATCH_HPP_
+#define OMURAISU_CPP_CAN_CAN_DISPATCH_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "can/can_dispatch.h"
+#include "can/can_interface.hpp"
+
+namespace omuraisu {
+namespace can {
+
+/// @brief 受信 ID からハンドラを引く振り分けテーブル（::CanDispatcher のラッパ）
+class CanDispatcher {
+ public:
+  CanDispatcher() noexcept;
+
+  CanDispatcher(const CanDispatcher&) = delete;
+  CanDispatcher& operator=(const CanDispatcher&) = delete;
+
+  bool add_id(uint32_t id, ::CanRxCallback callback, void* user_arg);
+  bool add_range(uint32_t first_id, uint32_t last_id, ::CanRxCallback callback,
+                 void* user_arg);
+  bool add_mask(uint32_t id, uint32_t mask, ::CanRxCallback callback,
+                void* user_arg);
+  void set_default(::CanRxCallback callback, void* user_arg);
+
+  bool dispatch(const CanMessage& msg);
+
+  /// @brief バスの受信フレームを read_batch で全て取り出して振り分ける
+  std::size_t poll(ICanBus& bus);
+
+  uint32_t unmatched_count() const;
+
+  ::CanDispatcher* c_dispatcher() noexcept;
+
+ private:
+  ::CanDispatcher dispatcher_;
+};
+
+}  // namespace can
+}  // namespace omuraisu
+
+#endif  // OMURAISU_CPP_CAN_CAN_DISPATCH_HPP_
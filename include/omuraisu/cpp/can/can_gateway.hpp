@@ -0,0 +1,54 @@
+#ifndef OMURAISU_CPP_CAN_CAN_GATEWAY_HPP_
+#define OMURAISU_CPP_CAN_CAN_GATEWAY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "can/can_gateway.h"
+#include "can/can_interface.hpp"
+
+namespace omuraisu {
+namespace can {
+
+/// @brief 複数のバスを経路表でつなぐゲートウェイ（::CanGateway のラッパ）
+/// @details ICanBus で渡したバスは内部で C の CanBus に橋渡しする。
+///          バスはゲートウェイより長く生きている必要がある。
+class CanGateway {
+ public:
+  CanGateway() noexcept;
+
+  CanGateway(const CanGateway&) = delete;
+  CanGateway& operator=(const CanGateway&) = delete;
+
+  /// @return バス番号（接続できない場合は -1）
+  int add_bus(ICanBus& bus, ::CanRxCallback local_callback = nullptr,
+              void* user_arg = nullptr);
+  int add_bus(::CanBus* bus, ::CanRxCallback local_callback = nullptr,
+              void* user_arg = nullptr);
+
+  bool add_route(uint8_t src_bus, uint32_t id, uint32_t mask, uint8_t dst_bus);
+  bool add_route(uint8_t src_bus, uint32_t id, uint32_t mask, uint8_t dst_bus,
+                 uint32_t rewrite_id, uint32_t rewrite_mask);
+
+  std::size_t forward(uint8_t src_bus, const CanMessage* msgs,
+                      std::size_t count);
+  std::size_t poll();
+
+  std::size_t get_filters(uint8_t bus, ::CanFilter* filters,
+                          std::size_t max_count) const;
+
+  /// @brief バスごとの中継の統計
+  const ::CanGatewayPort* port(uint8_t bus) const noexcept;
+
+  ::CanGateway* c_gateway() noexcept;
+
+ private:
+  std::optional<CppCanBusBridge> bridges_[CAN_GATEWAY_MAX_BUSES];
+  ::CanGateway gateway_;
+};
+
+}  // namespace can
+}  // namespace omuraisu
+
+#endif  // OMURAISU_CPP_CAN_CAN_GATEWAY_HPP_
@@ -1,6 +1,7 @@
 #ifndef OMURAISU_CPP_CAN_CAN_INTERFACE_HPP_
 #define OMURAISU_CPP_CAN_CAN_INTERFACE_HPP_
 
+#include <cstddef>
 #include <cstdint>
 
 #include "can/can_interface.h"
@@ -14,8 +15,27 @@ struct CanMessage : public ::CanMessage {
   CanMessage(const CanMessage& other) noexcept;
 
   CanMessage& operator=(const CanMessage& other) noexcept;
+
+  /// @brief timestamp_us（受信時刻 [us]）が有効か
+  bool has_timestamp() const noexcept;
+};
+
+/// @brief CAN FD フレーム（最大 64 バイト）
+struct CanFdMessage : public ::CanFdMessage {
+  CanFdMessage() noexcept;
+  CanFdMessage(uint32_t id, const uint8_t* data, uint8_t len,
+               uint8_t flags = CAN_FD_FLAG_FDF) noexcept;
+  explicit CanFdMessage(const ::CanFdMessage& other) noexcept;
+  explicit CanFdMessage(const ::CanMessage& other) noexcept;
+  CanFdMessage(const CanFdMessage& other) noexcept;
+
+  CanFdMessage& operator=(const CanFdMessage& other) noexcept;
+
+  bool has_timestamp() const noexcept;
 };
 
+using CanBusStats = ::CanBusStats;
+
 class ICanBus {
  public:
   virtual ~ICanBus() = default;
@@ -24,6 +44,66 @@ class ICanBus {
   virtual bool read(CanMessage& msg) = 0;
   virtual void start_read() {}
   virtual void stop_read() {}
+
+  /// @brief count 個のフレームを先頭から順にまとめて送信する
+  /// @details 既定実装は失敗するまで write() を繰り返す。
+  /// @return 受け付けたフレーム数
+  virtual std::size_t write_batch(const CanMessage* msgs, std::size_t count) {
+    std::size_t sent = 0;
+    while (sent < count && write(msgs[sent])) {
+      ++sent;
+    }
+    return sent;
+  }
+
+  template <std::size_t N>
+  std::size_t write_batch(const CanMessage (&msgs)[N]) {
+    return write_batch(msgs, N);
+  }
+
+  /// @brief 最大 max_count 個の受信フレームをまとめて取り出す
+  /// @details 既定実装は read() を繰り返す。
+  /// @return 取り出したフレーム数
+  virtual std::size_t read_batch(CanMessage* msgs, std::size_t max_count) {
+    std::size_t count = 0;
+    while (count < max_count && read(msgs[count])) {
+      ++count;
+    }
+    return count;
+  }
+
+  template <std::size_t N>
+  std::size_t read_batch(CanMessage (&msgs)[N]) {
+    return read_batch(msgs, N);
+  }
+
+  /// @brief CAN FD フレームを送信する
+  /// @details 既定実装は FDF なし・8 バイト以下のフレームだけを write() で送る。
+  virtual bool write_fd(const CanFdMessage& msg) {
+    ::CanMessage classic;
+    if (!can_fd_message_to_classic(&classic, &msg)) {
+      return false;
+    }
+    return write(CanMessage(classic));
+  }
+
+  /// @brief CAN FD フレームを取り出す
+  /// @details 既定実装は read() で受けた従来フレームを変換して返す。
+  virtual bool read_fd(CanFdMessage& msg) {
+    CanMessage classic;
+    if (!read(classic)) {
+      return false;
+    }
+    msg = CanFdMessage(static_cast<const ::CanMessage&>(classic));
+    return true;
+  }
+
+  /// @brief 統計情報のスナップショットを取る
+  /// @return 統計に対応していないバスでは false
+  virtual bool get_stats(CanBusStats& stats) {
+    stats = CanBusStats{};
+    return false;
+  }
 };
 
 class CCanBusAdapter : public ICanBus {
@@ -35,6 +115,17 @@ class CCanBusAdapter : public ICanBus {
   void start_read() override;
   void stop_read() override;
 
+  using ICanBus::write_batch;
+  std::size_t write_batch(const CanMessage* msgs, std::size_t count) override;
+
+  using ICanBus::read_batch;
+  std::size_t read_batch(CanMessage* msgs, std::size_t max_count) override;
+
+  bool write_fd(const CanFdMessage& msg) override;
+  bool read_fd(CanFdMessage& msg) override;
+
+  bool get_stats(CanBusStats& stats) override;
+
  private:
   ::CanBus* bus_;
 };
@@ -56,7 +147,14 @@ class CppCanBusBridge {
 
  private:
   static bool write_thunk(void* self, const ::CanMessage* msg);
+  static size_t write_batch_thunk(void* self, const ::CanMessage* msgs,
+                                  size_t count);
   static bool read_thunk(void* self, ::CanMessage* msg);
+  static size_t read_batch_thunk(void* self, ::CanMessage* msgs,
+                                 size_t max_count);
+  static bool write_fd_thunk(void* self, const ::CanFdMessage* msg);
+  static bool read_fd_thunk(void* self, ::CanFdMessage* msg);
+  static bool get_stats_thunk(void* self, ::CanBusStats* stats);
   static void start_read_thunk(void* self);
   static void stop_read_thunk(void* self);
   static void destroy_thunk(void* self);
@@ -0,0 +1,45 @@
+#ifndef OMURAISU_CPP_CAN_CAN_SCHEDULER_HPP_
+#define OMURAISU_CPP_CAN_CAN_SCHEDULER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "can/can_interface.hpp"
+#include "can/can_scheduler.h"
+
+namespace omuraisu {
+namespace can {
+
+/// @brief 周期送信フレームを tick() から送り出すスケジューラ（::CanScheduler のラッパ）
+class CanScheduler {
+ public:
+  explicit CanScheduler(ICanBus& bus) noexcept;
+
+  CanScheduler(const CanScheduler&) = delete;
+  CanScheduler& operator=(const CanScheduler&) = delete;
+
+  void set_max_per_tick(uint8_t max_per_tick);
+
+  /// @return スロット番号（登録できない場合は -1）
+  int add(uint32_t period, uint32_t phase, ::CanScheduleFillFn fill,
+          void* user_arg);
+  /// @brief 空いている位相を自動で選んで登録する
+  int add(uint32_t period, ::CanScheduleFillFn fill, void* user_arg);
+  void set_enabled(int slot, bool enabled);
+
+  std::size_t tick();
+
+  uint32_t deferred_count() const;
+  uint32_t skipped_count() const;
+
+  ::CanScheduler* c_scheduler() noexcept;
+
+ private:
+  CppCanBusBridge bridge_;
+  ::CanScheduler scheduler_;
+};
+
+}  // namespace can
+}  // namespace omuraisu
+
+#endif  // OMURAISU_CPP_CAN_CAN_SCHEDULER_HPP_
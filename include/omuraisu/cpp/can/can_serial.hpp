@@ -0,0 +1,52 @@
+#ifndef OMURAISU_CPP_CAN_CAN_SERIAL_HPP_
+#define OMURAISU_CPP_CAN_CAN_SERIAL_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "can/can_interface.hpp"
+#include "can/can_serial.h"
+#include "serial/serial_interface.hpp"
+
+namespace omuraisu {
+namespace can {
+
+/// @brief シリアル回線越しに CAN フレームをやり取りする ICanBus 実装
+/// @details ::CanSerial のラッパ。write() はフレームを溜めるだけなので、
+///          メインループで poll()（または flush()）を呼ぶ。
+class SerialCanBus : public ICanBus {
+ public:
+  explicit SerialCanBus(serial::ISerialPort& port) noexcept;
+
+  SerialCanBus(const SerialCanBus&) = delete;
+  SerialCanBus& operator=(const SerialCanBus&) = delete;
+
+  bool write(const CanMessage& msg) override;
+  bool read(CanMessage& msg) override;
+  void start_read() override;
+  void stop_read() override;
+  using ICanBus::write_batch;
+  std::size_t write_batch(const CanMessage* msgs, std::size_t count) override;
+  bool get_stats(CanBusStats& stats) override;
+
+  bool flush();
+  void feed(const uint8_t* data, std::size_t size);
+  void poll();
+
+  /// @brief 回線と実際の CAN バスの間でフレームを中継する
+  std::size_t relay(ICanBus& local, std::size_t max_frames);
+
+  uint32_t rx_errors() const;
+
+  /// @brief C APIから使う場合の CanBus
+  ::CanBus* c_bus() noexcept;
+
+ private:
+  serial::CppSerialPortBridge port_bridge_;
+  ::CanSerial link_;
+};
+
+}  // namespace can
+}  // namespace omuraisu
+
+#endif  // OMURAISU_CPP_CAN_CAN_SERIAL_HPP_
@@ -0,0 +1,64 @@
+#ifndef OMURAISU_CPP_CAN_CAN_SOCKETCAN_HPP_
+#define OMURAISU_CPP_CAN_CAN_SOCKETCAN_HPP_
+
+#include "can/can_interface.hpp"
+
+// このファイルはLinux（SocketCAN）環境でのみ使用可能
+#if defined(__has_include)
+#if __has_include(<linux/can.h>)
+#include <cstddef>
+#include <string>
+
+#include "can/can_socketcan.h"
+
+namespace omuraisu {
+namespace can {
+
+/// @brief Linux SocketCAN用のICanBus実装
+class SocketCanBus : public ICanBus {
+ public:
+  /// @brief コンストラクタ
+  /// @param ifname CANインターフェース名（例: "can0", "vcan0"）
+  explicit SocketCanBus(const std::string& ifname);
+  ~SocketCanBus() override;
+
+  // コピー禁止
+  SocketCanBus(const SocketCanBus&) = delete;
+  SocketCanBus& operator=(const SocketCanBus&) = delete;
+
+  bool open();
+  void close();
+  bool is_open() const;
+
+  bool write(const CanMessage& msg) override;
+  bool read(CanMessage& msg) override;
+
+  /// @brief recvmmsg で最大 max_count 個のフレームをまとめて受信する
+  using ICanBus::read_batch;
+  std::size_t read_batch(CanMessage* msgs, std::size_t max_count) override;
+
+  /// @brief sendmmsg で複数フレームをまとめて送信する
+  using ICanBus::write_batch;
+  std::size_t write_batch(const CanMessage* msgs, std::size_t count) override;
+
+  /// @brief カーネルの受信フィルタを設定する（count が 0 なら全受信）
+  bool set_filters(const ::CanFilter* filters, std::size_t count);
+
+  /// @brief epoll などに登録するためのファイルディスクリプタ
+  int fd() const;
+
+  /// @brief C APIから使う場合の CanBus
+  ::CanBus* c_bus() noexcept;
+
+ private:
+  std::string ifname_;
+  ::CanSocketCan socketcan_;
+};
+
+}  // namespace can
+}  // namespace omuraisu
+
+#endif
+#endif  // __has_include check
+
+#endif  // OMURAISU_CPP_CAN_CAN_SOCKETCAN_HPP_
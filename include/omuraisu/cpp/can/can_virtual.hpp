@@ -0,0 +1,65 @@
+#ifndef OMURAISU_CPP_CAN_CAN_VIRTUAL_HPP_
+#define OMURAISU_CPP_CAN_CAN_VIRTUAL_HPP_
+
+#include <cstdint>
+
+#include "can/can_interface.hpp"
+#include "can/can_virtual.h"
+
+namespace omuraisu {
+namespace can {
+
+/// @brief ノード間で共有するメモリ上の CAN 媒体（::CanVirtualMedium のラッパ）
+class VirtualCanMedium {
+ public:
+  explicit VirtualCanMedium(uint32_t bitrate) noexcept;
+
+  VirtualCanMedium(const VirtualCanMedium&) = delete;
+  VirtualCanMedium& operator=(const VirtualCanMedium&) = delete;
+
+  void set_latency(uint32_t latency_us);
+  void set_loss(uint16_t permille, uint32_t seed);
+
+  /// @brief シミュレーション時間を dt_us 進める
+  void advance(uint32_t dt_us);
+  uint32_t run_until_idle();
+  uint32_t now() const;
+
+  uint32_t delivered_count() const;
+  uint32_t lost_count() const;
+
+  ::CanVirtualMedium* c_medium() noexcept;
+
+ private:
+  ::CanVirtualMedium medium_;
+};
+
+/// @brief 仮想 CAN 媒体に接続された ICanBus 実装
+class VirtualCanBus : public ICanBus {
+ public:
+  /// @details 接続数が上限を超えた場合、送信は常に失敗する（is_attached で確認）
+  explicit VirtualCanBus(VirtualCanMedium& medium) noexcept;
+
+  VirtualCanBus(const VirtualCanBus&) = delete;
+  VirtualCanBus& operator=(const VirtualCanBus&) = delete;
+
+  bool is_attached() const;
+
+  bool write(const CanMessage& msg) override;
+  bool read(CanMessage& msg) override;
+  bool get_stats(CanBusStats& stats) override;
+
+  uint32_t tx_pending() const;
+
+  /// @brief C APIから使う場合の CanBus
+  ::CanBus* c_bus() noexcept;
+
+ private:
+  ::CanVirtualNode node_;
+  bool attached_;
+};
+
+}  // namespace can
+}  // namespace omuraisu
+
+#endif  // OMURAISU_CPP_CAN_CAN_VIRTUAL_HPP_
@@ -1,6 +1,8 @@
 #ifndef OMURAISU_CPP_DJI_ROBOMAS_HPP_
 #define OMURAISU_CPP_DJI_ROBOMAS_HPP_
+#include "can/can_dispatch.hpp"
 #include "can/can_interface.hpp"
+#include "can/can_scheduler.hpp"
 #include "robomas_core.hpp"
 
 namespace omuraisu {
@@ -13,8 +15,14 @@ class Robomas {
 
   void set_max_output(int16_t max);
   int read();
+  /// @brief 受信済みフレームを全て取り出して解析し、解析したフィードバック数を返す
+  int read_all();
   bool write();
   int parse(uint32_t id, const uint8_t data[8]);
+  /// @brief 0x201〜0x208 のフィードバックをこのインスタンスに振り分けるよう登録する
+  bool attach(can::CanDispatcher& dispatcher);
+  /// @brief 2 つの指令フレームを period tick ごとにスケジューラから送るよう登録する
+  bool schedule(can::CanScheduler& scheduler, uint32_t period);
   void set_output(int16_t current, int id);
   void set_output_percent(float percent, int id);
   void get_output(uint8_t out[2][8]) const;
@@ -23,9 +31,16 @@ class Robomas {
   uint16_t get_angle(int id) const;
   int16_t get_rpm(int id) const;
   uint8_t get_temp(int id) const;
+  /// @brief 最後に受信したフィードバックの受信時刻 [us]（未対応のバスでは 0）
+  uint32_t get_timestamp(int id) const;
   RobomasData get_data(int id) const;
 
  private:
+  static void on_can_message(const ::CanMessage* msg, void* user_arg);
+  int parse_message(const ::CanMessage& msg);
+  static bool fill_group1(::CanMessage* msg, void* user_arg);
+  static bool fill_group2(::CanMessage* msg, void* user_arg);
+
   can::ICanBus& bus_;
   RobomasCore core_;
 };
@@ -32,6 +32,8 @@ class RobomasCore {
   uint16_t get_angle(int id) const;
   int16_t get_rpm(int id) const;
   uint8_t get_temp(int id) const;
+  void set_timestamp(int id, uint32_t timestamp_us);
+  uint32_t get_timestamp(int id) const;
   RobomasData get_data(int id) const;
 
  private:
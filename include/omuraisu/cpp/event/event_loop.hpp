@@ -0,0 +1,47 @@
+#ifndef OMURAISU_CPP_EVENT_EVENT_LOOP_HPP_
+#define OMURAISU_CPP_EVENT_EVENT_LOOP_HPP_
+
+#include <cstdint>
+
+#include "event/event_loop.h"
+#include "serial/serial_posix.hpp"
+
+namespace omuraisu {
+namespace event {
+
+/// @brief epoll と timerfd による単一スレッドのイベントループ（::EventLoop のラッパ）
+/// @details SocketCAN は can::SocketCanBus::fd() を add_fd で登録するか、
+///          C API の event_loop_add_socketcan を c_loop() に対して使う。
+class EventLoop {
+ public:
+  EventLoop() noexcept;
+  ~EventLoop();
+
+  EventLoop(const EventLoop&) = delete;
+  EventLoop& operator=(const EventLoop&) = delete;
+
+  /// @brief epoll を作れたか
+  bool is_valid() const;
+
+  /// @return ソース番号（登録できない場合は -1）
+  int add_fd(int fd, uint32_t events, ::EventFdFn callback, void* user_arg);
+  int add_timer(uint32_t period_us, ::EventTimerFn callback, void* user_arg);
+  int add_serial(serial::PosixSerialPort& port,
+                 serial::SerialRxCallback callback, void* user_arg);
+  bool remove(int source);
+
+  int run_once(int timeout_ms);
+  void run();
+  void stop();
+
+  ::EventLoop* c_loop() noexcept;
+
+ private:
+  ::EventLoop loop_;
+  bool valid_;
+};
+
+}  // namespace event
+}  // namespace omuraisu
+
+#endif  // OMURAISU_CPP_EVENT_EVENT_LOOP_HPP_
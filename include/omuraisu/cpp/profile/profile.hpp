@@ -0,0 +1,42 @@
+#ifndef OMURAISU_CPP_PROFILE_PROFILE_HPP_
+#define OMURAISU_CPP_PROFILE_PROFILE_HPP_
+
+#include <cstdint>
+
+#include "profile/profile.h"
+
+namespace omuraisu {
+namespace profile {
+
+/// @brief 生成から破棄までの時間を区間 id に記録する
+/// @details OMURAISU_PROFILE_ENABLE に関係なく記録する。ビルド設定で
+///          消したい場合は OM_PROFILE_SCOPE を使う。
+class Scope {
+ public:
+  explicit Scope(int id) noexcept : id_(id), start_(om_profile_now()) {}
+  ~Scope() { om_profile_record(id_, om_profile_now() - start_); }
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+ private:
+  int id_;
+  uint32_t start_;
+};
+
+}  // namespace profile
+}  // namespace omuraisu
+
+#define OM_PROFILE_CONCAT_(a, b) a##b
+#define OM_PROFILE_CONCAT(a, b) OM_PROFILE_CONCAT_(a, b)
+
+/// @brief スコープの終わりまでを区間 id として計測する
+#ifdef OMURAISU_PROFILE_ENABLE
+#define OM_PROFILE_SCOPE(id)                                          \
+  const ::omuraisu::profile::Scope OM_PROFILE_CONCAT(om_profile_scope_, \
+                                                     __LINE__)(id)
+#else
+#define OM_PROFILE_SCOPE(id) ((void)0)
+#endif
+
+#endif  // OMURAISU_CPP_PROFILE_PROFILE_HPP_
@@ -1,6 +1,7 @@
 #ifndef OMURAISU_CPP_SERIAL_SERIAL_BOOST_HPP_
 #define OMURAISU_CPP_SERIAL_SERIAL_BOOST_HPP_
 
+#include "ring/spsc_ring.h"
 #include "serial/serial_interface.hpp"
 
 // このファイルはBoost.Asioが利用可能な環境でのみ使用可能
@@ -12,10 +13,13 @@
 namespace omuraisu {
 namespace serial {
 
+/// @brief 受信バイトバッファのサイズ（2のべき乗）
 #ifndef OMURAISU_SERIAL_BOOST_RX_BUFFER_SIZE
 #define OMURAISU_SERIAL_BOOST_RX_BUFFER_SIZE 512
 #endif
 
+SPSC_RING_ASSERT_POW2(OMURAISU_SERIAL_BOOST_RX_BUFFER_SIZE);
+
 class BoostSerialPort : public ISerialPort {
  public:
   BoostSerialPort(boost::asio::io_context& io, const std::string& device,
@@ -51,9 +55,7 @@ class BoostSerialPort : public ISerialPort {
   void* rx_callback_user_arg_;
 
   uint8_t rx_buffer_[OMURAISU_SERIAL_BOOST_RX_BUFFER_SIZE];
-  uint16_t rx_head_;
-  uint16_t rx_tail_;
-  uint16_t rx_count_;
+  SpscRing rx_ring_;
 
   uint8_t temp_buffer_[SERIAL_MESSAGE_MAX_LEN];
 };
@@ -1,6 +1,7 @@
 #ifndef OMURAISU_CPP_SERIAL_SERIAL_MBED_HPP_
 #define OMURAISU_CPP_SERIAL_SERIAL_MBED_HPP_
 
+#include "ring/spsc_ring.h"
 #include "serial/serial_interface.hpp"
 
 // このファイルはmbed環境でのみ使用可能
@@ -11,10 +12,13 @@
 namespace omuraisu {
 namespace serial {
 
+/// @brief 受信バイトバッファのサイズ（2のべき乗）
 #ifndef OMURAISU_SERIAL_MBED_RX_BUFFER_SIZE
 #define OMURAISU_SERIAL_MBED_RX_BUFFER_SIZE 256
 #endif
 
+SPSC_RING_ASSERT_POW2(OMURAISU_SERIAL_MBED_RX_BUFFER_SIZE);
+
 class MbedSerialPort : public ISerialPort {
  public:
   MbedSerialPort(PinName tx, PinName rx, int baudrate = 115200);
@@ -47,9 +51,7 @@ class MbedSerialPort : public ISerialPort {
   void* rx_callback_user_arg_;
 
   uint8_t rx_buffer_[OMURAISU_SERIAL_MBED_RX_BUFFER_SIZE];
-  uint16_t rx_head_;
-  uint16_t rx_tail_;
-  uint16_t rx_count_;
+  SpscRing rx_ring_;
 };
 
 }  // namespace serial
@@ -0,0 +1,47 @@
+#ifndef OMURAISU_CPP_SERIAL_SERIAL_POSIX_HPP_
+#define OMURAISU_CPP_SERIAL_SERIAL_POSIX_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "serial/serial_interface.hpp"
+#include "serial/serial_posix.h"
+
+namespace omuraisu {
+namespace serial {
+
+/// @brief POSIX の tty 向けの ISerialPort 実装（::SerialPosix のラッパ）
+/// @details Boost を使わずに PC から tty を扱う。受信コールバックは
+///          on_readable()（event::EventLoop が呼ぶ）から呼ばれる。
+class PosixSerialPort : public ISerialPort {
+ public:
+  PosixSerialPort(const std::string& device, uint32_t baudrate);
+  ~PosixSerialPort() override;
+
+  PosixSerialPort(const PosixSerialPort&) = delete;
+  PosixSerialPort& operator=(const PosixSerialPort&) = delete;
+
+  bool open() override;
+  void close() override;
+  bool write(const SerialMessage& msg) override;
+  bool read(SerialMessage& msg) override;
+  void set_rx_callback(SerialRxCallback callback, void* user_arg) override;
+
+  bool is_open() const;
+
+  /// @brief epoll などに登録するためのファイルディスクリプタ
+  int fd() const;
+
+  std::size_t on_readable();
+
+  ::SerialPosix* c_serial() noexcept;
+
+ private:
+  ::SerialPosix serial_;
+};
+
+}  // namespace serial
+}  // namespace omuraisu
+
+#endif  // OMURAISU_CPP_SERIAL_SERIAL_POSIX_HPP_
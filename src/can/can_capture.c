@@ -0,0 +1,497 @@
+#include "can/can_capture.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef OMURAISU_CAN_CAPTURE_ENABLE
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define CAN_CAPTURE_BYTE_ORDER 0x01020304U
+
+typedef struct {
+  uint32_t id;
+  uint32_t index;
+} CanCapturePosting;
+
+// --- 作成 ---
+
+static bool can_capture_grow(void** array, size_t* capacity, size_t count,
+                             size_t elem_size) {
+  void* grown = 0;
+  size_t next = 0;
+
+  if (count < *capacity) {
+    return true;
+  }
+  next = *capacity == 0U ? 1024U : *capacity * 2U;
+  grown = realloc(*array, next * elem_size);
+  if (grown == 0) {
+    return false;
+  }
+  *array = grown;
+  *capacity = next;
+  return true;
+}
+
+static bool can_capture_write(CanCaptureBuilder* builder, const void* data,
+                              size_t size) {
+  if (size != 0U && fwrite(data, 1U, size, builder->file) != size) {
+    builder->error = true;
+  }
+  return !builder->error;
+}
+
+// 次の書き込み位置を align バイト境界に揃える
+static bool can_capture_pad(CanCaptureBuilder* builder, uint64_t* offset,
+                            uint64_t align) {
+  static const uint8_t zeros[8] = {0};
+  uint64_t pad = (align - *offset % align) % align;
+  *offset += pad;
+  return can_capture_write(builder, zeros, (size_t)pad);
+}
+
+bool can_capture_builder_open(CanCaptureBuilder* builder, const char* path) {
+  CanCaptureHeader header;
+
+  memset(builder, 0, sizeof(*builder));
+  builder->file = fopen(path, "wb");
+  if (builder->file == 0) {
+    builder->error = true;
+    return false;
+  }
+  // ヘッダは finish で書き直す
+  memset(&header, 0, sizeof(header));
+  return can_capture_write(builder, &header, sizeof(header));
+}
+
+bool can_capture_builder_append(CanCaptureBuilder* builder,
+                                const CanLogRecord* record) {
+  CanMessage msg = record->msg;
+  uint64_t offset = 0;
+
+  if (builder->error) {
+    return false;
+  }
+  if (builder->count == 0U) {
+    builder->base_time_us = record->time_us;
+  }
+  if (record->time_us < builder->base_time_us + builder->last_offset_us) {
+    offset = builder->last_offset_us;
+    builder->clamped_count++;
+  } else {
+    offset = record->time_us - builder->base_time_us;
+  }
+  if (offset > UINT32_MAX) {
+    return false;
+  }
+
+  if (!can_capture_grow((void**)&builder->ids, &builder->ids_capacity,
+                        (size_t)builder->count, sizeof(uint32_t)) ||
+      !can_capture_grow((void**)&builder->time_index,
+                        &builder->time_index_capacity,
+                        builder->time_index_count, sizeof(uint32_t))) {
+    builder->error = true;
+    return false;
+  }
+
+  msg.flags = CAN_MSG_FLAG_TIMESTAMP;
+  msg.timestamp_us = (uint32_t)offset;
+  if (!can_capture_write(builder, &msg, sizeof(msg))) {
+    return false;
+  }
+  if (builder->count % CAN_CAPTURE_TIME_INDEX_STRIDE == 0U) {
+    builder->time_index[builder->time_index_count++] = (uint32_t)offset;
+  }
+  builder->ids[builder->count++] = msg.id;
+  builder->last_offset_us = (uint32_t)offset;
+  return true;
+}
+
+static int can_capture_compare_posting(const void* a, const void* b) {
+  const CanCapturePosting* pa = (const CanCapturePosting*)a;
+  const CanCapturePosting* pb = (const CanCapturePosting*)b;
+  if (pa->id != pb->id) {
+    return pa->id < pb->id ? -1 : 1;
+  }
+  return pa->index < pb->index ? -1 : (pa->index > pb->index ? 1 : 0);
+}
+
+// ID テーブルとレコード番号表を書く
+static bool can_capture_write_id_index(CanCaptureBuilder* builder,
+                                       CanCaptureHeader* header,
+                                       uint64_t* offset) {
+  size_t count = (size_t)builder->count;
+  CanCapturePosting* postings = 0;
+  uint64_t first = 0;
+
+  if (count != 0U) {
+    postings = (CanCapturePosting*)malloc(count * sizeof(*postings));
+    if (postings == 0) {
+      builder->error = true;
+      return false;
+    }
+  }
+  for (size_t i = 0; i < count; ++i) {
+    postings[i].id = builder->ids[i];
+    postings[i].index = (uint32_t)i;
+  }
+  qsort(postings, count, sizeof(*postings), can_capture_compare_posting);
+
+  can_capture_pad(builder, offset, 8U);
+  header->id_table_offset = *offset;
+  for (size_t i = 0; i < count;) {
+    CanCaptureIdEntry entry;
+    size_t j = i;
+    while (j < count && postings[j].id == postings[i].id) {
+      j++;
+    }
+    entry.id = postings[i].id;
+    entry.count = (uint32_t)(j - i);
+    entry.first = first;
+    can_capture_write(builder, &entry, sizeof(entry));
+    *offset += sizeof(entry);
+    header->id_count++;
+    first += entry.count;
+    i = j;
+  }
+
+  header->postings_offset = *offset;
+  for (size_t i = 0; i < count; ++i) {
+    can_capture_write(builder, &postings[i].index, sizeof(uint32_t));
+  }
+  *offset += (uint64_t)count * sizeof(uint32_t);
+
+  free(postings);
+  return !builder->error;
+}
+
+bool can_capture_builder_finish(CanCaptureBuilder* builder) {
+  CanCaptureHeader header;
+  uint64_t offset = 0;
+  bool ok = false;
+
+  if (builder->file == 0) {
+    return false;
+  }
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, CAN_CAPTURE_MAGIC, sizeof(header.magic));
+  header.version = CAN_CAPTURE_VERSION;
+  header.record_size = (uint32_t)sizeof(CanMessage);
+  header.byte_order = CAN_CAPTURE_BYTE_ORDER;
+  header.time_index_stride = CAN_CAPTURE_TIME_INDEX_STRIDE;
+  header.base_time_us = builder->base_time_us;
+  header.record_count = builder->count;
+  header.records_offset = sizeof(CanCaptureHeader);
+
+  offset = header.records_offset + builder->count * sizeof(CanMessage);
+  header.time_index_offset = offset;
+  header.time_index_count = builder->time_index_count;
+  can_capture_write(builder, builder->time_index,
+                    builder->time_index_count * sizeof(uint32_t));
+  offset += builder->time_index_count * sizeof(uint32_t);
+
+  if (can_capture_write_id_index(builder, &header, &offset) &&
+      fseek(builder->file, 0, SEEK_SET) == 0) {
+    ok = can_capture_write(builder, &header, sizeof(header));
+  }
+  if (fclose(builder->file) != 0) {
+    ok = false;
+  }
+  builder->file = 0;
+
+  free(builder->time_index);
+  free(builder->ids);
+  builder->time_index = 0;
+  builder->ids = 0;
+  return ok && !builder->error;
+}
+
+bool can_capture_import_candump(FILE* input, const char* path, size_t* count) {
+  CanCaptureBuilder builder;
+  CanLogRecord record;
+  char line[256];
+  size_t imported = 0;
+  bool ok = true;
+
+  if (!can_capture_builder_open(&builder, path)) {
+    return false;
+  }
+  while (fgets(line, sizeof(line), input) != 0) {
+    if (line[0] == '\n' || line[0] == '\r' || line[0] == '\0') {
+      continue;
+    }
+    if (!can_log_parse_candump(line, &record) ||
+        !can_capture_builder_append(&builder, &record)) {
+      ok = false;
+      continue;
+    }
+    imported++;
+  }
+  if (count != 0) {
+    *count = imported;
+  }
+  return can_capture_builder_finish(&builder) && ok;
+}
+
+// --- 読み出し ---
+
+#ifdef OMURAISU_CAN_CAPTURE_ENABLE
+static bool can_capture_in_range(const CanCapture* capture, uint64_t offset,
+                                 uint64_t count, uint64_t elem_size) {
+  return offset <= capture->size &&
+         count <= (capture->size - offset) / elem_size;
+}
+
+static bool can_capture_validate(CanCapture* capture) {
+  const CanCaptureHeader* header = (const CanCaptureHeader*)capture->base;
+
+  if (capture->size < sizeof(*header) ||
+      memcmp(header->magic, CAN_CAPTURE_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != CAN_CAPTURE_VERSION ||
+      header->record_size != sizeof(CanMessage) ||
+      header->byte_order != CAN_CAPTURE_BYTE_ORDER ||
+      header->time_index_stride == 0U) {
+    return false;
+  }
+  if (!can_capture_in_range(capture, header->records_offset,
+                            header->record_count, sizeof(CanMessage)) ||
+      !can_capture_in_range(capture, header->time_index_offset,
+                            header->time_index_count, sizeof(uint32_t)) ||
+      !can_capture_in_range(capture, header->id_table_offset,
+                            header->id_count, sizeof(CanCaptureIdEntry)) ||
+      !can_capture_in_range(capture, header->postings_offset,
+                            header->record_count, sizeof(uint32_t))) {
+    return false;
+  }
+  // 時刻インデックスはブロックごとに 1 つ（lower_bound がブロックの範囲を
+  // レコード数から求めるため）
+  if (header->time_index_count !=
+      (header->record_count + header->time_index_stride - 1U) /
+          header->time_index_stride) {
+    return false;
+  }
+
+  capture->records =
+      (const CanMessage*)(capture->base + header->records_offset);
+  capture->time_index =
+      (const uint32_t*)(capture->base + header->time_index_offset);
+  capture->ids =
+      (const CanCaptureIdEntry*)(capture->base + header->id_table_offset);
+  capture->postings =
+      (const uint32_t*)(capture->base + header->postings_offset);
+
+  // 問い合わせはここで確かめた範囲だけを読む。レコード番号表の中身は
+  // 開くたびに全て読むと mmap の遅延読み込みが無駄になるため、読むときに確かめる
+  for (uint64_t i = 0; i < header->id_count; ++i) {
+    const CanCaptureIdEntry* entry = &capture->ids[i];
+    if (entry->first > header->record_count ||
+        entry->count > header->record_count - entry->first ||
+        (i > 0U && capture->ids[i - 1U].id >= entry->id)) {
+      return false;
+    }
+  }
+  capture->header = header;
+  return true;
+}
+#endif
+
+bool can_capture_open(CanCapture* capture, const char* path) {
+  memset(capture, 0, sizeof(*capture));
+#ifdef OMURAISU_CAN_CAPTURE_ENABLE
+  {
+    struct stat st;
+    void* mapped = MAP_FAILED;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+      return false;
+    }
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      mapped = mmap(0, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapped == MAP_FAILED) {
+      return false;
+    }
+
+    capture->base = (const uint8_t*)mapped;
+    capture->size = (size_t)st.st_size;
+    if (!can_capture_validate(capture)) {
+      can_capture_close(capture);
+      return false;
+    }
+    return true;
+  }
+#else
+  (void)path;
+  return false;
+#endif
+}
+
+void can_capture_close(CanCapture* capture) {
+#ifdef OMURAISU_CAN_CAPTURE_ENABLE
+  if (capture->base != 0) {
+    munmap((void*)capture->base, capture->size);
+  }
+#endif
+  memset(capture, 0, sizeof(*capture));
+}
+
+size_t can_capture_count(const CanCapture* capture) {
+  return capture->header == 0 ? 0U : (size_t)capture->header->record_count;
+}
+
+const CanMessage* can_capture_records(const CanCapture* capture) {
+  return capture->records;
+}
+
+uint64_t can_capture_time_us(const CanCapture* capture, const CanMessage* msg) {
+  return capture->header->base_time_us + msg->timestamp_us;
+}
+
+// t_us を先頭からの経過時間に直す（範囲外は 0 または 2^32）
+static uint64_t can_capture_offset_of(const CanCapture* capture,
+                                      uint64_t t_us) {
+  uint64_t base = capture->header->base_time_us;
+  if (t_us <= base) {
+    return 0;
+  }
+  if (t_us - base > UINT32_MAX) {
+    return (uint64_t)UINT32_MAX + 1U;
+  }
+  return t_us - base;
+}
+
+size_t can_capture_lower_bound(const CanCapture* capture, uint64_t t_us) {
+  size_t count = can_capture_count(capture);
+  uint64_t offset = 0;
+  size_t lo = 0;
+  size_t hi = 0;
+
+  if (count == 0U) {
+    return 0;
+  }
+  offset = can_capture_offset_of(capture, t_us);
+
+  // 時刻インデックスで offset を含むブロックを探す
+  lo = 0;
+  hi = (size_t)capture->header->time_index_count;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2U;
+    if (capture->time_index[mid] < offset) {
+      lo = mid + 1U;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo == 0U) {
+    return 0;
+  }
+
+  // ブロック内を二分探索する
+  hi = lo * capture->header->time_index_stride;
+  lo = (lo - 1U) * capture->header->time_index_stride;
+  if (hi > count) {
+    hi = count;
+  }
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2U;
+    if (capture->records[mid].timestamp_us < offset) {
+      lo = mid + 1U;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+void can_capture_query(const CanCapture* capture, CanCaptureCursor* cursor,
+                       uint64_t t0_us, uint64_t t1_us) {
+  cursor->capture = capture;
+  cursor->postings = 0;
+  cursor->pos = can_capture_lower_bound(capture, t0_us);
+  cursor->end = t1_us <= t0_us ? cursor->pos
+                               : can_capture_lower_bound(capture, t1_us);
+}
+
+// レコード番号表の中で時刻が offset 以降の最初の位置
+static size_t can_capture_postings_lower_bound(const CanCapture* capture,
+                                               const uint32_t* postings,
+                                               size_t count, uint64_t offset) {
+  const size_t record_count = can_capture_count(capture);
+  size_t lo = 0;
+  size_t hi = count;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2U;
+    // 範囲外のレコード番号（壊れたファイル）は読まずに後ろ側とみなす
+    if (postings[mid] < record_count &&
+        capture->records[postings[mid]].timestamp_us < offset) {
+      lo = mid + 1U;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+bool can_capture_query_id(const CanCapture* capture, CanCaptureCursor* cursor,
+                          uint32_t id, uint64_t t0_us, uint64_t t1_us) {
+  size_t lo = 0;
+  size_t hi = capture->header == 0 ? 0U : (size_t)capture->header->id_count;
+  const CanCaptureIdEntry* entry = 0;
+
+  cursor->capture = capture;
+  cursor->postings = 0;
+  cursor->pos = 0;
+  cursor->end = 0;
+
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2U;
+    if (capture->ids[mid].id < id) {
+      lo = mid + 1U;
+    } else {
+      hi = mid;
+    }
+  }
+  if (capture->header == 0 || lo >= capture->header->id_count ||
+      capture->ids[lo].id != id) {
+    return false;
+  }
+
+  entry = &capture->ids[lo];
+  cursor->postings = capture->postings + entry->first;
+  cursor->pos = can_capture_postings_lower_bound(
+      capture, cursor->postings, entry->count,
+      can_capture_offset_of(capture, t0_us));
+  cursor->end = t1_us <= t0_us
+                    ? cursor->pos
+                    : can_capture_postings_lower_bound(
+                          capture, cursor->postings, entry->count,
+                          can_capture_offset_of(capture, t1_us));
+  return true;
+}
+
+const CanMessage* can_capture_next(CanCaptureCursor* cursor) {
+  const size_t count = can_capture_count(cursor->capture);
+  size_t index = 0;
+
+  while (cursor->pos < cursor->end) {
+    index =
+        cursor->postings == 0 ? cursor->pos : cursor->postings[cursor->pos];
+    cursor->pos++;
+    // 範囲外のレコード番号（壊れたファイル）は飛ばす
+    if (index < count) {
+      return &cursor->capture->records[index];
+    }
+  }
+  return 0;
+}
+
+size_t can_capture_cursor_remaining(const CanCaptureCursor* cursor) {
+  return cursor->end - cursor->pos;
+}
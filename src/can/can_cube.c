@@ -2,35 +2,286 @@
 
 #include <string.h>
 
-static bool can_cube_queue_push(CanCube* cube, const CanMessage* msg) {
-  if (cube->rx_count >= CAN_CUBE_RX_QUEUE_SIZE) {
+#include "profile/profile.h"
+
+// 1 フレームのビット数（SOF〜フレーム間スペース、スタッフビットを除く）
+static uint32_t can_cube_frame_bits(uint32_t id, uint8_t len) {
+  return (id > CAN_STD_ID_MAX ? 67U : 47U) + 8U * len;
+}
+
+static void can_cube_update_high_water(uint16_t* high_water,
+                                       const SpscRing* ring) {
+  uint32_t depth = spsc_ring_count(ring);
+  if (depth > *high_water) {
+    *high_water = (uint16_t)depth;
+  }
+}
+
+static bool can_cube_queue_pop(CanCube* cube, CanMessage* msg) {
+  uint32_t index = 0;
+  if (!spsc_ring_read_slot(&cube->rx_ring, &index)) {
+    return false;
+  }
+
+  *msg = cube->rx_queue[index];
+  spsc_ring_commit_read(&cube->rx_ring);
+  return true;
+}
+
+static size_t can_cube_queue_pop_batch(CanCube* cube, CanMessage* msgs,
+                                       size_t max_count) {
+  uint32_t count = spsc_ring_readable(&cube->rx_ring);
+  if (count > max_count) {
+    count = (uint32_t)max_count;
+  }
+
+  for (uint32_t i = 0; i < count; ++i) {
+    msgs[i] = cube->rx_queue[spsc_ring_read_index(&cube->rx_ring, i)];
+  }
+  spsc_ring_commit_read_n(&cube->rx_ring, count);
+  return count;
+}
+
+#if CAN_CUBE_FD_RX_QUEUE_SIZE > 0
+static bool can_cube_fd_queue_push(CanCube* cube, const CanFdMessage* msg) {
+  uint32_t index = 0;
+  if (!spsc_ring_write_slot(&cube->fd_rx_ring, &index)) {
     cube->rx_overflow_count++;
     return false;
   }
 
-  cube->rx_queue[cube->rx_head] = *msg;
-  cube->rx_head = (uint8_t)((cube->rx_head + 1U) % CAN_CUBE_RX_QUEUE_SIZE);
-  cube->rx_count++;
+  cube->fd_rx_queue[index] = *msg;
+  spsc_ring_commit_write(&cube->fd_rx_ring);
   return true;
 }
 
-static bool can_cube_queue_pop(CanCube* cube, CanMessage* msg) {
-  if (cube->rx_count == 0U) {
+static bool can_cube_fd_queue_pop(CanCube* cube, CanFdMessage* msg) {
+  uint32_t index = 0;
+  if (!spsc_ring_read_slot(&cube->fd_rx_ring, &index)) {
     return false;
   }
 
-  *msg = cube->rx_queue[cube->rx_tail];
-  cube->rx_tail = (uint8_t)((cube->rx_tail + 1U) % CAN_CUBE_RX_QUEUE_SIZE);
-  cube->rx_count--;
+  *msg = cube->fd_rx_queue[index];
+  spsc_ring_commit_read(&cube->fd_rx_ring);
   return true;
 }
+#endif
+
+static bool can_cube_hw_write(CanCube* cube, const CanMessage* msg) {
+  if (!cube->ops.write(cube->hal_context, msg)) {
+    return false;
+  }
+  cube->stats.tx_frames++;
+  cube->tx_bits += can_cube_frame_bits(msg->id, msg->len);
+  return true;
+}
+
+static bool can_cube_hw_write_fd(CanCube* cube, const CanFdMessage* msg) {
+  if (!cube->ops.write_fd(cube->hal_context, msg)) {
+    return false;
+  }
+  cube->stats.tx_frames++;
+  cube->tx_bits += can_cube_frame_bits(msg->id, msg->len);
+  return true;
+}
+
+static uint16_t can_cube_fd_tx_pending(const CanCube* cube) {
+#if CAN_CUBE_FD_TX_QUEUE_SIZE > 0
+  return cube->fd_tx_count;
+#else
+  (void)cube;
+  return 0;
+#endif
+}
+
+#if CAN_CUBE_FD_TX_QUEUE_SIZE > 0
+static bool can_cube_fd_tx_enqueue(CanCube* cube, const CanFdMessage* msg) {
+  uint16_t tail = 0;
+  uint16_t pending = 0;
+
+  if (cube->fd_tx_count >= CAN_CUBE_FD_TX_QUEUE_SIZE) {
+    return false;
+  }
+  tail = (uint16_t)((cube->fd_tx_head + cube->fd_tx_count) %
+                    CAN_CUBE_FD_TX_QUEUE_SIZE);
+  cube->fd_tx_queue[tail] = *msg;
+  cube->fd_tx_count++;
+  pending = (uint16_t)(cube->tx_count + cube->fd_tx_count);
+  if (pending > cube->stats.tx_queue_high_water) {
+    cube->stats.tx_queue_high_water = pending;
+  }
+  return true;
+}
+
+// FD 送信キューの先頭を、従来フレームの先頭より ID が小さければ送る
+// （0: 送る番ではない、1: 送った、-1: 送信バッファが一杯）
+static int can_cube_fd_tx_drain_one(CanCube* cube) {
+  const CanFdMessage* head = &cube->fd_tx_queue[cube->fd_tx_head];
+
+  if (cube->fd_tx_count == 0U ||
+      (cube->tx_count != 0U &&
+       cube->tx_queue[cube->tx_count - 1U].id <= head->id)) {
+    return 0;
+  }
+  if (!can_cube_hw_write_fd(cube, head)) {
+    return -1;
+  }
+  cube->fd_tx_head =
+      (uint16_t)((cube->fd_tx_head + 1U) % CAN_CUBE_FD_TX_QUEUE_SIZE);
+  cube->fd_tx_count--;
+  return 1;
+}
+#endif
+
+// 送信キューの優先度の高い順にハードウェアに積めるだけ積む
+static void can_cube_tx_drain(CanCube* cube) {
+  for (;;) {
+#if CAN_CUBE_FD_TX_QUEUE_SIZE > 0
+    const int fd = can_cube_fd_tx_drain_one(cube);
+    if (fd < 0) {
+      return;
+    }
+    if (fd > 0) {
+      continue;
+    }
+#endif
+    if (cube->tx_count == 0U ||
+        !can_cube_hw_write(cube, &cube->tx_queue[cube->tx_count - 1U])) {
+      return;
+    }
+    cube->tx_count--;
+  }
+}
+
+// msg より ID の大きい（優先度の低い）フレームの数 = 挿入位置
+// 同じ ID は後から積んだものほど先頭側に置き、積んだ順に送られる
+static uint16_t can_cube_tx_position(const CanCube* cube, uint32_t id) {
+  uint16_t pos = 0;
+  while (pos < cube->tx_count && cube->tx_queue[pos].id > id) {
+    pos++;
+  }
+  return pos;
+}
+
+// 送信キューに優先度順で積む
+static bool can_cube_tx_enqueue(CanCube* cube, const CanMessage* msg) {
+  uint16_t pos = can_cube_tx_position(cube, msg->id);
+
+  if ((msg->flags & CAN_MSG_FLAG_REPLACE) != 0U && pos < cube->tx_count &&
+      cube->tx_queue[pos].id == msg->id) {
+    cube->tx_queue[pos] = *msg;
+    return true;
+  }
+
+  if (cube->tx_count >= CAN_CUBE_TX_QUEUE_SIZE) {
+    cube->tx_overflow_count++;
+    if (pos == 0U) {
+      return false;
+    }
+    // 満杯でも優先度の高いフレームは最も優先度の低いフレームを押し出す
+    memmove(&cube->tx_queue[0], &cube->tx_queue[1],
+            (size_t)(pos - 1U) * sizeof(cube->tx_queue[0]));
+    cube->tx_queue[pos - 1U] = *msg;
+    return true;
+  }
+
+  memmove(&cube->tx_queue[pos + 1U], &cube->tx_queue[pos],
+          (size_t)(cube->tx_count - pos) * sizeof(cube->tx_queue[0]));
+  cube->tx_queue[pos] = *msg;
+  cube->tx_count++;
+  if (cube->tx_count > cube->stats.tx_queue_high_water) {
+    cube->stats.tx_queue_high_water = cube->tx_count;
+  }
+  return true;
+}
+
+// キューに先行フレームがなければ直接送信し、送れなければキューに積む
+static bool can_cube_tx_submit(CanCube* cube, const CanMessage* msg) {
+  if (cube->tx_count == 0U && can_cube_fd_tx_pending(cube) == 0U &&
+      can_cube_hw_write(cube, msg)) {
+    return true;
+  }
+  return can_cube_tx_enqueue(cube, msg);
+}
+
+static size_t can_cube_tx_write(CanCube* cube, const CanMessage* msgs,
+                                size_t count) {
+  size_t accepted = 0;
 
-static bool can_cube_bus_write_impl(void* self, const CanMessage* msg) {
-  CanCube* cube = (CanCube*)self;
   if (cube->ops.write == 0) {
+    return 0;
+  }
+
+  // 送信割り込みを使わない構成では従来どおりハードウェアへ直接書く
+  if (cube->ops.set_tx_notify == 0) {
+    while (accepted < count && can_cube_hw_write(cube, &msgs[accepted])) {
+      accepted++;
+    }
+  } else {
+    cube->ops.set_tx_notify(cube->hal_context, false);
+    can_cube_tx_drain(cube);
+    while (accepted < count && can_cube_tx_submit(cube, &msgs[accepted])) {
+      accepted++;
+    }
+    cube->ops.set_tx_notify(
+        cube->hal_context,
+        cube->tx_count != 0U || can_cube_fd_tx_pending(cube) != 0U);
+  }
+
+  if (accepted < count) {
+    cube->stats.tx_failures++;
+  }
+  return accepted;
+}
+
+static bool can_cube_tx_write_fd(CanCube* cube, const CanFdMessage* msg) {
+  CanMessage classic;
+  bool sent = false;
+
+  // 従来フレームで表せるものは送信キューを使う従来経路に流す
+  if (can_fd_message_to_classic(&classic, msg)) {
+    return can_cube_tx_write(cube, &classic, 1U) == 1U;
+  }
+  if (cube->ops.write_fd == 0) {
     return false;
   }
-  return cube->ops.write(cube->hal_context, msg);
+
+  if (cube->ops.set_tx_notify == 0) {
+    sent = can_cube_hw_write_fd(cube, msg);
+  } else {
+    // 先行フレームを追い越さないよう、キューが空のときだけ直接送る
+    cube->ops.set_tx_notify(cube->hal_context, false);
+    can_cube_tx_drain(cube);
+    sent = cube->tx_count == 0U && can_cube_fd_tx_pending(cube) == 0U &&
+           can_cube_hw_write_fd(cube, msg);
+#if CAN_CUBE_FD_TX_QUEUE_SIZE > 0
+    if (!sent) {
+      sent = can_cube_fd_tx_enqueue(cube, msg);
+    }
+#endif
+    if (!sent) {
+      cube->tx_overflow_count++;
+    }
+    cube->ops.set_tx_notify(
+        cube->hal_context,
+        cube->tx_count != 0U || can_cube_fd_tx_pending(cube) != 0U);
+  }
+
+  if (!sent) {
+    cube->stats.tx_failures++;
+  }
+  return sent;
+}
+
+static bool can_cube_bus_write_impl(void* self, const CanMessage* msg) {
+  CanCube* cube = (CanCube*)self;
+  return can_cube_tx_write(cube, msg, 1U) == 1U;
+}
+
+static size_t can_cube_bus_write_batch_impl(void* self, const CanMessage* msgs,
+                                            size_t count) {
+  CanCube* cube = (CanCube*)self;
+  return can_cube_tx_write(cube, msgs, count);
 }
 
 static bool can_cube_bus_read_impl(void* self, CanMessage* msg) {
@@ -38,6 +289,28 @@ static bool can_cube_bus_read_impl(void* self, CanMessage* msg) {
   return can_cube_queue_pop(cube, msg);
 }
 
+static size_t can_cube_bus_read_batch_impl(void* self, CanMessage* msgs,
+                                           size_t max_count) {
+  CanCube* cube = (CanCube*)self;
+  return can_cube_queue_pop_batch(cube, msgs, max_count);
+}
+
+static bool can_cube_bus_write_fd_impl(void* self, const CanFdMessage* msg) {
+  CanCube* cube = (CanCube*)self;
+  return can_cube_tx_write_fd(cube, msg);
+}
+
+static bool can_cube_bus_read_fd_impl(void* self, CanFdMessage* msg) {
+  CanCube* cube = (CanCube*)self;
+  return can_cube_poll_fd(cube, msg);
+}
+
+static bool can_cube_bus_get_stats_impl(void* self, CanBusStats* stats) {
+  CanCube* cube = (CanCube*)self;
+  can_cube_get_stats(cube, stats);
+  return true;
+}
+
 static void can_cube_bus_start_read_impl(void* self) {
   CanCube* cube = (CanCube*)self;
   if (cube->ops.start_read == 0) {
@@ -60,6 +333,10 @@ static void can_cube_bus_destroy_impl(void* self) {
 
 void can_cube_init(CanCube* cube, void* hal_context, const CanCubeOps* ops) {
   memset(cube, 0, sizeof(*cube));
+  spsc_ring_init(&cube->rx_ring, CAN_CUBE_RX_QUEUE_SIZE);
+#if CAN_CUBE_FD_RX_QUEUE_SIZE > 0
+  spsc_ring_init(&cube->fd_rx_ring, CAN_CUBE_FD_RX_QUEUE_SIZE);
+#endif
 
   cube->hal_context = hal_context;
   if (ops != 0) {
@@ -67,7 +344,12 @@ void can_cube_init(CanCube* cube, void* hal_context, const CanCubeOps* ops) {
   }
 
   cube->bus.write = can_cube_bus_write_impl;
+  cube->bus.write_batch = can_cube_bus_write_batch_impl;
   cube->bus.read = can_cube_bus_read_impl;
+  cube->bus.read_batch = can_cube_bus_read_batch_impl;
+  cube->bus.write_fd = can_cube_bus_write_fd_impl;
+  cube->bus.read_fd = can_cube_bus_read_fd_impl;
+  cube->bus.get_stats = can_cube_bus_get_stats_impl;
   cube->bus.start_read = can_cube_bus_start_read_impl;
   cube->bus.stop_read = can_cube_bus_stop_read_impl;
   cube->bus.destroy = can_cube_bus_destroy_impl;
@@ -82,14 +364,112 @@ void can_cube_set_rx_callback(CanCube* cube, CanRxCallback callback,
   cube->rx_callback_user_arg = user_arg;
 }
 
+void can_cube_set_rx_mode(CanCube* cube, CanCubeRxMode mode) {
+  cube->rx_mode = mode;
+}
+
+void can_cube_set_clock(CanCube* cube, CanClockFn clock, void* user_arg) {
+  cube->clock = clock;
+  cube->clock_user_arg = user_arg;
+}
+
+void can_cube_set_bitrate(CanCube* cube, uint32_t bitrate) {
+  cube->bitrate = bitrate;
+}
+
+static void can_cube_update_bus_load(CanCube* cube) {
+  uint32_t now = 0;
+  uint32_t bits = 0;
+  uint32_t elapsed_us = 0;
+
+  if (cube->clock == 0 || cube->bitrate == 0U) {
+    return;
+  }
+
+  now = cube->clock(cube->clock_user_arg);
+  bits = cube->rx_bits + cube->tx_bits;
+  elapsed_us = now - cube->load_last_time_us;
+  if (cube->load_window_started && elapsed_us == 0U) {
+    return;  // 同じ時刻の連続呼び出しでは前回の値を返す
+  }
+
+  if (cube->load_window_started) {
+    // bits / (elapsed [s] * bitrate) * 100
+    cube->stats.bus_load_percent = (float)(bits - cube->load_last_bits) *
+                                   1.0e8f /
+                                   ((float)elapsed_us * (float)cube->bitrate);
+  }
+  cube->load_last_bits = bits;
+  cube->load_last_time_us = now;
+  cube->load_window_started = true;
+}
+
+void can_cube_get_stats(CanCube* cube, CanBusStats* stats) {
+  bool was_bus_off = cube->stats.bus_off;
+
+  can_cube_update_bus_load(cube);
+  if (cube->ops.read_error_state != 0) {
+    cube->ops.read_error_state(cube->hal_context, &cube->stats);
+    if (cube->stats.bus_off && !was_bus_off) {
+      cube->stats.bus_off_count++;
+    }
+  }
+
+  *stats = cube->stats;
+  stats->rx_overflows = cube->rx_overflow_count;
+  stats->tx_overflows = cube->tx_overflow_count;
+}
+
 bool can_cube_poll(CanCube* cube, CanMessage* msg) {
   return can_cube_queue_pop(cube, msg);
 }
 
+size_t can_cube_poll_batch(CanCube* cube, CanMessage* msgs, size_t max_count) {
+  return can_cube_queue_pop_batch(cube, msgs, max_count);
+}
+
+bool can_cube_poll_fd(CanCube* cube, CanFdMessage* msg) {
+  CanMessage classic;
+
+#if CAN_CUBE_FD_RX_QUEUE_SIZE > 0
+  if (can_cube_fd_queue_pop(cube, msg)) {
+    return true;
+  }
+#endif
+  if (!can_cube_queue_pop(cube, &classic)) {
+    return false;
+  }
+  can_fd_message_from_classic(msg, &classic);
+  return true;
+}
+
 uint32_t can_cube_get_rx_overflow_count(const CanCube* cube) {
   return cube->rx_overflow_count;
 }
 
+uint32_t can_cube_get_tx_overflow_count(const CanCube* cube) {
+  return cube->tx_overflow_count;
+}
+
+uint32_t can_cube_get_tx_pending_count(const CanCube* cube) {
+  return (uint32_t)cube->tx_count + can_cube_fd_tx_pending(cube);
+}
+
+uint32_t can_cube_clear_tx(CanCube* cube) {
+  uint32_t dropped = 0;
+
+  if (cube->ops.set_tx_notify != 0) {
+    cube->ops.set_tx_notify(cube->hal_context, false);
+  }
+  dropped = can_cube_get_tx_pending_count(cube);
+  cube->tx_count = 0U;
+#if CAN_CUBE_FD_TX_QUEUE_SIZE > 0
+  cube->fd_tx_head = 0U;
+  cube->fd_tx_count = 0U;
+#endif
+  return dropped;
+}
+
 void can_cube_start_read(CanCube* cube) {
   if (cube->ops.start_read == 0) {
     return;
@@ -104,17 +484,146 @@ void can_cube_stop_read(CanCube* cube) {
   cube->ops.stop_read(cube->hal_context);
 }
 
-void can_cube_on_rx_pending(CanCube* cube) {
-  CanMessage msg;
+// 割り込み 1 回につき時計を 1 回だけ読み、未刻印のフレームに付ける
+static uint32_t can_cube_rx_now(CanCube* cube, bool* has_now) {
+  if (cube->clock == 0) {
+    *has_now = false;
+    return 0;
+  }
+  *has_now = true;
+  return cube->clock(cube->clock_user_arg);
+}
+
+static void can_cube_rx_count(CanCube* cube, uint32_t id, uint8_t len) {
+  cube->stats.rx_frames++;
+  cube->rx_bits += can_cube_frame_bits(id, len);
+}
+
+// 割り込み処理の所要時間を記録する（時計が無ければ何もしない）
+static void can_cube_rx_finish(CanCube* cube, bool has_now, uint32_t start) {
+  uint32_t elapsed = 0;
+
+  if (!has_now) {
+    return;
+  }
+  elapsed = cube->clock(cube->clock_user_arg) - start;
+  cube->stats.isr_count++;
+  cube->stats.isr_time_us += elapsed;
+  if (elapsed > cube->stats.isr_time_max_us) {
+    cube->stats.isr_time_max_us = elapsed;
+  }
+}
+
+static bool can_cube_rx_bypass(const CanCube* cube) {
+  return cube->rx_mode == CAN_CUBE_RX_CALLBACK_ONLY && cube->rx_callback != 0;
+}
+
+// 受信フレームの書き込み先を返す。キューに空きがあればそのスロット、
+// 無ければ（またはキューに積まない設定なら）scratch。
+static CanMessage* can_cube_rx_slot(CanCube* cube, CanMessage* scratch,
+                                    bool* queued) {
+  uint32_t index = 0;
+
+  *queued = !can_cube_rx_bypass(cube) &&
+            spsc_ring_write_slot(&cube->rx_ring, &index);
+  return *queued ? &cube->rx_queue[index] : scratch;
+}
+
+// スロットに書き込んだフレームを公開してコールバックに渡す。
+// 公開後もスロットを書き換えるのはこの割り込みだけなので、そのまま渡してよい。
+static void can_cube_rx_publish(CanCube* cube, const CanMessage* msg,
+                                bool queued) {
+  if (queued) {
+    spsc_ring_commit_write(&cube->rx_ring);
+    can_cube_update_high_water(&cube->stats.rx_queue_high_water,
+                               &cube->rx_ring);
+  } else if (!can_cube_rx_bypass(cube)) {
+    cube->rx_overflow_count++;
+  }
+  if (cube->rx_callback != 0) {
+    cube->rx_callback(msg, cube->rx_callback_user_arg);
+  }
+}
+
+#if CAN_CUBE_FD_RX_QUEUE_SIZE > 0
+static void can_cube_on_rx_pending_fd(CanCube* cube) {
+  CanFdMessage fd_msg;
+  CanMessage scratch;
+  bool has_now = false;
+  uint32_t now = can_cube_rx_now(cube, &has_now);
+
+  while (cube->ops.read_hw_fd(cube->hal_context, &fd_msg)) {
+    can_cube_rx_count(cube, fd_msg.id, fd_msg.len);
+    if (has_now && (fd_msg.flags & CAN_MSG_FLAG_TIMESTAMP) == 0U) {
+      fd_msg.flags |= CAN_MSG_FLAG_TIMESTAMP;
+      fd_msg.timestamp_us = now;
+    }
+    if ((fd_msg.flags & CAN_FD_FLAG_FDF) != 0U || fd_msg.len > 8U) {
+      can_cube_fd_queue_push(cube, &fd_msg);
+      continue;
+    }
+
+    bool queued = false;
+    CanMessage* msg = can_cube_rx_slot(cube, &scratch, &queued);
+    can_fd_message_to_classic(msg, &fd_msg);
+    can_cube_rx_publish(cube, msg, queued);
+  }
+  can_cube_rx_finish(cube, has_now, now);
+}
+#endif
+
+static void can_cube_rx_drain(CanCube* cube) {
+  CanMessage scratch;
+  bool has_now = false;
+  uint32_t now = 0;
 
+#if CAN_CUBE_FD_RX_QUEUE_SIZE > 0
+  if (cube->ops.read_hw_fd != 0) {
+    can_cube_on_rx_pending_fd(cube);
+    return;
+  }
+#endif
   if (cube->ops.read_hw == 0) {
     return;
   }
 
-  while (cube->ops.read_hw(cube->hal_context, &msg)) {
-    can_cube_queue_push(cube, &msg);
-    if (cube->rx_callback != 0) {
-      cube->rx_callback(&msg, cube->rx_callback_user_arg);
+  now = can_cube_rx_now(cube, &has_now);
+  for (;;) {
+    // HAL から受信キューのスロットへ直接読み込む
+    bool queued = false;
+    CanMessage* msg = can_cube_rx_slot(cube, &scratch, &queued);
+
+    // flags を設定しない read_hw 実装でも受信時刻の有無を誤らないよう毎回消す
+    msg->flags = 0;
+    if (!cube->ops.read_hw(cube->hal_context, msg)) {
+      break;
     }
+    can_cube_rx_count(cube, msg->id, msg->len);
+    if (has_now && (msg->flags & CAN_MSG_FLAG_TIMESTAMP) == 0U) {
+      msg->flags |= CAN_MSG_FLAG_TIMESTAMP;
+      msg->timestamp_us = now;
+    }
+    can_cube_rx_publish(cube, msg, queued);
+  }
+  can_cube_rx_finish(cube, has_now, now);
+}
+
+void can_cube_on_rx_pending(CanCube* cube) {
+  OM_PROFILE_BEGIN(profile_start);
+  can_cube_rx_drain(cube);
+  OM_PROFILE_END(OM_PROFILE_CAN_CUBE_RX, profile_start);
+}
+
+void can_cube_on_tx_ready(CanCube* cube) {
+  if (cube->ops.write == 0) {
+    return;
+  }
+
+  OM_PROFILE_BEGIN(profile_start);
+  can_cube_tx_drain(cube);
+  if (cube->ops.set_tx_notify != 0 && cube->tx_count == 0U &&
+      can_cube_fd_tx_pending(cube) == 0U) {
+    cube->ops.set_tx_notify(cube->hal_context, false);
   }
+  OM_PROFILE_END(OM_PROFILE_CAN_CUBE_TX, profile_start);
 }
@@ -0,0 +1,218 @@
+#include "can/can_dispatch.h"
+
+#include <string.h>
+
+#include "profile/profile.h"
+
+_Static_assert((CAN_DISPATCH_TABLE_SIZE & (CAN_DISPATCH_TABLE_SIZE - 1)) == 0,
+               "CAN_DISPATCH_TABLE_SIZE must be a power of two");
+_Static_assert(CAN_DISPATCH_MAX_RULES < 255,
+               "CAN_DISPATCH_MAX_RULES must fit in CanDispatchSlot::rule");
+
+// テーブルの使用率を 3/4 までに抑えて探索長を短く保つ
+#define CAN_DISPATCH_TABLE_LIMIT (CAN_DISPATCH_TABLE_SIZE * 3 / 4)
+
+
+static uint32_t can_dispatch_hash(uint32_t id) {
+  // フィボナッチハッシュ（連続 ID をテーブル全体に散らす）
+  return (id * 2654435761U) >> 16;
+}
+
+static const CanDispatchSlot* can_dispatch_find_slot(
+    const CanDispatcher* dispatcher, uint32_t id) {
+  uint32_t index = can_dispatch_hash(id);
+
+  for (uint32_t i = 0; i < CAN_DISPATCH_TABLE_SIZE; ++i) {
+    const CanDispatchSlot* slot =
+        &dispatcher->table[(index + i) & (CAN_DISPATCH_TABLE_SIZE - 1)];
+    if (slot->rule == 0U) {
+      return 0;
+    }
+    if (slot->id == id) {
+      return slot;
+    }
+  }
+  return 0;
+}
+
+static void can_dispatch_insert(CanDispatcher* dispatcher, uint32_t id,
+                                uint8_t rule) {
+  uint32_t index = can_dispatch_hash(id);
+
+  for (uint32_t i = 0; i < CAN_DISPATCH_TABLE_SIZE; ++i) {
+    CanDispatchSlot* slot =
+        &dispatcher->table[(index + i) & (CAN_DISPATCH_TABLE_SIZE - 1)];
+    if (slot->rule == 0U) {
+      slot->id = id;
+      slot->rule = rule;
+      dispatcher->table_count++;
+      return;
+    }
+  }
+}
+
+static CanDispatchRule* can_dispatch_new_rule(CanDispatcher* dispatcher,
+                                              CanRxCallback callback,
+                                              void* user_arg) {
+  CanDispatchRule* rule = 0;
+
+  if (callback == 0 || dispatcher->rule_count >= CAN_DISPATCH_MAX_RULES) {
+    return 0;
+  }
+
+  rule = &dispatcher->rules[dispatcher->rule_count];
+  memset(rule, 0, sizeof(*rule));
+  rule->callback = callback;
+  rule->user_arg = user_arg;
+  return rule;
+}
+
+void can_dispatcher_init(CanDispatcher* dispatcher) {
+  memset(dispatcher, 0, sizeof(*dispatcher));
+}
+
+bool can_dispatcher_add_id(CanDispatcher* dispatcher, uint32_t id,
+                           CanRxCallback callback, void* user_arg) {
+  return can_dispatcher_add_range(dispatcher, id, id, callback, user_arg);
+}
+
+bool can_dispatcher_add_range(CanDispatcher* dispatcher, uint32_t first_id,
+                              uint32_t last_id, CanRxCallback callback,
+                              void* user_arg) {
+  CanDispatchRule* rule = 0;
+
+  if (first_id > last_id || last_id > CAN_EXT_ID_MAX ||
+      last_id - first_id >=
+          (uint32_t)(CAN_DISPATCH_TABLE_LIMIT - dispatcher->table_count)) {
+    return false;
+  }
+  for (uint32_t id = first_id; id <= last_id; ++id) {
+    if (can_dispatch_find_slot(dispatcher, id) != 0) {
+      return false;
+    }
+  }
+
+  rule = can_dispatch_new_rule(dispatcher, callback, user_arg);
+  if (rule == 0) {
+    return false;
+  }
+  rule->kind = CAN_DISPATCH_RULE_RANGE;
+  rule->id = first_id;
+  rule->id_last = last_id;
+  dispatcher->rule_count++;
+
+  for (uint32_t id = first_id; id <= last_id; ++id) {
+    can_dispatch_insert(dispatcher, id, dispatcher->rule_count);
+  }
+  return true;
+}
+
+bool can_dispatcher_add_mask(CanDispatcher* dispatcher, uint32_t id,
+                             uint32_t mask, CanRxCallback callback,
+                             void* user_arg) {
+  CanDispatchRule* rule = can_dispatch_new_rule(dispatcher, callback, user_arg);
+  if (rule == 0) {
+    return false;
+  }
+
+  rule->kind = CAN_DISPATCH_RULE_MASK;
+  rule->id = id & mask;
+  rule->mask = mask;
+  dispatcher->rule_count++;
+  return true;
+}
+
+void can_dispatcher_set_default(CanDispatcher* dispatcher,
+                                CanRxCallback callback, void* user_arg) {
+  dispatcher->default_callback = callback;
+  dispatcher->default_user_arg = user_arg;
+}
+
+bool can_dispatcher_dispatch(CanDispatcher* dispatcher, const CanMessage* msg) {
+  const CanDispatchSlot* slot = 0;
+
+  if (msg == 0) {
+    return false;
+  }
+
+  slot = can_dispatch_find_slot(dispatcher, msg->id);
+  if (slot != 0) {
+    const CanDispatchRule* rule = &dispatcher->rules[slot->rule - 1U];
+    rule->callback(msg, rule->user_arg);
+    return true;
+  }
+
+  for (uint8_t i = 0; i < dispatcher->rule_count; ++i) {
+    const CanDispatchRule* rule = &dispatcher->rules[i];
+    if (rule->kind == CAN_DISPATCH_RULE_MASK &&
+        (msg->id & rule->mask) == rule->id) {
+      rule->callback(msg, rule->user_arg);
+      return true;
+    }
+  }
+
+  dispatcher->unmatched_count++;
+  if (dispatcher->default_callback != 0) {
+    dispatcher->default_callback(msg, dispatcher->default_user_arg);
+  }
+  return false;
+}
+
+size_t can_dispatcher_poll(CanDispatcher* dispatcher, CanBus* bus) {
+  CanMessage msgs[CAN_DISPATCH_POLL_BATCH_SIZE];
+  size_t count = 0;
+  size_t total = 0;
+  OM_PROFILE_BEGIN(profile_start);
+
+  do {
+    count = can_bus_read_batch(bus, msgs, CAN_DISPATCH_POLL_BATCH_SIZE);
+    for (size_t i = 0; i < count; ++i) {
+      can_dispatcher_dispatch(dispatcher, &msgs[i]);
+    }
+    total += count;
+  } while (count == CAN_DISPATCH_POLL_BATCH_SIZE);
+  OM_PROFILE_END(OM_PROFILE_CAN_DISPATCH, profile_start);
+  return total;
+}
+
+uint32_t can_dispatcher_get_unmatched_count(const CanDispatcher* dispatcher) {
+  return dispatcher->unmatched_count;
+}
+
+static CanFilter can_dispatch_rule_filter(const CanDispatchRule* rule) {
+  CanFilter filter;
+
+  if (rule->kind == CAN_DISPATCH_RULE_MASK) {
+    filter.id = rule->id;
+    filter.mask = rule->mask;
+  } else {
+    // first〜last で変化しうるビットをマスクから外す
+    uint32_t diff = rule->id ^ rule->id_last;
+    uint32_t spread = 0;
+    while (diff != 0U) {
+      spread = (spread << 1) | 1U;
+      diff >>= 1;
+    }
+    filter.mask = ~spread;
+    filter.id = rule->id & filter.mask;
+  }
+
+  if (rule->id_last > CAN_STD_ID_MAX || filter.id > CAN_STD_ID_MAX) {
+    filter.mask &= CAN_EXT_ID_MAX;
+  } else {
+    filter.mask &= CAN_STD_ID_MAX;
+  }
+  return filter;
+}
+
+size_t can_dispatcher_get_filters(const CanDispatcher* dispatcher,
+                                  CanFilter* filters, size_t max_count) {
+  if (dispatcher->default_callback != 0) {
+    return 0;
+  }
+
+  for (uint8_t i = 0; i < dispatcher->rule_count && i < max_count; ++i) {
+    filters[i] = can_dispatch_rule_filter(&dispatcher->rules[i]);
+  }
+  return dispatcher->rule_count;
+}
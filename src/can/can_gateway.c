@@ -0,0 +1,158 @@
+#include "can/can_gateway.h"
+
+#include <string.h>
+
+_Static_assert(CAN_GATEWAY_BATCH_SIZE <= 255,
+               "CAN_GATEWAY_BATCH_SIZE must fit in CanGateway::tx_count");
+
+static size_t can_gateway_flush(CanGateway* gateway, uint8_t dst) {
+  CanGatewayPort* port = &gateway->ports[dst];
+  const size_t count = gateway->tx_count[dst];
+
+  if (count == 0U) {
+    return 0;
+  }
+  const size_t sent =
+      can_bus_write_batch(port->bus, gateway->tx_batch[dst], count);
+  port->forwarded += (uint32_t)sent;
+  port->tx_dropped += (uint32_t)(count - sent);
+  gateway->tx_count[dst] = 0U;
+  return sent;
+}
+
+static bool can_gateway_match(const CanGatewayRoute* route, uint8_t src_bus,
+                              uint32_t id) {
+  return route->src_bus == src_bus && (id & route->mask) == route->id;
+}
+
+void can_gateway_init(CanGateway* gateway) {
+  memset(gateway, 0, sizeof(*gateway));
+}
+
+int can_gateway_add_bus(CanGateway* gateway, CanBus* bus,
+                        CanRxCallback local_callback, void* user_arg) {
+  if (bus == 0 || gateway->port_count >= CAN_GATEWAY_MAX_BUSES) {
+    return -1;
+  }
+
+  CanGatewayPort* port = &gateway->ports[gateway->port_count];
+  memset(port, 0, sizeof(*port));
+  port->bus = bus;
+  port->local_callback = local_callback;
+  port->local_user_arg = user_arg;
+  return gateway->port_count++;
+}
+
+bool can_gateway_add_route(CanGateway* gateway, uint8_t src_bus, uint32_t id,
+                           uint32_t mask, uint8_t dst_bus) {
+  return can_gateway_add_route_rewrite(gateway, src_bus, id, mask, dst_bus, 0U,
+                                       0U);
+}
+
+bool can_gateway_add_route_rewrite(CanGateway* gateway, uint8_t src_bus,
+                                   uint32_t id, uint32_t mask, uint8_t dst_bus,
+                                   uint32_t rewrite_id, uint32_t rewrite_mask) {
+  if (src_bus >= gateway->port_count || dst_bus >= gateway->port_count ||
+      src_bus == dst_bus || gateway->route_count >= CAN_GATEWAY_MAX_ROUTES) {
+    return false;
+  }
+
+  CanGatewayRoute* route = &gateway->routes[gateway->route_count++];
+  route->src_bus = src_bus;
+  route->dst_bus = dst_bus;
+  route->id = id & mask;
+  route->mask = mask;
+  route->rewrite_id = rewrite_id & rewrite_mask;
+  route->rewrite_mask = rewrite_mask;
+  return true;
+}
+
+size_t can_gateway_forward(CanGateway* gateway, uint8_t src_bus,
+                           const CanMessage* msgs, size_t count) {
+  size_t forwarded = 0;
+
+  if (src_bus >= gateway->port_count) {
+    return 0;
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    const CanMessage* msg = &msgs[i];
+    bool routed = false;
+
+    for (uint8_t r = 0; r < gateway->route_count; ++r) {
+      const CanGatewayRoute* route = &gateway->routes[r];
+      if (!can_gateway_match(route, src_bus, msg->id)) {
+        continue;
+      }
+      routed = true;
+
+      const uint8_t dst = route->dst_bus;
+      CanMessage* out = &gateway->tx_batch[dst][gateway->tx_count[dst]];
+      *out = *msg;
+      out->flags = 0U;
+      out->timestamp_us = 0U;
+      if (route->rewrite_mask != 0U) {
+        out->id = ((msg->id & ~route->rewrite_mask) | route->rewrite_id) &
+                  CAN_EXT_ID_MAX;
+      }
+      if (++gateway->tx_count[dst] == CAN_GATEWAY_BATCH_SIZE) {
+        forwarded += can_gateway_flush(gateway, dst);
+      }
+    }
+    if (!routed) {
+      gateway->ports[src_bus].unrouted++;
+    }
+  }
+
+  for (uint8_t i = 0; i < gateway->port_count; ++i) {
+    forwarded += can_gateway_flush(gateway, i);
+  }
+  return forwarded;
+}
+
+size_t can_gateway_poll(CanGateway* gateway) {
+  CanMessage msgs[CAN_GATEWAY_BATCH_SIZE];
+  size_t total = 0;
+
+  for (uint8_t i = 0; i < gateway->port_count; ++i) {
+    CanGatewayPort* port = &gateway->ports[i];
+    size_t count = 0;
+
+    do {
+      count = can_bus_read_batch(port->bus, msgs, CAN_GATEWAY_BATCH_SIZE);
+      port->rx_frames += (uint32_t)count;
+      if (port->local_callback != 0) {
+        for (size_t j = 0; j < count; ++j) {
+          port->local_callback(&msgs[j], port->local_user_arg);
+        }
+      }
+      can_gateway_forward(gateway, i, msgs, count);
+      total += count;
+    } while (count == CAN_GATEWAY_BATCH_SIZE);
+  }
+  return total;
+}
+
+size_t can_gateway_get_filters(const CanGateway* gateway, uint8_t bus,
+                               CanFilter* filters, size_t max_count) {
+  size_t count = 0;
+
+  if (bus >= gateway->port_count ||
+      gateway->ports[bus].local_callback != 0) {
+    return 0;
+  }
+  for (uint8_t r = 0; r < gateway->route_count; ++r) {
+    const CanGatewayRoute* route = &gateway->routes[r];
+    if (route->src_bus != bus) {
+      continue;
+    }
+    if (count < max_count) {
+      filters[count].id = route->id;
+      filters[count].mask = route->id > CAN_STD_ID_MAX
+                                ? route->mask & CAN_EXT_ID_MAX
+                                : route->mask & CAN_STD_ID_MAX;
+    }
+    ++count;
+  }
+  return count;
+}
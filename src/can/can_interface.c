@@ -1,5 +1,7 @@
 #include "can/can_interface.h"
 
+#include <string.h>
+
 bool can_bus_write(CanBus* bus, const CanMessage* msg) {
   if (bus == 0 || bus->write == 0) {
     return false;
@@ -7,6 +9,25 @@ bool can_bus_write(CanBus* bus, const CanMessage* msg) {
   return bus->write(bus->impl, msg);
 }
 
+size_t can_bus_write_batch(CanBus* bus, const CanMessage* msgs, size_t count) {
+  size_t sent = 0;
+
+  if (bus == 0 || msgs == 0) {
+    return 0;
+  }
+  if (bus->write_batch != 0) {
+    return bus->write_batch(bus->impl, msgs, count);
+  }
+  if (bus->write == 0) {
+    return 0;
+  }
+
+  while (sent < count && bus->write(bus->impl, &msgs[sent])) {
+    sent++;
+  }
+  return sent;
+}
+
 bool can_bus_read(CanBus* bus, CanMessage* msg) {
   if (bus == 0 || bus->read == 0) {
     return false;
@@ -14,6 +35,116 @@ bool can_bus_read(CanBus* bus, CanMessage* msg) {
   return bus->read(bus->impl, msg);
 }
 
+size_t can_bus_read_batch(CanBus* bus, CanMessage* msgs, size_t max_count) {
+  size_t count = 0;
+
+  if (bus == 0 || msgs == 0) {
+    return 0;
+  }
+  if (bus->read_batch != 0) {
+    return bus->read_batch(bus->impl, msgs, max_count);
+  }
+  if (bus->read == 0) {
+    return 0;
+  }
+
+  while (count < max_count && bus->read(bus->impl, &msgs[count])) {
+    count++;
+  }
+  return count;
+}
+
+bool can_bus_write_fd(CanBus* bus, const CanFdMessage* msg) {
+  CanMessage classic;
+
+  if (bus == 0 || msg == 0) {
+    return false;
+  }
+  if (bus->write_fd != 0) {
+    return bus->write_fd(bus->impl, msg);
+  }
+  if (bus->write == 0 || !can_fd_message_to_classic(&classic, msg)) {
+    return false;
+  }
+  return bus->write(bus->impl, &classic);
+}
+
+bool can_bus_read_fd(CanBus* bus, CanFdMessage* msg) {
+  CanMessage classic;
+
+  if (bus == 0 || msg == 0) {
+    return false;
+  }
+  if (bus->read_fd != 0) {
+    return bus->read_fd(bus->impl, msg);
+  }
+  if (bus->read == 0 || !bus->read(bus->impl, &classic)) {
+    return false;
+  }
+  can_fd_message_from_classic(msg, &classic);
+  return true;
+}
+
+static const uint8_t can_fd_dlc_lengths[16] = {0,  1,  2,  3,  4,  5,  6,  7,
+                                               8,  12, 16, 20, 24, 32, 48, 64};
+
+uint8_t can_fd_len_to_dlc(uint8_t len) {
+  uint8_t dlc = 0;
+
+  if (len <= 8U) {
+    return len;
+  }
+  for (dlc = 9; dlc < 15U; ++dlc) {
+    if (len <= can_fd_dlc_lengths[dlc]) {
+      return dlc;
+    }
+  }
+  return 15;
+}
+
+uint8_t can_fd_dlc_to_len(uint8_t dlc) {
+  return can_fd_dlc_lengths[dlc & 0x0FU];
+}
+
+uint8_t can_fd_round_len(uint8_t len) {
+  return can_fd_dlc_to_len(can_fd_len_to_dlc(len));
+}
+
+void can_fd_message_from_classic(CanFdMessage* dst, const CanMessage* src) {
+  uint8_t len = src->len > 8U ? 8U : src->len;
+
+  dst->id = src->id;
+  dst->len = len;
+  dst->flags = src->flags & CAN_MSG_FLAG_TIMESTAMP;
+  dst->timestamp_us = src->timestamp_us;
+  memcpy(dst->data, src->data, len);
+}
+
+bool can_fd_message_to_classic(CanMessage* dst, const CanFdMessage* src) {
+  if ((src->flags & CAN_FD_FLAG_FDF) != 0U || src->len > 8U) {
+    return false;
+  }
+
+  memset(dst, 0, sizeof(*dst));
+  dst->id = src->id;
+  dst->len = src->len;
+  dst->flags = src->flags & CAN_MSG_FLAG_TIMESTAMP;
+  dst->timestamp_us = src->timestamp_us;
+  memcpy(dst->data, src->data, src->len);
+  return true;
+}
+
+bool can_bus_get_stats(CanBus* bus, CanBusStats* stats) {
+  if (stats == 0) {
+    return false;
+  }
+  memset(stats, 0, sizeof(*stats));
+  if (bus == 0 || bus->get_stats == 0) {
+    return false;
+  }
+  return bus->get_stats(bus->impl, stats);
+}
+
 void can_bus_start_read(CanBus* bus) {
   if (bus == 0 || bus->start_read == 0) {
     return;
@@ -0,0 +1,606 @@
+#include "can/can_log.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define CAN_LOG_INFO_LEN_MASK 0x0FU
+#define CAN_LOG_INFO_EXT 0x10U
+#define CAN_LOG_INFO_TX 0x20U
+
+// --- レコードの符号化 ---
+
+static size_t can_log_put_varint(uint8_t* out, uint64_t value) {
+  size_t n = 0;
+  while (value >= 0x80U) {
+    out[n++] = (uint8_t)(value | 0x80U);
+    value >>= 7;
+  }
+  out[n++] = (uint8_t)value;
+  return n;
+}
+
+static size_t can_log_encode(uint8_t* out, uint64_t* last_time_us,
+                             const CanLogRecord* record) {
+  const CanMessage* msg = &record->msg;
+  int64_t delta = (int64_t)(record->time_us - *last_time_us);
+  uint64_t zigzag = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+  uint8_t len = msg->len > 8U ? 8U : msg->len;
+  uint8_t info = len;
+  size_t n = can_log_put_varint(out, zigzag);
+
+  if (msg->id > CAN_STD_ID_MAX) {
+    info |= CAN_LOG_INFO_EXT;
+  }
+  if (record->tx) {
+    info |= CAN_LOG_INFO_TX;
+  }
+  out[n++] = info;
+  out[n++] = (uint8_t)msg->id;
+  out[n++] = (uint8_t)(msg->id >> 8);
+  if ((info & CAN_LOG_INFO_EXT) != 0U) {
+    out[n++] = (uint8_t)(msg->id >> 16);
+    out[n++] = (uint8_t)(msg->id >> 24);
+  }
+  memcpy(&out[n], msg->data, len);
+  *last_time_us = record->time_us;
+  return n + len;
+}
+
+// 復号できたバイト数を返す（途中で切れている場合は 0）
+static size_t can_log_decode(const uint8_t* in, size_t size,
+                             uint64_t* last_time_us, CanLogRecord* record) {
+  uint64_t zigzag = 0;
+  size_t n = 0;
+  unsigned shift = 0;
+  uint8_t info = 0;
+  uint8_t len = 0;
+  int64_t delta = 0;
+
+  for (;;) {
+    if (n >= size || shift > 63U) {
+      return 0;
+    }
+    zigzag |= (uint64_t)(in[n] & 0x7FU) << shift;
+    shift += 7U;
+    if ((in[n++] & 0x80U) == 0U) {
+      break;
+    }
+  }
+  if (n >= size) {
+    return 0;
+  }
+  info = in[n++];
+  len = info & CAN_LOG_INFO_LEN_MASK;
+  if (len > 8U ||
+      n + ((info & CAN_LOG_INFO_EXT) != 0U ? 4U : 2U) + len > size) {
+    return 0;
+  }
+
+  memset(record, 0, sizeof(*record));
+  record->msg.id = (uint32_t)in[n] | ((uint32_t)in[n + 1U] << 8);
+  n += 2U;
+  if ((info & CAN_LOG_INFO_EXT) != 0U) {
+    record->msg.id |= ((uint32_t)in[n] << 16) | ((uint32_t)in[n + 1U] << 24);
+    n += 2U;
+  }
+  record->msg.len = len;
+  memcpy(record->msg.data, &in[n], len);
+  n += len;
+
+  delta = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1U);
+  record->time_us = *last_time_us + (uint64_t)delta;
+  record->tx = (info & CAN_LOG_INFO_TX) != 0U;
+  record->msg.flags = CAN_MSG_FLAG_TIMESTAMP;
+  record->msg.timestamp_us = (uint32_t)record->time_us;
+  *last_time_us = record->time_us;
+  return n;
+}
+
+// --- ライタ ---
+
+void can_log_writer_init(CanLogWriter* writer, CanLogSinkFn sink,
+                         void* user_arg) {
+  memset(writer, 0, sizeof(*writer));
+  writer->sink = sink;
+  writer->sink_user_arg = user_arg;
+
+  memcpy(writer->buffer, CAN_LOG_MAGIC, 4U);
+  writer->buffer[4] = CAN_LOG_VERSION;
+  writer->used = CAN_LOG_HEADER_SIZE;
+}
+
+bool can_log_writer_flush(CanLogWriter* writer) {
+  if (writer->error) {
+    return false;
+  }
+  if (writer->used == 0U) {
+    return true;
+  }
+  if (writer->sink == 0 ||
+      writer->sink(writer->sink_user_arg, writer->buffer, writer->used) !=
+          writer->used) {
+    writer->error = true;
+    return false;
+  }
+  writer->used = 0;
+  return true;
+}
+
+bool can_log_writer_append(CanLogWriter* writer, const CanLogRecord* record) {
+  if (!writer->error &&
+      writer->used + CAN_LOG_MAX_RECORD_SIZE > CAN_LOG_BUFFER_SIZE) {
+    can_log_writer_flush(writer);
+  }
+  if (writer->error) {
+    writer->dropped_count++;
+    return false;
+  }
+  writer->used += can_log_encode(&writer->buffer[writer->used],
+                                 &writer->last_time_us, record);
+  writer->record_count++;
+  return true;
+}
+
+// --- リーダ ---
+
+void can_log_reader_init(CanLogReader* reader, CanLogSourceFn source,
+                         void* user_arg) {
+  memset(reader, 0, sizeof(*reader));
+  reader->source = source;
+  reader->source_user_arg = user_arg;
+}
+
+// 1 レコード分以上のデータがバッファに揃うよう読み足す
+static void can_log_reader_fill(CanLogReader* reader) {
+  while (!reader->eof && reader->len - reader->pos < CAN_LOG_MAX_RECORD_SIZE) {
+    size_t n = 0;
+    if (reader->pos != 0U) {
+      memmove(reader->buffer, &reader->buffer[reader->pos],
+              reader->len - reader->pos);
+      reader->len -= reader->pos;
+      reader->pos = 0;
+    }
+    n = reader->source == 0
+            ? 0U
+            : reader->source(reader->source_user_arg,
+                             &reader->buffer[reader->len],
+                             CAN_LOG_BUFFER_SIZE - reader->len);
+    if (n == 0U) {
+      reader->eof = true;
+    }
+    reader->len += n;
+  }
+}
+
+bool can_log_reader_next(CanLogReader* reader, CanLogRecord* record) {
+  size_t n = 0;
+
+  if (reader->error) {
+    return false;
+  }
+  can_log_reader_fill(reader);
+
+  if (!reader->header_checked) {
+    if (reader->len - reader->pos < CAN_LOG_HEADER_SIZE ||
+        memcmp(&reader->buffer[reader->pos], CAN_LOG_MAGIC, 4U) != 0 ||
+        reader->buffer[reader->pos + 4U] != CAN_LOG_VERSION) {
+      reader->error = true;
+      return false;
+    }
+    reader->pos += CAN_LOG_HEADER_SIZE;
+    reader->header_checked = true;
+    can_log_reader_fill(reader);
+  }
+
+  if (reader->pos == reader->len) {
+    return false;
+  }
+  n = can_log_decode(&reader->buffer[reader->pos], reader->len - reader->pos,
+                     &reader->last_time_us, record);
+  if (n == 0U) {
+    reader->error = true;
+    return false;
+  }
+  reader->pos += n;
+  return true;
+}
+
+bool can_log_reader_has_error(const CanLogReader* reader) {
+  return reader->error;
+}
+
+// --- 書き込み先/読み込み元 ---
+
+void can_log_memory_init(CanLogMemory* memory, uint8_t* data, size_t size) {
+  memory->data = data;
+  memory->size = size;
+  memory->pos = 0;
+}
+
+size_t can_log_memory_sink(void* user_arg, const uint8_t* data, size_t size) {
+  CanLogMemory* memory = (CanLogMemory*)user_arg;
+  size_t n = memory->size - memory->pos;
+  if (n > size) {
+    n = size;
+  }
+  memcpy(&memory->data[memory->pos], data, n);
+  memory->pos += n;
+  return n;
+}
+
+size_t can_log_memory_source(void* user_arg, uint8_t* data, size_t size) {
+  CanLogMemory* memory = (CanLogMemory*)user_arg;
+  size_t n = memory->size - memory->pos;
+  if (n > size) {
+    n = size;
+  }
+  memcpy(data, &memory->data[memory->pos], n);
+  memory->pos += n;
+  return n;
+}
+
+size_t can_log_file_sink(void* user_arg, const uint8_t* data, size_t size) {
+  return fwrite(data, 1U, size, (FILE*)user_arg);
+}
+
+size_t can_log_file_source(void* user_arg, uint8_t* data, size_t size) {
+  return fread(data, 1U, size, (FILE*)user_arg);
+}
+
+// --- レコーダ ---
+
+static uint64_t can_log_recorder_time(CanLogRecorder* recorder,
+                                      const CanMessage* msg) {
+  uint32_t raw = 0;
+  int32_t delta = 0;
+
+  if ((msg->flags & CAN_MSG_FLAG_TIMESTAMP) != 0U) {
+    raw = msg->timestamp_us;
+  } else if (recorder->clock != 0) {
+    raw = recorder->clock(recorder->clock_user_arg);
+  } else {
+    return recorder->time_us;
+  }
+
+  // 受信時刻と時計の値は前後しうるため符号付きの差で伸ばす
+  if (!recorder->time_started) {
+    recorder->time_us = raw;
+    recorder->time_started = true;
+  } else {
+    delta = (int32_t)(raw - recorder->last_raw_us);
+    recorder->time_us += (uint64_t)(int64_t)delta;
+  }
+  recorder->last_raw_us = raw;
+  return recorder->time_us;
+}
+
+static void can_log_recorder_append(CanLogRecorder* recorder,
+                                    const CanMessage* msg, bool tx) {
+  CanLogRecord record;
+  record.msg = *msg;
+  record.time_us = can_log_recorder_time(recorder, msg);
+  record.tx = tx;
+  can_log_writer_append(recorder->writer, &record);
+}
+
+static bool can_log_recorder_write_impl(void* self, const CanMessage* msg) {
+  CanLogRecorder* recorder = (CanLogRecorder*)self;
+  if (!can_bus_write(recorder->inner, msg)) {
+    return false;
+  }
+  can_log_recorder_append(recorder, msg, true);
+  return true;
+}
+
+static size_t can_log_recorder_write_batch_impl(void* self,
+                                                const CanMessage* msgs,
+                                                size_t count) {
+  CanLogRecorder* recorder = (CanLogRecorder*)self;
+  size_t sent = can_bus_write_batch(recorder->inner, msgs, count);
+  for (size_t i = 0; i < sent; ++i) {
+    can_log_recorder_append(recorder, &msgs[i], true);
+  }
+  return sent;
+}
+
+static bool can_log_recorder_read_impl(void* self, CanMessage* msg) {
+  CanLogRecorder* recorder = (CanLogRecorder*)self;
+  if (!can_bus_read(recorder->inner, msg)) {
+    return false;
+  }
+  can_log_recorder_append(recorder, msg, false);
+  return true;
+}
+
+static size_t can_log_recorder_read_batch_impl(void* self, CanMessage* msgs,
+                                               size_t max_count) {
+  CanLogRecorder* recorder = (CanLogRecorder*)self;
+  size_t count = can_bus_read_batch(recorder->inner, msgs, max_count);
+  for (size_t i = 0; i < count; ++i) {
+    can_log_recorder_append(recorder, &msgs[i], false);
+  }
+  return count;
+}
+
+static bool can_log_recorder_write_fd_impl(void* self,
+                                           const CanFdMessage* msg) {
+  CanLogRecorder* recorder = (CanLogRecorder*)self;
+  return can_bus_write_fd(recorder->inner, msg);
+}
+
+static bool can_log_recorder_read_fd_impl(void* self, CanFdMessage* msg) {
+  CanLogRecorder* recorder = (CanLogRecorder*)self;
+  return can_bus_read_fd(recorder->inner, msg);
+}
+
+static bool can_log_recorder_get_stats_impl(void* self, CanBusStats* stats) {
+  CanLogRecorder* recorder = (CanLogRecorder*)self;
+  return can_bus_get_stats(recorder->inner, stats);
+}
+
+static void can_log_recorder_start_read_impl(void* self) {
+  CanLogRecorder* recorder = (CanLogRecorder*)self;
+  can_bus_start_read(recorder->inner);
+}
+
+static void can_log_recorder_stop_read_impl(void* self) {
+  CanLogRecorder* recorder = (CanLogRecorder*)self;
+  can_bus_stop_read(recorder->inner);
+}
+
+static void can_log_recorder_destroy_impl(void* self) {
+  // inner は借りているだけなので破棄しない
+  (void)self;
+}
+
+void can_log_recorder_init(CanLogRecorder* recorder, CanBus* inner,
+                           CanLogWriter* writer) {
+  memset(recorder, 0, sizeof(*recorder));
+  recorder->inner = inner;
+  recorder->writer = writer;
+
+  recorder->bus.write = can_log_recorder_write_impl;
+  recorder->bus.write_batch = can_log_recorder_write_batch_impl;
+  recorder->bus.read = can_log_recorder_read_impl;
+  recorder->bus.read_batch = can_log_recorder_read_batch_impl;
+  recorder->bus.write_fd = can_log_recorder_write_fd_impl;
+  recorder->bus.read_fd = can_log_recorder_read_fd_impl;
+  recorder->bus.get_stats = can_log_recorder_get_stats_impl;
+  recorder->bus.start_read = can_log_recorder_start_read_impl;
+  recorder->bus.stop_read = can_log_recorder_stop_read_impl;
+  recorder->bus.destroy = can_log_recorder_destroy_impl;
+  recorder->bus.impl = recorder;
+}
+
+void can_log_recorder_set_clock(CanLogRecorder* recorder, CanClockFn clock,
+                                void* user_arg) {
+  recorder->clock = clock;
+  recorder->clock_user_arg = user_arg;
+}
+
+CanBus* can_log_recorder_bus(CanLogRecorder* recorder) {
+  return &recorder->bus;
+}
+
+// --- リプレイヤ ---
+
+void can_log_replayer_init(CanLogReplayer* replayer, CanLogReader* reader,
+                           CanBus* target, uint32_t speed) {
+  memset(replayer, 0, sizeof(*replayer));
+  replayer->reader = reader;
+  replayer->target = target;
+  replayer->speed = speed;
+}
+
+void can_log_replayer_set_include_tx(CanLogReplayer* replayer, bool include) {
+  replayer->include_tx = include;
+}
+
+// 送る対象の次のレコードを pending に読む
+static bool can_log_replayer_load(CanLogReplayer* replayer) {
+  while (!replayer->has_pending) {
+    if (!can_log_reader_next(replayer->reader, &replayer->pending)) {
+      replayer->finished = true;
+      return false;
+    }
+    if (!replayer->started) {
+      replayer->log_start_us = replayer->pending.time_us;
+    }
+    replayer->has_pending = replayer->include_tx || !replayer->pending.tx;
+  }
+  return true;
+}
+
+size_t can_log_replayer_poll(CanLogReplayer* replayer, uint32_t now_us) {
+  size_t sent = 0;
+  uint64_t elapsed_log = 0;
+
+  if (!replayer->started) {
+    if (!can_log_replayer_load(replayer)) {
+      return 0;
+    }
+    replayer->wall_start_us = now_us;
+    replayer->started = true;
+  }
+  elapsed_log =
+      (uint64_t)(uint32_t)(now_us - replayer->wall_start_us) * replayer->speed;
+
+  while (can_log_replayer_load(replayer)) {
+    CanLogRecord* record = &replayer->pending;
+    if (replayer->speed != 0U &&
+        record->time_us > replayer->log_start_us + elapsed_log) {
+      break;
+    }
+    if (!can_bus_write(replayer->target, &record->msg)) {
+      break;
+    }
+    replayer->has_pending = false;
+    replayer->sent_count++;
+    sent++;
+  }
+  return sent;
+}
+
+bool can_log_replayer_done(const CanLogReplayer* replayer) {
+  return replayer->finished && !replayer->has_pending;
+}
+
+// --- candump 形式 ---
+
+static size_t can_log_put_hex(char* out, uint32_t value, int digits) {
+  static const char kHex[] = "0123456789ABCDEF";
+  for (int i = digits - 1; i >= 0; --i) {
+    out[i] = kHex[value & 0xFU];
+    value >>= 4;
+  }
+  return (size_t)digits;
+}
+
+static size_t can_log_put_decimal(char* out, uint64_t value, int min_digits) {
+  char tmp[20];
+  int n = 0;
+  do {
+    tmp[n++] = (char)('0' + value % 10U);
+    value /= 10U;
+  } while (value != 0U || n < min_digits);
+  for (int i = 0; i < n; ++i) {
+    out[i] = tmp[n - 1 - i];
+  }
+  return (size_t)n;
+}
+
+size_t can_log_format_candump(const CanLogRecord* record, const char* ifname,
+                              char* out, size_t size) {
+  // "(" + 秒 20 + "." + 6 + ") " + ifname + " " + ID 8 + "#" + データ 16
+  char line[80];
+  size_t n = 0;
+  size_t ifname_len = strlen(ifname);
+  uint8_t len = record->msg.len > 8U ? 8U : record->msg.len;
+
+  if (ifname_len > 16U) {
+    return 0;
+  }
+  line[n++] = '(';
+  n += can_log_put_decimal(&line[n], record->time_us / 1000000U, 1);
+  line[n++] = '.';
+  n += can_log_put_decimal(&line[n], record->time_us % 1000000U, 6);
+  line[n++] = ')';
+  line[n++] = ' ';
+  memcpy(&line[n], ifname, ifname_len);
+  n += ifname_len;
+  line[n++] = ' ';
+  n += can_log_put_hex(&line[n], record->msg.id,
+                       record->msg.id > CAN_STD_ID_MAX ? 8 : 3);
+  line[n++] = '#';
+  for (uint8_t i = 0; i < len; ++i) {
+    n += can_log_put_hex(&line[n], record->msg.data[i], 2);
+  }
+
+  if (n + 1U > size) {
+    return 0;
+  }
+  memcpy(out, line, n);
+  out[n] = '\0';
+  return n;
+}
+
+static int can_log_hex_value(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+bool can_log_parse_candump(const char* line, CanLogRecord* record) {
+  const char* p = line;
+  uint64_t seconds = 0;
+  uint64_t micros = 0;
+  int frac_digits = 0;
+  uint32_t id = 0;
+  int id_digits = 0;
+  uint8_t len = 0;
+
+  while (*p == ' ' || *p == '\t') {
+    p++;
+  }
+  if (*p++ != '(') {
+    return false;
+  }
+  if (*p < '0' || *p > '9') {
+    return false;
+  }
+  while (*p >= '0' && *p <= '9') {
+    seconds = seconds * 10U + (uint64_t)(*p++ - '0');
+  }
+  if (*p == '.') {
+    p++;
+    while (*p >= '0' && *p <= '9') {
+      if (frac_digits < 6) {
+        micros = micros * 10U + (uint64_t)(*p - '0');
+        frac_digits++;
+      }
+      p++;
+    }
+    for (; frac_digits < 6; ++frac_digits) {
+      micros *= 10U;
+    }
+  }
+  if (*p++ != ')') {
+    return false;
+  }
+
+  // インターフェース名を読み飛ばす
+  while (*p == ' ') {
+    p++;
+  }
+  if (*p == '\0' || *p == ' ') {
+    return false;
+  }
+  while (*p != ' ' && *p != '\0') {
+    p++;
+  }
+  while (*p == ' ') {
+    p++;
+  }
+
+  while (can_log_hex_value(*p) >= 0 && id_digits < 8) {
+    id = (id << 4) | (uint32_t)can_log_hex_value(*p++);
+    id_digits++;
+  }
+  if (*p++ != '#' || (id_digits != 3 && id_digits != 8) ||
+      id > CAN_EXT_ID_MAX) {
+    return false;
+  }
+
+  memset(record, 0, sizeof(*record));
+  // リモートフレームはデータなしとして読む
+  if (*p == 'R') {
+    p++;
+  } else {
+    while (can_log_hex_value(p[0]) >= 0 && can_log_hex_value(p[1]) >= 0) {
+      if (len >= 8U) {
+        return false;
+      }
+      record->msg.data[len++] =
+          (uint8_t)((can_log_hex_value(p[0]) << 4) | can_log_hex_value(p[1]));
+      p += 2;
+    }
+  }
+  if (*p != '\0' && *p != ' ' && *p != '\r' && *p != '\n') {
+    return false;
+  }
+
+  record->msg.id = id;
+  record->msg.len = len;
+  record->time_us = seconds * 1000000U + micros;
+  record->msg.flags = CAN_MSG_FLAG_TIMESTAMP;
+  record->msg.timestamp_us = (uint32_t)record->time_us;
+  record->tx = false;
+  return true;
+}
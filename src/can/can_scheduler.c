@@ -0,0 +1,197 @@
+#include "can/can_scheduler.h"
+
+#include <string.h>
+
+#include "profile/profile.h"
+
+// tick のラップアラウンドを考慮して a が b 以降か判定する
+static bool can_scheduler_reached(uint32_t a, uint32_t b) {
+  return (int32_t)(a - b) >= 0;
+}
+
+// tick の位置で送信予定になるスロット数
+static uint32_t can_scheduler_load_at(const CanScheduler* scheduler,
+                                      uint32_t tick) {
+  uint32_t load = 0;
+  for (uint8_t i = 0; i < scheduler->slot_count; ++i) {
+    const CanScheduleSlot* slot = &scheduler->slots[i];
+    if (tick % slot->period == slot->phase) {
+      load++;
+    }
+  }
+  return load;
+}
+
+static uint32_t can_scheduler_gcd(uint32_t a, uint32_t b) {
+  while (b != 0U) {
+    uint32_t r = a % b;
+    a = b;
+    b = r;
+  }
+  return a;
+}
+
+// 新しい周期と既存スロットの周期の組み合わせが一巡する長さ [tick]
+// 最小公倍数が CAN_SCHEDULER_PHASE_SCAN_LIMIT を超える場合は、上限と最長周期の
+// 大きい方で打ち切る
+static uint32_t can_scheduler_scan_span(const CanScheduler* scheduler,
+                                        uint32_t period) {
+  uint32_t lcm = period;
+  uint32_t longest = period;
+  bool capped = false;
+
+  for (uint8_t i = 0; i < scheduler->slot_count; ++i) {
+    const uint32_t other = scheduler->slots[i].period;
+    if (other > longest) {
+      longest = other;
+    }
+    if (!capped) {
+      const uint64_t next =
+          (uint64_t)lcm / can_scheduler_gcd(lcm, other) * other;
+      if (next > CAN_SCHEDULER_PHASE_SCAN_LIMIT) {
+        capped = true;
+      } else {
+        lcm = (uint32_t)next;
+      }
+    }
+  }
+  if (!capped) {
+    return lcm;
+  }
+  return longest > CAN_SCHEDULER_PHASE_SCAN_LIMIT
+             ? longest
+             : CAN_SCHEDULER_PHASE_SCAN_LIMIT;
+}
+
+// 既存スロットと最も重ならない位相を選ぶ（同点なら小さい位相）
+static uint32_t can_scheduler_pick_phase(const CanScheduler* scheduler,
+                                         uint32_t period) {
+  uint32_t best_phase = 0;
+  uint32_t best_load = UINT32_MAX;
+  const uint32_t span = can_scheduler_scan_span(scheduler, period);
+  const uint32_t repeats = (span + period - 1U) / period;
+
+  for (uint32_t phase = 0; phase < period; ++phase) {
+    uint32_t worst = 0;
+    // 他スロットの周期との組み合わせが一巡するまで調べる
+    for (uint32_t k = 0; k < repeats; ++k) {
+      uint32_t load = can_scheduler_load_at(scheduler, phase + k * period);
+      if (load > worst) {
+        worst = load;
+      }
+    }
+    if (worst < best_load) {
+      best_load = worst;
+      best_phase = phase;
+    }
+    if (best_load == 0U) {
+      break;
+    }
+  }
+  return best_phase;
+}
+
+// now 以降で最初に tick % period == phase となる tick
+static uint32_t can_scheduler_first_due(uint32_t now, uint32_t period,
+                                        uint32_t phase) {
+  uint32_t offset = (phase + period - now % period) % period;
+  return now + offset;
+}
+
+void can_scheduler_init(CanScheduler* scheduler, CanBus* bus) {
+  memset(scheduler, 0, sizeof(*scheduler));
+  scheduler->bus = bus;
+  scheduler->max_per_tick = CAN_SCHEDULER_DEFAULT_MAX_PER_TICK;
+}
+
+void can_scheduler_set_max_per_tick(CanScheduler* scheduler,
+                                    uint8_t max_per_tick) {
+  scheduler->max_per_tick = max_per_tick;
+}
+
+int can_scheduler_add(CanScheduler* scheduler, uint32_t period,
+                      uint32_t phase, CanScheduleFillFn fill, void* user_arg) {
+  CanScheduleSlot* slot = 0;
+
+  if (fill == 0 || period == 0U ||
+      scheduler->slot_count >= CAN_SCHEDULER_MAX_SLOTS) {
+    return -1;
+  }
+  if (phase == CAN_SCHEDULER_AUTO_PHASE) {
+    phase = can_scheduler_pick_phase(scheduler, period);
+  } else if (phase >= period) {
+    return -1;
+  }
+
+  slot = &scheduler->slots[scheduler->slot_count];
+  slot->period = period;
+  slot->phase = phase;
+  slot->next_due = can_scheduler_first_due(scheduler->now, period, phase);
+  slot->enabled = true;
+  slot->fill = fill;
+  slot->user_arg = user_arg;
+  return scheduler->slot_count++;
+}
+
+void can_scheduler_set_enabled(CanScheduler* scheduler, int slot,
+                               bool enabled) {
+  CanScheduleSlot* target = 0;
+
+  if (slot < 0 || slot >= scheduler->slot_count) {
+    return;
+  }
+  target = &scheduler->slots[slot];
+  if (enabled && !target->enabled) {
+    target->next_due =
+        can_scheduler_first_due(scheduler->now, target->period, target->phase);
+  }
+  target->enabled = enabled;
+}
+
+// 送信済み（または今周期は送らない）スロットを次の周期へ進める
+static void can_scheduler_advance(CanScheduler* scheduler,
+                                  CanScheduleSlot* slot) {
+  slot->next_due += slot->period;
+  // 送れないまま次の周期に入った場合は溜めずに捨てて位相を保つ
+  while (can_scheduler_reached(scheduler->now, slot->next_due)) {
+    slot->next_due += slot->period;
+    scheduler->skipped_count++;
+  }
+}
+
+size_t can_scheduler_tick(CanScheduler* scheduler) {
+  CanMessage msg;
+  size_t sent = 0;
+  bool bus_full = false;
+  OM_PROFILE_BEGIN(profile_start);
+
+  for (uint8_t i = 0; i < scheduler->slot_count; ++i) {
+    CanScheduleSlot* slot = &scheduler->slots[i];
+
+    if (!slot->enabled ||
+        !can_scheduler_reached(scheduler->now, slot->next_due)) {
+      continue;
+    }
+    if (bus_full ||
+        (scheduler->max_per_tick != 0U && sent >= scheduler->max_per_tick)) {
+      scheduler->deferred_count++;
+      continue;
+    }
+
+    memset(&msg, 0, sizeof(msg));
+    if (slot->fill(&msg, slot->user_arg)) {
+      if (!can_bus_write(scheduler->bus, &msg)) {
+        // バスが受け付けない間は同じ tick で後続を試さない
+        bus_full = true;
+        scheduler->deferred_count++;
+        continue;
+      }
+      sent++;
+    }
+    can_scheduler_advance(scheduler, slot);
+  }
+
+  scheduler->now++;
+  OM_PROFILE_END(OM_PROFILE_CAN_SCHEDULER, profile_start);
+  return sent;
+}
@@ -0,0 +1,252 @@
+#include "can/can_serial.h"
+
+#include <string.h>
+
+#include "cobs/cobs.h"
+
+#define CAN_SERIAL_INFO_LEN_MASK 0x0FU
+#define CAN_SERIAL_INFO_EXT 0x10U
+
+// CRC-8（多項式 0x07、初期値 0）
+static uint8_t can_serial_crc8(const uint8_t* data, size_t size) {
+  uint8_t crc = 0U;
+  for (size_t i = 0; i < size; ++i) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8U; ++bit) {
+      crc = (crc & 0x80U) != 0U ? (uint8_t)((crc << 1) ^ 0x07U)
+                                : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+static size_t can_serial_record_size(const CanMessage* msg) {
+  return 1U + (msg->id > CAN_STD_ID_MAX ? 4U : 2U) + msg->len;
+}
+
+static void can_serial_push_rx(CanSerial* link, const CanMessage* msg) {
+  uint32_t index = 0;
+
+  if (!spsc_ring_write_slot(&link->rx_ring, &index)) {
+    link->stats.rx_overflows++;
+    return;
+  }
+  link->rx_queue[index] = *msg;
+  spsc_ring_commit_write(&link->rx_ring);
+  link->stats.rx_frames++;
+  if (spsc_ring_count(&link->rx_ring) > link->stats.rx_queue_high_water) {
+    link->stats.rx_queue_high_water =
+        (uint16_t)spsc_ring_count(&link->rx_ring);
+  }
+}
+
+// 区切りまで揃ったパケットを復号して受信キューに積む
+static void can_serial_handle_packet(CanSerial* link) {
+  uint8_t payload[CAN_SERIAL_MAX_PAYLOAD];
+  size_t size = sizeof(payload);
+
+  if (link->rx_used <= 1U) {
+    return;  // 空のパケット（連続した区切り）は無視する
+  }
+  if (!om_cobs_decode(link->rx_encoded, link->rx_used, payload, &size) ||
+      size < 2U || can_serial_crc8(payload, size - 1U) != payload[size - 1U]) {
+    link->rx_errors++;
+    return;
+  }
+
+  link->rx_packets++;
+  size--;  // CRC
+  size_t pos = 0;
+  while (pos < size) {
+    const uint8_t info = payload[pos++];
+    const bool ext = (info & CAN_SERIAL_INFO_EXT) != 0U;
+    const size_t id_size = ext ? 4U : 2U;
+    CanMessage msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.len = info & CAN_SERIAL_INFO_LEN_MASK;
+    if (msg.len > 8U || pos + id_size + msg.len > size) {
+      link->rx_errors++;
+      return;
+    }
+    for (size_t i = 0; i < id_size; ++i) {
+      msg.id |= (uint32_t)payload[pos + i] << (8U * i);
+    }
+    pos += id_size;
+    memcpy(msg.data, &payload[pos], msg.len);
+    pos += msg.len;
+    can_serial_push_rx(link, &msg);
+  }
+}
+
+static bool can_serial_write_impl(void* self, const CanMessage* msg) {
+  CanSerial* link = (CanSerial*)self;
+
+  if (msg->len > 8U || msg->id > CAN_EXT_ID_MAX) {
+    link->stats.tx_failures++;
+    return false;
+  }
+
+  const size_t record_size = can_serial_record_size(msg);
+  // 末尾に CRC の 1 バイトを残す
+  if (link->tx_used + record_size + 1U > CAN_SERIAL_MAX_PAYLOAD &&
+      !can_serial_flush(link)) {
+    link->stats.tx_failures++;
+    return false;
+  }
+
+  uint8_t* out = &link->tx_payload[link->tx_used];
+  const bool ext = msg->id > CAN_STD_ID_MAX;
+  const size_t id_size = ext ? 4U : 2U;
+  *out++ = (uint8_t)(msg->len | (ext ? CAN_SERIAL_INFO_EXT : 0U));
+  for (size_t i = 0; i < id_size; ++i) {
+    *out++ = (uint8_t)(msg->id >> (8U * i));
+  }
+  memcpy(out, msg->data, msg->len);
+  link->tx_used += record_size;
+  link->tx_pending++;
+  return true;
+}
+
+static size_t can_serial_write_batch_impl(void* self, const CanMessage* msgs,
+                                          size_t count) {
+  CanSerial* link = (CanSerial*)self;
+  size_t accepted = 0;
+
+  while (accepted < count && can_serial_write_impl(link, &msgs[accepted])) {
+    ++accepted;
+  }
+  can_serial_flush(link);
+  return accepted;
+}
+
+static bool can_serial_read_impl(void* self, CanMessage* msg) {
+  CanSerial* link = (CanSerial*)self;
+  uint32_t index = 0;
+
+  if (!spsc_ring_read_slot(&link->rx_ring, &index)) {
+    return false;
+  }
+  *msg = link->rx_queue[index];
+  spsc_ring_commit_read(&link->rx_ring);
+  return true;
+}
+
+static void can_serial_start_read_impl(void* self) {
+  CanSerial* link = (CanSerial*)self;
+  serial_port_start_read(link->port);
+}
+
+static void can_serial_stop_read_impl(void* self) {
+  CanSerial* link = (CanSerial*)self;
+  serial_port_stop_read(link->port);
+}
+
+static bool can_serial_get_stats_impl(void* self, CanBusStats* stats) {
+  CanSerial* link = (CanSerial*)self;
+  *stats = link->stats;
+  return true;
+}
+
+static void can_serial_destroy_impl(void* self) { (void)self; }
+
+void can_serial_init(CanSerial* link, SerialPort* port) {
+  memset(link, 0, sizeof(*link));
+  spsc_ring_init(&link->rx_ring, CAN_SERIAL_RX_QUEUE_SIZE);
+  link->port = port;
+
+  link->bus.write = can_serial_write_impl;
+  link->bus.write_batch = can_serial_write_batch_impl;
+  link->bus.read = can_serial_read_impl;
+  link->bus.start_read = can_serial_start_read_impl;
+  link->bus.stop_read = can_serial_stop_read_impl;
+  link->bus.get_stats = can_serial_get_stats_impl;
+  link->bus.destroy = can_serial_destroy_impl;
+  link->bus.impl = link;
+}
+
+CanBus* can_serial_bus(CanSerial* link) { return &link->bus; }
+
+bool can_serial_flush(CanSerial* link) {
+  SerialMessage packet;
+  size_t encoded_length = sizeof(packet.data);
+
+  if (link->tx_used == 0U) {
+    return true;
+  }
+
+  link->tx_payload[link->tx_used] =
+      can_serial_crc8(link->tx_payload, link->tx_used);
+  if (!om_cobs_encode(link->tx_payload, link->tx_used + 1U, packet.data,
+                      &encoded_length)) {
+    return false;
+  }
+  packet.len = (uint16_t)encoded_length;
+  if (!serial_port_write(link->port, &packet)) {
+    return false;
+  }
+
+  link->tx_packets++;
+  link->stats.tx_frames += link->tx_pending;
+  link->tx_used = 0U;
+  link->tx_pending = 0U;
+  return true;
+}
+
+void can_serial_feed(CanSerial* link, const uint8_t* data, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    const uint8_t byte = data[i];
+
+    if (link->rx_discarding) {
+      link->rx_discarding = byte != 0x00U;
+      continue;
+    }
+    if (link->rx_used >= sizeof(link->rx_encoded)) {
+      link->rx_errors++;
+      link->rx_used = 0U;
+      link->rx_discarding = byte != 0x00U;
+      continue;
+    }
+    link->rx_encoded[link->rx_used++] = byte;
+    if (byte == 0x00U) {
+      can_serial_handle_packet(link);
+      link->rx_used = 0U;
+    }
+  }
+}
+
+void can_serial_poll(CanSerial* link) {
+  SerialMessage chunk;
+
+  can_serial_flush(link);
+  while (serial_port_read(link->port, &chunk)) {
+    can_serial_feed(link, chunk.data,
+                    chunk.len > SERIAL_MESSAGE_MAX_LEN ? SERIAL_MESSAGE_MAX_LEN
+                                                       : chunk.len);
+  }
+}
+
+size_t can_serial_relay(CanSerial* link, CanBus* local, size_t max_frames) {
+  CanMessage msg;
+  size_t relayed = 0;
+  size_t count = 0;
+
+  can_serial_poll(link);
+  while (count < max_frames && can_serial_read_impl(link, &msg)) {
+    ++count;
+    if (can_bus_write(local, &msg)) {
+      ++relayed;
+    }
+  }
+
+  count = 0;
+  while (count < max_frames && can_bus_read(local, &msg)) {
+    ++count;
+    msg.flags = 0U;
+    if (can_serial_write_impl(link, &msg)) {
+      ++relayed;
+    }
+  }
+  can_serial_flush(link);
+  return relayed;
+}
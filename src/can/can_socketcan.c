@@ -0,0 +1,372 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  // recvmmsg / sendmmsg
+#endif
+
+#include "can/can_socketcan.h"
+
+#include <string.h>
+
+#ifdef OMURAISU_CAN_SOCKETCAN_ENABLE
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+static void can_socketcan_frame_from_message(struct can_frame* frame,
+                                             const CanMessage* msg) {
+  memset(frame, 0, sizeof(*frame));
+  if (msg->id <= CAN_SFF_MASK) {
+    frame->can_id = msg->id;
+  } else {
+    frame->can_id = (msg->id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+  }
+  frame->can_dlc = msg->len > 8U ? 8U : msg->len;
+  memcpy(frame->data, msg->data, frame->can_dlc);
+}
+
+static bool can_socketcan_message_from_frame(CanMessage* msg,
+                                             const struct can_frame* frame) {
+  if ((frame->can_id & (CAN_RTR_FLAG | CAN_ERR_FLAG)) != 0U) {
+    return false;
+  }
+
+  memset(msg, 0, sizeof(*msg));
+  if ((frame->can_id & CAN_EFF_FLAG) != 0U) {
+    msg->id = frame->can_id & CAN_EFF_MASK;
+  } else {
+    msg->id = frame->can_id & CAN_SFF_MASK;
+  }
+  msg->len = frame->can_dlc > 8U ? 8U : frame->can_dlc;
+  memcpy(msg->data, frame->data, msg->len);
+  return true;
+}
+
+// SO_TIMESTAMP の受信時刻（CLOCK_REALTIME）を [us] の下位 32bit にする
+static void can_socketcan_stamp_message(CanMessage* msg, struct msghdr* hdr) {
+  struct cmsghdr* cmsg = 0;
+
+  for (cmsg = CMSG_FIRSTHDR(hdr); cmsg != 0; cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMP) {
+      struct timeval tv;
+      memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));
+      msg->flags |= CAN_MSG_FLAG_TIMESTAMP;
+      msg->timestamp_us =
+          (uint32_t)((uint64_t)tv.tv_sec * 1000000U + (uint64_t)tv.tv_usec);
+      return;
+    }
+  }
+}
+
+static size_t can_socketcan_recv(CanSocketCan* socketcan, CanMessage* msgs,
+                                 size_t max_count) {
+  struct can_frame frames[CAN_SOCKETCAN_BATCH_SIZE];
+  struct iovec iov[CAN_SOCKETCAN_BATCH_SIZE];
+  struct mmsghdr headers[CAN_SOCKETCAN_BATCH_SIZE];
+  char control[CAN_SOCKETCAN_BATCH_SIZE][CMSG_SPACE(sizeof(struct timeval))];
+  size_t count = 0;
+
+  if (socketcan->fd < 0 || max_count == 0U) {
+    return 0;
+  }
+  if (max_count > CAN_SOCKETCAN_BATCH_SIZE) {
+    max_count = CAN_SOCKETCAN_BATCH_SIZE;
+  }
+
+  memset(headers, 0, sizeof(headers[0]) * max_count);
+  for (size_t i = 0; i < max_count; ++i) {
+    iov[i].iov_base = &frames[i];
+    iov[i].iov_len = sizeof(frames[i]);
+    headers[i].msg_hdr.msg_iov = &iov[i];
+    headers[i].msg_hdr.msg_iovlen = 1;
+    headers[i].msg_hdr.msg_control = control[i];
+    headers[i].msg_hdr.msg_controllen = sizeof(control[i]);
+  }
+
+  int received = recvmmsg(socketcan->fd, headers, (unsigned int)max_count,
+                          MSG_DONTWAIT, NULL);
+  if (received <= 0) {
+    return 0;
+  }
+
+  for (int i = 0; i < received; ++i) {
+    if (headers[i].msg_len != sizeof(struct can_frame)) {
+      continue;
+    }
+    if (can_socketcan_message_from_frame(&msgs[count], &frames[i])) {
+      can_socketcan_stamp_message(&msgs[count], &headers[i].msg_hdr);
+      count++;
+    }
+  }
+  return count;
+}
+
+static bool can_socketcan_bus_write_impl(void* self, const CanMessage* msg) {
+  CanSocketCan* socketcan = (CanSocketCan*)self;
+  struct can_frame frame;
+
+  if (socketcan->fd < 0 || msg == 0) {
+    return false;
+  }
+
+  can_socketcan_frame_from_message(&frame, msg);
+  return write(socketcan->fd, &frame, sizeof(frame)) ==
+         (ssize_t)sizeof(frame);
+}
+
+static size_t can_socketcan_bus_write_batch_impl(void* self,
+                                                 const CanMessage* msgs,
+                                                 size_t count) {
+  return can_socketcan_write_batch((CanSocketCan*)self, msgs, count);
+}
+
+static bool can_socketcan_bus_read_impl(void* self, CanMessage* msg) {
+  CanSocketCan* socketcan = (CanSocketCan*)self;
+  return can_socketcan_read_batch(socketcan, msg, 1U) == 1U;
+}
+
+static size_t can_socketcan_bus_read_batch_impl(void* self, CanMessage* msgs,
+                                                size_t max_count) {
+  return can_socketcan_read_batch((CanSocketCan*)self, msgs, max_count);
+}
+
+static void can_socketcan_bus_destroy_impl(void* self) {
+  can_socketcan_close((CanSocketCan*)self);
+}
+
+void can_socketcan_init(CanSocketCan* socketcan) {
+  memset(socketcan, 0, sizeof(*socketcan));
+  socketcan->fd = -1;
+
+  socketcan->bus.write = can_socketcan_bus_write_impl;
+  socketcan->bus.write_batch = can_socketcan_bus_write_batch_impl;
+  socketcan->bus.read = can_socketcan_bus_read_impl;
+  socketcan->bus.read_batch = can_socketcan_bus_read_batch_impl;
+  socketcan->bus.destroy = can_socketcan_bus_destroy_impl;
+  socketcan->bus.impl = socketcan;
+}
+
+bool can_socketcan_open(CanSocketCan* socketcan, const char* ifname) {
+  struct sockaddr_can addr;
+  unsigned int ifindex = 0;
+
+  if (ifname == 0) {
+    return false;
+  }
+  if (socketcan->fd >= 0) {
+    return true;
+  }
+
+  ifindex = if_nametoindex(ifname);
+  if (ifindex == 0U) {
+    return false;
+  }
+
+  int fd = socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, CAN_RAW);
+  if (fd < 0) {
+    return false;
+  }
+
+  memset(&addr, 0, sizeof(addr));
+  addr.can_family = AF_CAN;
+  addr.can_ifindex = (int)ifindex;
+  if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+    close(fd);
+    return false;
+  }
+
+  // 受信時刻はカーネルが付ける（失敗しても受信自体はできる）
+  int enable_timestamp = 1;
+  setsockopt(fd, SOL_SOCKET, SO_TIMESTAMP, &enable_timestamp,
+             sizeof(enable_timestamp));
+
+  socketcan->fd = fd;
+  socketcan->rx_head = 0;
+  socketcan->rx_count = 0;
+  return true;
+}
+
+void can_socketcan_close(CanSocketCan* socketcan) {
+  if (socketcan->fd >= 0) {
+    close(socketcan->fd);
+  }
+  socketcan->fd = -1;
+  socketcan->rx_head = 0;
+  socketcan->rx_count = 0;
+}
+
+bool can_socketcan_is_open(const CanSocketCan* socketcan) {
+  return socketcan->fd >= 0;
+}
+
+CanBus* can_socketcan_bus(CanSocketCan* socketcan) { return &socketcan->bus; }
+
+int can_socketcan_fd(const CanSocketCan* socketcan) { return socketcan->fd; }
+
+bool can_socketcan_set_filters(CanSocketCan* socketcan,
+                               const CanFilter* filters, size_t count) {
+  struct can_filter raw_filters[CAN_SOCKETCAN_MAX_FILTERS];
+
+  if (socketcan->fd < 0 || count > CAN_SOCKETCAN_MAX_FILTERS ||
+      (count > 0U && filters == 0)) {
+    return false;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    // EFF / RTR フラグも照合して標準/拡張の取り違えとリモートフレームを除く
+    raw_filters[i].can_mask = CAN_EFF_FLAG | CAN_RTR_FLAG;
+    if (filters[i].id > CAN_SFF_MASK) {
+      raw_filters[i].can_id = (filters[i].id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+      raw_filters[i].can_mask |= filters[i].mask & CAN_EFF_MASK;
+    } else {
+      raw_filters[i].can_id = filters[i].id;
+      raw_filters[i].can_mask |= filters[i].mask & CAN_SFF_MASK;
+    }
+  }
+  if (count == 0U) {
+    // マスク 0 のフィルタ 1 つで全フレームを受け付ける
+    raw_filters[0].can_id = 0;
+    raw_filters[0].can_mask = 0;
+    count = 1U;
+  }
+
+  return setsockopt(socketcan->fd, SOL_CAN_RAW, CAN_RAW_FILTER, raw_filters,
+                    (socklen_t)(sizeof(raw_filters[0]) * count)) == 0;
+}
+
+static size_t can_socketcan_pop_buffered(CanSocketCan* socketcan,
+                                         CanMessage* msgs, size_t max_count) {
+  size_t count = 0;
+  while (count < max_count && socketcan->rx_count > 0U) {
+    msgs[count++] = socketcan->rx_buffer[socketcan->rx_head];
+    socketcan->rx_head++;
+    socketcan->rx_count--;
+  }
+  return count;
+}
+
+size_t can_socketcan_read_batch(CanSocketCan* socketcan, CanMessage* msgs,
+                                size_t max_count) {
+  size_t count = 0;
+
+  if (msgs == 0) {
+    return 0;
+  }
+
+  count = can_socketcan_pop_buffered(socketcan, msgs, max_count);
+
+  // 大きな要求は呼び出し側の配列に直接受信する
+  while (max_count - count >= CAN_SOCKETCAN_BATCH_SIZE) {
+    size_t received =
+        can_socketcan_recv(socketcan, &msgs[count], max_count - count);
+    if (received == 0U) {
+      return count;
+    }
+    count += received;
+  }
+
+  // 小さな要求（単発の read() など）は 1 回の recvmmsg でまとめて取り込み、
+  // 余ったフレームは次回以降に返す
+  if (count < max_count) {
+    socketcan->rx_head = 0;
+    socketcan->rx_count = (uint16_t)can_socketcan_recv(
+        socketcan, socketcan->rx_buffer, CAN_SOCKETCAN_BATCH_SIZE);
+    count += can_socketcan_pop_buffered(socketcan, &msgs[count],
+                                        max_count - count);
+  }
+  return count;
+}
+
+size_t can_socketcan_write_batch(CanSocketCan* socketcan,
+                                 const CanMessage* msgs, size_t count) {
+  struct can_frame frames[CAN_SOCKETCAN_BATCH_SIZE];
+  struct iovec iov[CAN_SOCKETCAN_BATCH_SIZE];
+  struct mmsghdr headers[CAN_SOCKETCAN_BATCH_SIZE];
+  size_t sent = 0;
+
+  if (socketcan->fd < 0 || msgs == 0) {
+    return 0;
+  }
+
+  while (sent < count) {
+    size_t chunk = count - sent;
+    if (chunk > CAN_SOCKETCAN_BATCH_SIZE) {
+      chunk = CAN_SOCKETCAN_BATCH_SIZE;
+    }
+
+    memset(headers, 0, sizeof(headers[0]) * chunk);
+    for (size_t i = 0; i < chunk; ++i) {
+      can_socketcan_frame_from_message(&frames[i], &msgs[sent + i]);
+      iov[i].iov_base = &frames[i];
+      iov[i].iov_len = sizeof(frames[i]);
+      headers[i].msg_hdr.msg_iov = &iov[i];
+      headers[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int result =
+        sendmmsg(socketcan->fd, headers, (unsigned int)chunk, MSG_DONTWAIT);
+    if (result <= 0) {
+      break;
+    }
+    sent += (size_t)result;
+    if ((size_t)result < chunk) {
+      break;
+    }
+  }
+  return sent;
+}
+
+#else
+
+void can_socketcan_init(CanSocketCan* socketcan) {
+  memset(socketcan, 0, sizeof(*socketcan));
+  socketcan->fd = -1;
+  socketcan->bus.impl = socketcan;
+}
+
+bool can_socketcan_open(CanSocketCan* socketcan, const char* ifname) {
+  (void)socketcan;
+  (void)ifname;
+  return false;
+}
+
+void can_socketcan_close(CanSocketCan* socketcan) { socketcan->fd = -1; }
+
+bool can_socketcan_is_open(const CanSocketCan* socketcan) {
+  (void)socketcan;
+  return false;
+}
+
+CanBus* can_socketcan_bus(CanSocketCan* socketcan) { return &socketcan->bus; }
+
+int can_socketcan_fd(const CanSocketCan* socketcan) {
+  (void)socketcan;
+  return -1;
+}
+
+bool can_socketcan_set_filters(CanSocketCan* socketcan,
+                               const CanFilter* filters, size_t count) {
+  (void)socketcan;
+  (void)filters;
+  (void)count;
+  return false;
+}
+
+size_t can_socketcan_read_batch(CanSocketCan* socketcan, CanMessage* msgs,
+                                size_t max_count) {
+  (void)socketcan;
+  (void)msgs;
+  (void)max_count;
+  return 0;
+}
+
+size_t can_socketcan_write_batch(CanSocketCan* socketcan,
+                                 const CanMessage* msgs, size_t count) {
+  (void)socketcan;
+  (void)msgs;
+  (void)count;
+  return 0;
+}
+
+#endif  // OMURAISU_CAN_SOCKETCAN_ENABLE
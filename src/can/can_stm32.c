@@ -2,54 +2,426 @@
 
 #include <string.h>
 
-#ifndef OMURAISU_CAN_STM32_MAX_CONTEXTS
-#define OMURAISU_CAN_STM32_MAX_CONTEXTS 4
-#endif
-
 #ifndef OMURAISU_CAN_STM32_HAL_HEADER
 #define OMURAISU_CAN_STM32_HAL_HEADER "main.h"
 #endif
 
+// bxCAN 1 台あたりのフィルタバンク数（CAN1 / CAN2 は SlaveStartFilterBank で
+// 28 バンクを 14 ずつに分け、CAN3 は単独で 14 バンク持つ）
+#define CAN_STM32_CAN_FILTER_BANKS 14U
+
+// 同じ周辺機能のもう一方の FIFO に登録されたコンテキスト
+static CanStm32Context* can_stm32_sibling(const CanStm32Context* context);
+
+// FDCAN に確保された標準 / 拡張 ID のフィルタ要素数（CubeMX の Std/Ext Filters
+// Nbr）。分からなければ false。
+static bool can_stm32_fdcan_capacity(const CanStm32Context* context,
+                                     uint32_t capacity[2]);
+
+static const CanStm32RecoveryPolicy kCanStm32DefaultRecovery = {
+    .auto_recover = true,
+    .backoff_initial_ms = 10U,
+    .backoff_max_ms = 1000U,
+    .stable_ms = 1000U,
+};
+
+void can_stm32_context_init(CanStm32Context* context, CanCube* cube,
+                            void* handle, CanStm32Kind kind,
+                            uint32_t rx_fifo) {
+  context->cube = cube;
+  context->handle = handle;
+  context->kind = kind;
+  context->rx_fifo = rx_fifo;
+  context->filter_count = 0;
+  context->filter_error = false;
+  context->timestamp_ns_per_tick = 0;
+  context->timestamp_last_raw = 0;
+  context->timestamp_ticks = 0;
+  context->error_state = CAN_STM32_ERROR_ACTIVE;
+  context->last_error = CAN_STM32_LEC_NONE;
+  context->bus_off_count = 0;
+  context->recovery_count = 0;
+  context->recovery = kCanStm32DefaultRecovery;
+  context->backoff_ms = kCanStm32DefaultRecovery.backoff_initial_ms;
+  context->bus_off_time_ms = 0;
+  context->recovered_time_ms = 0;
+  context->bus_off_irq_count = 0;
+  context->bus_off_irq_seen = 0;
+  context->tx_notify = false;
+  context->rx_fd_dropped = 0;
+  context->error_callback = 0;
+  context->error_user_arg = 0;
+  context->has_rx_irq = false;
+  context->rx_irqn = 0;
+  context->rx_irq_priority = 0;
+}
+
+void can_stm32_set_error_callback(CanStm32Context* context,
+                                  CanStm32ErrorCallback callback,
+                                  void* user_arg) {
+  context->error_callback = callback;
+  context->error_user_arg = user_arg;
+}
+
+void can_stm32_set_rx_irq_priority(CanStm32Context* context, int32_t irqn,
+                                   uint32_t priority) {
+  context->has_rx_irq = true;
+  context->rx_irqn = irqn;
+  context->rx_irq_priority = priority;
+}
+
+void can_stm32_set_recovery_policy(CanStm32Context* context,
+                                   const CanStm32RecoveryPolicy* policy) {
+  context->recovery = *policy;
+  context->backoff_ms = policy->backoff_initial_ms;
+}
+
+void can_stm32_update_error_state(CanStm32Context* context,
+                                  CanStm32ErrorState state,
+                                  CanStm32LastError last_error,
+                                  uint32_t now_ms) {
+  if (last_error != CAN_STM32_LEC_NONE) {
+    context->last_error = last_error;
+  }
+  if (state == context->error_state) {
+    return;
+  }
+
+  if (state == CAN_STM32_ERROR_BUS_OFF) {
+    const CanStm32RecoveryPolicy* policy = &context->recovery;
+    // 復帰してすぐ再びバスオフになるなら、原因が残っているので間隔を空ける
+    if (context->recovery_count > 0U &&
+        now_ms - context->recovered_time_ms < policy->stable_ms) {
+      context->backoff_ms = context->backoff_ms * 2U > policy->backoff_max_ms
+                                ? policy->backoff_max_ms
+                                : context->backoff_ms * 2U;
+    } else {
+      context->backoff_ms = policy->backoff_initial_ms;
+    }
+    context->bus_off_time_ms = now_ms;
+    context->bus_off_count++;
+  }
+  context->error_state = state;
+  if (context->error_callback != 0) {
+    context->error_callback(context, state, context->error_user_arg);
+  }
+}
+
+bool can_stm32_begin_recovery(CanStm32Context* context, uint32_t now_ms) {
+  if (!context->recovery.auto_recover ||
+      context->error_state != CAN_STM32_ERROR_BUS_OFF ||
+      now_ms - context->bus_off_time_ms < context->backoff_ms) {
+    return false;
+  }
+  context->bus_off_time_ms = now_ms;
+  context->recovered_time_ms = now_ms;
+  context->recovery_count++;
+  return true;
+}
+
+void can_stm32_enable_timestamp(CanStm32Context* context,
+                                uint32_t ns_per_tick) {
+  context->timestamp_ns_per_tick = ns_per_tick;
+  context->timestamp_last_raw = 0;
+  context->timestamp_ticks = 0;
+}
+
+uint32_t can_stm32_extend_timestamp(CanStm32Context* context, uint16_t raw) {
+  context->timestamp_ticks += (uint16_t)(raw - context->timestamp_last_raw);
+  context->timestamp_last_raw = raw;
+  return (uint32_t)(context->timestamp_ticks * context->timestamp_ns_per_tick /
+                    1000U);
+}
+
+CanStm32Filter can_stm32_filter_mask(uint32_t id, uint32_t mask,
+                                     uint32_t fifo) {
+  CanStm32Filter filter;
+  memset(&filter, 0, sizeof(filter));
+  filter.mode = CAN_STM32_FILTER_MASK;
+  filter.scale = CAN_STM32_FILTER_SCALE_32;
+  filter.values[0] = id;
+  filter.values[1] = mask;
+  filter.fifo = fifo;
+  return filter;
+}
+
+CanStm32Filter can_stm32_filter_list(uint32_t id1, uint32_t id2,
+                                     uint32_t fifo) {
+  CanStm32Filter filter = can_stm32_filter_mask(id1, id2, fifo);
+  filter.mode = CAN_STM32_FILTER_LIST;
+  return filter;
+}
+
+CanStm32Filter can_stm32_filter_mask16(uint32_t id1, uint32_t mask1,
+                                       uint32_t id2, uint32_t mask2,
+                                       uint32_t fifo) {
+  CanStm32Filter filter = can_stm32_filter_mask(id1, mask1, fifo);
+  filter.scale = CAN_STM32_FILTER_SCALE_16;
+  filter.values[2] = id2;
+  filter.values[3] = mask2;
+  return filter;
+}
+
+CanStm32Filter can_stm32_filter_list16(uint32_t id1, uint32_t id2,
+                                       uint32_t id3, uint32_t id4,
+                                       uint32_t fifo) {
+  CanStm32Filter filter = can_stm32_filter_mask16(id1, id2, id3, id4, fifo);
+  filter.mode = CAN_STM32_FILTER_LIST;
+  return filter;
+}
+
+// bxCAN の周辺機能 1 台で使うバンク数。両方の FIFO のフィルタと、フィルタの
+// 無い側へ残りを渡す全受信のバンクを数える。
+static uint32_t can_stm32_can_banks_needed(const CanStm32Context* context,
+                                           uint32_t extra) {
+  const CanStm32Context* sibling = can_stm32_sibling(context);
+  const uint32_t own = (uint32_t)context->filter_count + extra;
+  uint32_t banks = own;
+  bool catch_all = own == 0U;
+
+  if (sibling != 0) {
+    banks += sibling->filter_count;
+    catch_all = catch_all || sibling->filter_count == 0U;
+  }
+  return banks + (catch_all ? 1U : 0U);
+}
+
+// FDCAN で filter が使う標準 / 拡張 ID のフィルタ要素の数を counts に足す
+// （can_stm32_fdcan_add_filter の展開と同じ）
+static void can_stm32_fdcan_count_elements(const CanStm32Filter* filter,
+                                           uint32_t counts[2]) {
+  const uint32_t* v = filter->values;
+  uint32_t ids[2];
+  size_t id_count = 0;
+
+  ids[id_count++] = v[0];
+  if (filter->scale == CAN_STM32_FILTER_SCALE_16) {
+    ids[id_count++] = v[2];
+  } else if (filter->mode == CAN_STM32_FILTER_LIST &&
+             (v[0] > CAN_STD_ID_MAX) != (v[1] > CAN_STD_ID_MAX)) {
+    ids[id_count++] = v[1];
+  }
+  for (size_t i = 0; i < id_count; ++i) {
+    counts[ids[i] > CAN_STD_ID_MAX ? 1 : 0]++;
+  }
+}
+
+// 両方の FIFO のフィルタ（と extra）が FDCAN のフィルタ要素に収まるか
+static bool can_stm32_fdcan_filters_fit(const CanStm32Context* context,
+                                        const CanStm32Filter* extra) {
+  const CanStm32Context* sibling = can_stm32_sibling(context);
+  uint32_t capacity[2];
+  uint32_t counts[2] = {0, 0};
+
+  if (!can_stm32_fdcan_capacity(context, capacity)) {
+    return true;
+  }
+  for (uint8_t i = 0; i < context->filter_count; ++i) {
+    can_stm32_fdcan_count_elements(&context->filters[i], counts);
+  }
+  if (sibling != 0) {
+    for (uint8_t i = 0; i < sibling->filter_count; ++i) {
+      can_stm32_fdcan_count_elements(&sibling->filters[i], counts);
+    }
+  }
+  if (extra != 0) {
+    can_stm32_fdcan_count_elements(extra, counts);
+  }
+  return counts[0] <= capacity[0] && counts[1] <= capacity[1];
+}
+
+bool can_stm32_add_filter(CanStm32Context* context,
+                          const CanStm32Filter* filter) {
+  if (filter == 0 || context->filter_count >= CAN_STM32_MAX_FILTERS) {
+    return false;
+  }
+  if (context->kind == CAN_STM32_KIND_CAN &&
+      can_stm32_can_banks_needed(context, 1U) > CAN_STM32_CAN_FILTER_BANKS) {
+    return false;
+  }
+  if (context->kind == CAN_STM32_KIND_FDCAN &&
+      !can_stm32_fdcan_filters_fit(context, filter)) {
+    return false;
+  }
+  context->filters[context->filter_count++] = *filter;
+  return true;
+}
+
+void can_stm32_clear_filters(CanStm32Context* context) {
+  context->filter_count = 0;
+}
+
+bool can_stm32_set_filters_from_dispatcher(CanStm32Context* context,
+                                           const CanDispatcher* dispatcher) {
+  CanFilter filters[CAN_DISPATCH_MAX_RULES];
+  CanStm32Filter banks[CAN_STM32_MAX_FILTERS];
+  const CanFilter* pending_std = 0;
+  size_t bank_count = 0;
+  size_t count =
+      can_dispatcher_get_filters(dispatcher, filters, CAN_DISPATCH_MAX_RULES);
+
+  for (size_t i = 0; i < count; ++i) {
+    const CanFilter* filter = &filters[i];
+
+    if (filter->id <= CAN_STD_ID_MAX && pending_std == 0) {
+      pending_std = filter;
+      continue;
+    }
+    if (bank_count >= CAN_STM32_MAX_FILTERS) {
+      return false;
+    }
+    if (filter->id <= CAN_STD_ID_MAX) {
+      // 標準 ID は 16bit スケールで 2 組を 1 バンクにまとめる
+      banks[bank_count++] =
+          can_stm32_filter_mask16(pending_std->id, pending_std->mask,
+                                  filter->id, filter->mask, context->rx_fifo);
+      pending_std = 0;
+    } else {
+      banks[bank_count++] =
+          can_stm32_filter_mask(filter->id, filter->mask, context->rx_fifo);
+    }
+  }
+  if (pending_std != 0) {
+    if (bank_count >= CAN_STM32_MAX_FILTERS) {
+      return false;
+    }
+    banks[bank_count++] = can_stm32_filter_mask(
+        pending_std->id, pending_std->mask, context->rx_fifo);
+  }
+
+  memcpy(context->filters, banks, sizeof(banks[0]) * bank_count);
+  context->filter_count = (uint8_t)bank_count;
+  return true;
+}
+
 #ifdef OMURAISU_CAN_STM32_ENABLE
 #include OMURAISU_CAN_STM32_HAL_HEADER
 
+// エラー状態の変化（ワーニング・パッシブ・バスオフ）だけを割り込みにする。
+// LEC 割り込みはエラーフレームごとに入るため使わず、レジスタから読む。
+#define CAN_STM32_CAN_ERROR_IT \
+  (CAN_IT_ERROR_WARNING | CAN_IT_ERROR_PASSIVE | CAN_IT_BUSOFF | CAN_IT_ERROR)
+
+#ifdef OMURAISU_CAN_STM32_FDCAN_ENABLE
+#define CAN_STM32_FDCAN_ERROR_IT \
+  (FDCAN_IT_BUS_OFF | FDCAN_IT_ERROR_PASSIVE | FDCAN_IT_ERROR_WARNING)
+
+/// @brief 送信完了割り込みと、再起動時の送信要求の取り消しに使う送信バッファ
+///        （G4 は 3 つ）
+#ifndef CAN_STM32_FDCAN_TX_BUFFERS
+#define CAN_STM32_FDCAN_TX_BUFFERS \
+  (FDCAN_TX_BUFFER0 | FDCAN_TX_BUFFER1 | FDCAN_TX_BUFFER2)
+#endif
+#endif  // OMURAISU_CAN_STM32_FDCAN_ENABLE
+
 typedef struct {
-  CanStm32Context* context;
-} CanStm32Slot;
+  uint8_t tec;
+  uint8_t rec;
+  CanStm32ErrorState state;
+  CanStm32LastError last_error;
+} CanStm32HwError;
 
-static CanStm32Slot g_slots[OMURAISU_CAN_STM32_MAX_CONTEXTS];
+// bxCAN 1〜3 と FDCAN 1〜3
+#define CAN_STM32_PERIPHERAL_COUNT 6
 
-static CanStm32Context* can_stm32_find_context(void* handle) {
-  for (int i = 0; i < OMURAISU_CAN_STM32_MAX_CONTEXTS; ++i) {
-    if (g_slots[i].context != 0 && g_slots[i].context->handle == handle) {
-      return g_slots[i].context;
-    }
+// 周辺機能ごと・受信 FIFO ごとの登録先。割り込みからは Instance で直接引く。
+static CanStm32Context* g_contexts[CAN_STM32_PERIPHERAL_COUNT][2];
+
+// CAN_HandleTypeDef / FDCAN_HandleTypeDef はどちらも先頭メンバが Instance
+static int can_stm32_peripheral_index(const void* handle) {
+  const void* instance = 0;
+
+  if (handle == 0) {
+    return -1;
   }
-  return 0;
+  memcpy(&instance, handle, sizeof(instance));
+#if defined(CAN1)
+  if (instance == (const void*)CAN1) {
+    return 0;
+  }
+#elif defined(CAN)
+  if (instance == (const void*)CAN) {
+    return 0;
+  }
+#endif
+#ifdef CAN2
+  if (instance == (const void*)CAN2) {
+    return 1;
+  }
+#endif
+#ifdef CAN3
+  if (instance == (const void*)CAN3) {
+    return 2;
+  }
+#endif
+#ifdef OMURAISU_CAN_STM32_FDCAN_ENABLE
+#ifdef FDCAN1
+  if (instance == (const void*)FDCAN1) {
+    return 3;
+  }
+#endif
+#ifdef FDCAN2
+  if (instance == (const void*)FDCAN2) {
+    return 4;
+  }
+#endif
+#ifdef FDCAN3
+  if (instance == (const void*)FDCAN3) {
+    return 5;
+  }
+#endif
+#endif  // OMURAISU_CAN_STM32_FDCAN_ENABLE
+  return -1;
+}
+
+// rx_fifo は 0/1 のほか CAN_RX_FIFOx / FDCAN_RX_FIFOx（0x40/0x41）も受け付ける
+static uint32_t can_stm32_fifo_index(const CanStm32Context* context) {
+  return context->rx_fifo & 1U;
 }
 
+static CanStm32Context* can_stm32_find_context(void* handle, uint32_t fifo) {
+  const int index = can_stm32_peripheral_index(handle);
+  return index < 0 ? 0 : g_contexts[index][fifo & 1U];
+}
+
+static CanStm32Context* can_stm32_sibling(const CanStm32Context* context) {
+  const int index = can_stm32_peripheral_index(context->handle);
+  const uint32_t fifo = can_stm32_fifo_index(context);
+
+  if (index < 0 || g_contexts[index][fifo] != context) {
+    return 0;
+  }
+  return g_contexts[index][fifo ^ 1U];
+}
+
+static bool can_stm32_fdcan_capacity(const CanStm32Context* context,
+                                     uint32_t capacity[2]) {
 #ifdef OMURAISU_CAN_STM32_FDCAN_ENABLE
-static uint32_t can_stm32_fdcan_dlc_from_len(uint8_t len) {
-  switch (len) {
-    case 0:
-      return FDCAN_DLC_BYTES_0;
-    case 1:
-      return FDCAN_DLC_BYTES_1;
-    case 2:
-      return FDCAN_DLC_BYTES_2;
-    case 3:
-      return FDCAN_DLC_BYTES_3;
-    case 4:
-      return FDCAN_DLC_BYTES_4;
-    case 5:
-      return FDCAN_DLC_BYTES_5;
-    case 6:
-      return FDCAN_DLC_BYTES_6;
-    case 7:
-      return FDCAN_DLC_BYTES_7;
-    default:
-      return FDCAN_DLC_BYTES_8;
+  if (context->kind == CAN_STM32_KIND_FDCAN && context->handle != 0) {
+    const FDCAN_HandleTypeDef* hfdcan =
+        (const FDCAN_HandleTypeDef*)context->handle;
+    capacity[0] = hfdcan->Init.StdFiltersNbr;
+    capacity[1] = hfdcan->Init.ExtFiltersNbr;
+    return true;
   }
+#else
+  (void)context;
+  (void)capacity;
+#endif  // OMURAISU_CAN_STM32_FDCAN_ENABLE
+  return false;
+}
+
+#ifdef OMURAISU_CAN_STM32_FDCAN_ENABLE
+static uint32_t can_stm32_fdcan_dlc_from_len(uint8_t len) {
+  // HAL の DLC 定数はシリーズによってビット位置が異なるため定数で引く
+  static const uint32_t dlc_codes[16] = {
+      FDCAN_DLC_BYTES_0,  FDCAN_DLC_BYTES_1,  FDCAN_DLC_BYTES_2,
+      FDCAN_DLC_BYTES_3,  FDCAN_DLC_BYTES_4,  FDCAN_DLC_BYTES_5,
+      FDCAN_DLC_BYTES_6,  FDCAN_DLC_BYTES_7,  FDCAN_DLC_BYTES_8,
+      FDCAN_DLC_BYTES_12, FDCAN_DLC_BYTES_16, FDCAN_DLC_BYTES_20,
+      FDCAN_DLC_BYTES_24, FDCAN_DLC_BYTES_32, FDCAN_DLC_BYTES_48,
+      FDCAN_DLC_BYTES_64};
+  return dlc_codes[can_fd_len_to_dlc(len)];
 }
 
 static uint8_t can_stm32_len_from_fdcan_dlc(uint32_t dlc) {
@@ -70,6 +442,20 @@ static uint8_t can_stm32_len_from_fdcan_dlc(uint32_t dlc) {
       return 6;
     case FDCAN_DLC_BYTES_7:
       return 7;
+    case FDCAN_DLC_BYTES_12:
+      return 12;
+    case FDCAN_DLC_BYTES_16:
+      return 16;
+    case FDCAN_DLC_BYTES_20:
+      return 20;
+    case FDCAN_DLC_BYTES_24:
+      return 24;
+    case FDCAN_DLC_BYTES_32:
+      return 32;
+    case FDCAN_DLC_BYTES_48:
+      return 48;
+    case FDCAN_DLC_BYTES_64:
+      return 64;
     default:
       return 8;
   }
@@ -85,6 +471,10 @@ static bool can_stm32_can_write(void* self, const CanMessage* msg) {
   if (context->kind != CAN_STM32_KIND_CAN) {
     return false;
   }
+  // 3 つの送信メールボックスが埋まっている場合は CanCube の送信キューに任せる
+  if (HAL_CAN_GetTxMailboxesFreeLevel(hcan) == 0U) {
+    return false;
+  }
 
   memset(&header, 0, sizeof(header));
   header.DLC = msg->len > 8 ? 8 : msg->len;
@@ -110,12 +500,16 @@ static bool can_stm32_fdcan_write(void* self, const CanMessage* msg) {
   if (context->kind != CAN_STM32_KIND_FDCAN) {
     return false;
   }
+  if (HAL_FDCAN_GetTxFifoFreeLevel(hfdcan) == 0U) {
+    return false;
+  }
 
   memset(&header, 0, sizeof(header));
   header.Identifier = msg->id;
   header.IdType = msg->id <= 0x7FFU ? FDCAN_STANDARD_ID : FDCAN_EXTENDED_ID;
   header.TxFrameType = FDCAN_DATA_FRAME;
-  header.DataLength = can_stm32_fdcan_dlc_from_len(msg->len);
+  header.DataLength =
+      can_stm32_fdcan_dlc_from_len(msg->len > 8U ? 8U : msg->len);
   header.ErrorStateIndicator = FDCAN_ESI_ACTIVE;
   header.BitRateSwitch = FDCAN_BRS_OFF;
   header.FDFormat = FDCAN_CLASSIC_CAN;
@@ -125,6 +519,44 @@ static bool can_stm32_fdcan_write(void* self, const CanMessage* msg) {
   return HAL_FDCAN_AddMessageToTxFifoQ(hfdcan, &header,
                                        (uint8_t*)msg->data) == HAL_OK;
 }
+
+static bool can_stm32_fdcan_write_fd(CanStm32Context* context,
+                                     const CanFdMessage* msg) {
+  FDCAN_HandleTypeDef* hfdcan = (FDCAN_HandleTypeDef*)context->handle;
+  FDCAN_TxHeaderTypeDef header;
+  uint8_t data[CAN_FD_MAX_DATA_LEN];
+  bool fd_format = (msg->flags & CAN_FD_FLAG_FDF) != 0U;
+  uint8_t len = msg->len;
+
+  if (HAL_FDCAN_GetTxFifoFreeLevel(hfdcan) == 0U) {
+    return false;
+  }
+  if (len > CAN_FD_MAX_DATA_LEN) {
+    len = CAN_FD_MAX_DATA_LEN;
+  }
+  if (!fd_format && len > 8U) {
+    return false;
+  }
+
+  // DLC の刻みに合わせて切り上げた分は 0 で埋める（HAL は DLC 分だけ読む）
+  memset(data, 0, sizeof(data));
+  memcpy(data, msg->data, len);
+
+  memset(&header, 0, sizeof(header));
+  header.Identifier = msg->id;
+  header.IdType = msg->id <= 0x7FFU ? FDCAN_STANDARD_ID : FDCAN_EXTENDED_ID;
+  header.TxFrameType = FDCAN_DATA_FRAME;
+  header.DataLength = can_stm32_fdcan_dlc_from_len(len);
+  header.ErrorStateIndicator = FDCAN_ESI_ACTIVE;
+  header.BitRateSwitch = fd_format && (msg->flags & CAN_FD_FLAG_BRS) != 0U
+                             ? FDCAN_BRS_ON
+                             : FDCAN_BRS_OFF;
+  header.FDFormat = fd_format ? FDCAN_FD_CAN : FDCAN_CLASSIC_CAN;
+  header.TxEventFifoControl = FDCAN_NO_TX_EVENTS;
+  header.MessageMarker = 0;
+
+  return HAL_FDCAN_AddMessageToTxFifoQ(hfdcan, &header, data) == HAL_OK;
+}
 #endif  // OMURAISU_CAN_STM32_FDCAN_ENABLE
 
 static bool can_stm32_write(void* self, const CanMessage* msg) {
@@ -143,44 +575,125 @@ static bool can_stm32_write(void* self, const CanMessage* msg) {
   return false;
 }
 
+static bool can_stm32_write_fd(void* self, const CanFdMessage* msg) {
+  CanStm32Context* context = (CanStm32Context*)self;
+  CanMessage classic;
+
+#ifdef OMURAISU_CAN_STM32_FDCAN_ENABLE
+  if (context->kind == CAN_STM32_KIND_FDCAN) {
+    return can_stm32_fdcan_write_fd(context, msg);
+  }
+#endif  // OMURAISU_CAN_STM32_FDCAN_ENABLE
+
+  // bxCAN は FD 非対応のため従来フレームで表せるものだけ送る
+  if (context->kind != CAN_STM32_KIND_CAN ||
+      !can_fd_message_to_classic(&classic, msg)) {
+    return false;
+  }
+  return can_stm32_can_write(self, &classic);
+}
+
 static bool can_stm32_read_common_can(CanStm32Context* context,
                                       CanMessage* msg) {
   CAN_HandleTypeDef* hcan = (CAN_HandleTypeDef*)context->handle;
   CAN_RxHeaderTypeDef header;
 
-  if (HAL_CAN_GetRxFifoFillLevel(hcan, context->rx_fifo) == 0U) {
+  const uint32_t fifo =
+      can_stm32_fifo_index(context) == 0U ? CAN_RX_FIFO0 : CAN_RX_FIFO1;
+
+  if (HAL_CAN_GetRxFifoFillLevel(hcan, fifo) == 0U) {
     return false;
   }
 
-  if (HAL_CAN_GetRxMessage(hcan, context->rx_fifo, &header, msg->data) !=
-      HAL_OK) {
+  if (HAL_CAN_GetRxMessage(hcan, fifo, &header, msg->data) != HAL_OK) {
     return false;
   }
 
   msg->id = header.IDE == CAN_ID_STD ? header.StdId : header.ExtId;
   msg->len = header.DLC > 8U ? 8U : (uint8_t)header.DLC;
+  msg->flags = 0;
+  if (context->timestamp_ns_per_tick != 0U) {
+    msg->flags |= CAN_MSG_FLAG_TIMESTAMP;
+    msg->timestamp_us =
+        can_stm32_extend_timestamp(context, (uint16_t)header.Timestamp);
+  }
   return true;
 }
 
 #ifdef OMURAISU_CAN_STM32_FDCAN_ENABLE
 static bool can_stm32_read_common_fdcan(CanStm32Context* context,
-                                        CanMessage* msg) {
+                                        CanFdMessage* msg) {
   FDCAN_HandleTypeDef* hfdcan = (FDCAN_HandleTypeDef*)context->handle;
   FDCAN_RxHeaderTypeDef header;
 
-  if (HAL_FDCAN_GetRxFifoFillLevel(hfdcan, context->rx_fifo) == 0U) {
+  const uint32_t fifo =
+      can_stm32_fifo_index(context) == 0U ? FDCAN_RX_FIFO0 : FDCAN_RX_FIFO1;
+
+  if (HAL_FDCAN_GetRxFifoFillLevel(hfdcan, fifo) == 0U) {
     return false;
   }
 
-  if (HAL_FDCAN_GetRxMessage(hfdcan, context->rx_fifo, &header, msg->data) !=
-      HAL_OK) {
+  // FD フレームは最大 64 バイト書き込まれるため必ず FD 用のバッファで受ける
+  if (HAL_FDCAN_GetRxMessage(hfdcan, fifo, &header, msg->data) != HAL_OK) {
     return false;
   }
 
   msg->id = header.Identifier;
   msg->len = can_stm32_len_from_fdcan_dlc(header.DataLength);
+  msg->flags = 0;
+  if (header.FDFormat == FDCAN_FD_CAN) {
+    msg->flags |= CAN_FD_FLAG_FDF;
+  }
+  if (header.BitRateSwitch == FDCAN_BRS_ON) {
+    msg->flags |= CAN_FD_FLAG_BRS;
+  }
+  if (context->timestamp_ns_per_tick != 0U) {
+    msg->flags |= CAN_MSG_FLAG_TIMESTAMP;
+    msg->timestamp_us =
+        can_stm32_extend_timestamp(context, (uint16_t)header.RxTimestamp);
+  }
   return true;
 }
+
+// 従来フレームだけを CanMessage へ受ける（FD フレームは数えて読み捨てる）
+static bool can_stm32_read_fdcan_classic(CanStm32Context* context,
+                                         CanMessage* msg) {
+  FDCAN_HandleTypeDef* hfdcan = (FDCAN_HandleTypeDef*)context->handle;
+  FDCAN_RxHeaderTypeDef header;
+  uint8_t fd_data[CAN_FD_MAX_DATA_LEN];
+
+  const uint32_t fifo =
+      can_stm32_fifo_index(context) == 0U ? FDCAN_RX_FIFO0 : FDCAN_RX_FIFO1;
+  // FrameFormat が従来フォーマットなら 8 バイトまでしか書き込まれないので
+  // スロットへ直接受ける。FD を受けうる設定では最大 64 バイトに備える
+  const bool classic_only = hfdcan->Init.FrameFormat == FDCAN_FRAME_CLASSIC;
+  uint8_t* data = classic_only ? msg->data : fd_data;
+
+  while (HAL_FDCAN_GetRxFifoFillLevel(hfdcan, fifo) > 0U) {
+    if (HAL_FDCAN_GetRxMessage(hfdcan, fifo, &header, data) != HAL_OK) {
+      return false;
+    }
+
+    const uint8_t len = can_stm32_len_from_fdcan_dlc(header.DataLength);
+    if (header.FDFormat == FDCAN_FD_CAN || len > 8U) {
+      context->rx_fd_dropped++;
+      continue;
+    }
+    if (!classic_only) {
+      memcpy(msg->data, fd_data, len);
+    }
+    msg->id = header.Identifier;
+    msg->len = len;
+    msg->flags = 0;
+    if (context->timestamp_ns_per_tick != 0U) {
+      msg->flags |= CAN_MSG_FLAG_TIMESTAMP;
+      msg->timestamp_us =
+          can_stm32_extend_timestamp(context, (uint16_t)header.RxTimestamp);
+    }
+    return true;
+  }
+  return false;
+}
 #endif  // OMURAISU_CAN_STM32_FDCAN_ENABLE
 
 static bool can_stm32_read_hw(void* self, CanMessage* msg) {
@@ -192,58 +705,344 @@ static bool can_stm32_read_hw(void* self, CanMessage* msg) {
 
 #ifdef OMURAISU_CAN_STM32_FDCAN_ENABLE
   if (context->kind == CAN_STM32_KIND_FDCAN) {
-    return can_stm32_read_common_fdcan(context, msg);
+    return can_stm32_read_fdcan_classic(context, msg);
   }
 #endif  // OMURAISU_CAN_STM32_FDCAN_ENABLE
 
   return false;
 }
 
-static void can_stm32_start_read(void* self) {
+static bool can_stm32_read_hw_fd(void* self, CanFdMessage* msg) {
   CanStm32Context* context = (CanStm32Context*)self;
+  CanMessage classic;
 
-  if (context->kind == CAN_STM32_KIND_CAN) {
-    CAN_HandleTypeDef* hcan = (CAN_HandleTypeDef*)context->handle;
-    uint32_t it_mask = context->rx_fifo == 0U ? CAN_IT_RX_FIFO0_MSG_PENDING
-                                              : CAN_IT_RX_FIFO1_MSG_PENDING;
+#ifdef OMURAISU_CAN_STM32_FDCAN_ENABLE
+  if (context->kind == CAN_STM32_KIND_FDCAN) {
+    return can_stm32_read_common_fdcan(context, msg);
+  }
+#endif  // OMURAISU_CAN_STM32_FDCAN_ENABLE
+
+  if (context->kind != CAN_STM32_KIND_CAN ||
+      !can_stm32_read_common_can(context, &classic)) {
+    return false;
+  }
+  can_fd_message_from_classic(msg, &classic);
+  return true;
+}
+
+// bxCAN フィルタレジスタ（32bit）: STID[31:21] EXID[20:3] IDE[2] RTR[1]
+static uint32_t can_stm32_can_filter_id32(uint32_t id) {
+  if (id > CAN_STD_ID_MAX) {
+    return (id << 3) | CAN_ID_EXT;
+  }
+  return id << 21;
+}
+
+static uint32_t can_stm32_can_filter_mask32(uint32_t id, uint32_t mask) {
+  // IDE / RTR も照合し、標準/拡張の取り違えとリモートフレームを除く
+  if (id > CAN_STD_ID_MAX) {
+    return (mask << 3) | CAN_ID_EXT | CAN_RTR_REMOTE;
+  }
+  return (mask << 21) | CAN_ID_EXT | CAN_RTR_REMOTE;
+}
+
+// bxCAN フィルタレジスタ（16bit）: STID[15:5] RTR[4] IDE[3] EXID[2:0]
+static uint32_t can_stm32_can_filter_id16(uint32_t id) {
+  return (id & CAN_STD_ID_MAX) << 5;
+}
+
+static uint32_t can_stm32_can_filter_mask16(uint32_t mask) {
+  return ((mask & CAN_STD_ID_MAX) << 5) | 0x18U;
+}
+
+static void can_stm32_can_config_bank(CAN_HandleTypeDef* hcan,
+                                      const CanStm32Filter* filter,
+                                      uint32_t bank) {
+  const uint32_t* v = filter->values;
+  CAN_FilterTypeDef can_filter = {0};
+  uint32_t id_reg = 0;
+  uint32_t mask_reg = 0;
+
+  if (filter->scale == CAN_STM32_FILTER_SCALE_16) {
+    can_filter.FilterScale = CAN_FILTERSCALE_16BIT;
+    if (filter->mode == CAN_STM32_FILTER_MASK) {
+      can_filter.FilterMode = CAN_FILTERMODE_IDMASK;
+      can_filter.FilterIdLow = can_stm32_can_filter_id16(v[0]);
+      can_filter.FilterMaskIdLow = can_stm32_can_filter_mask16(v[1]);
+      can_filter.FilterIdHigh = can_stm32_can_filter_id16(v[2]);
+      can_filter.FilterMaskIdHigh = can_stm32_can_filter_mask16(v[3]);
+    } else {
+      can_filter.FilterMode = CAN_FILTERMODE_IDLIST;
+      can_filter.FilterIdLow = can_stm32_can_filter_id16(v[0]);
+      can_filter.FilterMaskIdLow = can_stm32_can_filter_id16(v[1]);
+      can_filter.FilterIdHigh = can_stm32_can_filter_id16(v[2]);
+      can_filter.FilterMaskIdHigh = can_stm32_can_filter_id16(v[3]);
+    }
+  } else {
+    can_filter.FilterScale = CAN_FILTERSCALE_32BIT;
+    id_reg = can_stm32_can_filter_id32(v[0]);
+    if (filter->mode == CAN_STM32_FILTER_MASK) {
+      can_filter.FilterMode = CAN_FILTERMODE_IDMASK;
+      mask_reg = can_stm32_can_filter_mask32(v[0], v[1]);
+    } else {
+      can_filter.FilterMode = CAN_FILTERMODE_IDLIST;
+      mask_reg = can_stm32_can_filter_id32(v[1]);
+    }
+    can_filter.FilterIdHigh = id_reg >> 16;
+    can_filter.FilterIdLow = id_reg & 0xFFFFU;
+    can_filter.FilterMaskIdHigh = mask_reg >> 16;
+    can_filter.FilterMaskIdLow = mask_reg & 0xFFFFU;
+  }
+
+  can_filter.FilterFIFOAssignment =
+      (filter->fifo & 1U) == 0U ? CAN_FILTER_FIFO0 : CAN_FILTER_FIFO1;
+  can_filter.FilterActivation = ENABLE;
+  can_filter.SlaveStartFilterBank = CAN_STM32_CAN_FILTER_BANKS;
+  can_filter.FilterBank = bank;
+  HAL_CAN_ConfigFilter(hcan, &can_filter);
+}
+
+// 同じ周辺機能に登録された FIFO0 / FIFO1 のコンテキスト（FIFO 番号順）
+static size_t can_stm32_peripheral_contexts(CanStm32Context* context,
+                                            CanStm32Context* contexts[2]) {
+  CanStm32Context* sibling = can_stm32_sibling(context);
+
+  if (sibling == 0) {
+    contexts[0] = context;
+    return 1U;
+  }
+  contexts[0] = can_stm32_fifo_index(context) == 0U ? context : sibling;
+  contexts[1] = can_stm32_fifo_index(context) == 0U ? sibling : context;
+  return 2U;
+}
+
+// 両方の FIFO のフィルタを続き番号のバンクに設定する。フィルタを持たない
+// コンテキストには、他のどのフィルタにも一致しなかったフレームを渡す。
+// この周辺機能のバンクに収まらない場合は何も設定せず false を返す（超えた分が
+// CAN2 のバンクを上書きしないように）。
+static bool can_stm32_can_config_filters(CanStm32Context* context,
+                                         CAN_HandleTypeDef* hcan) {
+  CanStm32Context* contexts[2];
+  const size_t count = can_stm32_peripheral_contexts(context, contexts);
+  const CanStm32Context* catch_all = 0;
+  uint32_t bank = 0U;
+
+  if (can_stm32_can_banks_needed(context, 0U) > CAN_STM32_CAN_FILTER_BANKS) {
+    return false;
+  }
+#ifdef CAN2
+  if (hcan->Instance == CAN2) {
+    bank = CAN_STM32_CAN_FILTER_BANKS;
+  }
+#endif
+
+  for (size_t c = 0; c < count; ++c) {
+    if (contexts[c]->filter_count == 0U) {
+      if (catch_all == 0) {
+        catch_all = contexts[c];
+      }
+      continue;
+    }
+    for (uint8_t i = 0; i < contexts[c]->filter_count; ++i) {
+      can_stm32_can_config_bank(hcan, &contexts[c]->filters[i], bank++);
+    }
+  }
+
+  if (catch_all != 0) {
+    // 全ビット無視の 16bit マスクを最後のバンクに置く。bxCAN は 32bit、
+    // リスト、番号の小さいバンクの順に優先するため、他のフィルタに一致した
+    // フレームはそちらの FIFO へ入る。
     CAN_FilterTypeDef can_filter = {0};
     can_filter.FilterMode = CAN_FILTERMODE_IDMASK;
-    can_filter.FilterScale = CAN_FILTERSCALE_32BIT;
-    can_filter.FilterIdHigh = 0x0000;
-    can_filter.FilterIdLow = 0x0000;
-    can_filter.FilterMaskIdHigh = 0x0000;
-    can_filter.FilterMaskIdLow = 0x0000;
-    can_filter.FilterFIFOAssignment = CAN_FILTER_FIFO0;
+    can_filter.FilterScale = CAN_FILTERSCALE_16BIT;
+    can_filter.FilterFIFOAssignment = can_stm32_fifo_index(catch_all) == 0U
+                                          ? CAN_FILTER_FIFO0
+                                          : CAN_FILTER_FIFO1;
     can_filter.FilterActivation = ENABLE;
-    can_filter.SlaveStartFilterBank = 14;
+    can_filter.SlaveStartFilterBank = CAN_STM32_CAN_FILTER_BANKS;
+    can_filter.FilterBank = bank;
+    HAL_CAN_ConfigFilter(hcan, &can_filter);
+  }
+  return true;
+}
 
-    if (hcan->Instance == CAN1) {
-      can_filter.FilterBank = 0;
-    } else {
-      can_filter.FilterBank = 14;
+#ifdef OMURAISU_CAN_STM32_FDCAN_ENABLE
+typedef struct {
+  uint32_t std_index;
+  uint32_t ext_index;
+} CanStm32FdcanFilterIndex;
+
+static bool can_stm32_fdcan_add_element(FDCAN_HandleTypeDef* hfdcan,
+                                        CanStm32FdcanFilterIndex* index,
+                                        uint32_t type, uint32_t id1,
+                                        uint32_t id2, uint32_t fifo) {
+  FDCAN_FilterTypeDef element;
+  bool extended = id1 > CAN_STD_ID_MAX;
+
+  memset(&element, 0, sizeof(element));
+  if (extended) {
+    if (index->ext_index >= hfdcan->Init.ExtFiltersNbr) {
+      return false;
+    }
+    element.IdType = FDCAN_EXTENDED_ID;
+    element.FilterIndex = index->ext_index++;
+  } else {
+    if (index->std_index >= hfdcan->Init.StdFiltersNbr) {
+      return false;
+    }
+    element.IdType = FDCAN_STANDARD_ID;
+    element.FilterIndex = index->std_index++;
+  }
+  element.FilterType = type;
+  element.FilterConfig =
+      fifo == 0U ? FDCAN_FILTER_TO_RXFIFO0 : FDCAN_FILTER_TO_RXFIFO1;
+  element.FilterID1 = id1;
+  element.FilterID2 = id2;
+  return HAL_FDCAN_ConfigFilter(hfdcan, &element) == HAL_OK;
+}
+
+static bool can_stm32_fdcan_add_filter(FDCAN_HandleTypeDef* hfdcan,
+                                       CanStm32FdcanFilterIndex* index,
+                                       const CanStm32Filter* filter) {
+  const uint32_t* v = filter->values;
+  const uint32_t fifo = filter->fifo & 1U;
+  bool ok = true;
+
+  if (filter->mode == CAN_STM32_FILTER_MASK) {
+    ok = can_stm32_fdcan_add_element(hfdcan, index, FDCAN_FILTER_MASK, v[0],
+                                     v[1], fifo);
+    if (filter->scale == CAN_STM32_FILTER_SCALE_16) {
+      ok = can_stm32_fdcan_add_element(hfdcan, index, FDCAN_FILTER_MASK, v[2],
+                                       v[3], fifo) &&
+           ok;
     }
+  } else if (filter->scale == CAN_STM32_FILTER_SCALE_16) {
+    ok = can_stm32_fdcan_add_element(hfdcan, index, FDCAN_FILTER_DUAL, v[0],
+                                     v[1], fifo);
+    ok = can_stm32_fdcan_add_element(hfdcan, index, FDCAN_FILTER_DUAL, v[2],
+                                     v[3], fifo) &&
+         ok;
+  } else if ((v[0] > CAN_STD_ID_MAX) == (v[1] > CAN_STD_ID_MAX)) {
+    ok = can_stm32_fdcan_add_element(hfdcan, index, FDCAN_FILTER_DUAL, v[0],
+                                     v[1], fifo);
+  } else {
+    // DUAL 要素は同じ ID 種別の組しか持てないため分ける
+    ok = can_stm32_fdcan_add_element(hfdcan, index, FDCAN_FILTER_DUAL, v[0],
+                                     v[0], fifo);
+    ok = can_stm32_fdcan_add_element(hfdcan, index, FDCAN_FILTER_DUAL, v[1],
+                                     v[1], fifo) &&
+         ok;
+  }
+  return ok;
+}
+
+// 両方の FIFO のフィルタ要素を設定する。フィルタを持たないコンテキストには
+// グローバルフィルタで、どの要素にも一致しなかったフレームを渡す。
+// 確保された要素数に収まらない場合は何も設定せず false を返す（溢れた ID を
+// グローバルフィルタが捨てないように）。HAL が設定を拒んだ場合も false。
+static bool can_stm32_fdcan_config_filters(CanStm32Context* context,
+                                           FDCAN_HandleTypeDef* hfdcan) {
+  CanStm32Context* contexts[2];
+  const size_t count = can_stm32_peripheral_contexts(context, contexts);
+  const CanStm32Context* catch_all = 0;
+  CanStm32FdcanFilterIndex index = {0, 0};
+  uint32_t non_matching = FDCAN_REJECT;
+  bool ok = true;
+
+  if (!can_stm32_fdcan_filters_fit(context, 0)) {
+    return false;
+  }
+
+  for (size_t c = 0; c < count; ++c) {
+    if (contexts[c]->filter_count == 0U && catch_all == 0) {
+      catch_all = contexts[c];
+    }
+    for (uint8_t i = 0; i < contexts[c]->filter_count; ++i) {
+      ok = can_stm32_fdcan_add_filter(hfdcan, &index,
+                                      &contexts[c]->filters[i]) &&
+           ok;
+    }
+  }
 
-    HAL_CAN_ConfigFilter (hcan, &can_filter);
+  if (catch_all != 0) {
+    non_matching = can_stm32_fifo_index(catch_all) == 0U
+                       ? FDCAN_ACCEPT_IN_RX_FIFO0
+                       : FDCAN_ACCEPT_IN_RX_FIFO1;
+  }
+  return HAL_FDCAN_ConfigGlobalFilter(hfdcan, non_matching, non_matching,
+                                      FDCAN_REJECT_REMOTE,
+                                      FDCAN_REJECT_REMOTE) == HAL_OK &&
+         ok;
+}
+#endif  // OMURAISU_CAN_STM32_FDCAN_ENABLE
+
+static uint32_t can_stm32_can_rx_it(const CanStm32Context* context) {
+  return can_stm32_fifo_index(context) == 0U ? CAN_IT_RX_FIFO0_MSG_PENDING
+                                             : CAN_IT_RX_FIFO1_MSG_PENDING;
+}
+
+#ifdef OMURAISU_CAN_STM32_FDCAN_ENABLE
+static uint32_t can_stm32_fdcan_rx_it(const CanStm32Context* context) {
+  return can_stm32_fifo_index(context) == 0U ? FDCAN_IT_RX_FIFO0_NEW_MESSAGE
+                                             : FDCAN_IT_RX_FIFO1_NEW_MESSAGE;
+}
+#endif  // OMURAISU_CAN_STM32_FDCAN_ENABLE
+
+static void can_stm32_start_read(void* self) {
+  CanStm32Context* context = (CanStm32Context*)self;
+
+  if (context->has_rx_irq) {
+    HAL_NVIC_SetPriority((IRQn_Type)context->rx_irqn,
+                         context->rx_irq_priority, 0U);
+  }
+
+  // フィルタは同じ周辺機能のもう一方の FIFO の分もまとめて設定する。
+  // bxCAN は動作中でもフィルタを変えられるため、2 つ目の start_read では
+  // Start が既に動作中としてエラーを返すだけ。
+  context->filter_error = false;
+  if (context->kind == CAN_STM32_KIND_CAN) {
+    CAN_HandleTypeDef* hcan = (CAN_HandleTypeDef*)context->handle;
+    if (!can_stm32_can_config_filters(context, hcan)) {
+      context->filter_error = true;
+      return;
+    }
     HAL_CAN_Start(hcan);
-    HAL_CAN_ActivateNotification(hcan, it_mask);
+    HAL_CAN_ActivateNotification(
+        hcan, can_stm32_can_rx_it(context) | CAN_STM32_CAN_ERROR_IT);
     return;
   }
 
 #ifdef OMURAISU_CAN_STM32_FDCAN_ENABLE
   if (context->kind == CAN_STM32_KIND_FDCAN) {
     FDCAN_HandleTypeDef* hfdcan = (FDCAN_HandleTypeDef*)context->handle;
-    uint32_t it_mask = context->rx_fifo == 0U ? FDCAN_IT_RX_FIFO0_NEW_MESSAGE
-                                              : FDCAN_IT_RX_FIFO1_NEW_MESSAGE;
-    FDCAN_FilterTypeDef sFilter;
-    sFilter.IdType       = FDCAN_STANDARD_ID;
-    sFilter.FilterIndex  = 0;
-    sFilter.FilterType   = FDCAN_FILTER_MASK;
-    sFilter.FilterConfig = FDCAN_FILTER_TO_RXFIFO0;
-    sFilter.FilterID1    = 0x000;
-    sFilter.FilterID2    = 0x000;
-    HAL_FDCAN_ConfigFilter(hfdcan, &sFilter);
+    bool ok = true;
+
+    // グローバルフィルタとタイムスタンプカウンタは停止中（READY）でしか
+    // 設定できないため、2 つ目の start_read では一度止めて設定し直す
+    if (HAL_FDCAN_GetState(hfdcan) == HAL_FDCAN_STATE_BUSY) {
+      ok = HAL_FDCAN_Stop(hfdcan) == HAL_OK;
+    }
+
+    // FIFO を分けた場合は FIFO1 を割り込みライン 1 に移し、別の優先度にする
+    if (ok && can_stm32_sibling(context) != 0) {
+      ok = HAL_FDCAN_ConfigInterruptLines(hfdcan, FDCAN_IT_GROUP_RX_FIFO1,
+                                          FDCAN_INTERRUPT_LINE1) == HAL_OK;
+    }
+
+    // タイムスタンプカウンタとフィルタの設定は HAL_FDCAN_Start の前に行う
+    if (ok && context->timestamp_ns_per_tick != 0U) {
+      ok = HAL_FDCAN_ConfigTimestampCounter(hfdcan, FDCAN_TIMESTAMP_PRESC_1) ==
+               HAL_OK &&
+           HAL_FDCAN_EnableTimestampCounter(hfdcan, FDCAN_TIMESTAMP_INTERNAL) ==
+               HAL_OK;
+    }
+    if (!ok || !can_stm32_fdcan_config_filters(context, hfdcan)) {
+      context->filter_error = true;
+      return;
+    }
     HAL_FDCAN_Start(hfdcan);
-    HAL_FDCAN_ActivateNotification(hfdcan, it_mask, 0U);
+    HAL_FDCAN_ActivateNotification(
+        hfdcan, can_stm32_fdcan_rx_it(context) | CAN_STM32_FDCAN_ERROR_IT, 0U);
   }
 #endif  // OMURAISU_CAN_STM32_FDCAN_ENABLE
 }
@@ -253,9 +1052,13 @@ static void can_stm32_stop_read(void* self) {
 
   if (context->kind == CAN_STM32_KIND_CAN) {
     CAN_HandleTypeDef* hcan = (CAN_HandleTypeDef*)context->handle;
-    uint32_t it_mask = context->rx_fifo == 0U ? CAN_IT_RX_FIFO0_MSG_PENDING
-                                              : CAN_IT_RX_FIFO1_MSG_PENDING;
-    HAL_CAN_DeactivateNotification(hcan, it_mask);
+    uint32_t it_mask = can_stm32_can_rx_it(context);
+    // もう一方の FIFO が使っている間はコントローラを止めない
+    if (can_stm32_sibling(context) != 0) {
+      HAL_CAN_DeactivateNotification(hcan, it_mask);
+      return;
+    }
+    HAL_CAN_DeactivateNotification(hcan, it_mask | CAN_STM32_CAN_ERROR_IT);
     HAL_CAN_Stop(hcan);
     return;
   }
@@ -263,21 +1066,168 @@ static void can_stm32_stop_read(void* self) {
 #ifdef OMURAISU_CAN_STM32_FDCAN_ENABLE
   if (context->kind == CAN_STM32_KIND_FDCAN) {
     FDCAN_HandleTypeDef* hfdcan = (FDCAN_HandleTypeDef*)context->handle;
-    uint32_t it_mask = context->rx_fifo == 0U ? FDCAN_IT_RX_FIFO0_NEW_MESSAGE
-                                              : FDCAN_IT_RX_FIFO1_NEW_MESSAGE;
-    HAL_FDCAN_DeactivateNotification(hfdcan, it_mask);
+    uint32_t it_mask = can_stm32_fdcan_rx_it(context);
+    if (can_stm32_sibling(context) != 0) {
+      HAL_FDCAN_DeactivateNotification(hfdcan, it_mask);
+      return;
+    }
+    HAL_FDCAN_DeactivateNotification(hfdcan,
+                                     it_mask | CAN_STM32_FDCAN_ERROR_IT);
     HAL_FDCAN_Stop(hfdcan);
   }
 #endif  // OMURAISU_CAN_STM32_FDCAN_ENABLE
 }
 
-void can_stm32_context_init(CanStm32Context* context, CanCube* cube,
-                            void* handle, CanStm32Kind kind,
-                            uint32_t rx_fifo) {
-  context->cube = cube;
-  context->handle = handle;
-  context->kind = kind;
-  context->rx_fifo = rx_fifo;
+static void can_stm32_set_tx_notify(void* self, bool enable) {
+  CanStm32Context* context = (CanStm32Context*)self;
+  CanStm32Context* sibling = can_stm32_sibling(context);
+
+  // 無効化は常にこのコンテキストへ即座に効かせる（can_stm32_dispatch_tx は
+  // tx_notify が false のキューに触れない）。送信完了割り込みは周辺機能で
+  // 1 つなので、ハードウェアはどちらかのコンテキストが要求していれば有効にする
+  context->tx_notify = enable;
+  enable = enable || (sibling != 0 && sibling->tx_notify);
+
+  if (context->kind == CAN_STM32_KIND_CAN) {
+    CAN_HandleTypeDef* hcan = (CAN_HandleTypeDef*)context->handle;
+    if (enable) {
+      HAL_CAN_ActivateNotification(hcan, CAN_IT_TX_MAILBOX_EMPTY);
+    } else {
+      HAL_CAN_DeactivateNotification(hcan, CAN_IT_TX_MAILBOX_EMPTY);
+    }
+    return;
+  }
+
+#ifdef OMURAISU_CAN_STM32_FDCAN_ENABLE
+  if (context->kind == CAN_STM32_KIND_FDCAN) {
+    FDCAN_HandleTypeDef* hfdcan = (FDCAN_HandleTypeDef*)context->handle;
+    if (enable) {
+      // FIFO が空になるまで待たず、送信バッファが 1 つ空くごとに補充する
+      HAL_FDCAN_ActivateNotification(hfdcan, FDCAN_IT_TX_COMPLETE,
+                                     CAN_STM32_FDCAN_TX_BUFFERS);
+    } else {
+      HAL_FDCAN_DeactivateNotification(hfdcan, FDCAN_IT_TX_COMPLETE);
+    }
+  }
+#endif  // OMURAISU_CAN_STM32_FDCAN_ENABLE
+}
+
+static CanStm32LastError can_stm32_last_error(uint32_t lec) {
+  // 7 は「前回から変化なし」（FDCAN）/ ソフトウェアが書き込んだ値（bxCAN）
+  return lec <= (uint32_t)CAN_STM32_LEC_CRC ? (CanStm32LastError)lec
+                                            : CAN_STM32_LEC_NONE;
+}
+
+static bool can_stm32_read_hw_error(CanStm32Context* context,
+                                    CanStm32HwError* error) {
+  memset(error, 0, sizeof(*error));
+
+  if (context->kind == CAN_STM32_KIND_CAN) {
+    CAN_HandleTypeDef* hcan = (CAN_HandleTypeDef*)context->handle;
+    uint32_t esr = hcan->Instance->ESR;
+    error->tec = (uint8_t)((esr & CAN_ESR_TEC) >> CAN_ESR_TEC_Pos);
+    error->rec = (uint8_t)((esr & CAN_ESR_REC) >> CAN_ESR_REC_Pos);
+    error->last_error =
+        can_stm32_last_error((esr & CAN_ESR_LEC) >> CAN_ESR_LEC_Pos);
+    if ((esr & CAN_ESR_BOFF) != 0U) {
+      error->state = CAN_STM32_ERROR_BUS_OFF;
+    } else if ((esr & CAN_ESR_EPVF) != 0U) {
+      error->state = CAN_STM32_ERROR_PASSIVE;
+    } else if ((esr & CAN_ESR_EWGF) != 0U) {
+      error->state = CAN_STM32_ERROR_WARNING;
+    }
+    return true;
+  }
+
+#ifdef OMURAISU_CAN_STM32_FDCAN_ENABLE
+  if (context->kind == CAN_STM32_KIND_FDCAN) {
+    FDCAN_HandleTypeDef* hfdcan = (FDCAN_HandleTypeDef*)context->handle;
+    FDCAN_ErrorCountersTypeDef counters;
+    FDCAN_ProtocolStatusTypeDef status;
+
+    if (HAL_FDCAN_GetErrorCounters(hfdcan, &counters) != HAL_OK ||
+        HAL_FDCAN_GetProtocolStatus(hfdcan, &status) != HAL_OK) {
+      return false;
+    }
+    error->tec = (uint8_t)counters.TxErrorCnt;
+    error->rec = (uint8_t)counters.RxErrorCnt;
+    error->last_error = can_stm32_last_error(status.LastErrorCode);
+    if (status.BusOff != 0U) {
+      error->state = CAN_STM32_ERROR_BUS_OFF;
+    } else if (status.ErrorPassive != 0U) {
+      error->state = CAN_STM32_ERROR_PASSIVE;
+    } else if (status.Warning != 0U) {
+      error->state = CAN_STM32_ERROR_WARNING;
+    }
+    return true;
+  }
+#endif  // OMURAISU_CAN_STM32_FDCAN_ENABLE
+
+  return false;
+}
+
+static void can_stm32_read_error_state(void* self, CanBusStats* stats) {
+  CanStm32HwError error;
+
+  if (can_stm32_read_hw_error((CanStm32Context*)self, &error)) {
+    stats->tec = error.tec;
+    stats->rec = error.rec;
+    stats->bus_off = error.state == CAN_STM32_ERROR_BUS_OFF;
+  }
+}
+
+// 未送信のフレームを捨ててコントローラを再起動し、バスオフから抜ける
+static void can_stm32_restart(CanStm32Context* context) {
+  CanStm32Context* sibling = can_stm32_sibling(context);
+
+  if (context->cube != 0) {
+    can_cube_clear_tx(context->cube);
+  }
+  if (sibling != 0 && sibling->cube != 0) {
+    can_cube_clear_tx(sibling->cube);
+  }
+
+  if (context->kind == CAN_STM32_KIND_CAN) {
+    CAN_HandleTypeDef* hcan = (CAN_HandleTypeDef*)context->handle;
+    HAL_CAN_AbortTxRequest(hcan,
+                           CAN_TX_MAILBOX0 | CAN_TX_MAILBOX1 | CAN_TX_MAILBOX2);
+    HAL_CAN_Stop(hcan);
+    HAL_CAN_Start(hcan);
+    HAL_CAN_ResetError(hcan);
+    return;
+  }
+
+#ifdef OMURAISU_CAN_STM32_FDCAN_ENABLE
+  if (context->kind == CAN_STM32_KIND_FDCAN) {
+    FDCAN_HandleTypeDef* hfdcan = (FDCAN_HandleTypeDef*)context->handle;
+    HAL_FDCAN_AbortTxRequest(hfdcan, CAN_STM32_FDCAN_TX_BUFFERS);
+    HAL_FDCAN_Stop(hfdcan);
+    HAL_FDCAN_Start(hfdcan);
+  }
+#endif  // OMURAISU_CAN_STM32_FDCAN_ENABLE
+}
+
+void can_stm32_process_errors(CanStm32Context* context) {
+  CanStm32HwError error;
+  const uint32_t now_ms = HAL_GetTick();
+  const uint32_t bus_off_irq_count = context->bus_off_irq_count;
+
+  if (!can_stm32_read_hw_error(context, &error)) {
+    return;
+  }
+  // 割り込みで見つけたバスオフから既に抜けていても 1 回として数える
+  // （既にバスオフとして処理中なら同じバスオフの割り込み）
+  if (bus_off_irq_count != context->bus_off_irq_seen) {
+    context->bus_off_irq_seen = bus_off_irq_count;
+    if (context->error_state != CAN_STM32_ERROR_BUS_OFF) {
+      can_stm32_update_error_state(context, CAN_STM32_ERROR_BUS_OFF,
+                                   CAN_STM32_LEC_NONE, now_ms);
+    }
+  }
+  can_stm32_update_error_state(context, error.state, error.last_error, now_ms);
+  if (can_stm32_begin_recovery(context, now_ms)) {
+    can_stm32_restart(context);
+  }
 }
 
 void can_stm32_make_ops(CanCubeOps* ops) {
@@ -285,70 +1235,132 @@ void can_stm32_make_ops(CanCubeOps* ops) {
   ops->read_hw = can_stm32_read_hw;
   ops->start_read = can_stm32_start_read;
   ops->stop_read = can_stm32_stop_read;
+  ops->set_tx_notify = can_stm32_set_tx_notify;
+  ops->write_fd = can_stm32_write_fd;
+  ops->read_hw_fd = can_stm32_read_hw_fd;
+  ops->read_error_state = can_stm32_read_error_state;
 }
 
 bool can_stm32_register(CanStm32Context* context) {
-  for (int i = 0; i < OMURAISU_CAN_STM32_MAX_CONTEXTS; ++i) {
-    if (g_slots[i].context == context) {
-      return true;
-    }
-    if (g_slots[i].context == 0) {
-      g_slots[i].context = context;
-      return true;
-    }
+  const int index = can_stm32_peripheral_index(context->handle);
+  CanStm32Context** slot = 0;
+
+  if (index < 0) {
+    return false;
   }
-  return false;
+  slot = &g_contexts[index][can_stm32_fifo_index(context)];
+  if (*slot != 0 && *slot != context) {
+    return false;
+  }
+  *slot = context;
+  return true;
 }
 
 void can_stm32_unregister(CanStm32Context* context) {
-  for (int i = 0; i < OMURAISU_CAN_STM32_MAX_CONTEXTS; ++i) {
-    if (g_slots[i].context == context) {
-      g_slots[i].context = 0;
-      return;
-    }
+  const int index = can_stm32_peripheral_index(context->handle);
+  const uint32_t fifo = can_stm32_fifo_index(context);
+
+  if (index >= 0 && g_contexts[index][fifo] == context) {
+    g_contexts[index][fifo] = 0;
   }
 }
 
-void can_stm32_dispatch_rx(void* handle) {
-  CanStm32Context* context = can_stm32_find_context(handle);
+void can_stm32_dispatch_rx_fifo(void* handle, uint32_t fifo) {
+  CanStm32Context* context = can_stm32_find_context(handle, fifo);
   if (context == 0 || context->cube == 0) {
     return;
   }
   can_cube_on_rx_pending(context->cube);
 }
 
+void can_stm32_dispatch_rx(void* handle) {
+  can_stm32_dispatch_rx_fifo(handle, 0U);
+  can_stm32_dispatch_rx_fifo(handle, 1U);
+}
+
+void can_stm32_dispatch_tx(void* handle) {
+  for (uint32_t fifo = 0; fifo < 2U; ++fifo) {
+    CanStm32Context* context = can_stm32_find_context(handle, fifo);
+    if (context != 0 && context->cube != 0 && context->tx_notify) {
+      can_cube_on_tx_ready(context->cube);
+    }
+  }
+}
+
+void can_stm32_dispatch_error(void* handle) {
+  for (uint32_t fifo = 0; fifo < 2U; ++fifo) {
+    CanStm32HwError error;
+    CanStm32Context* context = can_stm32_find_context(handle, fifo);
+    if (context != 0 && can_stm32_read_hw_error(context, &error) &&
+        error.state == CAN_STM32_ERROR_BUS_OFF) {
+      context->bus_off_irq_count++;
+    }
+  }
+}
+
 void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef* hcan) {
-  can_stm32_dispatch_rx(hcan);
+  can_stm32_dispatch_rx_fifo(hcan, 0U);
 }
 
 void HAL_CAN_RxFifo1MsgPendingCallback(CAN_HandleTypeDef* hcan) {
-  can_stm32_dispatch_rx(hcan);
+  can_stm32_dispatch_rx_fifo(hcan, 1U);
+}
+
+void HAL_CAN_TxMailbox0CompleteCallback(CAN_HandleTypeDef* hcan) {
+  can_stm32_dispatch_tx(hcan);
+}
+
+void HAL_CAN_TxMailbox1CompleteCallback(CAN_HandleTypeDef* hcan) {
+  can_stm32_dispatch_tx(hcan);
+}
+
+void HAL_CAN_TxMailbox2CompleteCallback(CAN_HandleTypeDef* hcan) {
+  can_stm32_dispatch_tx(hcan);
+}
+
+void HAL_CAN_ErrorCallback(CAN_HandleTypeDef* hcan) {
+  can_stm32_dispatch_error(hcan);
+  HAL_CAN_ResetError(hcan);
 }
 
 #ifdef OMURAISU_CAN_STM32_FDCAN_ENABLE
 void HAL_FDCAN_RxFifo0Callback(FDCAN_HandleTypeDef* hfdcan,
                                uint32_t RxFifo0ITs) {
   (void)RxFifo0ITs;
-  can_stm32_dispatch_rx(hfdcan);
+  can_stm32_dispatch_rx_fifo(hfdcan, 0U);
 }
 
 void HAL_FDCAN_RxFifo1Callback(FDCAN_HandleTypeDef* hfdcan,
                                uint32_t RxFifo1ITs) {
   (void)RxFifo1ITs;
-  can_stm32_dispatch_rx(hfdcan);
+  can_stm32_dispatch_rx_fifo(hfdcan, 1U);
+}
+
+void HAL_FDCAN_TxBufferCompleteCallback(FDCAN_HandleTypeDef* hfdcan,
+                                        uint32_t BufferIndexes) {
+  (void)BufferIndexes;
+  can_stm32_dispatch_tx(hfdcan);
+}
+
+void HAL_FDCAN_ErrorStatusCallback(FDCAN_HandleTypeDef* hfdcan,
+                                   uint32_t ErrorStatusITs) {
+  (void)ErrorStatusITs;
+  can_stm32_dispatch_error(hfdcan);
 }
 #endif  // OMURAISU_CAN_STM32_FDCAN_ENABLE
 
 #else
 
-void can_stm32_context_init(CanStm32Context* context, CanCube* cube,
-                            void* handle, CanStm32Kind kind,
-                            uint32_t rx_fifo) {
+static CanStm32Context* can_stm32_sibling(const CanStm32Context* context) {
   (void)context;
-  (void)cube;
-  (void)handle;
-  (void)kind;
-  (void)rx_fifo;
+  return 0;
+}
+
+static bool can_stm32_fdcan_capacity(const CanStm32Context* context,
+                                     uint32_t capacity[2]) {
+  (void)context;
+  (void)capacity;
+  return false;
 }
 
 void can_stm32_make_ops(CanCubeOps* ops) { memset(ops, 0, sizeof(*ops)); }
@@ -360,6 +1372,17 @@ bool can_stm32_register(CanStm32Context* context) {
 
 void can_stm32_unregister(CanStm32Context* context) { (void)context; }
 
+void can_stm32_dispatch_rx_fifo(void* handle, uint32_t fifo) {
+  (void)handle;
+  (void)fifo;
+}
+
 void can_stm32_dispatch_rx(void* handle) { (void)handle; }
 
+void can_stm32_dispatch_tx(void* handle) { (void)handle; }
+
+void can_stm32_dispatch_error(void* handle) { (void)handle; }
+
+void can_stm32_process_errors(CanStm32Context* context) { (void)context; }
+
 #endif  // OMURAISU_CAN_STM32_ENABLE
\ No newline at end of file
@@ -0,0 +1,248 @@
+#include "can/can_virtual.h"
+
+#include <string.h>
+
+// 時刻のラップアラウンドを考慮して a が b 以降か判定する
+static bool can_virtual_reached(uint32_t a, uint32_t b) {
+  return (int32_t)(a - b) >= 0;
+}
+
+static uint32_t can_virtual_next_random(CanVirtualMedium* medium) {
+  // xorshift32
+  uint32_t x = medium->loss_state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  medium->loss_state = x;
+  return x;
+}
+
+static bool can_virtual_node_write_impl(void* self, const CanMessage* msg) {
+  CanVirtualNode* node = (CanVirtualNode*)self;
+  uint32_t index = 0;
+
+  if (!spsc_ring_write_slot(&node->tx_ring, &index)) {
+    node->stats.tx_overflows++;
+    node->stats.tx_failures++;
+    return false;
+  }
+  node->tx_queue[index] = *msg;
+  spsc_ring_commit_write(&node->tx_ring);
+  if (spsc_ring_count(&node->tx_ring) > node->stats.tx_queue_high_water) {
+    node->stats.tx_queue_high_water =
+        (uint16_t)spsc_ring_count(&node->tx_ring);
+  }
+  return true;
+}
+
+static bool can_virtual_node_read_impl(void* self, CanMessage* msg) {
+  CanVirtualNode* node = (CanVirtualNode*)self;
+  uint32_t index = 0;
+
+  if (!spsc_ring_read_slot(&node->rx_ring, &index)) {
+    return false;
+  }
+  // 遅延中のフレームはまだ読めない（遅延は一定なので先頭だけ見ればよい）
+  if (!can_virtual_reached(node->medium->now_us,
+                           node->rx_queue[index].deliver_at_us)) {
+    return false;
+  }
+  *msg = node->rx_queue[index].msg;
+  spsc_ring_commit_read(&node->rx_ring);
+  return true;
+}
+
+static bool can_virtual_node_get_stats_impl(void* self, CanBusStats* stats) {
+  CanVirtualNode* node = (CanVirtualNode*)self;
+  const CanVirtualMedium* medium = node->medium;
+  uint32_t elapsed = medium->now_us - node->load_last_time_us;
+
+  if (elapsed != 0U) {
+    node->stats.bus_load_percent =
+        100.0f * (float)(medium->busy_us - node->load_last_busy_us) /
+        (float)elapsed;
+    node->load_last_busy_us = medium->busy_us;
+    node->load_last_time_us = medium->now_us;
+  }
+  *stats = node->stats;
+  return true;
+}
+
+static void can_virtual_node_destroy_impl(void* self) {
+  (void)self;
+}
+
+void can_virtual_medium_init(CanVirtualMedium* medium, uint32_t bitrate) {
+  memset(medium, 0, sizeof(*medium));
+  medium->bitrate = bitrate;
+  medium->loss_state = 1U;
+}
+
+void can_virtual_medium_set_latency(CanVirtualMedium* medium,
+                                    uint32_t latency_us) {
+  medium->latency_us = latency_us;
+}
+
+void can_virtual_medium_set_loss(CanVirtualMedium* medium,
+                                 uint16_t permille, uint32_t seed) {
+  medium->loss_permille = permille;
+  medium->loss_state = seed != 0U ? seed : 1U;
+}
+
+uint32_t can_virtual_medium_frame_time_us(const CanVirtualMedium* medium,
+                                          const CanMessage* msg) {
+  // SOF〜フレーム間スペース（スタッフビットを除く）
+  uint64_t bits = (msg->id > CAN_STD_ID_MAX ? 67U : 47U) + 8U * msg->len;
+  if (medium->bitrate == 0U) {
+    return 0;
+  }
+  return (uint32_t)((bits * 1000000U + medium->bitrate - 1U) /
+                    medium->bitrate);
+}
+
+// 調停フィールドを小さいほど優先される値にする。ベース ID（11 bit）、
+// IDE（標準 0 / 拡張 1）、拡張 ID の下位 18 bit の順に並べるため、ベース ID が
+// 小さい拡張フレームは大きい標準フレームに勝ち、同じなら標準フレームが勝つ。
+static uint32_t can_virtual_arbitration_key(uint32_t id) {
+  if (id > CAN_STD_ID_MAX) {
+    return ((id >> 18) << 19) | (1U << 18) | (id & 0x3FFFFU);
+  }
+  return id << 19;
+}
+
+// 各ノードの先頭フレームで調停し、勝ったフレームの送信を始める
+static bool can_virtual_start_frame(CanVirtualMedium* medium) {
+  CanVirtualNode* winner = 0;
+  uint32_t winner_index = 0;
+
+  for (uint8_t i = 0; i < medium->node_count; ++i) {
+    CanVirtualNode* node = medium->nodes[i];
+    uint32_t index = 0;
+    if (!spsc_ring_read_slot(&node->tx_ring, &index)) {
+      continue;
+    }
+    if (winner == 0 ||
+        can_virtual_arbitration_key(node->tx_queue[index].id) <
+            can_virtual_arbitration_key(winner->tx_queue[winner_index].id)) {
+      winner = node;
+      winner_index = index;
+    }
+  }
+  if (winner == 0) {
+    return false;
+  }
+
+  medium->frame = winner->tx_queue[winner_index];
+  medium->sender = winner;
+  medium->transmitting = true;
+  medium->frame_end_us =
+      medium->now_us +
+      can_virtual_medium_frame_time_us(medium, &medium->frame);
+  spsc_ring_commit_read(&winner->tx_ring);
+  return true;
+}
+
+// 送信が完了したフレームを送信元以外の全ノードへ届ける
+static void can_virtual_finish_frame(CanVirtualMedium* medium) {
+  CanMessage msg = medium->frame;
+  uint32_t frame_us = can_virtual_medium_frame_time_us(medium, &msg);
+
+  medium->transmitting = false;
+  medium->busy_us += frame_us;
+  medium->sender->stats.tx_frames++;
+
+  if (medium->loss_permille != 0U &&
+      can_virtual_next_random(medium) % 1000U < medium->loss_permille) {
+    medium->lost_count++;
+    return;
+  }
+  medium->delivered_count++;
+
+  msg.flags = CAN_MSG_FLAG_TIMESTAMP;
+  msg.timestamp_us = medium->frame_end_us;
+  for (uint8_t i = 0; i < medium->node_count; ++i) {
+    CanVirtualNode* node = medium->nodes[i];
+    uint32_t index = 0;
+
+    if (node == medium->sender) {
+      continue;
+    }
+    if (!spsc_ring_write_slot(&node->rx_ring, &index)) {
+      node->stats.rx_overflows++;
+      continue;
+    }
+    node->rx_queue[index].msg = msg;
+    node->rx_queue[index].deliver_at_us =
+        medium->frame_end_us + medium->latency_us;
+    spsc_ring_commit_write(&node->rx_ring);
+    node->stats.rx_frames++;
+    if (spsc_ring_count(&node->rx_ring) > node->stats.rx_queue_high_water) {
+      node->stats.rx_queue_high_water =
+          (uint16_t)spsc_ring_count(&node->rx_ring);
+    }
+  }
+}
+
+void can_virtual_medium_advance(CanVirtualMedium* medium, uint32_t dt_us) {
+  uint32_t target = medium->now_us + dt_us;
+
+  for (;;) {
+    if (!medium->transmitting && !can_virtual_start_frame(medium)) {
+      break;
+    }
+    if (!can_virtual_reached(target, medium->frame_end_us)) {
+      break;
+    }
+    medium->now_us = medium->frame_end_us;
+    can_virtual_finish_frame(medium);
+  }
+  medium->now_us = target;
+}
+
+uint32_t can_virtual_medium_run_until_idle(CanVirtualMedium* medium) {
+  uint32_t start = medium->now_us;
+
+  while (medium->transmitting || can_virtual_start_frame(medium)) {
+    medium->now_us = medium->frame_end_us;
+    can_virtual_finish_frame(medium);
+  }
+  // 遅延中のフレームが読めるところまで進める
+  medium->now_us += medium->latency_us;
+  return medium->now_us - start;
+}
+
+uint32_t can_virtual_medium_now(const CanVirtualMedium* medium) {
+  return medium->now_us;
+}
+
+uint32_t can_virtual_medium_clock(void* user_arg) {
+  return can_virtual_medium_now((const CanVirtualMedium*)user_arg);
+}
+
+bool can_virtual_node_init(CanVirtualNode* node, CanVirtualMedium* medium) {
+  if (medium->node_count >= CAN_VIRTUAL_MAX_NODES) {
+    return false;
+  }
+
+  memset(node, 0, sizeof(*node));
+  spsc_ring_init(&node->tx_ring, CAN_VIRTUAL_TX_QUEUE_SIZE);
+  spsc_ring_init(&node->rx_ring, CAN_VIRTUAL_RX_QUEUE_SIZE);
+  node->medium = medium;
+  node->load_last_busy_us = medium->busy_us;
+  node->load_last_time_us = medium->now_us;
+
+  node->bus.write = can_virtual_node_write_impl;
+  node->bus.read = can_virtual_node_read_impl;
+  node->bus.get_stats = can_virtual_node_get_stats_impl;
+  node->bus.destroy = can_virtual_node_destroy_impl;
+  node->bus.impl = node;
+
+  medium->nodes[medium->node_count++] = node;
+  return true;
+}
+
+CanBus* can_virtual_node_bus(CanVirtualNode* node) { return &node->bus; }
+
+uint32_t can_virtual_node_tx_pending(const CanVirtualNode* node) {
+  return spsc_ring_count(&node->tx_ring);
+}
@@ -315,3 +315,43 @@ bool om_ctrl_data_to_ros_joy(const ControllerData* data, float* axes,
 
   return true;
 }
+
+bool om_ctrl_data_update_from_can(ControllerData* controller, uint32_t id,
+                                  const uint8_t data[8]) {
+  ControllerData decoded;
+
+  if (controller == NULL || data == NULL) {
+    return false;
+  }
+
+  decoded = om_ctrl_data_from_can(id, data);
+  switch (id) {
+    case OM_CONTROLLER_CAN_ID_ANALOG:
+      controller->left_x = decoded.left_x;
+      controller->left_y = decoded.left_y;
+      controller->right_x = decoded.right_x;
+      controller->right_y = decoded.right_y;
+      controller->l2_trigger = decoded.l2_trigger;
+      controller->r2_trigger = decoded.r2_trigger;
+      return true;
+
+    case OM_CONTROLLER_CAN_ID_BUTTONS:
+      controller->buttons = decoded.buttons;
+      controller->dpad = decoded.dpad;
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+static void om_ctrl_on_can_message(const CanMessage* msg, void* user_arg) {
+  om_ctrl_data_update_from_can((ControllerData*)user_arg, msg->id, msg->data);
+}
+
+bool om_ctrl_can_attach(ControllerData* controller,
+                        CanDispatcher* dispatcher) {
+  return can_dispatcher_add_range(dispatcher, OM_CONTROLLER_CAN_ID_ANALOG,
+                                  OM_CONTROLLER_CAN_ID_BUTTONS,
+                                  om_ctrl_on_can_message, controller);
+}
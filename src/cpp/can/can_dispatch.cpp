@@ -0,0 +1,57 @@
+#include "can/can_dispatch.hpp"
+
+namespace omuraisu {
+namespace can {
+
+CanDispatcher::CanDispatcher() noexcept : dispatcher_{} {
+  can_dispatcher_init(&dispatcher_);
+}
+
+bool CanDispatcher::add_id(uint32_t id, ::CanRxCallback callback,
+                           void* user_arg) {
+  return can_dispatcher_add_id(&dispatcher_, id, callback, user_arg);
+}
+
+bool CanDispatcher::add_range(uint32_t first_id, uint32_t last_id,
+                              ::CanRxCallback callback, void* user_arg) {
+  return can_dispatcher_add_range(&dispatcher_, first_id, last_id, callback,
+                                  user_arg);
+}
+
+bool CanDispatcher::add_mask(uint32_t id, uint32_t mask,
+                             ::CanRxCallback callback, void* user_arg) {
+  return can_dispatcher_add_mask(&dispatcher_, id, mask, callback, user_arg);
+}
+
+void CanDispatcher::set_default(::CanRxCallback callback, void* user_arg) {
+  can_dispatcher_set_default(&dispatcher_, callback, user_arg);
+}
+
+bool CanDispatcher::dispatch(const CanMessage& msg) {
+  return can_dispatcher_dispatch(&dispatcher_,
+                                 static_cast<const ::CanMessage*>(&msg));
+}
+
+std::size_t CanDispatcher::poll(ICanBus& bus) {
+  CanMessage msgs[CAN_DISPATCH_POLL_BATCH_SIZE];
+  std::size_t count = 0;
+  std::size_t total = 0;
+
+  do {
+    count = bus.read_batch(msgs);
+    for (std::size_t i = 0; i < count; ++i) {
+      dispatch(msgs[i]);
+    }
+    total += count;
+  } while (count == CAN_DISPATCH_POLL_BATCH_SIZE);
+  return total;
+}
+
+uint32_t CanDispatcher::unmatched_count() const {
+  return can_dispatcher_get_unmatched_count(&dispatcher_);
+}
+
+::CanDispatcher* CanDispatcher::c_dispatcher() noexcept { return &dispatcher_; }
+
+}  // namespace can
+}  // namespace omuraisu
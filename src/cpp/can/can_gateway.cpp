@@ -0,0 +1,61 @@
+#include "can/can_gateway.hpp"
+
+namespace omuraisu {
+namespace can {
+
+static_assert(sizeof(CanMessage) == sizeof(::CanMessage),
+              "CanMessage must be layout compatible with ::CanMessage");
+
+CanGateway::CanGateway() noexcept : bridges_{}, gateway_{} {
+  can_gateway_init(&gateway_);
+}
+
+int CanGateway::add_bus(ICanBus& bus, ::CanRxCallback local_callback,
+                        void* user_arg) {
+  const uint8_t index = gateway_.port_count;
+  if (index >= CAN_GATEWAY_MAX_BUSES) {
+    return -1;
+  }
+  bridges_[index].emplace(bus);
+  return can_gateway_add_bus(&gateway_, bridges_[index]->c_bus(),
+                             local_callback, user_arg);
+}
+
+int CanGateway::add_bus(::CanBus* bus, ::CanRxCallback local_callback,
+                        void* user_arg) {
+  return can_gateway_add_bus(&gateway_, bus, local_callback, user_arg);
+}
+
+bool CanGateway::add_route(uint8_t src_bus, uint32_t id, uint32_t mask,
+                           uint8_t dst_bus) {
+  return can_gateway_add_route(&gateway_, src_bus, id, mask, dst_bus);
+}
+
+bool CanGateway::add_route(uint8_t src_bus, uint32_t id, uint32_t mask,
+                           uint8_t dst_bus, uint32_t rewrite_id,
+                           uint32_t rewrite_mask) {
+  return can_gateway_add_route_rewrite(&gateway_, src_bus, id, mask, dst_bus,
+                                       rewrite_id, rewrite_mask);
+}
+
+std::size_t CanGateway::forward(uint8_t src_bus, const CanMessage* msgs,
+                                std::size_t count) {
+  return can_gateway_forward(&gateway_, src_bus,
+                             static_cast<const ::CanMessage*>(msgs), count);
+}
+
+std::size_t CanGateway::poll() { return can_gateway_poll(&gateway_); }
+
+std::size_t CanGateway::get_filters(uint8_t bus, ::CanFilter* filters,
+                                    std::size_t max_count) const {
+  return can_gateway_get_filters(&gateway_, bus, filters, max_count);
+}
+
+const ::CanGatewayPort* CanGateway::port(uint8_t bus) const noexcept {
+  return bus < gateway_.port_count ? &gateway_.ports[bus] : nullptr;
+}
+
+::CanGateway* CanGateway::c_gateway() noexcept { return &gateway_; }
+
+}  // namespace can
+}  // namespace omuraisu
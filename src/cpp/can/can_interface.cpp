@@ -2,6 +2,13 @@
 
 namespace omuraisu {
 namespace can {
+
+// read_batch / write_batch は CanMessage 配列と ::CanMessage 配列を相互に読み替える
+static_assert(sizeof(CanMessage) == sizeof(::CanMessage),
+              "CanMessage must be layout compatible with ::CanMessage");
+static_assert(sizeof(CanFdMessage) == sizeof(::CanFdMessage),
+              "CanFdMessage must be layout compatible with ::CanFdMessage");
+
 namespace {
 
 uint8_t clamp_can_len(uint8_t len) { return len > 8 ? 8 : len; }
@@ -13,38 +20,104 @@ void copy_data(uint8_t dst[8], const uint8_t src[8], uint8_t len) {
   }
 }
 
+uint8_t clamp_can_fd_len(uint8_t len) {
+  return len > CAN_FD_MAX_DATA_LEN ? CAN_FD_MAX_DATA_LEN : len;
+}
+
+void copy_fd_data(uint8_t dst[CAN_FD_MAX_DATA_LEN], const uint8_t* src,
+                  uint8_t len) {
+  uint8_t bounded_len = clamp_can_fd_len(len);
+  for (uint8_t i = 0; i < CAN_FD_MAX_DATA_LEN; ++i) {
+    dst[i] = i < bounded_len ? src[i] : 0;
+  }
+}
+
 }  // namespace
 
-CanMessage::CanMessage() noexcept : ::CanMessage{0, {0}, 0} {}
+CanMessage::CanMessage() noexcept : ::CanMessage{0, {0}, 0, 0, 0} {}
 
 CanMessage::CanMessage(uint32_t id_value, const uint8_t raw_data[8],
                        uint8_t len_value) noexcept
-    : ::CanMessage{id_value, {0}, clamp_can_len(len_value)} {
+    : ::CanMessage{id_value, {0}, clamp_can_len(len_value), 0, 0} {
   if (raw_data != nullptr) {
     copy_data(data, raw_data, len);
   }
 }
 
 CanMessage::CanMessage(const ::CanMessage& other) noexcept
-    : ::CanMessage{other.id, {0}, clamp_can_len(other.len)} {
+    : ::CanMessage{other.id, {0}, clamp_can_len(other.len), other.flags,
+                   other.timestamp_us} {
   copy_data(data, other.data, len);
 }
 
 CanMessage::CanMessage(const CanMessage& other) noexcept
-    : ::CanMessage{other.id, {0}, clamp_can_len(other.len)} {
+    : ::CanMessage{other.id, {0}, clamp_can_len(other.len), other.flags,
+                   other.timestamp_us} {
   copy_data(data, other.data, len);
 }
 
+bool CanMessage::has_timestamp() const noexcept {
+  return (flags & CAN_MSG_FLAG_TIMESTAMP) != 0U;
+}
+
 CanMessage& CanMessage::operator=(const CanMessage& other) noexcept {
   if (this == &other) {
     return *this;
   }
   id = other.id;
   len = clamp_can_len(other.len);
+  flags = other.flags;
+  timestamp_us = other.timestamp_us;
   copy_data(data, other.data, len);
   return *this;
 }
 
+CanFdMessage::CanFdMessage() noexcept : ::CanFdMessage{0, {0}, 0, 0, 0} {}
+
+CanFdMessage::CanFdMessage(uint32_t id_value, const uint8_t* raw_data,
+                           uint8_t len_value, uint8_t flags_value) noexcept
+    : ::CanFdMessage{id_value, {0}, clamp_can_fd_len(len_value), flags_value,
+                     0} {
+  if (raw_data != nullptr) {
+    copy_fd_data(data, raw_data, len);
+  }
+}
+
+CanFdMessage::CanFdMessage(const ::CanFdMessage& other) noexcept
+    : ::CanFdMessage{other.id, {0}, clamp_can_fd_len(other.len), other.flags,
+                     other.timestamp_us} {
+  copy_fd_data(data, other.data, len);
+}
+
+CanFdMessage::CanFdMessage(const ::CanMessage& other) noexcept
+    : ::CanFdMessage{other.id, {0}, clamp_can_len(other.len),
+                     static_cast<uint8_t>(other.flags & CAN_MSG_FLAG_TIMESTAMP),
+                     other.timestamp_us} {
+  copy_fd_data(data, other.data, len);
+}
+
+CanFdMessage::CanFdMessage(const CanFdMessage& other) noexcept
+    : ::CanFdMessage{other.id, {0}, clamp_can_fd_len(other.len), other.flags,
+                     other.timestamp_us} {
+  copy_fd_data(data, other.data, len);
+}
+
+bool CanFdMessage::has_timestamp() const noexcept {
+  return (flags & CAN_MSG_FLAG_TIMESTAMP) != 0U;
+}
+
+CanFdMessage& CanFdMessage::operator=(const CanFdMessage& other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+  id = other.id;
+  len = clamp_can_fd_len(other.len);
+  flags = other.flags;
+  timestamp_us = other.timestamp_us;
+  copy_fd_data(data, other.data, len);
+  return *this;
+}
+
 CCanBusAdapter::CCanBusAdapter(::CanBus* bus) noexcept : bus_(bus) {}
 
 bool CCanBusAdapter::write(const CanMessage& msg) {
@@ -54,6 +127,15 @@ bool CCanBusAdapter::write(const CanMessage& msg) {
   return can_bus_write(bus_, static_cast<const ::CanMessage*>(&msg));
 }
 
+std::size_t CCanBusAdapter::write_batch(const CanMessage* msgs,
+                                       std::size_t count) {
+  if (bus_ == nullptr || msgs == nullptr) {
+    return 0;
+  }
+  return can_bus_write_batch(bus_, static_cast<const ::CanMessage*>(msgs),
+                             count);
+}
+
 bool CCanBusAdapter::read(CanMessage& msg) {
   if (bus_ == nullptr) {
     return false;
@@ -64,6 +146,32 @@ bool CCanBusAdapter::read(CanMessage& msg) {
   return true;
 }
 
+std::size_t CCanBusAdapter::read_batch(CanMessage* msgs,
+                                      std::size_t max_count) {
+  if (bus_ == nullptr || msgs == nullptr) {
+    return 0;
+  }
+  return can_bus_read_batch(bus_, static_cast<::CanMessage*>(msgs), max_count);
+}
+
+bool CCanBusAdapter::write_fd(const CanFdMessage& msg) {
+  if (bus_ == nullptr) {
+    return false;
+  }
+  return can_bus_write_fd(bus_, static_cast<const ::CanFdMessage*>(&msg));
+}
+
+bool CCanBusAdapter::read_fd(CanFdMessage& msg) {
+  if (bus_ == nullptr) {
+    return false;
+  }
+  return can_bus_read_fd(bus_, static_cast<::CanFdMessage*>(&msg));
+}
+
+bool CCanBusAdapter::get_stats(CanBusStats& stats) {
+  return can_bus_get_stats(bus_, &stats);
+}
+
 void CCanBusAdapter::start_read() {
   if (bus_ == nullptr) {
     return;
@@ -80,7 +188,12 @@ void CCanBusAdapter::stop_read() {
 
 CppCanBusBridge::CppCanBusBridge(ICanBus& bus) noexcept : bus_(&bus), c_bus_{} {
   c_bus_.write = &CppCanBusBridge::write_thunk;
+  c_bus_.write_batch = &CppCanBusBridge::write_batch_thunk;
   c_bus_.read = &CppCanBusBridge::read_thunk;
+  c_bus_.read_batch = &CppCanBusBridge::read_batch_thunk;
+  c_bus_.write_fd = &CppCanBusBridge::write_fd_thunk;
+  c_bus_.read_fd = &CppCanBusBridge::read_fd_thunk;
+  c_bus_.get_stats = &CppCanBusBridge::get_stats_thunk;
   c_bus_.start_read = &CppCanBusBridge::start_read_thunk;
   c_bus_.stop_read = &CppCanBusBridge::stop_read_thunk;
   c_bus_.destroy = &CppCanBusBridge::destroy_thunk;
@@ -103,6 +216,18 @@ bool CppCanBusBridge::write_thunk(void* self, const ::CanMessage* msg) {
   return bridge->bus_->write(cpp_msg);
 }
 
+size_t CppCanBusBridge::write_batch_thunk(void* self, const ::CanMessage* msgs,
+                                          size_t count) {
+  if (self == nullptr || msgs == nullptr) {
+    return 0;
+  }
+  CppCanBusBridge* bridge = static_cast<CppCanBusBridge*>(self);
+  if (bridge->bus_ == nullptr) {
+    return 0;
+  }
+  return bridge->bus_->write_batch(static_cast<const CanMessage*>(msgs), count);
+}
+
 bool CppCanBusBridge::read_thunk(void* self, ::CanMessage* msg) {
   if (self == nullptr || msg == nullptr) {
     return false;
@@ -115,6 +240,51 @@ bool CppCanBusBridge::read_thunk(void* self, ::CanMessage* msg) {
   return bridge->bus_->read(cpp_msg);
 }
 
+size_t CppCanBusBridge::read_batch_thunk(void* self, ::CanMessage* msgs,
+                                         size_t max_count) {
+  if (self == nullptr || msgs == nullptr) {
+    return 0;
+  }
+  CppCanBusBridge* bridge = static_cast<CppCanBusBridge*>(self);
+  if (bridge->bus_ == nullptr) {
+    return 0;
+  }
+  return bridge->bus_->read_batch(static_cast<CanMessage*>(msgs), max_count);
+}
+
+bool CppCanBusBridge::write_fd_thunk(void* self, const ::CanFdMessage* msg) {
+  if (self == nullptr || msg == nullptr) {
+    return false;
+  }
+  CppCanBusBridge* bridge = static_cast<CppCanBusBridge*>(self);
+  if (bridge->bus_ == nullptr) {
+    return false;
+  }
+  return bridge->bus_->write_fd(*static_cast<const CanFdMessage*>(msg));
+}
+
+bool CppCanBusBridge::read_fd_thunk(void* self, ::CanFdMessage* msg) {
+  if (self == nullptr || msg == nullptr) {
+    return false;
+  }
+  CppCanBusBridge* bridge = static_cast<CppCanBusBridge*>(self);
+  if (bridge->bus_ == nullptr) {
+    return false;
+  }
+  return bridge->bus_->read_fd(*static_cast<CanFdMessage*>(msg));
+}
+
+bool CppCanBusBridge::get_stats_thunk(void* self, ::CanBusStats* stats) {
+  if (self == nullptr || stats == nullptr) {
+    return false;
+  }
+  CppCanBusBridge* bridge = static_cast<CppCanBusBridge*>(self);
+  if (bridge->bus_ == nullptr) {
+    return false;
+  }
+  return bridge->bus_->get_stats(*stats);
+}
+
 void CppCanBusBridge::start_read_thunk(void* self) {
   if (self == nullptr) {
     return;
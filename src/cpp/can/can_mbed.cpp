@@ -25,6 +25,7 @@ bool MbedCanBus::read(CanMessage& msg) {
   if (can_->read(mbed_msg)) {
     msg.id = mbed_msg.id;
     msg.len = mbed_msg.len;
+    msg.flags = 0;
     for (int i = 0; i < 8; ++i) {
       msg.data[i] = mbed_msg.data[i];
     }
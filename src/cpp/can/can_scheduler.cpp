@@ -0,0 +1,43 @@
+#include "can/can_scheduler.hpp"
+
+namespace omuraisu {
+namespace can {
+
+CanScheduler::CanScheduler(ICanBus& bus) noexcept
+    : bridge_(bus), scheduler_{} {
+  can_scheduler_init(&scheduler_, bridge_.c_bus());
+}
+
+void CanScheduler::set_max_per_tick(uint8_t max_per_tick) {
+  can_scheduler_set_max_per_tick(&scheduler_, max_per_tick);
+}
+
+int CanScheduler::add(uint32_t period, uint32_t phase,
+                      ::CanScheduleFillFn fill, void* user_arg) {
+  return can_scheduler_add(&scheduler_, period, phase, fill, user_arg);
+}
+
+int CanScheduler::add(uint32_t period, ::CanScheduleFillFn fill,
+                      void* user_arg) {
+  return can_scheduler_add(&scheduler_, period, CAN_SCHEDULER_AUTO_PHASE, fill,
+                           user_arg);
+}
+
+void CanScheduler::set_enabled(int slot, bool enabled) {
+  can_scheduler_set_enabled(&scheduler_, slot, enabled);
+}
+
+std::size_t CanScheduler::tick() { return can_scheduler_tick(&scheduler_); }
+
+uint32_t CanScheduler::deferred_count() const {
+  return scheduler_.deferred_count;
+}
+
+uint32_t CanScheduler::skipped_count() const {
+  return scheduler_.skipped_count;
+}
+
+::CanScheduler* CanScheduler::c_scheduler() noexcept { return &scheduler_; }
+
+}  // namespace can
+}  // namespace omuraisu
@@ -0,0 +1,51 @@
+#include "can/can_serial.hpp"
+
+namespace omuraisu {
+namespace can {
+
+SerialCanBus::SerialCanBus(serial::ISerialPort& port) noexcept
+    : port_bridge_(port), link_{} {
+  can_serial_init(&link_, port_bridge_.c_port());
+}
+
+bool SerialCanBus::write(const CanMessage& msg) {
+  return can_bus_write(&link_.bus, static_cast<const ::CanMessage*>(&msg));
+}
+
+bool SerialCanBus::read(CanMessage& msg) {
+  return can_bus_read(&link_.bus, static_cast<::CanMessage*>(&msg));
+}
+
+void SerialCanBus::start_read() { can_bus_start_read(&link_.bus); }
+
+void SerialCanBus::stop_read() { can_bus_stop_read(&link_.bus); }
+
+std::size_t SerialCanBus::write_batch(const CanMessage* msgs,
+                                      std::size_t count) {
+  return can_bus_write_batch(&link_.bus, static_cast<const ::CanMessage*>(msgs),
+                             count);
+}
+
+bool SerialCanBus::get_stats(CanBusStats& stats) {
+  return can_bus_get_stats(&link_.bus, &stats);
+}
+
+bool SerialCanBus::flush() { return can_serial_flush(&link_); }
+
+void SerialCanBus::feed(const uint8_t* data, std::size_t size) {
+  can_serial_feed(&link_, data, size);
+}
+
+void SerialCanBus::poll() { can_serial_poll(&link_); }
+
+std::size_t SerialCanBus::relay(ICanBus& local, std::size_t max_frames) {
+  CppCanBusBridge bridge(local);
+  return can_serial_relay(&link_, bridge.c_bus(), max_frames);
+}
+
+uint32_t SerialCanBus::rx_errors() const { return link_.rx_errors; }
+
+::CanBus* SerialCanBus::c_bus() noexcept { return &link_.bus; }
+
+}  // namespace can
+}  // namespace omuraisu
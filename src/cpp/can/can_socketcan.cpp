@@ -0,0 +1,58 @@
+#include "can/can_socketcan.hpp"
+
+// このファイルはLinux（SocketCAN）環境でのみ使用可能
+#if defined(__has_include)
+#if __has_include(<linux/can.h>)
+
+namespace omuraisu {
+namespace can {
+
+static_assert(sizeof(CanMessage) == sizeof(::CanMessage),
+              "CanMessage must be layout compatible with ::CanMessage");
+
+SocketCanBus::SocketCanBus(const std::string& ifname) : ifname_(ifname) {
+  can_socketcan_init(&socketcan_);
+}
+
+SocketCanBus::~SocketCanBus() { close(); }
+
+bool SocketCanBus::open() {
+  return can_socketcan_open(&socketcan_, ifname_.c_str());
+}
+
+void SocketCanBus::close() { can_socketcan_close(&socketcan_); }
+
+bool SocketCanBus::is_open() const { return can_socketcan_is_open(&socketcan_); }
+
+bool SocketCanBus::write(const CanMessage& msg) {
+  return can_bus_write(&socketcan_.bus, static_cast<const ::CanMessage*>(&msg));
+}
+
+bool SocketCanBus::read(CanMessage& msg) {
+  return can_bus_read(&socketcan_.bus, static_cast<::CanMessage*>(&msg));
+}
+
+std::size_t SocketCanBus::read_batch(CanMessage* msgs, std::size_t max_count) {
+  return can_socketcan_read_batch(&socketcan_, static_cast<::CanMessage*>(msgs),
+                                  max_count);
+}
+
+std::size_t SocketCanBus::write_batch(const CanMessage* msgs,
+                                      std::size_t count) {
+  return can_socketcan_write_batch(
+      &socketcan_, static_cast<const ::CanMessage*>(msgs), count);
+}
+
+bool SocketCanBus::set_filters(const ::CanFilter* filters, std::size_t count) {
+  return can_socketcan_set_filters(&socketcan_, filters, count);
+}
+
+int SocketCanBus::fd() const { return can_socketcan_fd(&socketcan_); }
+
+::CanBus* SocketCanBus::c_bus() noexcept { return &socketcan_.bus; }
+
+}  // namespace can
+}  // namespace omuraisu
+
+#endif
+#endif  // __has_include check
@@ -0,0 +1,65 @@
+#include "can/can_virtual.hpp"
+
+namespace omuraisu {
+namespace can {
+
+VirtualCanMedium::VirtualCanMedium(uint32_t bitrate) noexcept : medium_{} {
+  can_virtual_medium_init(&medium_, bitrate);
+}
+
+void VirtualCanMedium::set_latency(uint32_t latency_us) {
+  can_virtual_medium_set_latency(&medium_, latency_us);
+}
+
+void VirtualCanMedium::set_loss(uint16_t permille, uint32_t seed) {
+  can_virtual_medium_set_loss(&medium_, permille, seed);
+}
+
+void VirtualCanMedium::advance(uint32_t dt_us) {
+  can_virtual_medium_advance(&medium_, dt_us);
+}
+
+uint32_t VirtualCanMedium::run_until_idle() {
+  return can_virtual_medium_run_until_idle(&medium_);
+}
+
+uint32_t VirtualCanMedium::now() const {
+  return can_virtual_medium_now(&medium_);
+}
+
+uint32_t VirtualCanMedium::delivered_count() const {
+  return medium_.delivered_count;
+}
+
+uint32_t VirtualCanMedium::lost_count() const { return medium_.lost_count; }
+
+::CanVirtualMedium* VirtualCanMedium::c_medium() noexcept { return &medium_; }
+
+VirtualCanBus::VirtualCanBus(VirtualCanMedium& medium) noexcept
+    : node_{}, attached_(false) {
+  attached_ = can_virtual_node_init(&node_, medium.c_medium());
+}
+
+bool VirtualCanBus::is_attached() const { return attached_; }
+
+bool VirtualCanBus::write(const CanMessage& msg) {
+  return attached_ &&
+         can_bus_write(&node_.bus, static_cast<const ::CanMessage*>(&msg));
+}
+
+bool VirtualCanBus::read(CanMessage& msg) {
+  return attached_ && can_bus_read(&node_.bus, static_cast<::CanMessage*>(&msg));
+}
+
+bool VirtualCanBus::get_stats(CanBusStats& stats) {
+  return can_bus_get_stats(attached_ ? &node_.bus : nullptr, &stats);
+}
+
+uint32_t VirtualCanBus::tx_pending() const {
+  return can_virtual_node_tx_pending(&node_);
+}
+
+::CanBus* VirtualCanBus::c_bus() noexcept { return &node_.bus; }
+
+}  // namespace can
+}  // namespace omuraisu
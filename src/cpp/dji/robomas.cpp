@@ -1,5 +1,9 @@
 #include "dji/robomas.hpp"
 
+#include <cstddef>
+
+#include "dji/robomas.h"
+
 namespace omuraisu {
 namespace dji {
 Robomas::Robomas(can::ICanBus& bus) noexcept : bus_(bus) {}
@@ -11,28 +15,75 @@ int Robomas::read() {
   if (!bus_.read(msg)) {
     return -1;
   }
-  return core_.parse(msg.id, msg.data);
+  return parse_message(msg);
+}
+
+int Robomas::read_all() {
+  can::CanMessage msgs[OM_RM_READ_BATCH_SIZE];
+  std::size_t count = 0;
+  int parsed = 0;
+
+  do {
+    count = bus_.read_batch(msgs);
+    for (std::size_t i = 0; i < count; ++i) {
+      if (parse_message(msgs[i]) >= 0) {
+        ++parsed;
+      }
+    }
+  } while (count == OM_RM_READ_BATCH_SIZE);
+  return parsed;
 }
 
 bool Robomas::write() {
-  can::CanMessage msg1;
-  can::CanMessage msg2;
-  core_.get_output_group(msg1.data, 0);
-  msg1.id = TX_ID_GROUP1;
-  msg1.len = 8;
+  can::CanMessage msgs[2];
+  core_.get_output_group(msgs[0].data, 0);
+  msgs[0].id = TX_ID_GROUP1;
+  msgs[0].len = 8;
+  msgs[0].flags = CAN_MSG_FLAG_REPLACE;
 
-  core_.get_output_group(msg2.data, 1);
-  msg2.id = TX_ID_GROUP2;
-  msg2.len = 8;
+  core_.get_output_group(msgs[1].data, 1);
+  msgs[1].id = TX_ID_GROUP2;
+  msgs[1].len = 8;
+  msgs[1].flags = CAN_MSG_FLAG_REPLACE;
 
-  bool success1 = bus_.write(msg1);
-  bool success2 = bus_.write(msg2);
-  return success1 && success2;
+  return bus_.write_batch(msgs) == 2U;
 }
 
 int Robomas::parse(uint32_t id, const uint8_t data[8]) {
   return core_.parse(id, data);
 }
+bool Robomas::attach(can::CanDispatcher& dispatcher) {
+  return dispatcher.add_range(RX_ID_MIN, RX_ID_MAX, &Robomas::on_can_message,
+                              this);
+}
+void Robomas::on_can_message(const ::CanMessage* msg, void* user_arg) {
+  static_cast<Robomas*>(user_arg)->parse_message(*msg);
+}
+int Robomas::parse_message(const ::CanMessage& msg) {
+  int index = core_.parse(msg.id, msg.data);
+  if (index >= 0 && (msg.flags & CAN_MSG_FLAG_TIMESTAMP) != 0U) {
+    core_.set_timestamp(index + 1, msg.timestamp_us);
+  }
+  return index;
+}
+bool Robomas::schedule(can::CanScheduler& scheduler, uint32_t period) {
+  return scheduler.add(period, &Robomas::fill_group1, this) >= 0 &&
+         scheduler.add(period, &Robomas::fill_group2, this) >= 0;
+}
+bool Robomas::fill_group1(::CanMessage* msg, void* user_arg) {
+  static_cast<Robomas*>(user_arg)->core_.get_output_group(msg->data, 0);
+  msg->id = TX_ID_GROUP1;
+  msg->len = 8;
+  msg->flags = CAN_MSG_FLAG_REPLACE;
+  return true;
+}
+bool Robomas::fill_group2(::CanMessage* msg, void* user_arg) {
+  static_cast<Robomas*>(user_arg)->core_.get_output_group(msg->data, 1);
+  msg->id = TX_ID_GROUP2;
+  msg->len = 8;
+  msg->flags = CAN_MSG_FLAG_REPLACE;
+  return true;
+}
 void Robomas::set_output(int16_t current, int id) {
   core_.set_output(current, id);
 }
@@ -47,6 +98,9 @@ int16_t Robomas::get_current(int id) const { return core_.get_current(id); }
 uint16_t Robomas::get_angle(int id) const { return core_.get_angle(id); }
 int16_t Robomas::get_rpm(int id) const { return core_.get_rpm(id); }
 uint8_t Robomas::get_temp(int id) const { return core_.get_temp(id); }
+uint32_t Robomas::get_timestamp(int id) const {
+  return core_.get_timestamp(id);
+}
 RobomasData Robomas::get_data(int id) const { return core_.get_data(id); }
 }  // namespace dji
 }  // namespace omuraisu
@@ -2,7 +2,7 @@
 
 namespace omuraisu {
 namespace dji {
-RobomasData::RobomasData() noexcept : ::RobomasData{0} {}
+RobomasData::RobomasData() noexcept : ::RobomasData{} {}
 RobomasData::RobomasData(const ::RobomasData& other) noexcept
     : ::RobomasData{other} {}
 RobomasData::RobomasData(const RobomasData& other) noexcept
@@ -59,6 +59,12 @@ int16_t RobomasCore::get_rpm(int id) const {
 uint8_t RobomasCore::get_temp(int id) const {
   return om_rm_core_get_temp(&core_, id);
 }
+void RobomasCore::set_timestamp(int id, uint32_t timestamp_us) {
+  om_rm_core_set_timestamp(&core_, id, timestamp_us);
+}
+uint32_t RobomasCore::get_timestamp(int id) const {
+  return om_rm_core_get_timestamp(&core_, id);
+}
 RobomasData RobomasCore::get_data(int id) const {
   return static_cast<RobomasData>(om_rm_core_get_data(&core_, id));
 }
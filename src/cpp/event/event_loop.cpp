@@ -0,0 +1,42 @@
+#include "event/event_loop.hpp"
+
+namespace omuraisu {
+namespace event {
+
+EventLoop::EventLoop() noexcept : loop_{}, valid_(false) {
+  valid_ = event_loop_init(&loop_);
+}
+
+EventLoop::~EventLoop() { event_loop_close(&loop_); }
+
+bool EventLoop::is_valid() const { return valid_; }
+
+int EventLoop::add_fd(int fd, uint32_t events, ::EventFdFn callback,
+                      void* user_arg) {
+  return event_loop_add_fd(&loop_, fd, events, callback, user_arg);
+}
+
+int EventLoop::add_timer(uint32_t period_us, ::EventTimerFn callback,
+                         void* user_arg) {
+  return event_loop_add_timer(&loop_, period_us, callback, user_arg);
+}
+
+int EventLoop::add_serial(serial::PosixSerialPort& port,
+                          serial::SerialRxCallback callback, void* user_arg) {
+  return event_loop_add_serial(&loop_, port.c_serial(), callback, user_arg);
+}
+
+bool EventLoop::remove(int source) { return event_loop_remove(&loop_, source); }
+
+int EventLoop::run_once(int timeout_ms) {
+  return event_loop_run_once(&loop_, timeout_ms);
+}
+
+void EventLoop::run() { event_loop_run(&loop_); }
+
+void EventLoop::stop() { event_loop_stop(&loop_); }
+
+::EventLoop* EventLoop::c_loop() noexcept { return &loop_; }
+
+}  // namespace event
+}  // namespace omuraisu
@@ -17,9 +17,9 @@ BoostSerialPort::BoostSerialPort(boost::asio::io_context& io,
       reading_(false),
       rx_callback_(nullptr),
       rx_callback_user_arg_(nullptr),
-      rx_head_(0),
-      rx_tail_(0),
-      rx_count_(0) {}
+      rx_ring_{} {
+  spsc_ring_init(&rx_ring_, OMURAISU_SERIAL_BOOST_RX_BUFFER_SIZE);
+}
 
 BoostSerialPort::~BoostSerialPort() { close(); }
 
@@ -164,28 +164,30 @@ void BoostSerialPort::on_read(const boost::system::error_code& ec,
 }
 
 bool BoostSerialPort::rx_push(uint8_t value) {
-  if (rx_count_ >= OMURAISU_SERIAL_BOOST_RX_BUFFER_SIZE) {
+  uint32_t index = 0;
+  if (!spsc_ring_write_slot(&rx_ring_, &index)) {
     return false;
   }
 
-  rx_buffer_[rx_head_] = value;
-  rx_head_ = (uint16_t)((rx_head_ + 1U) % OMURAISU_SERIAL_BOOST_RX_BUFFER_SIZE);
-  rx_count_++;
+  rx_buffer_[index] = value;
+  spsc_ring_commit_write(&rx_ring_);
   return true;
 }
 
 bool BoostSerialPort::rx_pop(uint8_t* value) {
-  if (rx_count_ == 0U) {
+  uint32_t index = 0;
+  if (!spsc_ring_read_slot(&rx_ring_, &index)) {
     return false;
   }
 
-  *value = rx_buffer_[rx_tail_];
-  rx_tail_ = (uint16_t)((rx_tail_ + 1U) % OMURAISU_SERIAL_BOOST_RX_BUFFER_SIZE);
-  rx_count_--;
+  *value = rx_buffer_[index];
+  spsc_ring_commit_read(&rx_ring_);
   return true;
 }
 
-uint16_t BoostSerialPort::rx_available() const { return rx_count_; }
+uint16_t BoostSerialPort::rx_available() const {
+  return static_cast<uint16_t>(spsc_ring_readable(&rx_ring_));
+}
 
 }  // namespace serial
 }  // namespace omuraisu
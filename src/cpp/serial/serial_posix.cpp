@@ -0,0 +1,42 @@
+#include "serial/serial_posix.hpp"
+
+namespace omuraisu {
+namespace serial {
+
+PosixSerialPort::PosixSerialPort(const std::string& device, uint32_t baudrate)
+    : serial_{} {
+  serial_posix_init(&serial_, device.c_str(), baudrate);
+}
+
+PosixSerialPort::~PosixSerialPort() { close(); }
+
+bool PosixSerialPort::open() { return serial_posix_open(&serial_); }
+
+void PosixSerialPort::close() { serial_posix_close(&serial_); }
+
+bool PosixSerialPort::write(const SerialMessage& msg) {
+  return serial_port_write(&serial_.port,
+                           static_cast<const ::SerialMessage*>(&msg));
+}
+
+bool PosixSerialPort::read(SerialMessage& msg) {
+  return serial_port_read(&serial_.port, static_cast<::SerialMessage*>(&msg));
+}
+
+void PosixSerialPort::set_rx_callback(SerialRxCallback callback,
+                                      void* user_arg) {
+  serial_posix_set_rx_callback(&serial_, callback, user_arg);
+}
+
+bool PosixSerialPort::is_open() const { return serial_posix_is_open(&serial_); }
+
+int PosixSerialPort::fd() const { return serial_posix_fd(&serial_); }
+
+std::size_t PosixSerialPort::on_readable() {
+  return serial_posix_on_readable(&serial_);
+}
+
+::SerialPosix* PosixSerialPort::c_serial() noexcept { return &serial_; }
+
+}  // namespace serial
+}  // namespace omuraisu
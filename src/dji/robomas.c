@@ -1,5 +1,7 @@
 #include "dji/robomas.h"
 
+#include "profile/profile.h"
+
 Robomas om_rm_init(CanBus* can) {
   Robomas rm;
   rm.can = can;
@@ -11,14 +13,76 @@ void om_rm_set_max_output(Robomas* rm, int16_t max) {
   om_rm_core_set_max_output(&rm->core, max);
 }
 
+// フィードバックを解析し、受信時刻があれば一緒に記録する
+static int om_rm_parse_message(Robomas* rm, const CanMessage* msg) {
+  int index = om_rm_core_parse(&rm->core, msg->id, msg->data);
+  if (index >= 0 && (msg->flags & CAN_MSG_FLAG_TIMESTAMP) != 0U) {
+    om_rm_core_set_timestamp(&rm->core, index + 1, msg->timestamp_us);
+  }
+  return index;
+}
+
 int om_rm_read(Robomas* rm) {
   CanMessage msg;
   if (rm->can->read(rm->can->impl, &msg)) {
-    return om_rm_core_parse(&rm->core, msg.id, msg.data);
+    return om_rm_parse_message(rm, &msg);
   }
   return -1;
 }
 
+int om_rm_read_all(Robomas* rm) {
+  CanMessage msgs[OM_RM_READ_BATCH_SIZE];
+  size_t count = 0;
+  int parsed = 0;
+  OM_PROFILE_BEGIN(profile_start);
+
+  do {
+    count = can_bus_read_batch(rm->can, msgs, OM_RM_READ_BATCH_SIZE);
+    for (size_t i = 0; i < count; ++i) {
+      if (om_rm_parse_message(rm, &msgs[i]) >= 0) {
+        parsed++;
+      }
+    }
+  } while (count == OM_RM_READ_BATCH_SIZE);
+  OM_PROFILE_END(OM_PROFILE_RM_READ, profile_start);
+  return parsed;
+}
+
+static void om_rm_on_can_message(const CanMessage* msg, void* user_arg) {
+  Robomas* rm = (Robomas*)user_arg;
+  om_rm_parse_message(rm, msg);
+}
+
+bool om_rm_attach(Robomas* rm, CanDispatcher* dispatcher) {
+  return can_dispatcher_add_range(dispatcher, RX_ID_MIN, RX_ID_MAX,
+                                  om_rm_on_can_message, rm);
+}
+
+static bool om_rm_fill_group1(CanMessage* msg, void* user_arg) {
+  Robomas* rm = (Robomas*)user_arg;
+  msg->id = TX_ID_GROUP1;
+  msg->len = 8;
+  msg->flags = CAN_MSG_FLAG_REPLACE;
+  om_rm_core_get_output_group(&rm->core, msg->data, 0);
+  return true;
+}
+
+static bool om_rm_fill_group2(CanMessage* msg, void* user_arg) {
+  Robomas* rm = (Robomas*)user_arg;
+  msg->id = TX_ID_GROUP2;
+  msg->len = 8;
+  msg->flags = CAN_MSG_FLAG_REPLACE;
+  om_rm_core_get_output_group(&rm->core, msg->data, 1);
+  return true;
+}
+
+bool om_rm_schedule(Robomas* rm, CanScheduler* scheduler, uint32_t period) {
+  return can_scheduler_add(scheduler, period, CAN_SCHEDULER_AUTO_PHASE,
+                           om_rm_fill_group1, rm) >= 0 &&
+         can_scheduler_add(scheduler, period, CAN_SCHEDULER_AUTO_PHASE,
+                           om_rm_fill_group2, rm) >= 0;
+}
+
 int om_rm_parse(Robomas* rm, uint32_t id, const uint8_t data[8]) {
   return om_rm_core_parse(&rm->core, id, data);
 }
@@ -32,16 +96,20 @@ void om_rm_set_output_percent(Robomas* rm, float percent, int id) {
 }
 
 bool om_rm_write(Robomas* rm) {
-  CanMessage msg1, msg2;
-  msg1.id = TX_ID_GROUP1;
-  msg2.id = TX_ID_GROUP2;
-  om_rm_core_get_output_group(&rm->core, msg1.data, 0);
-  om_rm_core_get_output_group(&rm->core, msg2.data, 1);
-  msg1.len = 8;
-  msg2.len = 8;
-  bool success1 = rm->can->write(rm->can->impl, &msg1);
-  bool success2 = rm->can->write(rm->can->impl, &msg2);
-  return success1 && success2;
+  OM_PROFILE_BEGIN(profile_start);
+  CanMessage msgs[2];
+  msgs[0].id = TX_ID_GROUP1;
+  msgs[1].id = TX_ID_GROUP2;
+  om_rm_core_get_output_group(&rm->core, msgs[0].data, 0);
+  om_rm_core_get_output_group(&rm->core, msgs[1].data, 1);
+  msgs[0].len = 8;
+  msgs[1].len = 8;
+  // 送信待ちの古い指令値は新しい値で置き換える
+  msgs[0].flags = CAN_MSG_FLAG_REPLACE;
+  msgs[1].flags = CAN_MSG_FLAG_REPLACE;
+  const bool ok = can_bus_write_batch(rm->can, msgs, 2) == 2;
+  OM_PROFILE_END(OM_PROFILE_RM_WRITE, profile_start);
+  return ok;
 }
 
 int16_t om_rm_get_current(const Robomas* rm, int id) {
@@ -60,6 +128,10 @@ uint8_t om_rm_get_temp(const Robomas* rm, int id) {
   return om_rm_core_get_temp(&rm->core, id);
 }
 
+uint32_t om_rm_get_timestamp(const Robomas* rm, int id) {
+  return om_rm_core_get_timestamp(&rm->core, id);
+}
+
 RobomasData om_rm_get_data(const Robomas* rm, int id) {
   return om_rm_core_get_data(&rm->core, id);
 }
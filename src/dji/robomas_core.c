@@ -6,8 +6,8 @@ const uint16_t M3508_GEAR_RATIO = 19;
 const uint16_t M2006_GEAR_RATIO = 36;
 const uint16_t ANGLE_MAX_VALUE = 8192;
 
-static const uint32_t RX_ID_MIN = 0x201;
-static const uint32_t RX_ID_MAX = 0x208;
+const uint32_t RX_ID_MIN = 0x201;
+const uint32_t RX_ID_MAX = 0x208;
 
 const uint32_t TX_ID_GROUP1 = 0x200;
 const uint32_t TX_ID_GROUP2 = 0x1FF;
@@ -18,6 +18,7 @@ RobomasData om_rm_data_init() {
   data.rpm = 0;
   data.current = 0;
   data.temp = 0;
+  data.timestamp_us = 0;
   return data;
 }
 
@@ -123,6 +124,23 @@ uint8_t om_rm_core_get_temp(const RobomasCore* core, int id) {
   return core->data_[index].temp;
 }
 
+void om_rm_core_set_timestamp(RobomasCore* core, int id,
+                              uint32_t timestamp_us) {
+  if (id < 1 || id > 8) {
+    return;
+  }
+  int index = id - 1;
+  core->data_[index].timestamp_us = timestamp_us;
+}
+
+uint32_t om_rm_core_get_timestamp(const RobomasCore* core, int id) {
+  if (id < 1 || id > 8) {
+    return 0;
+  }
+  int index = id - 1;
+  return core->data_[index].timestamp_us;
+}
+
 RobomasData om_rm_core_get_data(const RobomasCore* core, int id) {
   if (id < 1 || id > 8) {
     return om_rm_data_init();
@@ -0,0 +1,307 @@
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE  // CLOCK_MONOTONIC
+#endif
+
+#include "event/event_loop.h"
+
+#include <string.h>
+
+#ifdef OMURAISU_EVENT_LOOP_ENABLE
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+static uint64_t event_loop_tag(int source, uint16_t generation) {
+  return ((uint64_t)generation << 32) | (uint32_t)source;
+}
+
+static int event_loop_add_source(EventLoop* loop, EventSourceKind kind, int fd,
+                                 uint32_t events) {
+  struct epoll_event ev;
+
+  if (loop->epoll_fd < 0 || fd < 0) {
+    return -1;
+  }
+  for (int i = 0; i < EVENT_LOOP_MAX_SOURCES; ++i) {
+    EventSource* source = &loop->sources[i];
+    if (source->kind != EVENT_SOURCE_NONE) {
+      continue;
+    }
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.u64 = event_loop_tag(i, (uint16_t)(source->generation + 1U));
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+      return -1;
+    }
+    source->generation++;
+    source->kind = kind;
+    source->fd = fd;
+    source->socketcan = 0;
+    source->serial = 0;
+    return i;
+  }
+  return -1;
+}
+
+static void event_loop_dispatch_socketcan(EventSource* source) {
+  CanMessage msgs[CAN_SOCKETCAN_BATCH_SIZE];
+  size_t count = 0;
+  const uint16_t generation = source->generation;
+
+  while ((count = can_socketcan_read_batch(source->socketcan, msgs,
+                                           CAN_SOCKETCAN_BATCH_SIZE)) > 0U) {
+    for (size_t i = 0; i < count; ++i) {
+      source->callback.can(&msgs[i], source->user_arg);
+      // コールバックがこのソースを削除した（スロットが別のソースに再利用された）
+      // ら、残りのフレームは配らない
+      if (source->kind != EVENT_SOURCE_SOCKETCAN ||
+          source->generation != generation) {
+        return;
+      }
+    }
+  }
+}
+
+static void event_loop_dispatch(EventSource* source, uint32_t events) {
+  uint64_t expirations = 0;
+
+  switch (source->kind) {
+    case EVENT_SOURCE_FD:
+      source->callback.fd(source->fd, events, source->user_arg);
+      break;
+    case EVENT_SOURCE_TIMER:
+      if (read(source->fd, &expirations, sizeof(expirations)) ==
+          (ssize_t)sizeof(expirations)) {
+        source->callback.timer(expirations, source->user_arg);
+      }
+      break;
+    case EVENT_SOURCE_SOCKETCAN:
+      event_loop_dispatch_socketcan(source);
+      break;
+    case EVENT_SOURCE_SERIAL:
+      serial_posix_on_readable(source->serial);
+      break;
+    default:
+      break;
+  }
+}
+
+bool event_loop_init(EventLoop* loop) {
+  memset(loop, 0, sizeof(*loop));
+  for (int i = 0; i < EVENT_LOOP_MAX_SOURCES; ++i) {
+    loop->sources[i].fd = -1;
+  }
+  loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  return loop->epoll_fd >= 0;
+}
+
+void event_loop_close(EventLoop* loop) {
+  for (int i = 0; i < EVENT_LOOP_MAX_SOURCES; ++i) {
+    event_loop_remove(loop, i);
+  }
+  if (loop->epoll_fd >= 0) {
+    close(loop->epoll_fd);
+  }
+  loop->epoll_fd = -1;
+  loop->running = false;
+}
+
+int event_loop_add_fd(EventLoop* loop, int fd, uint32_t events,
+                      EventFdFn callback, void* user_arg) {
+  if (callback == 0) {
+    return -1;
+  }
+  int index = event_loop_add_source(loop, EVENT_SOURCE_FD, fd, events);
+  if (index >= 0) {
+    loop->sources[index].callback.fd = callback;
+    loop->sources[index].user_arg = user_arg;
+  }
+  return index;
+}
+
+int event_loop_add_timer(EventLoop* loop, uint32_t period_us,
+                         EventTimerFn callback, void* user_arg) {
+  struct itimerspec spec;
+
+  if (callback == 0 || period_us == 0U) {
+    return -1;
+  }
+  int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (fd < 0) {
+    return -1;
+  }
+  memset(&spec, 0, sizeof(spec));
+  spec.it_interval.tv_sec = (time_t)(period_us / 1000000U);
+  spec.it_interval.tv_nsec = (long)(period_us % 1000000U) * 1000L;
+  spec.it_value = spec.it_interval;
+  if (timerfd_settime(fd, 0, &spec, 0) != 0) {
+    close(fd);
+    return -1;
+  }
+
+  int index = event_loop_add_source(loop, EVENT_SOURCE_TIMER, fd, EPOLLIN);
+  if (index < 0) {
+    close(fd);
+    return -1;
+  }
+  loop->sources[index].callback.timer = callback;
+  loop->sources[index].user_arg = user_arg;
+  return index;
+}
+
+int event_loop_add_socketcan(EventLoop* loop, CanSocketCan* socketcan,
+                             CanRxCallback callback, void* user_arg) {
+  if (socketcan == 0 || callback == 0) {
+    return -1;
+  }
+  int index = event_loop_add_source(loop, EVENT_SOURCE_SOCKETCAN,
+                                    can_socketcan_fd(socketcan), EPOLLIN);
+  if (index >= 0) {
+    loop->sources[index].callback.can = callback;
+    loop->sources[index].user_arg = user_arg;
+    loop->sources[index].socketcan = socketcan;
+  }
+  return index;
+}
+
+int event_loop_add_serial(EventLoop* loop, SerialPosix* serial,
+                          SerialRxCallback callback, void* user_arg) {
+  if (serial == 0) {
+    return -1;
+  }
+  int index = event_loop_add_source(loop, EVENT_SOURCE_SERIAL,
+                                    serial_posix_fd(serial), EPOLLIN);
+  if (index >= 0) {
+    serial_posix_set_rx_callback(serial, callback, user_arg);
+    loop->sources[index].serial = serial;
+  }
+  return index;
+}
+
+bool event_loop_remove(EventLoop* loop, int source) {
+  if (source < 0 || source >= EVENT_LOOP_MAX_SOURCES) {
+    return false;
+  }
+  EventSource* entry = &loop->sources[source];
+  if (entry->kind == EVENT_SOURCE_NONE) {
+    return false;
+  }
+
+  epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, entry->fd, 0);
+  if (entry->kind == EVENT_SOURCE_TIMER) {
+    close(entry->fd);
+  }
+  entry->kind = EVENT_SOURCE_NONE;
+  entry->fd = -1;
+  return true;
+}
+
+int event_loop_run_once(EventLoop* loop, int timeout_ms) {
+  struct epoll_event events[EVENT_LOOP_MAX_EVENTS];
+
+  if (loop->epoll_fd < 0) {
+    return -1;
+  }
+  int count = epoll_wait(loop->epoll_fd, events, EVENT_LOOP_MAX_EVENTS,
+                         timeout_ms);
+  if (count < 0) {
+    return errno == EINTR ? 0 : -1;
+  }
+
+  int dispatched = 0;
+  for (int i = 0; i < count; ++i) {
+    const uint32_t index = (uint32_t)events[i].data.u64;
+    const uint16_t generation = (uint16_t)(events[i].data.u64 >> 32);
+    EventSource* source = &loop->sources[index];
+
+    // 同じ epoll_wait の結果を処理する間に削除・再登録されたソースは飛ばす
+    if (source->kind == EVENT_SOURCE_NONE ||
+        source->generation != generation) {
+      continue;
+    }
+    event_loop_dispatch(source, events[i].events);
+    ++dispatched;
+  }
+  loop->dispatch_count += (uint32_t)dispatched;
+  return dispatched;
+}
+
+void event_loop_run(EventLoop* loop) {
+  loop->running = true;
+  while (loop->running) {
+    if (event_loop_run_once(loop, -1) < 0) {
+      break;
+    }
+  }
+  loop->running = false;
+}
+
+void event_loop_stop(EventLoop* loop) { loop->running = false; }
+
+#else
+
+bool event_loop_init(EventLoop* loop) {
+  memset(loop, 0, sizeof(*loop));
+  loop->epoll_fd = -1;
+  return false;
+}
+
+void event_loop_close(EventLoop* loop) { loop->epoll_fd = -1; }
+
+int event_loop_add_fd(EventLoop* loop, int fd, uint32_t events,
+                      EventFdFn callback, void* user_arg) {
+  (void)loop;
+  (void)fd;
+  (void)events;
+  (void)callback;
+  (void)user_arg;
+  return -1;
+}
+
+int event_loop_add_timer(EventLoop* loop, uint32_t period_us,
+                         EventTimerFn callback, void* user_arg) {
+  (void)loop;
+  (void)period_us;
+  (void)callback;
+  (void)user_arg;
+  return -1;
+}
+
+int event_loop_add_socketcan(EventLoop* loop, CanSocketCan* socketcan,
+                             CanRxCallback callback, void* user_arg) {
+  (void)loop;
+  (void)socketcan;
+  (void)callback;
+  (void)user_arg;
+  return -1;
+}
+
+int event_loop_add_serial(EventLoop* loop, SerialPosix* serial,
+                          SerialRxCallback callback, void* user_arg) {
+  (void)loop;
+  (void)serial;
+  (void)callback;
+  (void)user_arg;
+  return -1;
+}
+
+bool event_loop_remove(EventLoop* loop, int source) {
+  (void)loop;
+  (void)source;
+  return false;
+}
+
+int event_loop_run_once(EventLoop* loop, int timeout_ms) {
+  (void)loop;
+  (void)timeout_ms;
+  return -1;
+}
+
+void event_loop_run(EventLoop* loop) { (void)loop; }
+
+void event_loop_stop(EventLoop* loop) { loop->running = false; }
+
+#endif  // OMURAISU_EVENT_LOOP_ENABLE
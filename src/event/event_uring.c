@@ -0,0 +1,544 @@
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE  // MAP_ANONYMOUS
+#endif
+
+#include "event/event_uring.h"
+
+#include <string.h>
+
+#include "ring/spsc_ring.h"
+
+SPSC_RING_ASSERT_POW2(EVENT_URING_QUEUE_DEPTH);
+SPSC_RING_ASSERT_POW2(EVENT_URING_CAN_BUFFERS);
+SPSC_RING_ASSERT_POW2(EVENT_URING_SERIAL_BUFFERS);
+
+#ifdef OMURAISU_EVENT_URING_ENABLE
+#include <errno.h>
+#include <linux/can.h>
+#include <linux/io_uring.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+_Static_assert(sizeof(struct can_frame) == 16U,
+               "EventUringTxSlot assumes a 16-byte can_frame");
+
+// 古いヘッダには無い IORING_OP_READ_MULTISHOT（Linux 6.7）。複数回完了する
+// recv（IORING_RECV_MULTISHOT）は 6.0 から。
+#define EVENT_URING_OP_READ_MULTISHOT 49U
+
+// user_data の最上位ビットが立っていれば送信（下位は送信スロット番号）
+#define EVENT_URING_TX_TAG (1ULL << 63)
+
+static int event_uring_setup(unsigned entries, struct io_uring_params* p) {
+  return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int event_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                             unsigned flags) {
+  return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+                      NULL, 0);
+}
+
+static int event_uring_register(int fd, unsigned opcode, void* arg,
+                                unsigned nr_args) {
+  return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+// 次の投入エントリを確保する（満杯なら NULL）
+static struct io_uring_sqe* event_uring_get_sqe(EventUring* uring) {
+  const uint32_t head = SPSC_RING_LOAD_ACQUIRE(uring->sq_head);
+  const uint32_t tail = *uring->sq_tail + uring->sq_pending;
+
+  if (tail - head >= uring->sq_entries) {
+    return NULL;
+  }
+  struct io_uring_sqe* sqe =
+      &((struct io_uring_sqe*)uring->sqes)[tail & uring->sq_mask];
+  memset(sqe, 0, sizeof(*sqe));
+  uring->sq_array[tail & uring->sq_mask] = tail & uring->sq_mask;
+  uring->sq_pending++;
+  return sqe;
+}
+
+// 送信用の投入エントリを確保し、直前に積んだ同じ fd への送信とつなぐ
+static struct io_uring_sqe* event_uring_get_tx_sqe(EventUring* uring, int fd,
+                                                   uint16_t slot,
+                                                   uint32_t len) {
+  const uint32_t tail = *uring->sq_tail + uring->sq_pending;
+  struct io_uring_sqe* sqe = event_uring_get_sqe(uring);
+
+  if (sqe == NULL) {
+    return NULL;
+  }
+  // つなげるのは SQ で隣り合う未投入のエントリだけ（間に受信要求が入ったり、
+  // 前のエントリが投入済みだったりすればつながない）
+  if (uring->sq_pending > 1U && uring->tx_link_fd == fd &&
+      uring->tx_link_tail + 1U == tail) {
+    struct io_uring_sqe* prev =
+        &((struct io_uring_sqe*)uring->sqes)[uring->tx_link_tail &
+                                             uring->sq_mask];
+    prev->flags |= IOSQE_IO_LINK;
+  }
+  uring->tx_link_fd = fd;
+  uring->tx_link_tail = tail;
+
+  sqe->fd = fd;
+  sqe->len = len;
+  sqe->user_data = EVENT_URING_TX_TAG | slot;
+  uring->tx_len[slot] = (uint16_t)len;
+  return sqe;
+}
+
+static void event_uring_publish_sqes(EventUring* uring) {
+  SPSC_RING_STORE_RELEASE(uring->sq_tail, *uring->sq_tail + uring->sq_pending);
+}
+
+static void event_uring_provide_buffer(EventUringSource* source, uint16_t bid) {
+  struct io_uring_buf_ring* ring = (struct io_uring_buf_ring*)source->buf_ring;
+  struct io_uring_buf* buf =
+      &ring->bufs[source->buf_tail & (source->buf_count - 1U)];
+
+  if (source->kind == EVENT_URING_SOURCE_CAN) {
+    buf->addr = (uint64_t)(uintptr_t)&((struct can_frame*)source->buffers)[bid];
+    buf->len = (uint32_t)sizeof(struct can_frame);
+  } else {
+    SerialMessage* msg = &((SerialMessage*)source->buffers)[bid];
+    buf->addr = (uint64_t)(uintptr_t)msg->data;
+    buf->len = SERIAL_MESSAGE_MAX_LEN;
+  }
+  buf->bid = bid;
+  source->buf_tail++;
+  SPSC_RING_STORE_RELEASE(&ring->tail, source->buf_tail);
+}
+
+static bool event_uring_arm(EventUring* uring, int index) {
+  EventUringSource* source = &uring->sources[index];
+  struct io_uring_sqe* sqe = event_uring_get_sqe(uring);
+
+  if (sqe == NULL) {
+    return false;
+  }
+  sqe->fd = source->fd;
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = (uint16_t)index;
+  sqe->user_data = (uint64_t)index;
+  if (source->kind == EVENT_URING_SOURCE_CAN) {
+    sqe->opcode = IORING_OP_RECV;
+    if (source->multishot) {
+      sqe->ioprio = IORING_RECV_MULTISHOT;
+    } else {
+      sqe->len = (uint32_t)sizeof(struct can_frame);
+    }
+  } else if (source->multishot) {
+    sqe->opcode = EVENT_URING_OP_READ_MULTISHOT;
+    sqe->off = (uint64_t)-1;
+  } else {
+    sqe->opcode = IORING_OP_READ;
+    sqe->len = SERIAL_MESSAGE_MAX_LEN;
+    sqe->off = (uint64_t)-1;
+  }
+  source->armed = true;
+  return true;
+}
+
+static int event_uring_add_source(EventUring* uring, EventUringSourceKind kind,
+                                  int fd, uint16_t buf_count,
+                                  size_t buffer_size) {
+  struct io_uring_buf_reg reg;
+
+  if (uring->ring_fd < 0 || fd < 0) {
+    return -1;
+  }
+  for (int i = 0; i < EVENT_URING_MAX_SOURCES; ++i) {
+    EventUringSource* source = &uring->sources[i];
+    if (source->kind != EVENT_URING_SOURCE_NONE) {
+      continue;
+    }
+
+    const size_t ring_size = buf_count * sizeof(struct io_uring_buf);
+    void* ring = mmap(NULL, ring_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED) {
+      return -1;
+    }
+    void* buffers = calloc(buf_count, buffer_size);
+    if (buffers == NULL) {
+      munmap(ring, ring_size);
+      return -1;
+    }
+
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)ring;
+    reg.ring_entries = buf_count;
+    reg.bgid = (uint16_t)i;
+    if (event_uring_register(uring->ring_fd, IORING_REGISTER_PBUF_RING, &reg,
+                             1U) != 0) {
+      free(buffers);
+      munmap(ring, ring_size);
+      return -1;
+    }
+
+    memset(source, 0, sizeof(*source));
+    source->kind = kind;
+    source->fd = fd;
+    source->multishot = true;
+    source->buf_ring = ring;
+    source->buf_ring_size = ring_size;
+    source->buffers = buffers;
+    source->buf_count = buf_count;
+    for (uint16_t bid = 0; bid < buf_count; ++bid) {
+      event_uring_provide_buffer(source, bid);
+    }
+    event_uring_arm(uring, i);
+    return i;
+  }
+  return -1;
+}
+
+static void event_uring_deliver(EventUring* uring, EventUringSource* source,
+                                uint16_t bid, int32_t res) {
+  if (source->kind == EVENT_URING_SOURCE_CAN) {
+    const struct can_frame* frame =
+        &((const struct can_frame*)source->buffers)[bid];
+    CanMessage msg;
+
+    if (res == (int32_t)sizeof(*frame) &&
+        (frame->can_id & (CAN_RTR_FLAG | CAN_ERR_FLAG)) == 0U) {
+      memset(&msg, 0, sizeof(msg));
+      msg.id = (frame->can_id & CAN_EFF_FLAG) != 0U
+                   ? frame->can_id & CAN_EFF_MASK
+                   : frame->can_id & CAN_SFF_MASK;
+      msg.len = frame->can_dlc > 8U ? 8U : frame->can_dlc;
+      memcpy(msg.data, frame->data, msg.len);
+      uring->rx_count++;
+      source->callback.can(&msg, source->user_arg);
+    }
+  } else {
+    SerialMessage* msg = &((SerialMessage*)source->buffers)[bid];
+    msg->len = (uint16_t)res;
+    uring->rx_count++;
+    if (source->callback.serial != 0) {
+      source->callback.serial(msg, source->user_arg);
+    }
+  }
+  event_uring_provide_buffer(source, bid);
+}
+
+static void event_uring_complete_rx(EventUring* uring, int index,
+                                    const struct io_uring_cqe* cqe) {
+  EventUringSource* source = &uring->sources[index];
+
+  if (cqe->res > 0 && (cqe->flags & IORING_CQE_F_BUFFER) != 0U) {
+    event_uring_deliver(uring, source,
+                        (uint16_t)(cqe->flags >> IORING_CQE_BUFFER_SHIFT),
+                        cqe->res);
+  } else if (cqe->res == -ENOBUFS) {
+    uring->rx_overflows++;
+  } else if (cqe->res == -EINVAL && source->multishot) {
+    // 複数回完了する recv（Linux 6.0）/ read（6.7）が無いカーネルでは
+    // 1 回ずつの recv / read に切り替える
+    source->multishot = false;
+  } else if (cqe->res <= 0 && cqe->res != -EAGAIN && cqe->res != -EINTR) {
+    source->failed = true;  // EOF・切断・取り消し
+  }
+
+  if ((cqe->flags & IORING_CQE_F_MORE) == 0U) {
+    source->armed = false;
+  }
+}
+
+static void event_uring_complete_tx(EventUring* uring, uint16_t slot,
+                                    const struct io_uring_cqe* cqe) {
+  // 書ききれなかった送信も失敗として数える（残りは出し直さない）
+  if (cqe->res != (int32_t)uring->tx_len[slot]) {
+    uring->tx_errors++;
+  } else {
+    uring->tx_count++;
+  }
+  uring->tx_free[uring->tx_free_count++] = slot;
+}
+
+bool event_uring_init(EventUring* uring) {
+  struct io_uring_params params;
+
+  memset(uring, 0, sizeof(*uring));
+  uring->ring_fd = -1;
+  uring->tx_link_fd = -1;
+  for (uint16_t i = 0; i < EVENT_URING_TX_SLOTS; ++i) {
+    uring->tx_free[i] = (uint16_t)(EVENT_URING_TX_SLOTS - 1U - i);
+  }
+  uring->tx_free_count = EVENT_URING_TX_SLOTS;
+
+  memset(&params, 0, sizeof(params));
+  int fd = event_uring_setup(EVENT_URING_QUEUE_DEPTH, &params);
+  if (fd < 0) {
+    return false;
+  }
+  uring->ring_fd = fd;
+
+  uring->sq_ring_size =
+      params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  uring->cq_ring_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0U) {
+    if (uring->cq_ring_size > uring->sq_ring_size) {
+      uring->sq_ring_size = uring->cq_ring_size;
+    }
+    uring->cq_ring_size = 0U;
+  }
+
+  uring->sq_ring = mmap(NULL, uring->sq_ring_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (uring->sq_ring == MAP_FAILED) {
+    uring->sq_ring = NULL;
+    event_uring_close(uring);
+    return false;
+  }
+  if (uring->cq_ring_size == 0U) {
+    uring->cq_ring = uring->sq_ring;
+  } else {
+    uring->cq_ring = mmap(NULL, uring->cq_ring_size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (uring->cq_ring == MAP_FAILED) {
+      uring->cq_ring = NULL;
+      event_uring_close(uring);
+      return false;
+    }
+  }
+  uring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  uring->sqes = mmap(NULL, uring->sqes_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (uring->sqes == MAP_FAILED) {
+    uring->sqes = NULL;
+    event_uring_close(uring);
+    return false;
+  }
+
+  uint8_t* sq = (uint8_t*)uring->sq_ring;
+  uint8_t* cq = (uint8_t*)uring->cq_ring;
+  uring->sq_head = (uint32_t*)(sq + params.sq_off.head);
+  uring->sq_tail = (uint32_t*)(sq + params.sq_off.tail);
+  uring->sq_mask = *(uint32_t*)(sq + params.sq_off.ring_mask);
+  uring->sq_entries = params.sq_entries;
+  uring->sq_array = (uint32_t*)(sq + params.sq_off.array);
+  uring->cq_head = (uint32_t*)(cq + params.cq_off.head);
+  uring->cq_tail = (uint32_t*)(cq + params.cq_off.tail);
+  uring->cq_mask = *(uint32_t*)(cq + params.cq_off.ring_mask);
+  uring->cqes = cq + params.cq_off.cqes;
+  return true;
+}
+
+void event_uring_close(EventUring* uring) {
+  // リングを閉じるとカーネル側の要求は全て取り消される
+  if (uring->ring_fd >= 0) {
+    close(uring->ring_fd);
+  }
+  uring->ring_fd = -1;
+  if (uring->sqes != NULL) {
+    munmap(uring->sqes, uring->sqes_size);
+  }
+  if (uring->cq_ring != NULL && uring->cq_ring != uring->sq_ring) {
+    munmap(uring->cq_ring, uring->cq_ring_size);
+  }
+  if (uring->sq_ring != NULL) {
+    munmap(uring->sq_ring, uring->sq_ring_size);
+  }
+  uring->sqes = NULL;
+  uring->cq_ring = NULL;
+  uring->sq_ring = NULL;
+
+  for (int i = 0; i < EVENT_URING_MAX_SOURCES; ++i) {
+    EventUringSource* source = &uring->sources[i];
+    if (source->kind == EVENT_URING_SOURCE_NONE) {
+      continue;
+    }
+    munmap(source->buf_ring, source->buf_ring_size);
+    free(source->buffers);
+    memset(source, 0, sizeof(*source));
+  }
+}
+
+int event_uring_add_can(EventUring* uring, int fd, CanRxCallback callback,
+                        void* user_arg) {
+  if (callback == 0) {
+    return -1;
+  }
+  int index = event_uring_add_source(uring, EVENT_URING_SOURCE_CAN, fd,
+                                     EVENT_URING_CAN_BUFFERS,
+                                     sizeof(struct can_frame));
+  if (index >= 0) {
+    uring->sources[index].callback.can = callback;
+    uring->sources[index].user_arg = user_arg;
+  }
+  return index;
+}
+
+int event_uring_add_serial(EventUring* uring, int fd,
+                           SerialRxCallback callback, void* user_arg) {
+  int index = event_uring_add_source(uring, EVENT_URING_SOURCE_SERIAL, fd,
+                                     EVENT_URING_SERIAL_BUFFERS,
+                                     sizeof(SerialMessage));
+  if (index >= 0) {
+    uring->sources[index].callback.serial = callback;
+    uring->sources[index].user_arg = user_arg;
+  }
+  return index;
+}
+
+size_t event_uring_write_can(EventUring* uring, int fd, const CanMessage* msgs,
+                             size_t count) {
+  size_t queued = 0;
+
+  if (uring->ring_fd < 0) {
+    return 0;
+  }
+  while (queued < count && uring->tx_free_count > 0U) {
+    const CanMessage* msg = &msgs[queued];
+    const uint16_t slot = uring->tx_free[uring->tx_free_count - 1U];
+    struct io_uring_sqe* sqe = event_uring_get_tx_sqe(
+        uring, fd, slot, (uint32_t)sizeof(struct can_frame));
+    if (sqe == NULL) {
+      break;
+    }
+
+    uring->tx_free_count--;
+    struct can_frame* frame =
+        (struct can_frame*)uring->tx_slots[slot].can_frame;
+    memset(frame, 0, sizeof(*frame));
+    frame->can_id = msg->id <= CAN_SFF_MASK
+                        ? msg->id
+                        : (msg->id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+    frame->can_dlc = msg->len > 8U ? 8U : msg->len;
+    memcpy(frame->data, msg->data, frame->can_dlc);
+
+    sqe->opcode = IORING_OP_SEND;
+    sqe->addr = (uint64_t)(uintptr_t)frame;
+    ++queued;
+  }
+  return queued;
+}
+
+bool event_uring_write_serial(EventUring* uring, int fd,
+                              const SerialMessage* msg) {
+  if (uring->ring_fd < 0 || uring->tx_free_count == 0U) {
+    return false;
+  }
+  const uint16_t slot = uring->tx_free[uring->tx_free_count - 1U];
+  const uint32_t len = msg->len > SERIAL_MESSAGE_MAX_LEN
+                           ? (uint32_t)SERIAL_MESSAGE_MAX_LEN
+                           : (uint32_t)msg->len;
+  struct io_uring_sqe* sqe = event_uring_get_tx_sqe(uring, fd, slot, len);
+  if (sqe == NULL) {
+    return false;
+  }
+
+  uring->tx_free_count--;
+  SerialMessage* copy = &uring->tx_slots[slot].serial;
+  *copy = *msg;
+  copy->len = (uint16_t)len;
+
+  sqe->opcode = IORING_OP_WRITE;
+  sqe->addr = (uint64_t)(uintptr_t)copy->data;
+  sqe->off = (uint64_t)-1;
+  return true;
+}
+
+int event_uring_run_once(EventUring* uring, bool wait) {
+  if (uring->ring_fd < 0) {
+    return -1;
+  }
+
+  // 止まった受信要求を出し直す
+  for (int i = 0; i < EVENT_URING_MAX_SOURCES; ++i) {
+    EventUringSource* source = &uring->sources[i];
+    if (source->kind != EVENT_URING_SOURCE_NONE && !source->armed &&
+        !source->failed) {
+      event_uring_arm(uring, i);
+    }
+  }
+
+  const uint32_t to_submit = uring->sq_pending;
+  event_uring_publish_sqes(uring);
+  uring->sq_pending = 0U;
+  const uint32_t head = *uring->cq_head;
+  const bool has_cqe = SPSC_RING_LOAD_ACQUIRE(uring->cq_tail) != head;
+  if (to_submit > 0U || (wait && !has_cqe)) {
+    uring->enter_count++;
+    if (event_uring_enter(uring->ring_fd, to_submit, wait ? 1U : 0U,
+                          wait ? IORING_ENTER_GETEVENTS : 0U) < 0 &&
+        errno != EINTR && errno != EBUSY) {
+      return -1;
+    }
+  }
+
+  const uint32_t rx_before = uring->rx_count;
+  uint32_t cq_head = *uring->cq_head;
+  const uint32_t cq_tail = SPSC_RING_LOAD_ACQUIRE(uring->cq_tail);
+  while (cq_head != cq_tail) {
+    const struct io_uring_cqe* cqe =
+        &((const struct io_uring_cqe*)uring->cqes)[cq_head & uring->cq_mask];
+    if ((cqe->user_data & EVENT_URING_TX_TAG) != 0U) {
+      event_uring_complete_tx(uring, (uint16_t)cqe->user_data, cqe);
+    } else {
+      event_uring_complete_rx(uring, (int)cqe->user_data, cqe);
+    }
+    ++cq_head;
+  }
+  SPSC_RING_STORE_RELEASE(uring->cq_head, cq_head);
+  return (int)(uring->rx_count - rx_before);
+}
+
+#else
+
+bool event_uring_init(EventUring* uring) {
+  memset(uring, 0, sizeof(*uring));
+  uring->ring_fd = -1;
+  return false;
+}
+
+void event_uring_close(EventUring* uring) { uring->ring_fd = -1; }
+
+int event_uring_add_can(EventUring* uring, int fd, CanRxCallback callback,
+                        void* user_arg) {
+  (void)uring;
+  (void)fd;
+  (void)callback;
+  (void)user_arg;
+  return -1;
+}
+
+int event_uring_add_serial(EventUring* uring, int fd,
+                           SerialRxCallback callback, void* user_arg) {
+  (void)uring;
+  (void)fd;
+  (void)callback;
+  (void)user_arg;
+  return -1;
+}
+
+size_t event_uring_write_can(EventUring* uring, int fd, const CanMessage* msgs,
+                             size_t count) {
+  (void)uring;
+  (void)fd;
+  (void)msgs;
+  (void)count;
+  return 0;
+}
+
+bool event_uring_write_serial(EventUring* uring, int fd,
+                              const SerialMessage* msg) {
+  (void)uring;
+  (void)fd;
+  (void)msg;
+  return false;
+}
+
+int event_uring_run_once(EventUring* uring, bool wait) {
+  (void)uring;
+  (void)wait;
+  return -1;
+}
+
+#endif  // OMURAISU_EVENT_URING_ENABLE
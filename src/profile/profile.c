@@ -0,0 +1,156 @@
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE  // CLOCK_MONOTONIC
+#endif
+
+#include "profile/profile.h"
+
+#include <string.h>
+
+#if !defined(OM_PROFILE_HAS_DWT) && (defined(__unix__) || defined(__APPLE__))
+#include <time.h>
+
+static uint64_t om_profile_monotonic_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+#ifndef OM_PROFILE_HAS_RDTSC
+uint32_t om_profile_now(void) { return (uint32_t)om_profile_monotonic_ns(); }
+#endif
+#endif
+
+#ifdef OM_PROFILE_HAS_DWT
+#define OM_PROFILE_DEMCR (*(volatile uint32_t*)0xE000EDFCUL)
+#define OM_PROFILE_DWT_CTRL (*(volatile uint32_t*)0xE0001000UL)
+#define OM_PROFILE_DWT_LAR (*(volatile uint32_t*)0xE0001FB0UL)
+#define OM_PROFILE_DEMCR_TRCENA (1UL << 24)
+#define OM_PROFILE_DWT_CYCCNTENA (1UL << 0)
+#endif
+
+static const char* const kBuiltinNames[OM_PROFILE_USER_FIRST] = {
+    [OM_PROFILE_CAN_CUBE_RX] = "can_cube_rx",
+    [OM_PROFILE_CAN_CUBE_TX] = "can_cube_tx",
+    [OM_PROFILE_SERIAL_STM32_RX] = "serial_stm32_rx",
+    [OM_PROFILE_CAN_DISPATCH] = "can_dispatch",
+    [OM_PROFILE_CAN_SCHEDULER] = "can_scheduler",
+    [OM_PROFILE_RM_READ] = "rm_read",
+    [OM_PROFILE_RM_WRITE] = "rm_write",
+};
+
+_Static_assert(OM_PROFILE_MAX_REGIONS >= OM_PROFILE_USER_FIRST,
+               "OM_PROFILE_MAX_REGIONS must cover the built-in regions");
+_Static_assert(OM_PROFILE_HIST_BINS >= 2,
+               "OM_PROFILE_HIST_BINS must be at least 2");
+
+static ProfileRegion g_regions[OM_PROFILE_MAX_REGIONS];
+static int g_region_count = OM_PROFILE_USER_FIRST;
+static uint32_t g_ticks_per_us = 1U;
+static uint32_t g_periods;
+
+static uint32_t om_profile_calibrate(void) {
+#if defined(OM_PROFILE_HAS_RDTSC) && (defined(__unix__) || defined(__APPLE__))
+  const uint64_t begin_ns = om_profile_monotonic_ns();
+  const uint32_t begin = om_profile_now();
+  uint64_t elapsed_ns = 0;
+  do {
+    elapsed_ns = om_profile_monotonic_ns() - begin_ns;
+  } while (elapsed_ns < 10000000U);
+  const uint64_t ticks = (uint32_t)(om_profile_now() - begin);
+  const uint64_t per_us = ticks * 1000U / elapsed_ns;
+  return per_us != 0U ? (uint32_t)per_us : 1U;
+#elif !defined(OM_PROFILE_HAS_DWT) && (defined(__unix__) || defined(__APPLE__))
+  return 1000U;
+#else
+  return 1U;
+#endif
+}
+
+void om_profile_init(uint32_t ticks_per_us) {
+#ifdef OM_PROFILE_HAS_DWT
+  OM_PROFILE_DEMCR |= OM_PROFILE_DEMCR_TRCENA;
+  OM_PROFILE_DWT_LAR = 0xC5ACCE55UL;  // Cortex-M7 は書き込みの解錠が必要
+  OM_PROFILE_DWT_CYCCNT = 0U;
+  OM_PROFILE_DWT_CTRL |= OM_PROFILE_DWT_CYCCNTENA;
+#endif
+#if !defined(OM_PROFILE_HAS_DWT) && !defined(OM_PROFILE_HAS_RDTSC) && \
+    (defined(__unix__) || defined(__APPLE__))
+  // clock_gettime の tick は ns で固定
+  ticks_per_us = 1000U;
+#endif
+
+  memset(g_regions, 0, sizeof(g_regions));
+  for (int i = 0; i < OM_PROFILE_USER_FIRST; ++i) {
+    g_regions[i].name = kBuiltinNames[i];
+  }
+  g_region_count = OM_PROFILE_USER_FIRST;
+  g_ticks_per_us = ticks_per_us != 0U ? ticks_per_us : om_profile_calibrate();
+  g_periods = 0U;
+}
+
+uint32_t om_profile_ticks_per_us(void) { return g_ticks_per_us; }
+
+int om_profile_register(const char* name) {
+  if (name == 0 || g_region_count >= OM_PROFILE_MAX_REGIONS) {
+    return -1;
+  }
+
+  ProfileRegion* region = &g_regions[g_region_count];
+  memset(region, 0, sizeof(*region));
+  region->name = name;
+  return g_region_count++;
+}
+
+void om_profile_record(int id, uint32_t ticks) {
+  if (id < 0 || id >= OM_PROFILE_MAX_REGIONS) {
+    return;
+  }
+
+  ProfileRegion* region = &g_regions[id];
+  if (region->name == 0 && id < OM_PROFILE_USER_FIRST) {
+    // om_profile_init 前でもライブラリ内の区間は名前付きで残す
+    region->name = kBuiltinNames[id];
+  }
+  if (region->calls == 0U || ticks < region->min_ticks) {
+    region->min_ticks = ticks;
+  }
+  if (ticks > region->max_ticks) {
+    region->max_ticks = ticks;
+  }
+  region->calls++;
+  region->total_ticks += ticks;
+
+  // 1 µs, 2 µs, 4 µs, ... の境界と比べる（除算を避ける）
+  uint32_t bin = 0;
+  uint32_t edge = g_ticks_per_us;
+  while (bin < OM_PROFILE_HIST_BINS - 1U && ticks >= edge) {
+    bin++;
+    edge <<= 1;
+  }
+  region->hist[bin]++;
+}
+
+void om_profile_mark_period(void) { g_periods++; }
+
+uint32_t om_profile_period_count(void) { return g_periods; }
+
+void om_profile_reset(void) {
+  for (int i = 0; i < OM_PROFILE_MAX_REGIONS; ++i) {
+    ProfileRegion* region = &g_regions[i];
+    const char* name = region->name;
+    memset(region, 0, sizeof(*region));
+    region->name = name;
+  }
+  g_periods = 0U;
+}
+
+const ProfileRegion* om_profile_get(int id) {
+  if (id < 0 || id >= OM_PROFILE_MAX_REGIONS) {
+    return 0;
+  }
+  return &g_regions[id];
+}
+
+float om_profile_ticks_to_us(uint64_t ticks) {
+  return (float)ticks / (float)g_ticks_per_us;
+}
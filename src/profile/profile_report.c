@@ -0,0 +1,76 @@
+#include "profile/profile.h"
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+// printf の浮動小数点対応が無い環境（newlib-nano など）でも出せるよう、
+// µs は 0.01 µs 単位の整数にしてから整形する
+typedef struct {
+  char* buf;
+  size_t size;
+  size_t length;
+} ProfileWriter;
+
+static void om_profile_append(ProfileWriter* writer, const char* format, ...) {
+  if (writer->length + 1U >= writer->size) {
+    return;
+  }
+
+  va_list args;
+  va_start(args, format);
+  const int written = vsnprintf(writer->buf + writer->length,
+                                writer->size - writer->length, format, args);
+  va_end(args);
+  if (written < 0) {
+    return;
+  }
+  writer->length += (size_t)written;
+  if (writer->length >= writer->size) {
+    writer->length = writer->size - 1U;
+  }
+}
+
+static void om_profile_append_us(ProfileWriter* writer, uint64_t ticks,
+                                 uint32_t divisor) {
+  if (divisor == 0U) {
+    om_profile_append(writer, " %10s", "-");
+    return;
+  }
+  const uint64_t cus =
+      ticks * 100U / ((uint64_t)om_profile_ticks_per_us() * divisor);
+  om_profile_append(writer, " %7" PRIu64 ".%02u", cus / 100U,
+                    (unsigned)(cus % 100U));
+}
+
+size_t om_profile_format(char* buf, size_t size) {
+  ProfileWriter writer = {buf, size, 0U};
+  const uint32_t periods = om_profile_period_count();
+  uint64_t total_ticks = 0;
+
+  if (size == 0U) {
+    return 0;
+  }
+  buf[0] = '\0';
+
+  om_profile_append(&writer, "%-16s %10s %10s %10s %10s %10s\n", "region",
+                    "calls", "min_us", "avg_us", "max_us", "us/period");
+  for (int i = 0; i < OM_PROFILE_MAX_REGIONS; ++i) {
+    const ProfileRegion* region = om_profile_get(i);
+    if (region->name == 0 || region->calls == 0U) {
+      continue;
+    }
+    om_profile_append(&writer, "%-16s %10" PRIu32, region->name,
+                      region->calls);
+    om_profile_append_us(&writer, region->min_ticks, 1U);
+    om_profile_append_us(&writer, region->total_ticks, region->calls);
+    om_profile_append_us(&writer, region->max_ticks, 1U);
+    om_profile_append_us(&writer, region->total_ticks, periods);
+    om_profile_append(&writer, "\n");
+    total_ticks += region->total_ticks;
+  }
+  om_profile_append(&writer, "%-16s %43s", "total", "");
+  om_profile_append_us(&writer, total_ticks, periods);
+  om_profile_append(&writer, "\n");
+  return writer.length;
+}
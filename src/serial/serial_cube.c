@@ -3,25 +3,25 @@
 #include <string.h>
 
 static bool serial_cube_queue_push(SerialCube* cube, const SerialMessage* msg) {
-  if (cube->rx_count >= SERIAL_CUBE_RX_QUEUE_SIZE) {
+  uint32_t index = 0;
+  if (!spsc_ring_write_slot(&cube->rx_ring, &index)) {
     cube->rx_overflow_count++;
     return false;
   }
 
-  cube->rx_queue[cube->rx_head] = *msg;
-  cube->rx_head = (uint8_t)((cube->rx_head + 1U) % SERIAL_CUBE_RX_QUEUE_SIZE);
-  cube->rx_count++;
+  cube->rx_queue[index] = *msg;
+  spsc_ring_commit_write(&cube->rx_ring);
   return true;
 }
 
 static bool serial_cube_queue_pop(SerialCube* cube, SerialMessage* msg) {
-  if (cube->rx_count == 0U) {
+  uint32_t index = 0;
+  if (!spsc_ring_read_slot(&cube->rx_ring, &index)) {
     return false;
   }
 
-  *msg = cube->rx_queue[cube->rx_tail];
-  cube->rx_tail = (uint8_t)((cube->rx_tail + 1U) % SERIAL_CUBE_RX_QUEUE_SIZE);
-  cube->rx_count--;
+  *msg = cube->rx_queue[index];
+  spsc_ring_commit_read(&cube->rx_ring);
   return true;
 }
 
@@ -82,6 +82,7 @@ static void serial_cube_port_destroy_impl(void* self) { (void)self; }
 void serial_cube_init(SerialCube* cube, void* hal_context,
                       const SerialCubeOps* ops) {
   memset(cube, 0, sizeof(*cube));
+  spsc_ring_init(&cube->rx_ring, SERIAL_CUBE_RX_QUEUE_SIZE);
 
   cube->hal_context = hal_context;
   if (ops != 0) {
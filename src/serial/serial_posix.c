@@ -0,0 +1,257 @@
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE  // cfmakeraw
+#endif
+
+#include "serial/serial_posix.h"
+
+#include <string.h>
+
+#ifdef OMURAISU_SERIAL_POSIX_ENABLE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+static bool serial_posix_speed(uint32_t baudrate, speed_t* speed) {
+  switch (baudrate) {
+    case 9600U:
+      *speed = B9600;
+      return true;
+    case 19200U:
+      *speed = B19200;
+      return true;
+    case 38400U:
+      *speed = B38400;
+      return true;
+    case 57600U:
+      *speed = B57600;
+      return true;
+    case 115200U:
+      *speed = B115200;
+      return true;
+    case 230400U:
+      *speed = B230400;
+      return true;
+#ifdef B460800
+    case 460800U:
+      *speed = B460800;
+      return true;
+#endif
+#ifdef B921600
+    case 921600U:
+      *speed = B921600;
+      return true;
+#endif
+#ifdef B1000000
+    case 1000000U:
+      *speed = B1000000;
+      return true;
+#endif
+#ifdef B2000000
+    case 2000000U:
+      *speed = B2000000;
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+static bool serial_posix_port_open_impl(void* self) {
+  return serial_posix_open((SerialPosix*)self);
+}
+
+static void serial_posix_port_close_impl(void* self) {
+  serial_posix_close((SerialPosix*)self);
+}
+
+static bool serial_posix_port_write_impl(void* self, const SerialMessage* msg) {
+  SerialPosix* serial = (SerialPosix*)self;
+  uint16_t len = msg->len > SERIAL_MESSAGE_MAX_LEN ? SERIAL_MESSAGE_MAX_LEN
+                                                   : msg->len;
+  uint16_t written = 0;
+
+  if (serial->fd < 0) {
+    return false;
+  }
+  while (written < len) {
+    ssize_t n = write(serial->fd, &msg->data[written], len - written);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // 1 バイトも書いていなければ送らなかったことにして呼び出し側に任せる
+      if (written == 0U || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+        return false;
+      }
+      // 途中まで書いた分は取り消せないため、空くのを待って残りを送り切る
+      // （呼び出し側がパケット全体を送り直すと受信側で壊れる）
+      struct pollfd pfd = {serial->fd, POLLOUT, 0};
+      int ready = poll(&pfd, 1, SERIAL_POSIX_WRITE_TIMEOUT_MS);
+      if (ready < 0 && errno == EINTR) {
+        continue;
+      }
+      if (ready <= 0 || (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) != 0) {
+        return false;
+      }
+      continue;
+    }
+    written = (uint16_t)(written + n);
+  }
+  return true;
+}
+
+static bool serial_posix_port_read_impl(void* self, SerialMessage* msg) {
+  SerialPosix* serial = (SerialPosix*)self;
+
+  if (serial->fd < 0) {
+    return false;
+  }
+  ssize_t n = read(serial->fd, msg->data, SERIAL_MESSAGE_MAX_LEN);
+  if (n <= 0) {
+    return false;
+  }
+  msg->len = (uint16_t)n;
+  return true;
+}
+
+static void serial_posix_port_set_rx_callback_impl(void* self,
+                                                   SerialRxCallback callback,
+                                                   void* user_arg) {
+  serial_posix_set_rx_callback((SerialPosix*)self, callback, user_arg);
+}
+
+static void serial_posix_port_destroy_impl(void* self) {
+  serial_posix_close((SerialPosix*)self);
+}
+
+void serial_posix_init(SerialPosix* serial, const char* device,
+                       uint32_t baudrate) {
+  memset(serial, 0, sizeof(*serial));
+  serial->fd = -1;
+  serial->baudrate = baudrate;
+  if (device != 0) {
+    strncpy(serial->device, device, sizeof(serial->device) - 1U);
+  }
+
+  serial->port.open = serial_posix_port_open_impl;
+  serial->port.close = serial_posix_port_close_impl;
+  serial->port.write = serial_posix_port_write_impl;
+  serial->port.read = serial_posix_port_read_impl;
+  serial->port.set_rx_callback = serial_posix_port_set_rx_callback_impl;
+  serial->port.destroy = serial_posix_port_destroy_impl;
+  serial->port.impl = serial;
+}
+
+bool serial_posix_open(SerialPosix* serial) {
+  struct termios tio;
+  speed_t speed;
+
+  if (serial->fd >= 0) {
+    return true;
+  }
+  if (!serial_posix_speed(serial->baudrate, &speed)) {
+    return false;
+  }
+
+  int fd = open(serial->device, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  if (tcgetattr(fd, &tio) != 0) {
+    close(fd);
+    return false;
+  }
+  cfmakeraw(&tio);
+  tio.c_cflag |= CLOCAL | CREAD;
+  tio.c_cflag &= ~(tcflag_t)CSTOPB;
+  // 非ブロッキングなので待ちは起きない。データが無いときに 0 ではなく EAGAIN
+  // を返させ、io_uring の read がポーリングに回れるようにする
+  tio.c_cc[VMIN] = 1;
+  tio.c_cc[VTIME] = 0;
+  if (cfsetispeed(&tio, speed) != 0 || cfsetospeed(&tio, speed) != 0 ||
+      tcsetattr(fd, TCSANOW, &tio) != 0) {
+    close(fd);
+    return false;
+  }
+  tcflush(fd, TCIOFLUSH);
+
+  serial->fd = fd;
+  return true;
+}
+
+void serial_posix_close(SerialPosix* serial) {
+  if (serial->fd >= 0) {
+    close(serial->fd);
+  }
+  serial->fd = -1;
+}
+
+bool serial_posix_is_open(const SerialPosix* serial) { return serial->fd >= 0; }
+
+SerialPort* serial_posix_port(SerialPosix* serial) { return &serial->port; }
+
+int serial_posix_fd(const SerialPosix* serial) { return serial->fd; }
+
+void serial_posix_set_rx_callback(SerialPosix* serial,
+                                  SerialRxCallback callback, void* user_arg) {
+  serial->rx_callback = callback;
+  serial->rx_callback_user_arg = user_arg;
+}
+
+size_t serial_posix_on_readable(SerialPosix* serial) {
+  SerialMessage msg;
+  size_t total = 0;
+
+  while (serial_posix_port_read_impl(serial, &msg)) {
+    total += msg.len;
+    if (serial->rx_callback != 0) {
+      serial->rx_callback(&msg, serial->rx_callback_user_arg);
+    }
+  }
+  return total;
+}
+
+#else
+
+void serial_posix_init(SerialPosix* serial, const char* device,
+                       uint32_t baudrate) {
+  (void)device;
+  memset(serial, 0, sizeof(*serial));
+  serial->fd = -1;
+  serial->baudrate = baudrate;
+  serial->port.impl = serial;
+}
+
+bool serial_posix_open(SerialPosix* serial) {
+  (void)serial;
+  return false;
+}
+
+void serial_posix_close(SerialPosix* serial) { serial->fd = -1; }
+
+bool serial_posix_is_open(const SerialPosix* serial) {
+  (void)serial;
+  return false;
+}
+
+SerialPort* serial_posix_port(SerialPosix* serial) { return &serial->port; }
+
+int serial_posix_fd(const SerialPosix* serial) {
+  (void)serial;
+  return -1;
+}
+
+void serial_posix_set_rx_callback(SerialPosix* serial,
+                                  SerialRxCallback callback, void* user_arg) {
+  serial->rx_callback = callback;
+  serial->rx_callback_user_arg = user_arg;
+}
+
+size_t serial_posix_on_readable(SerialPosix* serial) {
+  (void)serial;
+  return 0;
+}
+
+#endif  // OMURAISU_SERIAL_POSIX_ENABLE
@@ -2,9 +2,7 @@
 
 #include <string.h>
 
-#ifndef OMURAISU_SERIAL_STM32_MAX_CONTEXTS
-#define OMURAISU_SERIAL_STM32_MAX_CONTEXTS 4
-#endif
+#include "profile/profile.h"
 
 #ifndef OMURAISU_SERIAL_STM32_HAL_HEADER
 #define OMURAISU_SERIAL_STM32_HAL_HEADER "main.h"
@@ -17,42 +15,90 @@
 #ifdef OMURAISU_SERIAL_STM32_ENABLE
 #include OMURAISU_SERIAL_STM32_HAL_HEADER
 
-typedef struct {
-  SerialStm32Context* context;
-} SerialStm32Slot;
+// USART1〜3, UART4/5, USART6, UART7〜9, USART10, LPUART1
+#define SERIAL_STM32_PERIPHERAL_COUNT 11
 
-static SerialStm32Slot g_slots[OMURAISU_SERIAL_STM32_MAX_CONTEXTS];
+// 周辺機能ごとの登録先。割り込みからは Instance で直接引く。
+static SerialStm32Context* g_contexts[SERIAL_STM32_PERIPHERAL_COUNT];
 
-static SerialStm32Context* serial_stm32_find_context(void* handle) {
-  for (int i = 0; i < OMURAISU_SERIAL_STM32_MAX_CONTEXTS; ++i) {
-    if (g_slots[i].context != 0 && g_slots[i].context->handle == handle) {
-      return g_slots[i].context;
-    }
-  }
-  return 0;
-}
+static int serial_stm32_peripheral_index(const void* handle) {
+  const void* instance = 0;
 
-static bool serial_stm32_rx_push(SerialStm32Context* context, uint8_t value) {
-  uint16_t buffer_size = (uint16_t)(sizeof(context->rx_buffer));
-  if (context->rx_count >= buffer_size) {
-    return false;
+  if (handle == 0) {
+    return -1;
+  }
+  instance = ((const UART_HandleTypeDef*)handle)->Instance;
+#ifdef USART1
+  if (instance == (const void*)USART1) {
+    return 0;
+  }
+#endif
+#ifdef USART2
+  if (instance == (const void*)USART2) {
+    return 1;
+  }
+#endif
+#ifdef USART3
+  if (instance == (const void*)USART3) {
+    return 2;
+  }
+#endif
+#ifdef UART4
+  if (instance == (const void*)UART4) {
+    return 3;
+  }
+#endif
+#ifdef UART5
+  if (instance == (const void*)UART5) {
+    return 4;
+  }
+#endif
+#ifdef USART6
+  if (instance == (const void*)USART6) {
+    return 5;
+  }
+#endif
+#ifdef UART7
+  if (instance == (const void*)UART7) {
+    return 6;
   }
+#endif
+#ifdef UART8
+  if (instance == (const void*)UART8) {
+    return 7;
+  }
+#endif
+#ifdef UART9
+  if (instance == (const void*)UART9) {
+    return 8;
+  }
+#endif
+#ifdef USART10
+  if (instance == (const void*)USART10) {
+    return 9;
+  }
+#endif
+#ifdef LPUART1
+  if (instance == (const void*)LPUART1) {
+    return 10;
+  }
+#endif
+  return -1;
+}
 
-  context->rx_buffer[context->rx_head] = value;
-  context->rx_head = (uint16_t)((context->rx_head + 1U) % buffer_size);
-  context->rx_count++;
-  return true;
+static SerialStm32Context* serial_stm32_find_context(void* handle) {
+  const int index = serial_stm32_peripheral_index(handle);
+  return index < 0 ? 0 : g_contexts[index];
 }
 
-static bool serial_stm32_rx_pop(SerialStm32Context* context, uint8_t* value) {
-  uint16_t buffer_size = (uint16_t)(sizeof(context->rx_buffer));
-  if (context->rx_count == 0U) {
+static bool serial_stm32_rx_push(SerialStm32Context* context, uint8_t value) {
+  uint32_t index = 0;
+  if (!spsc_ring_write_slot(&context->rx_ring, &index)) {
     return false;
   }
 
-  *value = context->rx_buffer[context->rx_tail];
-  context->rx_tail = (uint16_t)((context->rx_tail + 1U) % buffer_size);
-  context->rx_count--;
+  context->rx_buffer[index] = value;
+  spsc_ring_commit_write(&context->rx_ring);
   return true;
 }
 
@@ -81,21 +127,23 @@ static bool serial_stm32_write(void* self, const SerialMessage* msg) {
 
 static bool serial_stm32_read_hw(void* self, SerialMessage* msg) {
   SerialStm32Context* context = (SerialStm32Context*)self;
-  uint16_t count = 0;
+  uint32_t count = 0;
 
   if (msg == 0) {
     return false;
   }
 
-  while (count < SERIAL_MESSAGE_MAX_LEN) {
-    uint8_t value = 0;
-    if (!serial_stm32_rx_pop(context, &value)) {
-      break;
-    }
-    msg->data[count++] = value;
+  count = spsc_ring_readable(&context->rx_ring);
+  if (count > SERIAL_MESSAGE_MAX_LEN) {
+    count = SERIAL_MESSAGE_MAX_LEN;
   }
+  for (uint32_t i = 0; i < count; ++i) {
+    uint32_t index = spsc_ring_read_index(&context->rx_ring, i);
+    msg->data[i] = context->rx_buffer[index];
+  }
+  spsc_ring_commit_read_n(&context->rx_ring, count);
 
-  msg->len = count;
+  msg->len = (uint16_t)count;
   return count > 0;
 }
 
@@ -114,6 +162,7 @@ static void serial_stm32_stop_read(void* self) {
 void serial_stm32_context_init(SerialStm32Context* context, SerialCube* cube,
                                void* handle) {
   memset(context, 0, sizeof(*context));
+  spsc_ring_init(&context->rx_ring, SERIAL_STM32_RX_BUFFER_SIZE);
   context->cube = cube;
   context->handle = handle;
 }
@@ -128,24 +177,20 @@ void serial_stm32_make_ops(SerialCubeOps* ops) {
 }
 
 bool serial_stm32_register(SerialStm32Context* context) {
-  for (int i = 0; i < OMURAISU_SERIAL_STM32_MAX_CONTEXTS; ++i) {
-    if (g_slots[i].context == context) {
-      return true;
-    }
-    if (g_slots[i].context == 0) {
-      g_slots[i].context = context;
-      return true;
-    }
+  const int index = serial_stm32_peripheral_index(context->handle);
+
+  if (index < 0 || (g_contexts[index] != 0 && g_contexts[index] != context)) {
+    return false;
   }
-  return false;
+  g_contexts[index] = context;
+  return true;
 }
 
 void serial_stm32_unregister(SerialStm32Context* context) {
-  for (int i = 0; i < OMURAISU_SERIAL_STM32_MAX_CONTEXTS; ++i) {
-    if (g_slots[i].context == context) {
-      g_slots[i].context = 0;
-      return;
-    }
+  const int index = serial_stm32_peripheral_index(context->handle);
+
+  if (index >= 0 && g_contexts[index] == context) {
+    g_contexts[index] = 0;
   }
 }
 
@@ -155,10 +200,12 @@ void serial_stm32_dispatch_rx(void* handle) {
     return;
   }
 
+  OM_PROFILE_BEGIN(profile_start);
   serial_stm32_rx_push(context, context->rx_byte);
   (void)HAL_UART_Receive_IT((UART_HandleTypeDef*)context->handle,
                             &context->rx_byte, 1U);
   serial_cube_on_rx_pending(context->cube);
+  OM_PROFILE_END(OM_PROFILE_SERIAL_STM32_RX, profile_start);
 }
 
 void HAL_UART_RxCpltCallback(UART_HandleTypeDef* huart) {
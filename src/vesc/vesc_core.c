@@ -107,6 +107,18 @@ int om_vesc_core_parse(VescCore* core, uint32_t id, const uint8_t data[8]) {
   return controller_id;
 }
 
+static void om_vesc_core_on_can_message(const CanMessage* msg,
+                                        void* user_arg) {
+  om_vesc_core_parse((VescCore*)user_arg, msg->id, msg->data);
+}
+
+bool om_vesc_core_attach(VescCore* core, CanDispatcher* dispatcher) {
+  // 拡張 ID の上位ビットも照合し、(STATUS << 8) | コントローラ ID だけに一致させる
+  return can_dispatcher_add_mask(dispatcher, VESC_CAN_PACKET_STATUS << 8,
+                                 CAN_EXT_ID_MAX & ~0xFFU,
+                                 om_vesc_core_on_can_message, core);
+}
+
 void om_vesc_core_set_current(VescCore* core, float current, uint8_t id) {
   const float clamped_current =
       om_vesc_clamp_float(current, core->max_current_);
@@ -0,0 +1,319 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "can/can_capture.h"
+#include "dji/robomas.h"
+
+namespace {
+
+bool ExpectTrue(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << message << std::endl;
+    return false;
+  }
+  return true;
+}
+
+const char kCapturePath[] = "can_capture_cpp_test.omcap";
+const char kCandumpPath[] = "can_capture_cpp_test.log";
+
+constexpr uint64_t kBaseTime = 1000000000ULL;
+constexpr std::size_t kRecordCount = 5000U;
+
+uint32_t IdOf(std::size_t i) {
+  static const uint32_t ids[] = {0x201U, 0x202U, 0x203U, 0x204U, 0x200U,
+                                 0x0901U};
+  return ids[i % 6U];
+}
+
+uint64_t TimeOf(std::size_t i) { return kBaseTime + i * 250U; }
+
+bool BuildCapture() {
+  ::CanCaptureBuilder builder;
+  if (!can_capture_builder_open(&builder, kCapturePath)) {
+    return false;
+  }
+  for (std::size_t i = 0; i < kRecordCount; ++i) {
+    ::CanLogRecord record = {};
+    record.msg.id = IdOf(i);
+    record.msg.len = 8U;
+    record.msg.data[0] = static_cast<uint8_t>(i >> 8);
+    record.msg.data[1] = static_cast<uint8_t>(i);
+    record.time_us = TimeOf(i);
+    can_capture_builder_append(&builder, &record);
+  }
+  return can_capture_builder_finish(&builder);
+}
+
+bool TestLowerBoundMatchesLinearScan() {
+  ::CanCapture capture;
+  if (!ExpectTrue(can_capture_open(&capture, kCapturePath) &&
+                      can_capture_count(&capture) == kRecordCount,
+                  "capture should open with every record")) {
+    return false;
+  }
+
+  bool ok = true;
+  const uint64_t probes[] = {0U,
+                             kBaseTime,
+                             kBaseTime + 1U,
+                             TimeOf(1023U),
+                             TimeOf(1024U),
+                             TimeOf(1024U) + 1U,
+                             TimeOf(3000U) - 1U,
+                             TimeOf(kRecordCount - 1U),
+                             TimeOf(kRecordCount)};
+  for (uint64_t t : probes) {
+    std::size_t expected = 0;
+    while (expected < kRecordCount && TimeOf(expected) < t) {
+      ++expected;
+    }
+    ok = ExpectTrue(can_capture_lower_bound(&capture, t) == expected,
+                    "lower bound should match a linear scan") &&
+         ok;
+  }
+  can_capture_close(&capture);
+  return ok;
+}
+
+bool TestQueryIdInTimeRange() {
+  ::CanCapture capture;
+  can_capture_open(&capture, kCapturePath);
+
+  const uint64_t t0 = TimeOf(1000U);
+  const uint64_t t1 = TimeOf(4000U);
+  ::CanCaptureCursor cursor;
+  if (!ExpectTrue(can_capture_query_id(&capture, &cursor, 0x203U, t0, t1),
+                  "0x203 should be indexed")) {
+    return false;
+  }
+
+  std::size_t expected = 0;
+  for (std::size_t i = 1000U; i < 4000U; ++i) {
+    expected += IdOf(i) == 0x203U ? 1U : 0U;
+  }
+  if (!ExpectTrue(can_capture_cursor_remaining(&cursor) == expected,
+                  "query should count only frames in range")) {
+    return false;
+  }
+
+  // マップ上のフレームをそのままドライバに渡す
+  Robomas rm = om_rm_init(nullptr);
+  const ::CanMessage* msg = nullptr;
+  uint64_t last_time = 0;
+  bool ordered = true;
+  while ((msg = can_capture_next(&cursor)) != nullptr) {
+    const uint64_t t = can_capture_time_us(&capture, msg);
+    ordered = ordered && msg->id == 0x203U && t >= t0 && t < t1 &&
+              t >= last_time;
+    last_time = t;
+    om_rm_parse(&rm, msg->id, msg->data);
+  }
+  if (!ExpectTrue(ordered, "frames should be 0x203 in time order")) {
+    return false;
+  }
+  if (!ExpectTrue(om_rm_get_angle(&rm, 3) == 3998U,
+                  "parser should consume frames straight from the mapping")) {
+    return false;
+  }
+
+  ::CanCaptureCursor all;
+  can_capture_query(&capture, &all, t0, t1);
+  const bool all_ok = can_capture_cursor_remaining(&all) == 3000U &&
+                      can_capture_next(&all) == &can_capture_records(
+                                                    &capture)[1000U];
+  const bool missing =
+      !can_capture_query_id(&capture, &cursor, 0x7FFU, t0, t1) &&
+      can_capture_next(&cursor) == nullptr;
+  can_capture_close(&capture);
+  return ExpectTrue(all_ok && missing,
+                    "range queries should be zero-copy and ids may be absent");
+}
+
+bool TestCandumpImport() {
+  std::FILE* text = std::fopen(kCandumpPath, "w");
+  if (text == nullptr) {
+    return false;
+  }
+  std::fputs("(100.000000) can0 201#0001020304050607\n", text);
+  std::fputs("(100.000500) can0 00000901#00000064\n", text);
+  std::fputs("\n", text);
+  std::fputs("garbage\n", text);
+  std::fputs("(100.001000) can0 202#\n", text);
+  std::fclose(text);
+
+  text = std::fopen(kCandumpPath, "r");
+  std::size_t count = 0;
+  const bool ok = can_capture_import_candump(text, kCapturePath, &count);
+  std::fclose(text);
+  if (!ExpectTrue(!ok && count == 3U,
+                  "bad lines should be reported but skipped")) {
+    return false;
+  }
+
+  ::CanCapture capture;
+  if (!ExpectTrue(can_capture_open(&capture, kCapturePath) &&
+                      can_capture_count(&capture) == 3U,
+                  "imported capture should open")) {
+    return false;
+  }
+  const ::CanMessage* records = can_capture_records(&capture);
+  const bool fields_ok =
+      records[1].id == 0x901U && records[1].data[3] == 0x64U &&
+      can_capture_time_us(&capture, &records[2]) == 100001000ULL &&
+      records[2].len == 0U;
+  can_capture_close(&capture);
+  return ExpectTrue(fields_ok, "imported frames should keep id and time");
+}
+
+bool TestRejectsForeignFiles() {
+  std::FILE* file = std::fopen(kCandumpPath, "w");
+  std::fputs("not a capture file at all, just some text\n", file);
+  std::fclose(file);
+
+  ::CanCapture capture;
+  return ExpectTrue(!can_capture_open(&capture, kCandumpPath) &&
+                        !can_capture_open(&capture, "no_such_file.omcap"),
+                    "invalid files should not open");
+}
+
+// ヘッダを書き換えたコピーを作る。patch は書き換え後のファイル内容を受け取る。
+template <typename Patch>
+bool WritePatchedCapture(const char* path, Patch patch) {
+  std::FILE* file = std::fopen(kCapturePath, "rb");
+  if (file == nullptr) {
+    return false;
+  }
+  std::vector<uint8_t> bytes;
+  uint8_t chunk[4096];
+  std::size_t n = 0;
+  while ((n = std::fread(chunk, 1U, sizeof(chunk), file)) != 0U) {
+    bytes.insert(bytes.end(), chunk, chunk + n);
+  }
+  std::fclose(file);
+
+  ::CanCaptureHeader header;
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  patch(&header, &bytes);
+  std::memcpy(bytes.data(), &header, sizeof(header));
+
+  file = std::fopen(path, "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  const bool ok = std::fwrite(bytes.data(), 1U, bytes.size(), file) ==
+                  bytes.size();
+  std::fclose(file);
+  return ok;
+}
+
+bool OpensCleanly(const char* path) {
+  ::CanCapture capture;
+  if (!can_capture_open(&capture, path)) {
+    return false;
+  }
+  can_capture_close(&capture);
+  return true;
+}
+
+// 全時間の ID 問い合わせがレコード配列の中の、その ID のフレームだけを返すか
+bool QueryIdStaysInRange(const char* path, uint32_t id) {
+  ::CanCapture capture;
+  if (!can_capture_open(&capture, path)) {
+    return false;
+  }
+  const ::CanMessage* begin = can_capture_records(&capture);
+  const ::CanMessage* end = begin + can_capture_count(&capture);
+  ::CanCaptureCursor cursor;
+  bool ok = can_capture_query_id(&capture, &cursor, id, 0U, UINT64_MAX);
+  std::size_t count = 0;
+  for (const ::CanMessage* msg = nullptr;
+       ok && (msg = can_capture_next(&cursor)) != nullptr; ++count) {
+    ok = msg >= begin && msg < end && msg->id == id;
+  }
+  can_capture_close(&capture);
+  return ok && count > 0U;
+}
+
+bool TestRejectsCorruptIndex() {
+  const char kCorruptPath[] = "can_capture_cpp_test_corrupt.omcap";
+  bool ok = ExpectTrue(BuildCapture(), "capture should be written");
+
+  ok = ExpectTrue(WritePatchedCapture(kCorruptPath,
+                                      [](::CanCaptureHeader*,
+                                         std::vector<uint8_t>*) {}) &&
+                      OpensCleanly(kCorruptPath),
+                  "an unmodified copy should open") &&
+       ok;
+
+  // ID テーブルの範囲がレコード番号表の外を指す
+  ok = ExpectTrue(
+           WritePatchedCapture(
+               kCorruptPath,
+               [](::CanCaptureHeader* header, std::vector<uint8_t>* bytes) {
+                 ::CanCaptureIdEntry entry;
+                 uint8_t* at = bytes->data() + header->id_table_offset;
+                 std::memcpy(&entry, at, sizeof(entry));
+                 entry.first = header->record_count - 1U;
+                 std::memcpy(at, &entry, sizeof(entry));
+               }) &&
+               !OpensCleanly(kCorruptPath),
+           "an ID entry past the postings should be rejected") &&
+       ok;
+
+  // レコード番号がレコード数を超える（開けるが、問い合わせで読み飛ばす）
+  ok = ExpectTrue(
+           WritePatchedCapture(
+               kCorruptPath,
+               [](::CanCaptureHeader* header, std::vector<uint8_t>* bytes) {
+                 const uint32_t bad = 0xFFFFFFF0U;
+                 std::memcpy(bytes->data() + header->postings_offset +
+                                 sizeof(uint32_t) * 7U,
+                             &bad, sizeof(bad));
+               }) &&
+               QueryIdStaysInRange(kCorruptPath, 0x200U),
+           "a posting past the records should be skipped") &&
+       ok;
+
+  // 時刻インデックスがファイル内に収まるがレコード数と合わない
+  ok = ExpectTrue(WritePatchedCapture(kCorruptPath,
+                                      [](::CanCaptureHeader* header,
+                                         std::vector<uint8_t>*) {
+                                        header->time_index_count += 2U;
+                                      }) &&
+                      !OpensCleanly(kCorruptPath),
+                  "a time index that does not match the records should be "
+                  "rejected") &&
+       ok;
+
+  std::remove(kCorruptPath);
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = ExpectTrue(BuildCapture(), "capture should be written");
+
+  ok = ok && TestLowerBoundMatchesLinearScan();
+  ok = ok && TestQueryIdInTimeRange();
+  ok = TestCandumpImport() && ok;
+  ok = TestRejectsForeignFiles() && ok;
+  ok = TestRejectsCorruptIndex() && ok;
+
+  std::remove(kCapturePath);
+  std::remove(kCandumpPath);
+
+  if (!ok) {
+    std::cerr << "can_capture_cpp_test failed" << std::endl;
+    return 1;
+  }
+
+  std::cout << "can_capture_cpp_test passed" << std::endl;
+  return 0;
+}
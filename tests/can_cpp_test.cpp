@@ -115,6 +115,84 @@ bool TestCCanBusAdapter() {
                     "adapter start/stop should call C callbacks");
 }
 
+bool TestReadBatchFallsBackToRead() {
+  FakeCBusContext ctx = {};
+  ctx.read_result = true;
+  ctx.read_message.id = 0x456U;
+  ctx.read_message.len = 1U;
+
+  ::CanBus c_bus = {};
+  c_bus.read = FakeCRead;
+  c_bus.impl = &ctx;
+
+  ::CanMessage c_msgs[3] = {};
+  if (!ExpectTrue(can_bus_read_batch(&c_bus, c_msgs, 3U) == 3U,
+                  "read_batch without native support should loop read")) {
+    return false;
+  }
+  if (!ExpectTrue(c_msgs[2].id == 0x456U,
+                  "fallback read_batch should fill every slot")) {
+    return false;
+  }
+
+  omuraisu::can::CCanBusAdapter adapter(&c_bus);
+  omuraisu::can::CanMessage msgs[4];
+  ctx.read_result = false;
+  return ExpectTrue(adapter.read_batch(msgs) == 0U,
+                    "adapter read_batch should stop when read fails");
+}
+
+bool TestFdDlcMapping() {
+  if (!ExpectTrue(can_fd_len_to_dlc(8U) == 8U && can_fd_len_to_dlc(12U) == 9U &&
+                      can_fd_len_to_dlc(64U) == 15U,
+                  "FD lengths should map to DLC codes")) {
+    return false;
+  }
+  if (!ExpectTrue(can_fd_round_len(9U) == 12U && can_fd_round_len(33U) == 48U,
+                  "odd lengths should round up to the next FD length")) {
+    return false;
+  }
+  return ExpectTrue(can_fd_dlc_to_len(13U) == 32U && can_fd_dlc_to_len(5U) == 5U,
+                    "DLC codes should map back to lengths");
+}
+
+bool TestFdFallsBackToClassicBus() {
+  FakeCBusContext ctx = {};
+  ctx.write_result = true;
+  ctx.read_result = true;
+  ctx.read_message.id = 0x456U;
+  ctx.read_message.len = 2U;
+  ctx.read_message.data[1] = 0x55U;
+
+  ::CanBus c_bus = {};
+  c_bus.write = FakeCWrite;
+  c_bus.read = FakeCRead;
+  c_bus.impl = &ctx;
+
+  uint8_t payload[64] = {};
+  payload[3] = 0x33U;
+  omuraisu::can::CanFdMessage classic(0x100U, payload, 4U, 0U);
+  if (!ExpectTrue(can_bus_write_fd(&c_bus, &classic) &&
+                      ctx.last_written.len == 4U &&
+                      ctx.last_written.data[3] == 0x33U,
+                  "short non-FD frames should go through write")) {
+    return false;
+  }
+
+  omuraisu::can::CanFdMessage fd(0x101U, payload, 64U);
+  omuraisu::can::CCanBusAdapter adapter(&c_bus);
+  if (!ExpectTrue(!adapter.write_fd(fd),
+                  "64 byte FD frames need a bus with write_fd")) {
+    return false;
+  }
+
+  omuraisu::can::CanFdMessage received;
+  return ExpectTrue(adapter.read_fd(received) && received.id == 0x456U &&
+                        received.len == 2U && received.flags == 0U &&
+                        received.data[1] == 0x55U,
+                    "read_fd should convert classic frames");
+}
+
 class FakeCppBus : public omuraisu::can::ICanBus {
  public:
   bool write_called = false;
@@ -145,6 +223,13 @@ class FakeCppBus : public omuraisu::can::ICanBus {
   void start_read() override { start_called = true; }
 
   void stop_read() override { stop_called = true; }
+
+  omuraisu::can::CanFdMessage written_fd_msg;
+
+  bool write_fd(const omuraisu::can::CanFdMessage& msg) override {
+    written_fd_msg = msg;
+    return true;
+  }
 };
 
 bool TestCppCanBusBridge() {
@@ -155,7 +240,7 @@ bool TestCppCanBusBridge() {
   omuraisu::can::CppCanBusBridge bridge(cpp_bus);
   ::CanBus* c_bus = bridge.c_bus();
 
-  ::CanMessage c_write = {0x222U, {10, 20, 30, 40, 0, 0, 0, 0}, 4U};
+  ::CanMessage c_write = {0x222U, {10, 20, 30, 40, 0, 0, 0, 0}, 4U, 0, 0};
   if (!ExpectTrue(can_bus_write(c_bus, &c_write),
                   "bridge write should succeed through C API")) {
     return false;
@@ -165,7 +250,7 @@ bool TestCppCanBusBridge() {
     return false;
   }
 
-  ::CanMessage c_read = {0, {0}, 0};
+  ::CanMessage c_read = {0, {0}, 0, 0, 0};
   if (!ExpectTrue(can_bus_read(c_bus, &c_read),
                   "bridge read should succeed through C API")) {
     return false;
@@ -176,6 +261,29 @@ bool TestCppCanBusBridge() {
     return false;
   }
 
+  ::CanMessage c_batch[2] = {};
+  if (!ExpectTrue(can_bus_read_batch(c_bus, c_batch, 2U) == 2U,
+                  "bridge read_batch should forward to C++ bus")) {
+    return false;
+  }
+  if (!ExpectTrue(c_batch[1].id == 0x321U && c_batch[1].data[4] == 9U,
+                  "bridge read_batch should copy C++ messages")) {
+    return false;
+  }
+
+  ::CanFdMessage c_fd = {};
+  c_fd.id = 0x333U;
+  c_fd.len = 48U;
+  c_fd.flags = CAN_FD_FLAG_FDF | CAN_FD_FLAG_BRS;
+  c_fd.data[47] = 0x47U;
+  if (!ExpectTrue(can_bus_write_fd(c_bus, &c_fd) &&
+                      cpp_bus.written_fd_msg.len == 48U &&
+                      cpp_bus.written_fd_msg.data[47] == 0x47U &&
+                      cpp_bus.written_fd_msg.flags == c_fd.flags,
+                  "bridge should forward FD frames into C++ bus")) {
+    return false;
+  }
+
   can_bus_start_read(c_bus);
   can_bus_stop_read(c_bus);
   return ExpectTrue(cpp_bus.start_called && cpp_bus.stop_called,
@@ -189,6 +297,9 @@ int main() {
 
   ok = TestCanMessageConversion() && ok;
   ok = TestCCanBusAdapter() && ok;
+  ok = TestReadBatchFallsBackToRead() && ok;
+  ok = TestFdDlcMapping() && ok;
+  ok = TestFdFallsBackToClassicBus() && ok;
   ok = TestCppCanBusBridge() && ok;
 
   if (!ok) {
@@ -0,0 +1,693 @@
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "can/can_cube.h"
+#include "can/can_stm32.h"
+#include "dji/robomas.h"
+
+namespace {
+
+bool ExpectTrue(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << message << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// 送信メールボックス数だけを模擬した HAL
+struct FakeTxHal {
+  uint32_t free_mailboxes;
+  bool tx_notify;
+  int notify_calls;
+  std::size_t sent_count;
+  CanMessage sent[64];
+  std::size_t fd_sent_count;
+  CanFdMessage fd_sent;
+};
+
+bool FakeWrite(void* hal_context, const CanMessage* msg) {
+  FakeTxHal* hal = static_cast<FakeTxHal*>(hal_context);
+  if (hal->free_mailboxes == 0U || hal->sent_count >= 64U) {
+    return false;
+  }
+  hal->free_mailboxes--;
+  hal->sent[hal->sent_count++] = *msg;
+  return true;
+}
+
+bool FakeWriteFd(void* hal_context, const CanFdMessage* msg) {
+  FakeTxHal* hal = static_cast<FakeTxHal*>(hal_context);
+  if (hal->free_mailboxes == 0U) {
+    return false;
+  }
+  hal->free_mailboxes--;
+  hal->fd_sent = *msg;
+  hal->fd_sent_count++;
+  return true;
+}
+
+void FakeSetTxNotify(void* hal_context, bool enable) {
+  FakeTxHal* hal = static_cast<FakeTxHal*>(hal_context);
+  hal->tx_notify = enable;
+  hal->notify_calls++;
+}
+
+void MakeFrames(CanMessage* msgs, std::size_t count, uint32_t first_id) {
+  for (std::size_t i = 0; i < count; ++i) {
+    msgs[i] = CanMessage{};
+    msgs[i].id = first_id + static_cast<uint32_t>(i);
+    msgs[i].len = 1U;
+  }
+}
+
+bool SentInOrder(const FakeTxHal& hal, uint32_t first_id) {
+  for (std::size_t i = 0; i < hal.sent_count; ++i) {
+    if (hal.sent[i].id != first_id + i) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TestWriteBatchQueuesWhenMailboxesFull() {
+  FakeTxHal hal = {};
+  hal.free_mailboxes = 3U;
+  CanCubeOps ops = {};
+  ops.write = FakeWrite;
+  ops.set_tx_notify = FakeSetTxNotify;
+
+  CanCube cube;
+  can_cube_init(&cube, &hal, &ops);
+
+  CanMessage msgs[5];
+  MakeFrames(msgs, 5U, 0x100U);
+  if (!ExpectTrue(can_bus_write_batch(can_cube_bus(&cube), msgs, 5U) == 5U,
+                  "all frames should be accepted while the queue has room")) {
+    return false;
+  }
+  if (!ExpectTrue(hal.sent_count == 3U &&
+                      can_cube_get_tx_pending_count(&cube) == 2U,
+                  "frames beyond the mailboxes should wait in the queue")) {
+    return false;
+  }
+  if (!ExpectTrue(hal.tx_notify, "TX notification should stay enabled")) {
+    return false;
+  }
+
+  // 後から書いたフレームがキューを追い越さないこと
+  hal.free_mailboxes = 1U;
+  CanMessage late;
+  MakeFrames(&late, 1U, 0x105U);
+  if (!ExpectTrue(can_bus_write(can_cube_bus(&cube), &late),
+                  "write should queue behind pending frames")) {
+    return false;
+  }
+
+  hal.free_mailboxes = 3U;
+  can_cube_on_tx_ready(&cube);
+  if (!ExpectTrue(hal.sent_count == 6U && SentInOrder(hal, 0x100U),
+                  "TX ready should flush the queue in FIFO order")) {
+    return false;
+  }
+  return ExpectTrue(
+      !hal.tx_notify && can_cube_get_tx_pending_count(&cube) == 0U,
+      "TX notification should be disabled once drained");
+}
+
+bool TestTxQueueOverflow() {
+  FakeTxHal hal = {};
+  CanCubeOps ops = {};
+  ops.write = FakeWrite;
+  ops.set_tx_notify = FakeSetTxNotify;
+
+  CanCube cube;
+  can_cube_init(&cube, &hal, &ops);
+
+  CanMessage msgs[CAN_CUBE_TX_QUEUE_SIZE + 2U];
+  MakeFrames(msgs, CAN_CUBE_TX_QUEUE_SIZE + 2U, 0x200U);
+  const std::size_t accepted = can_bus_write_batch(
+      can_cube_bus(&cube), msgs, CAN_CUBE_TX_QUEUE_SIZE + 2U);
+  if (!ExpectTrue(accepted == CAN_CUBE_TX_QUEUE_SIZE,
+                  "write_batch should stop when the queue is full")) {
+    return false;
+  }
+  return ExpectTrue(can_cube_get_tx_overflow_count(&cube) == 1U,
+                    "rejected frame should be counted as overflow");
+}
+
+bool TestWriteWithoutTxNotifyGoesDirect() {
+  FakeTxHal hal = {};
+  hal.free_mailboxes = 2U;
+  CanCubeOps ops = {};
+  ops.write = FakeWrite;
+
+  CanCube cube;
+  can_cube_init(&cube, &hal, &ops);
+
+  CanMessage msgs[3];
+  MakeFrames(msgs, 3U, 0x300U);
+  if (!ExpectTrue(can_bus_write_batch(can_cube_bus(&cube), msgs, 3U) == 2U,
+                  "without TX notification frames should not be queued")) {
+    return false;
+  }
+  return ExpectTrue(can_cube_get_tx_pending_count(&cube) == 0U &&
+                        hal.notify_calls == 0,
+                    "queue should stay unused without set_tx_notify");
+}
+
+bool TestRobomasWriteNeverDropsSecondGroup() {
+  FakeTxHal hal = {};
+  hal.free_mailboxes = 1U;
+  CanCubeOps ops = {};
+  ops.write = FakeWrite;
+  ops.set_tx_notify = FakeSetTxNotify;
+
+  CanCube cube;
+  can_cube_init(&cube, &hal, &ops);
+  Robomas rm = om_rm_init(can_cube_bus(&cube));
+
+  if (!ExpectTrue(om_rm_write(&rm),
+                  "om_rm_write should succeed with a single free mailbox")) {
+    return false;
+  }
+
+  hal.free_mailboxes = 3U;
+  can_cube_on_tx_ready(&cube);
+  return ExpectTrue(hal.sent_count == 2U && hal.sent[0].id == TX_ID_GROUP1 &&
+                        hal.sent[1].id == TX_ID_GROUP2,
+                    "both group frames should reach the hardware");
+}
+
+bool TestWriteFdKeepsQueueOrder() {
+  FakeTxHal hal = {};
+  hal.free_mailboxes = 1U;
+  CanCubeOps ops = {};
+  ops.write = FakeWrite;
+  ops.write_fd = FakeWriteFd;
+  ops.set_tx_notify = FakeSetTxNotify;
+
+  CanCube cube;
+  can_cube_init(&cube, &hal, &ops);
+
+  CanMessage msgs[2];
+  MakeFrames(msgs, 2U, 0x400U);
+  can_bus_write_batch(can_cube_bus(&cube), msgs, 2U);
+
+  CanFdMessage fd = {};
+  fd.id = 0x410U;
+  fd.len = 64U;
+  fd.flags = CAN_FD_FLAG_FDF | CAN_FD_FLAG_BRS;
+  fd.data[63] = 0xA5U;
+#if CAN_CUBE_FD_TX_QUEUE_SIZE > 0
+  if (!ExpectTrue(can_bus_write_fd(can_cube_bus(&cube), &fd) &&
+                      hal.fd_sent_count == 0U &&
+                      can_cube_get_tx_pending_count(&cube) == 2U,
+                  "FD frame should be queued behind queued frames")) {
+    return false;
+  }
+
+  hal.free_mailboxes = 3U;
+  can_cube_on_tx_ready(&cube);
+  if (!ExpectTrue(hal.sent_count == 2U && hal.sent[1].id == 0x401U &&
+                      hal.fd_sent_count == 1U &&
+                      hal.fd_sent.data[63] == 0xA5U && !hal.tx_notify,
+                  "FD frame should be sent after lower ids")) {
+    return false;
+  }
+
+  // FD 送信キューが溢れた分は送信キューの溢れとして数える
+  hal.free_mailboxes = 0U;
+  for (int i = 0; i < CAN_CUBE_FD_TX_QUEUE_SIZE; ++i) {
+    can_bus_write_fd(can_cube_bus(&cube), &fd);
+  }
+  if (!ExpectTrue(!can_bus_write_fd(can_cube_bus(&cube), &fd) &&
+                      can_cube_get_tx_overflow_count(&cube) == 1U &&
+                      can_cube_clear_tx(&cube) == CAN_CUBE_FD_TX_QUEUE_SIZE,
+                  "a full FD queue should count overflows")) {
+    return false;
+  }
+#else
+  // FD 送信キューが無いと、先行フレームを追い越さないよう送らずに数える
+  if (!ExpectTrue(!can_bus_write_fd(can_cube_bus(&cube), &fd) &&
+                      hal.fd_sent_count == 0U &&
+                      can_cube_get_tx_overflow_count(&cube) == 1U,
+                  "FD frame should not overtake queued frames")) {
+    return false;
+  }
+
+  hal.free_mailboxes = 3U;
+  can_cube_on_tx_ready(&cube);
+  if (!ExpectTrue(hal.sent_count == 2U && hal.sent[1].id == 0x401U &&
+                      can_bus_write_fd(can_cube_bus(&cube), &fd) &&
+                      hal.fd_sent_count == 1U &&
+                      hal.fd_sent.data[63] == 0xA5U && !hal.tx_notify,
+                  "FD frame should be sent once the queue is empty")) {
+    return false;
+  }
+#endif
+
+  // 8 バイト以下の従来フレームは送信キューを通る
+  CanFdMessage short_frame = {};
+  short_frame.id = 0x411U;
+  short_frame.len = 2U;
+  hal.free_mailboxes = 0U;
+  return ExpectTrue(can_bus_write_fd(can_cube_bus(&cube), &short_frame) &&
+                        can_cube_get_tx_pending_count(&cube) == 1U,
+                    "classic frames from write_fd should be queued");
+}
+
+bool TestTxQueueSendsLowestIdFirst() {
+  FakeTxHal hal = {};
+  CanCubeOps ops = {};
+  ops.write = FakeWrite;
+  ops.set_tx_notify = FakeSetTxNotify;
+
+  CanCube cube;
+  can_cube_init(&cube, &hal, &ops);
+
+  const uint32_t ids[] = {0x700U, 0x100U, 0x300U, 0x100U, 0x050U};
+  for (std::size_t i = 0; i < 5U; ++i) {
+    CanMessage msg = {};
+    msg.id = ids[i];
+    msg.len = 1U;
+    msg.data[0] = static_cast<uint8_t>(i);
+    can_bus_write(can_cube_bus(&cube), &msg);
+  }
+
+  hal.free_mailboxes = 5U;
+  can_cube_on_tx_ready(&cube);
+  if (!ExpectTrue(hal.sent_count == 5U && hal.sent[0].id == 0x050U &&
+                      hal.sent[3].id == 0x300U && hal.sent[4].id == 0x700U,
+                  "queued frames should leave in arbitration order")) {
+    return false;
+  }
+  return ExpectTrue(hal.sent[1].id == 0x100U && hal.sent[1].data[0] == 1U &&
+                        hal.sent[2].data[0] == 3U,
+                    "frames with the same id should keep their order");
+}
+
+bool TestReplaceCoalescesSetpoints() {
+  FakeTxHal hal = {};
+  CanCubeOps ops = {};
+  ops.write = FakeWrite;
+  ops.set_tx_notify = FakeSetTxNotify;
+
+  CanCube cube;
+  can_cube_init(&cube, &hal, &ops);
+  Robomas rm = om_rm_init(can_cube_bus(&cube));
+
+  // バスが詰まっている間に指令値を 3 回更新する
+  for (int16_t current = 100; current <= 300; current += 100) {
+    om_rm_set_output(&rm, current, 1);
+    om_rm_write(&rm);
+  }
+  if (!ExpectTrue(can_cube_get_tx_pending_count(&cube) == 2U,
+                  "newer setpoints should replace unsent ones")) {
+    return false;
+  }
+
+  hal.free_mailboxes = 3U;
+  can_cube_on_tx_ready(&cube);
+  const int16_t sent_current =
+      static_cast<int16_t>((hal.sent[1].data[0] << 8) | hal.sent[1].data[1]);
+  return ExpectTrue(hal.sent_count == 2U && hal.sent[0].id == TX_ID_GROUP2 &&
+                        hal.sent[1].id == TX_ID_GROUP1 && sent_current == 300,
+                    "only the latest setpoint should reach the bus");
+}
+
+bool TestFullQueueEvictsLowerPriority() {
+  FakeTxHal hal = {};
+  CanCubeOps ops = {};
+  ops.write = FakeWrite;
+  ops.set_tx_notify = FakeSetTxNotify;
+
+  CanCube cube;
+  can_cube_init(&cube, &hal, &ops);
+
+  CanMessage msgs[CAN_CUBE_TX_QUEUE_SIZE];
+  MakeFrames(msgs, CAN_CUBE_TX_QUEUE_SIZE, 0x500U);
+  can_bus_write_batch(can_cube_bus(&cube), msgs, CAN_CUBE_TX_QUEUE_SIZE);
+
+  CanMessage urgent = {};
+  urgent.id = 0x010U;
+  if (!ExpectTrue(can_bus_write(can_cube_bus(&cube), &urgent) &&
+                      can_cube_get_tx_overflow_count(&cube) == 1U,
+                  "high priority frame should push out the lowest one")) {
+    return false;
+  }
+
+  hal.free_mailboxes = CAN_CUBE_TX_QUEUE_SIZE;
+  can_cube_on_tx_ready(&cube);
+  return ExpectTrue(
+      hal.sent_count == CAN_CUBE_TX_QUEUE_SIZE && hal.sent[0].id == 0x010U &&
+          hal.sent[CAN_CUBE_TX_QUEUE_SIZE - 1U].id ==
+              0x500U + CAN_CUBE_TX_QUEUE_SIZE - 2U,
+      "evicted frame should be the lowest priority one");
+}
+
+bool ReadOneClassicFrame(void* hal_context, CanMessage* msg) {
+  int* remaining = static_cast<int*>(hal_context);
+  if (*remaining == 0) {
+    return false;
+  }
+  (*remaining)--;
+  *msg = CanMessage{};
+  msg->id = 0x123U;
+  msg->len = 3U;
+  msg->data[2] = 7U;
+  return true;
+}
+
+bool TestPollFdReturnsClassicFrames() {
+  int remaining = 1;
+  CanCubeOps ops = {};
+  ops.read_hw = ReadOneClassicFrame;
+
+  CanCube cube;
+  can_cube_init(&cube, &remaining, &ops);
+
+  CanFdMessage msg = {};
+  if (!ExpectTrue(!can_cube_poll_fd(&cube, &msg),
+                  "empty cube should have nothing to poll")) {
+    return false;
+  }
+
+  can_cube_on_rx_pending(&cube);
+  return ExpectTrue(can_bus_read_fd(can_cube_bus(&cube), &msg) &&
+                        msg.id == 0x123U && msg.len == 3U &&
+                        msg.data[2] == 7U && msg.flags == 0U,
+                    "read_fd should return classic frames from the RX queue");
+}
+
+uint32_t FakeClock(void* user_arg) {
+  uint32_t* now = static_cast<uint32_t*>(user_arg);
+  return (*now)++;
+}
+
+bool ReadHardwareStampedFrame(void* hal_context, CanMessage* msg) {
+  int* remaining = static_cast<int*>(hal_context);
+  if (*remaining == 0) {
+    return false;
+  }
+  (*remaining)--;
+  *msg = CanMessage{};
+  msg->id = 0x124U;
+  if (*remaining == 0) {
+    msg->flags = CAN_MSG_FLAG_TIMESTAMP;
+    msg->timestamp_us = 999U;
+  }
+  return true;
+}
+
+bool TestRxClockStampsFrames() {
+  int remaining = 3;
+  uint32_t now = 500U;
+  CanCubeOps ops = {};
+  ops.read_hw = ReadHardwareStampedFrame;
+
+  CanCube cube;
+  can_cube_init(&cube, &remaining, &ops);
+  can_cube_set_clock(&cube, FakeClock, &now);
+  can_cube_on_rx_pending(&cube);
+
+  CanMessage msgs[3];
+  if (!ExpectTrue(can_cube_poll_batch(&cube, msgs, 3U) == 3U,
+                  "every frame should be queued")) {
+    return false;
+  }
+  if (!ExpectTrue(now == 502U,
+                  "clock should be read at the start and end of the ISR")) {
+    return false;
+  }
+  if (!ExpectTrue((msgs[0].flags & CAN_MSG_FLAG_TIMESTAMP) != 0U &&
+                      msgs[0].timestamp_us == 500U &&
+                      msgs[1].timestamp_us == 500U,
+                  "frames without a hardware stamp should get the clock")) {
+    return false;
+  }
+  return ExpectTrue(msgs[2].timestamp_us == 999U,
+                    "hardware timestamps should be kept");
+}
+
+struct RxSlotProbe {
+  const CanCube* cube;
+  int calls;
+  int in_queue;
+};
+
+void ProbeRxSlot(const CanMessage* msg, void* user_arg) {
+  RxSlotProbe* probe = static_cast<RxSlotProbe*>(user_arg);
+  const CanMessage* first = &probe->cube->rx_queue[0];
+  probe->calls++;
+  if (msg >= first && msg < first + CAN_CUBE_RX_QUEUE_SIZE) {
+    probe->in_queue++;
+  }
+}
+
+bool TestRxCallbackSeesQueueSlot() {
+  int remaining = CAN_CUBE_RX_QUEUE_SIZE + 2;
+  CanCubeOps ops = {};
+  ops.read_hw = ReadOneClassicFrame;
+
+  CanCube cube;
+  can_cube_init(&cube, &remaining, &ops);
+  RxSlotProbe probe = {&cube, 0, 0};
+  can_cube_set_rx_callback(&cube, ProbeRxSlot, &probe);
+  can_cube_on_rx_pending(&cube);
+
+  // 満杯になった後の 2 フレームはキューに入らないがコールバックには届く
+  bool ok = ExpectTrue(probe.calls == CAN_CUBE_RX_QUEUE_SIZE + 2 &&
+                           probe.in_queue == CAN_CUBE_RX_QUEUE_SIZE &&
+                           can_cube_get_rx_overflow_count(&cube) == 2U,
+                       "the callback should be handed the queue slot");
+  CanMessage msg;
+  ok = ExpectTrue(can_cube_poll(&cube, &msg) && msg.id == 0x123U &&
+                      msg.data[2] == 7U,
+                  "frames read into the slot should be polled") &&
+       ok;
+
+  // コールバックだけに渡すモードではキューを使わない
+  can_cube_init(&cube, &remaining, &ops);
+  probe = RxSlotProbe{&cube, 0, 0};
+  can_cube_set_rx_callback(&cube, ProbeRxSlot, &probe);
+  can_cube_set_rx_mode(&cube, CAN_CUBE_RX_CALLBACK_ONLY);
+  remaining = CAN_CUBE_RX_QUEUE_SIZE + 2;
+  can_cube_on_rx_pending(&cube);
+  return ExpectTrue(probe.calls == CAN_CUBE_RX_QUEUE_SIZE + 2 &&
+                        probe.in_queue == 0 && !can_cube_poll(&cube, &msg) &&
+                        can_cube_get_rx_overflow_count(&cube) == 0U,
+                    "callback-only mode should bypass the queue") &&
+         ok;
+}
+
+struct FakeStatsHal {
+  FakeTxHal tx;
+  int rx_remaining;
+  uint8_t tec;
+  bool bus_off;
+};
+
+bool StatsWrite(void* hal_context, const CanMessage* msg) {
+  return FakeWrite(&static_cast<FakeStatsHal*>(hal_context)->tx, msg);
+}
+
+void StatsSetTxNotify(void* hal_context, bool enable) {
+  FakeSetTxNotify(&static_cast<FakeStatsHal*>(hal_context)->tx, enable);
+}
+
+bool StatsRead(void* hal_context, CanMessage* msg) {
+  return ReadOneClassicFrame(&static_cast<FakeStatsHal*>(hal_context)
+                                  ->rx_remaining,
+                             msg);
+}
+
+void StatsReadErrorState(void* hal_context, CanBusStats* stats) {
+  FakeStatsHal* hal = static_cast<FakeStatsHal*>(hal_context);
+  stats->tec = hal->tec;
+  stats->bus_off = hal->bus_off;
+}
+
+bool TestStatsSnapshot() {
+  FakeStatsHal hal = {};
+  hal.tx.free_mailboxes = 1U;
+  hal.rx_remaining = 2;
+  CanCubeOps ops = {};
+  ops.write = StatsWrite;
+  ops.set_tx_notify = StatsSetTxNotify;
+  ops.read_hw = StatsRead;
+  ops.read_error_state = StatsReadErrorState;
+
+  uint32_t now = 0U;
+  CanCube cube;
+  can_cube_init(&cube, &hal, &ops);
+  can_cube_set_clock(&cube, FakeClock, &now);
+  can_cube_set_bitrate(&cube, 1000000U);
+
+  CanBusStats stats;
+  can_cube_get_stats(&cube, &stats);  // バス負荷の計測区間を始める
+
+  CanMessage msgs[CAN_CUBE_TX_QUEUE_SIZE + 2U];
+  MakeFrames(msgs, CAN_CUBE_TX_QUEUE_SIZE + 2U, 0x500U);
+  can_bus_write_batch(can_cube_bus(&cube), msgs, CAN_CUBE_TX_QUEUE_SIZE + 2U);
+  can_cube_on_rx_pending(&cube);
+
+  now = 1000U;
+  hal.tec = 96U;
+  hal.bus_off = true;
+  if (!ExpectTrue(can_bus_get_stats(can_cube_bus(&cube), &stats),
+                  "CanCube should provide statistics")) {
+    return false;
+  }
+  if (!ExpectTrue(stats.tx_frames == 1U && stats.tx_failures == 1U &&
+                      stats.tx_overflows == 1U &&
+                      stats.tx_queue_high_water == CAN_CUBE_TX_QUEUE_SIZE,
+                  "TX counters should reflect the overflowing batch")) {
+    return false;
+  }
+  if (!ExpectTrue(stats.rx_frames == 2U && stats.rx_queue_high_water == 2U &&
+                      stats.isr_count == 1U && stats.isr_time_us == 1U,
+                  "RX counters should be updated by the ISR")) {
+    return false;
+  }
+  // 1 Mbps で 1 ms に 47+8 bit の TX 1 フレームと 47+24 bit の RX 2 フレーム
+  const float expected_load = (55.0f + 2.0f * 71.0f) / 1000.0f * 100.0f;
+  const float load_error = stats.bus_load_percent - expected_load;
+  if (!ExpectTrue(load_error < 0.5f && load_error > -0.5f,
+                  "bus load should be estimated from frame bits")) {
+    return false;
+  }
+  if (!ExpectTrue(stats.tec == 96U && stats.bus_off &&
+                      stats.bus_off_count == 1U,
+                  "error state should be read from the HAL")) {
+    return false;
+  }
+
+  can_cube_get_stats(&cube, &stats);
+  return ExpectTrue(stats.bus_off_count == 1U,
+                    "staying in bus-off should not count again");
+}
+
+bool TestStm32TimestampExtension() {
+  CanStm32Context context;
+  can_stm32_context_init(&context, nullptr, nullptr, CAN_STM32_KIND_FDCAN, 0U);
+  can_stm32_enable_timestamp(&context, 1000U);
+
+  if (!ExpectTrue(can_stm32_extend_timestamp(&context, 65000U) == 65000U,
+                  "1 tick should be 1 us at 1 Mbps")) {
+    return false;
+  }
+  return ExpectTrue(can_stm32_extend_timestamp(&context, 100U) == 65636U,
+                    "16bit counter wrap should be extended");
+}
+
+void RecordErrorState(CanStm32Context* context, CanStm32ErrorState state,
+                      void* user_arg) {
+  (void)context;
+  CanStm32ErrorState* last = static_cast<CanStm32ErrorState*>(user_arg);
+  *last = state;
+}
+
+bool TestStm32BusOffRecovery() {
+  FakeTxHal hal = {};
+  CanCubeOps ops = {};
+  ops.write = FakeWrite;
+  ops.set_tx_notify = FakeSetTxNotify;
+  CanCube cube;
+  can_cube_init(&cube, &hal, &ops);
+
+  CanStm32Context context;
+  can_stm32_context_init(&context, &cube, nullptr, CAN_STM32_KIND_CAN, 0U);
+  CanStm32ErrorState last = CAN_STM32_ERROR_ACTIVE;
+  can_stm32_set_error_callback(&context, RecordErrorState, &last);
+
+  can_stm32_update_error_state(&context, CAN_STM32_ERROR_WARNING,
+                               CAN_STM32_LEC_ACK, 0U);
+  bool ok = ExpectTrue(last == CAN_STM32_ERROR_WARNING &&
+                           context.last_error == CAN_STM32_LEC_ACK,
+                       "state changes should reach the callback");
+  can_stm32_update_error_state(&context, CAN_STM32_ERROR_BUS_OFF,
+                               CAN_STM32_LEC_NONE, 100U);
+  ok = ExpectTrue(context.bus_off_count == 1U && context.backoff_ms == 10U &&
+                      context.last_error == CAN_STM32_LEC_ACK,
+                  "bus-off should start the initial backoff") &&
+       ok;
+  ok = ExpectTrue(!can_stm32_begin_recovery(&context, 109U) &&
+                      can_stm32_begin_recovery(&context, 110U) &&
+                      context.recovery_count == 1U,
+                  "recovery should wait for the backoff") &&
+       ok;
+
+  // 復帰直後に再びバスオフ → 待ち時間を倍に
+  can_stm32_update_error_state(&context, CAN_STM32_ERROR_ACTIVE,
+                               CAN_STM32_LEC_NONE, 111U);
+  can_stm32_update_error_state(&context, CAN_STM32_ERROR_BUS_OFF,
+                               CAN_STM32_LEC_NONE, 200U);
+  ok = ExpectTrue(context.backoff_ms == 20U &&
+                      !can_stm32_begin_recovery(&context, 219U) &&
+                      can_stm32_begin_recovery(&context, 220U),
+                  "repeated bus-off should double the backoff") &&
+       ok;
+
+  // 安定して動いた後のバスオフは初期値に戻る
+  can_stm32_update_error_state(&context, CAN_STM32_ERROR_ACTIVE,
+                               CAN_STM32_LEC_NONE, 221U);
+  can_stm32_update_error_state(&context, CAN_STM32_ERROR_BUS_OFF,
+                               CAN_STM32_LEC_NONE, 5000U);
+  ok = ExpectTrue(context.backoff_ms == 10U && context.bus_off_count == 3U &&
+                      last == CAN_STM32_ERROR_BUS_OFF,
+                  "backoff should reset after a stable period") &&
+       ok;
+
+  CanStm32RecoveryPolicy manual = {false, 10U, 1000U, 1000U};
+  can_stm32_set_recovery_policy(&context, &manual);
+  ok = ExpectTrue(!can_stm32_begin_recovery(&context, 10000U),
+                  "manual policy should never restart") &&
+       ok;
+
+  // 再起動の前に捨てる送信キュー
+  hal.free_mailboxes = 0U;
+  CanMessage msgs[3];
+  MakeFrames(msgs, 3U, 0x200U);
+  can_bus_write_batch(can_cube_bus(&cube), msgs, 3U);
+  ok = ExpectTrue(can_cube_clear_tx(&cube) == 3U && !hal.tx_notify &&
+                      can_cube_clear_tx(&cube) == 0U,
+                  "clear_tx should drop the queued frames") &&
+       ok;
+  hal.free_mailboxes = 3U;
+  can_cube_on_tx_ready(&cube);
+  return ExpectTrue(hal.sent_count == 0U,
+                    "dropped frames should not be sent after recovery") &&
+         ok;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+
+  ok = TestWriteBatchQueuesWhenMailboxesFull() && ok;
+  ok = TestTxQueueOverflow() && ok;
+  ok = TestWriteWithoutTxNotifyGoesDirect() && ok;
+  ok = TestRobomasWriteNeverDropsSecondGroup() && ok;
+  ok = TestWriteFdKeepsQueueOrder() && ok;
+  ok = TestTxQueueSendsLowestIdFirst() && ok;
+  ok = TestReplaceCoalescesSetpoints() && ok;
+  ok = TestFullQueueEvictsLowerPriority() && ok;
+  ok = TestPollFdReturnsClassicFrames() && ok;
+  ok = TestRxClockStampsFrames() && ok;
+  ok = TestRxCallbackSeesQueueSlot() && ok;
+  ok = TestStm32TimestampExtension() && ok;
+  ok = TestStatsSnapshot() && ok;
+  ok = TestStm32BusOffRecovery() && ok;
+
+  if (!ok) {
+    std::cerr << "can_cube_cpp_test failed" << std::endl;
+    return 1;
+  }
+
+  std::cout << "can_cube_cpp_test passed" << std::endl;
+  return 0;
+}
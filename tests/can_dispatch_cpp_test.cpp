@@ -0,0 +1,273 @@
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "can/can_dispatch.hpp"
+#include "can/can_stm32.h"
+#include "controller/controller_transport.h"
+#include "dji/robomas.h"
+#include "vesc/vesc_core.h"
+
+namespace {
+
+bool ExpectTrue(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << message << std::endl;
+    return false;
+  }
+  return true;
+}
+
+struct CallCounter {
+  int calls;
+  uint32_t last_id;
+};
+
+void CountCall(const ::CanMessage* msg, void* user_arg) {
+  CallCounter* counter = static_cast<CallCounter*>(user_arg);
+  counter->calls++;
+  counter->last_id = msg->id;
+}
+
+::CanMessage MakeMessage(uint32_t id) {
+  ::CanMessage msg = {};
+  msg.id = id;
+  msg.len = 8U;
+  return msg;
+}
+
+bool TestExactRangeAndMaskRouting() {
+  ::CanDispatcher dispatcher;
+  can_dispatcher_init(&dispatcher);
+
+  CallCounter exact = {};
+  CallCounter range = {};
+  CallCounter mask = {};
+  CallCounter fallback = {};
+  const bool registered =
+      can_dispatcher_add_id(&dispatcher, 0x10U, CountCall, &exact) &&
+      can_dispatcher_add_range(&dispatcher, 0x201U, 0x208U, CountCall,
+                               &range) &&
+      can_dispatcher_add_mask(&dispatcher, 0x900U, 0xFF00U, CountCall, &mask);
+  if (!ExpectTrue(registered, "rules should be registered")) {
+    return false;
+  }
+  can_dispatcher_set_default(&dispatcher, CountCall, &fallback);
+
+  const uint32_t ids[] = {0x10U, 0x201U, 0x208U, 0x905U, 0x1234U, 0x209U};
+  for (uint32_t id : ids) {
+    ::CanMessage msg = MakeMessage(id);
+    can_dispatcher_dispatch(&dispatcher, &msg);
+  }
+
+  if (!ExpectTrue(exact.calls == 1 && range.calls == 2 && mask.calls == 1,
+                  "each frame should reach exactly one handler")) {
+    return false;
+  }
+  if (!ExpectTrue(mask.last_id == 0x905U, "mask rule should see VESC id")) {
+    return false;
+  }
+  return ExpectTrue(fallback.calls == 2 &&
+                        can_dispatcher_get_unmatched_count(&dispatcher) == 2U,
+                    "unmatched frames should go to the default handler");
+}
+
+bool TestOverlappingIdsAreRejected() {
+  ::CanDispatcher dispatcher;
+  can_dispatcher_init(&dispatcher);
+  CallCounter counter = {};
+
+  if (!ExpectTrue(can_dispatcher_add_range(&dispatcher, 0x201U, 0x208U,
+                                           CountCall, &counter),
+                  "first range should be accepted")) {
+    return false;
+  }
+  if (!ExpectTrue(!can_dispatcher_add_id(&dispatcher, 0x204U, CountCall,
+                                         &counter),
+                  "overlapping id should be rejected")) {
+    return false;
+  }
+  if (!ExpectTrue(!can_dispatcher_add_range(&dispatcher, 0x0U, 0x100U,
+                                            CountCall, &counter),
+                  "range larger than the table should be rejected")) {
+    return false;
+  }
+  return ExpectTrue(!can_dispatcher_add_id(&dispatcher, 0x1U, nullptr, nullptr),
+                    "null callback should be rejected");
+}
+
+bool TestDeviceDriversShareOneBus() {
+  ::CanDispatcher dispatcher;
+  can_dispatcher_init(&dispatcher);
+
+  Robomas rm = om_rm_init(nullptr);
+  VescCore vesc = om_vesc_core_init();
+  ControllerData controller = {};
+
+  if (!ExpectTrue(om_rm_attach(&rm, &dispatcher) &&
+                      om_vesc_core_attach(&vesc, &dispatcher) &&
+                      om_ctrl_can_attach(&controller, &dispatcher),
+                  "device drivers should attach to the dispatcher")) {
+    return false;
+  }
+
+  ::CanMessage rm_msg = MakeMessage(0x203U);
+  rm_msg.data[0] = 0x12U;
+  rm_msg.data[1] = 0x34U;
+  ::CanMessage vesc_msg = MakeMessage((VESC_CAN_PACKET_STATUS << 8) | 7U);
+  vesc_msg.data[3] = 100U;
+  ::CanMessage analog_msg = MakeMessage(OM_CONTROLLER_CAN_ID_ANALOG);
+  analog_msg.data[0] = 127U;
+  ::CanMessage buttons_msg = MakeMessage(OM_CONTROLLER_CAN_ID_BUTTONS);
+  buttons_msg.data[2] = 1U;
+
+  can_dispatcher_dispatch(&dispatcher, &rm_msg);
+  can_dispatcher_dispatch(&dispatcher, &vesc_msg);
+  can_dispatcher_dispatch(&dispatcher, &analog_msg);
+  can_dispatcher_dispatch(&dispatcher, &buttons_msg);
+
+  if (!ExpectTrue(om_rm_get_angle(&rm, 3) == 0x1234U,
+                  "Robomas feedback should be routed to the Robomas")) {
+    return false;
+  }
+  if (!ExpectTrue(om_vesc_core_get_rpm(&vesc, 7) == 100,
+                  "VESC status should be routed to the VESC core")) {
+    return false;
+  }
+
+  // 上位ビットが違う拡張 ID は VESC の STATUS ではない
+  ::CanMessage stray_msg =
+      MakeMessage(0x1000000U | (VESC_CAN_PACKET_STATUS << 8) | 7U);
+  stray_msg.data[3] = 50U;
+  can_dispatcher_dispatch(&dispatcher, &stray_msg);
+  if (!ExpectTrue(om_vesc_core_get_rpm(&vesc, 7) == 100,
+                  "other extended ids should not reach the VESC core")) {
+    return false;
+  }
+  return ExpectTrue(controller.left_x == 1.0f &&
+                        (controller.buttons & OM_CONTROLLER_BUTTON_L1) != 0U,
+                    "controller frames should update both halves");
+}
+
+bool TestFiltersFromDriverRules() {
+  ::CanDispatcher dispatcher;
+  can_dispatcher_init(&dispatcher);
+
+  Robomas rm = om_rm_init(nullptr);
+  VescCore vesc = om_vesc_core_init();
+  ControllerData controller = {};
+  om_rm_attach(&rm, &dispatcher);
+  om_vesc_core_attach(&vesc, &dispatcher);
+  om_ctrl_can_attach(&controller, &dispatcher);
+
+  ::CanFilter filters[CAN_DISPATCH_MAX_RULES];
+  if (!ExpectTrue(can_dispatcher_get_filters(&dispatcher, filters,
+                                             CAN_DISPATCH_MAX_RULES) == 3U,
+                  "one filter per rule should be derived")) {
+    return false;
+  }
+  if (!ExpectTrue(filters[0].id == 0x200U && filters[0].mask == 0x7F0U,
+                  "Robomas range should widen to 0x200/0x7F0")) {
+    return false;
+  }
+  if (!ExpectTrue(filters[1].id == 0x900U && filters[1].mask == 0x1FFFFF00U,
+                  "VESC STATUS mask should be kept")) {
+    return false;
+  }
+  if (!ExpectTrue(filters[2].id == 50U && filters[2].mask == 0x7FEU,
+                  "controller ids should share one filter")) {
+    return false;
+  }
+
+  CanStm32Context context;
+  can_stm32_context_init(&context, nullptr, nullptr, CAN_STM32_KIND_CAN, 1U);
+  if (!ExpectTrue(can_stm32_set_filters_from_dispatcher(&context, &dispatcher),
+                  "STM32 filters should fit into the banks")) {
+    return false;
+  }
+  if (!ExpectTrue(context.filter_count == 2U,
+                  "standard ids should be packed into one 16bit bank")) {
+    return false;
+  }
+  const CanStm32Filter& std_bank = context.filters[1];
+  const CanStm32Filter& ext_bank = context.filters[0];
+  if (!ExpectTrue(std_bank.scale == CAN_STM32_FILTER_SCALE_16 &&
+                      std_bank.values[0] == 0x200U &&
+                      std_bank.values[2] == 50U && std_bank.fifo == 1U,
+                  "16bit bank should hold Robomas and controller")) {
+    return false;
+  }
+  if (!ExpectTrue(ext_bank.scale == CAN_STM32_FILTER_SCALE_32 &&
+                      ext_bank.mode == CAN_STM32_FILTER_MASK &&
+                      ext_bank.values[0] == 0x900U,
+                  "extended id should use a 32bit mask bank")) {
+    return false;
+  }
+
+  CallCounter fallback = {};
+  can_dispatcher_set_default(&dispatcher, CountCall, &fallback);
+  return ExpectTrue(can_dispatcher_get_filters(&dispatcher, filters,
+                                               CAN_DISPATCH_MAX_RULES) == 0U,
+                    "default handler should require accepting everything");
+}
+
+class FakeCppBus : public omuraisu::can::ICanBus {
+ public:
+  std::size_t pending = 0;
+  uint32_t next_id = 0x201U;
+
+  bool write(const omuraisu::can::CanMessage& msg) override {
+    (void)msg;
+    return true;
+  }
+
+  bool read(omuraisu::can::CanMessage& msg) override {
+    if (pending == 0U) {
+      return false;
+    }
+    --pending;
+    msg = omuraisu::can::CanMessage(MakeMessage(next_id));
+    next_id = next_id == 0x208U ? 0x201U : next_id + 1U;
+    return true;
+  }
+};
+
+bool TestCppDispatcherPollsBus() {
+  FakeCppBus bus;
+  bus.pending = 20U;
+
+  omuraisu::can::CanDispatcher dispatcher;
+  CallCounter counter = {};
+  if (!ExpectTrue(dispatcher.add_range(0x201U, 0x208U, CountCall, &counter),
+                  "C++ dispatcher should accept a range")) {
+    return false;
+  }
+
+  if (!ExpectTrue(dispatcher.poll(bus) == 20U,
+                  "poll should drain every pending frame")) {
+    return false;
+  }
+  return ExpectTrue(counter.calls == 20 && dispatcher.unmatched_count() == 0U,
+                    "every polled frame should reach the handler");
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+
+  ok = TestExactRangeAndMaskRouting() && ok;
+  ok = TestOverlappingIdsAreRejected() && ok;
+  ok = TestDeviceDriversShareOneBus() && ok;
+  ok = TestFiltersFromDriverRules() && ok;
+  ok = TestCppDispatcherPollsBus() && ok;
+
+  if (!ok) {
+    std::cerr << "can_dispatch_cpp_test failed" << std::endl;
+    return 1;
+  }
+
+  std::cout << "can_dispatch_cpp_test passed" << std::endl;
+  return 0;
+}
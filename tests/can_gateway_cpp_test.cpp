@@ -0,0 +1,207 @@
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "can/can_gateway.h"
+#include "can/can_gateway.hpp"
+#include "can/can_virtual.h"
+
+namespace {
+
+bool ExpectTrue(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << message << std::endl;
+    return false;
+  }
+  return true;
+}
+
+::CanMessage MakeMessage(uint32_t id, uint8_t seed) {
+  ::CanMessage msg = {};
+  msg.id = id;
+  msg.len = 2U;
+  msg.data[0] = seed;
+  return msg;
+}
+
+void CountFrame(const ::CanMessage* msg, void* user_arg) {
+  (void)msg;
+  ++*static_cast<int*>(user_arg);
+}
+
+// 受信キューを持ち、送信を capacity 個まで受け付ける ICanBus
+class FakeBus : public omuraisu::can::ICanBus {
+ public:
+  explicit FakeBus(std::size_t capacity) : capacity_(capacity) {}
+
+  bool write(const omuraisu::can::CanMessage& msg) override {
+    if (sent.size() >= capacity_) {
+      return false;
+    }
+    sent.push_back(msg);
+    return true;
+  }
+
+  bool read(omuraisu::can::CanMessage& msg) override {
+    if (next_ >= inbox.size()) {
+      return false;
+    }
+    msg = inbox[next_++];
+    return true;
+  }
+
+  using ICanBus::write_batch;
+  std::size_t write_batch(const omuraisu::can::CanMessage* msgs,
+                          std::size_t count) override {
+    ++write_batch_calls;
+    return ICanBus::write_batch(msgs, count);
+  }
+
+  std::vector<omuraisu::can::CanMessage> inbox;
+  std::vector<omuraisu::can::CanMessage> sent;
+  int write_batch_calls = 0;
+
+ private:
+  std::size_t capacity_;
+  std::size_t next_ = 0;
+};
+
+bool TestRoutingAcrossVirtualBuses() {
+  ::CanVirtualMedium can1;
+  ::CanVirtualMedium can2;
+  can_virtual_medium_init(&can1, 1000000U);
+  can_virtual_medium_init(&can2, 1000000U);
+  ::CanVirtualNode gw1;
+  ::CanVirtualNode gw2;
+  ::CanVirtualNode motor_side;
+  ::CanVirtualNode sensor_side;
+  can_virtual_node_init(&gw1, &can1);
+  can_virtual_node_init(&motor_side, &can1);
+  can_virtual_node_init(&gw2, &can2);
+  can_virtual_node_init(&sensor_side, &can2);
+
+  ::CanGateway gateway;
+  can_gateway_init(&gateway);
+  int local_frames = 0;
+  const int bus1 = can_gateway_add_bus(&gateway, can_virtual_node_bus(&gw1),
+                                       CountFrame, &local_frames);
+  const int bus2 =
+      can_gateway_add_bus(&gateway, can_virtual_node_bus(&gw2), 0, 0);
+  bool ok = ExpectTrue(bus1 == 0 && bus2 == 1, "buses should be numbered");
+
+  // 0x201〜0x20F を 0x301〜 に付け替えて CAN2 へ、拡張 ID 0x900 番台は CAN1 へ
+  ok = ExpectTrue(can_gateway_add_route_rewrite(&gateway, 0U, 0x200U, 0x7F0U,
+                                                1U, 0x300U, 0x700U) &&
+                      can_gateway_add_route(&gateway, 1U, 0x0900U, 0xFF00U,
+                                            0U),
+                  "routes should be registered") &&
+       ok;
+  ok = ExpectTrue(!can_gateway_add_route(&gateway, 0U, 0U, 0U, 0U) &&
+                      !can_gateway_add_route(&gateway, 0U, 0U, 0U, 2U),
+                  "loops and unknown buses should be rejected") &&
+       ok;
+
+  ::CanMessage msg = MakeMessage(0x201U, 1U);
+  can_bus_write(can_virtual_node_bus(&motor_side), &msg);
+  msg = MakeMessage(0x202U, 2U);
+  can_bus_write(can_virtual_node_bus(&motor_side), &msg);
+  msg = MakeMessage(0x555U, 3U);
+  can_bus_write(can_virtual_node_bus(&motor_side), &msg);
+  msg = MakeMessage(0x0901U, 4U);
+  can_bus_write(can_virtual_node_bus(&sensor_side), &msg);
+  can_virtual_medium_run_until_idle(&can1);
+  can_virtual_medium_run_until_idle(&can2);
+
+  ok = ExpectTrue(can_gateway_poll(&gateway) == 4U && local_frames == 3,
+                  "every received frame should reach the local handler") &&
+       ok;
+  can_virtual_medium_run_until_idle(&can1);
+  can_virtual_medium_run_until_idle(&can2);
+
+  ::CanMessage rx = {};
+  ok = ExpectTrue(can_bus_read(can_virtual_node_bus(&sensor_side), &rx) &&
+                      rx.id == 0x301U && rx.data[0] == 1U &&
+                      can_bus_read(can_virtual_node_bus(&sensor_side), &rx) &&
+                      rx.id == 0x302U &&
+                      !can_bus_read(can_virtual_node_bus(&sensor_side), &rx),
+                  "matching frames should be rewritten and relayed") &&
+       ok;
+  ok = ExpectTrue(can_bus_read(can_virtual_node_bus(&motor_side), &rx) &&
+                      rx.id == 0x0901U && rx.data[0] == 4U,
+                  "extended frames should be relayed back") &&
+       ok;
+  return ExpectTrue(gateway.ports[0].unrouted == 1U &&
+                        gateway.ports[1].forwarded == 2U &&
+                        gateway.ports[0].forwarded == 1U,
+                    "per-bus counters should track relayed frames") &&
+         ok;
+}
+
+bool TestBatchedWritesAndDrops() {
+  FakeBus source(0U);
+  FakeBus narrow(30U);
+  FakeBus wide(100U);
+  for (uint8_t i = 0; i < 40U; ++i) {
+    source.inbox.push_back(
+        omuraisu::can::CanMessage(MakeMessage(0x100U + (i & 7U), i)));
+  }
+
+  omuraisu::can::CanGateway gateway;
+  gateway.add_bus(source);
+  gateway.add_bus(narrow);
+  gateway.add_bus(wide);
+  bool ok = gateway.add_route(0U, 0x100U, 0x7F8U, 1U) &&
+            gateway.add_route(0U, 0x104U, 0x7FCU, 2U);
+
+  ok = ExpectTrue(ok && gateway.poll() == 40U,
+                  "all queued frames should be drained") &&
+       ok;
+  // 16 フレームずつ読んで宛先ごとに 1 回ずつ送る
+  ok = ExpectTrue(narrow.write_batch_calls == 3 && narrow.sent.size() == 30U &&
+                      gateway.port(1U)->tx_dropped == 10U,
+                  "frames should be written in batches and drops counted") &&
+       ok;
+  return ExpectTrue(wide.sent.size() == 20U && wide.sent[0].id == 0x104U &&
+                        wide.sent[0].data[0] == 4U,
+                    "a frame may fan out to several buses") &&
+         ok;
+}
+
+bool TestFilters() {
+  FakeBus a(0U);
+  FakeBus b(0U);
+  omuraisu::can::CanGateway gateway;
+  gateway.add_bus(a);
+  gateway.add_bus(b, CountFrame, nullptr);
+  gateway.add_route(0U, 0x200U, 0xFFFFFFF0U, 1U);
+  gateway.add_route(0U, 0x18FF0000U, 0xFFFF0000U, 1U);
+  gateway.add_route(1U, 0x300U, 0x7FFU, 0U);
+
+  ::CanFilter filters[4] = {};
+  const std::size_t count = gateway.get_filters(0U, filters, 4U);
+  return ExpectTrue(count == 2U && filters[0].id == 0x200U &&
+                        filters[0].mask == 0x7F0U &&
+                        filters[1].mask == 0x1FFF0000U &&
+                        gateway.get_filters(1U, filters, 4U) == 0U,
+                    "filters should cover the routes of each source bus");
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+
+  ok = TestRoutingAcrossVirtualBuses() && ok;
+  ok = TestBatchedWritesAndDrops() && ok;
+  ok = TestFilters() && ok;
+
+  if (!ok) {
+    std::cerr << "can_gateway_cpp_test failed" << std::endl;
+    return 1;
+  }
+
+  std::cout << "can_gateway_cpp_test passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,308 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "can/can_dispatch.h"
+#include "can/can_log.h"
+#include "can/can_virtual.h"
+#include "dji/robomas.h"
+#include "vesc/vesc_core.h"
+
+namespace {
+
+bool ExpectTrue(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << message << std::endl;
+    return false;
+  }
+  return true;
+}
+
+::CanLogRecord MakeRecord(uint32_t id, uint64_t time_us, bool tx) {
+  ::CanLogRecord record = {};
+  record.msg.id = id;
+  record.msg.len = 8U;
+  for (uint8_t i = 0; i < 8U; ++i) {
+    record.msg.data[i] = static_cast<uint8_t>(id + i);
+  }
+  record.time_us = time_us;
+  record.tx = tx;
+  return record;
+}
+
+// 小さな塊でしか受け付けない書き込み先（バッファのフラッシュを確認する）
+struct ChunkSink {
+  std::vector<uint8_t> bytes;
+  int calls;
+};
+
+size_t ChunkWrite(void* user_arg, const uint8_t* data, size_t size) {
+  ChunkSink* sink = static_cast<ChunkSink*>(user_arg);
+  sink->bytes.insert(sink->bytes.end(), data, data + size);
+  sink->calls++;
+  return size;
+}
+
+bool TestRoundTrip() {
+  ChunkSink sink = {};
+  ::CanLogWriter writer;
+  can_log_writer_init(&writer, ChunkWrite, &sink);
+
+  std::vector<::CanLogRecord> records;
+  records.push_back(MakeRecord(0x201U, 1000U, false));
+  records.push_back(MakeRecord(0x1FFU, 1200U, true));
+  records.push_back(MakeRecord(0x0900U | 7U, 1150U, false));  // 時刻が戻る
+  records.push_back(MakeRecord(0x12345678U, 5000000000ULL, false));
+  records.back().msg.len = 3U;
+  for (int i = 0; i < 100; ++i) {
+    records.push_back(MakeRecord(0x202U, 5000000000ULL + 1000U * i, false));
+  }
+  for (const ::CanLogRecord& record : records) {
+    can_log_writer_append(&writer, &record);
+  }
+  if (!ExpectTrue(sink.calls > 0, "full buffers should be flushed")) {
+    return false;
+  }
+  can_log_writer_flush(&writer);
+  if (!ExpectTrue(writer.record_count == records.size() &&
+                      sink.bytes.size() < records.size() * 14U,
+                  "8 byte standard frames should stay compact")) {
+    return false;
+  }
+
+  ::CanLogMemory memory;
+  can_log_memory_init(&memory, sink.bytes.data(), sink.bytes.size());
+  ::CanLogReader reader;
+  can_log_reader_init(&reader, can_log_memory_source, &memory);
+
+  ::CanLogRecord out = {};
+  for (const ::CanLogRecord& record : records) {
+    if (!ExpectTrue(can_log_reader_next(&reader, &out), "record missing")) {
+      return false;
+    }
+    if (!ExpectTrue(out.msg.id == record.msg.id &&
+                        out.msg.len == record.msg.len &&
+                        std::memcmp(out.msg.data, record.msg.data,
+                                    record.msg.len) == 0 &&
+                        out.time_us == record.time_us && out.tx == record.tx,
+                    "record should survive the round trip")) {
+      return false;
+    }
+  }
+  return ExpectTrue(!can_log_reader_next(&reader, &out) &&
+                        !can_log_reader_has_error(&reader),
+                    "log should end cleanly");
+}
+
+bool TestReaderRejectsBrokenLogs() {
+  uint8_t garbage[] = {'N', 'O', 'P', 'E', 1, 0, 0, 0};
+  ::CanLogMemory memory;
+  can_log_memory_init(&memory, garbage, sizeof(garbage));
+  ::CanLogReader reader;
+  can_log_reader_init(&reader, can_log_memory_source, &memory);
+  ::CanLogRecord out = {};
+  if (!ExpectTrue(!can_log_reader_next(&reader, &out) &&
+                      can_log_reader_has_error(&reader),
+                  "wrong magic should be an error")) {
+    return false;
+  }
+
+  uint8_t buffer[64];
+  can_log_memory_init(&memory, buffer, sizeof(buffer));
+  ::CanLogWriter writer;
+  can_log_writer_init(&writer, can_log_memory_sink, &memory);
+  ::CanLogRecord record = MakeRecord(0x201U, 10U, false);
+  can_log_writer_append(&writer, &record);
+  can_log_writer_flush(&writer);
+
+  // 最後のレコードを途中で切る
+  can_log_memory_init(&memory, buffer, memory.pos - 3U);
+  can_log_reader_init(&reader, can_log_memory_source, &memory);
+  return ExpectTrue(!can_log_reader_next(&reader, &out) &&
+                        can_log_reader_has_error(&reader),
+                    "truncated record should be an error");
+}
+
+bool TestRecorderTapsBus() {
+  ::CanVirtualMedium medium;
+  can_virtual_medium_init(&medium, 1000000U);
+  ::CanVirtualNode robot;
+  ::CanVirtualNode motors;
+  can_virtual_node_init(&robot, &medium);
+  can_virtual_node_init(&motors, &medium);
+
+  ChunkSink sink = {};
+  ::CanLogWriter writer;
+  can_log_writer_init(&writer, ChunkWrite, &sink);
+  ::CanLogRecorder recorder;
+  can_log_recorder_init(&recorder, can_virtual_node_bus(&robot), &writer);
+  can_log_recorder_set_clock(&recorder, can_virtual_medium_clock, &medium);
+
+  Robomas rm = om_rm_init(can_log_recorder_bus(&recorder));
+  can_virtual_medium_advance(&medium, 1000U);
+  om_rm_write(&rm);
+
+  ::CanMessage feedback = {};
+  feedback.id = 0x201U;
+  feedback.len = 8U;
+  feedback.data[1] = 0x42U;
+  can_bus_write(can_virtual_node_bus(&motors), &feedback);
+  can_virtual_medium_run_until_idle(&medium);
+  om_rm_read_all(&rm);
+  can_log_writer_flush(&writer);
+
+  ::CanLogMemory memory;
+  can_log_memory_init(&memory, sink.bytes.data(), sink.bytes.size());
+  ::CanLogReader reader;
+  can_log_reader_init(&reader, can_log_memory_source, &memory);
+
+  ::CanLogRecord out[3] = {};
+  for (::CanLogRecord& record : out) {
+    if (!ExpectTrue(can_log_reader_next(&reader, &record),
+                    "recorder should log every frame")) {
+      return false;
+    }
+  }
+  if (!ExpectTrue(out[0].tx && out[0].msg.id == TX_ID_GROUP1 &&
+                      out[0].time_us == 1000U && out[1].tx &&
+                      out[1].msg.id == TX_ID_GROUP2,
+                  "written frames should be logged as TX at clock time")) {
+    return false;
+  }
+  // 受信フレームは仮想バスが付けた受信時刻を使う
+  return ExpectTrue(!out[2].tx && out[2].msg.id == 0x201U &&
+                        out[2].time_us == 1000U + 3U * 111U &&
+                        om_rm_get_angle(&rm, 1) == 0x42U,
+                    "received frames should pass through and be logged");
+}
+
+bool TestCandumpFormat() {
+  ::CanLogRecord record = {};
+  if (!ExpectTrue(can_log_parse_candump(
+                      "(1436509052.249713) can0 12345678#DEADBEEF", &record),
+                  "candump line should parse")) {
+    return false;
+  }
+  if (!ExpectTrue(record.msg.id == 0x12345678U && record.msg.len == 4U &&
+                      record.msg.data[0] == 0xDEU &&
+                      record.msg.data[3] == 0xEFU &&
+                      record.time_us == 1436509052249713ULL,
+                  "fields should match the line")) {
+    return false;
+  }
+
+  char line[96];
+  if (!ExpectTrue(can_log_format_candump(&record, "can0", line,
+                                         sizeof(line)) != 0U &&
+                      std::string(line) ==
+                          "(1436509052.249713) can0 12345678#DEADBEEF",
+                  "formatting should reproduce the line")) {
+    return false;
+  }
+
+  ::CanLogRecord std_record = MakeRecord(0x1FFU, 5U, true);
+  std_record.msg.len = 0U;
+  can_log_format_candump(&std_record, "vcan0", line, sizeof(line));
+  if (!ExpectTrue(std::string(line) == "(0.000005) vcan0 1FF#",
+                  "standard ids should use three digits")) {
+    return false;
+  }
+  if (!ExpectTrue(can_log_parse_candump(line, &record) &&
+                      record.msg.id == 0x1FFU && record.msg.len == 0U,
+                  "empty payload should parse")) {
+    return false;
+  }
+  return ExpectTrue(!can_log_parse_candump("can0 123#00", &record) &&
+                        !can_log_parse_candump("(1.0) can0 12#00", &record) &&
+                        !can_log_parse_candump("(1.0) can0 123#001", &record),
+                    "malformed lines should be rejected");
+}
+
+struct DispatchBus {
+  ::CanDispatcher* dispatcher;
+};
+
+bool DispatchWrite(void* impl, const ::CanMessage* msg) {
+  can_dispatcher_dispatch(static_cast<DispatchBus*>(impl)->dispatcher, msg);
+  return true;
+}
+
+bool TestReplayMatchLogThroughDrivers() {
+  // 100ms 分の試合ログ（1ms ごとにモーター 1 と VESC 7）
+  std::vector<uint8_t> bytes(8192);
+  ::CanLogMemory memory;
+  can_log_memory_init(&memory, bytes.data(), bytes.size());
+  ::CanLogWriter writer;
+  can_log_writer_init(&writer, can_log_memory_sink, &memory);
+  for (uint32_t ms = 0; ms < 100U; ++ms) {
+    ::CanLogRecord motor = MakeRecord(0x201U, 20000U + ms * 1000U, false);
+    motor.msg.data[0] = 0U;
+    motor.msg.data[1] = static_cast<uint8_t>(ms);
+    ::CanLogRecord vesc = MakeRecord((VESC_CAN_PACKET_STATUS << 8) | 7U,
+                                     20000U + ms * 1000U + 100U, false);
+    std::memset(vesc.msg.data, 0, 8U);
+    vesc.msg.data[3] = static_cast<uint8_t>(ms);
+    ::CanLogRecord command = MakeRecord(0x200U, 20000U + ms * 1000U + 500U,
+                                        true);
+    can_log_writer_append(&writer, &motor);
+    can_log_writer_append(&writer, &vesc);
+    can_log_writer_append(&writer, &command);
+  }
+  can_log_writer_flush(&writer);
+  can_log_memory_init(&memory, bytes.data(), memory.pos);
+
+  ::CanDispatcher dispatcher;
+  can_dispatcher_init(&dispatcher);
+  Robomas rm = om_rm_init(nullptr);
+  VescCore vesc = om_vesc_core_init();
+  om_rm_attach(&rm, &dispatcher);
+  om_vesc_core_attach(&vesc, &dispatcher);
+  DispatchBus target_impl = {&dispatcher};
+  ::CanBus target = {};
+  target.write = DispatchWrite;
+  target.impl = &target_impl;
+
+  ::CanLogReader reader;
+  can_log_reader_init(&reader, can_log_memory_source, &memory);
+  ::CanLogReplayer replayer;
+  can_log_replayer_init(&replayer, &reader, &target, 100U);
+
+  // 100 倍速なので 500us で 50ms 分進む
+  can_log_replayer_poll(&replayer, 7000U);
+  can_log_replayer_poll(&replayer, 7500U);
+  if (!ExpectTrue(om_rm_get_angle(&rm, 1) == 50U &&
+                      om_vesc_core_get_rpm(&vesc, 7) == 49,
+                  "replay should follow the accelerated log time")) {
+    return false;
+  }
+
+  can_log_replayer_poll(&replayer, 8000U);
+  return ExpectTrue(can_log_replayer_done(&replayer) &&
+                        replayer.sent_count == 200U &&
+                        om_rm_get_angle(&rm, 1) == 99U &&
+                        om_vesc_core_get_rpm(&vesc, 7) == 99,
+                    "whole log should be replayed without TX frames");
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+
+  ok = TestRoundTrip() && ok;
+  ok = TestReaderRejectsBrokenLogs() && ok;
+  ok = TestRecorderTapsBus() && ok;
+  ok = TestCandumpFormat() && ok;
+  ok = TestReplayMatchLogThroughDrivers() && ok;
+
+  if (!ok) {
+    std::cerr << "can_log_cpp_test failed" << std::endl;
+    return 1;
+  }
+
+  std::cout << "can_log_cpp_test passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,261 @@
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "can/can_scheduler.hpp"
+#include "dji/robomas.h"
+#include "dji/robomas.hpp"
+
+namespace {
+
+bool ExpectTrue(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << message << std::endl;
+    return false;
+  }
+  return true;
+}
+
+struct FakeBus {
+  std::vector<uint32_t> written;
+  std::size_t accept = SIZE_MAX;  // 受け付ける残りフレーム数
+};
+
+bool FakeWrite(void* impl, const ::CanMessage* msg) {
+  FakeBus* bus = static_cast<FakeBus*>(impl);
+  if (bus->accept == 0U) {
+    return false;
+  }
+  if (bus->accept != SIZE_MAX) {
+    --bus->accept;
+  }
+  bus->written.push_back(msg->id);
+  return true;
+}
+
+::CanBus MakeBus(FakeBus* fake) {
+  ::CanBus bus = {};
+  bus.write = FakeWrite;
+  bus.impl = fake;
+  return bus;
+}
+
+bool FillId(::CanMessage* msg, void* user_arg) {
+  msg->id = *static_cast<uint32_t*>(user_arg);
+  msg->len = 8U;
+  return true;
+}
+
+bool TestPhasesSpreadFrames() {
+  FakeBus fake;
+  ::CanBus bus = MakeBus(&fake);
+  ::CanScheduler scheduler;
+  can_scheduler_init(&scheduler, &bus);
+
+  uint32_t ids[4] = {0x10U, 0x11U, 0x12U, 0x13U};
+  for (uint32_t& id : ids) {
+    if (!ExpectTrue(can_scheduler_add(&scheduler, 4U, CAN_SCHEDULER_AUTO_PHASE,
+                                      FillId, &id) >= 0,
+                    "slot should be registered")) {
+      return false;
+    }
+  }
+
+  for (int tick = 0; tick < 8; ++tick) {
+    if (!ExpectTrue(can_scheduler_tick(&scheduler) == 1U,
+                    "auto phase should put one frame on each tick")) {
+      return false;
+    }
+  }
+  return ExpectTrue(fake.written.size() == 8U && fake.written[0] == 0x10U &&
+                        fake.written[3] == 0x13U && fake.written[4] == 0x10U,
+                    "each slot should be sent once per period");
+}
+
+bool TestAutoPhaseAvoidsLongerPeriods() {
+  FakeBus fake;
+  ::CanBus bus = MakeBus(&fake);
+  ::CanScheduler scheduler;
+  can_scheduler_init(&scheduler, &bus);
+
+  // 周期 100 のスロットが 40 tick 目にあると、周期 2 の偶数位相は
+  // 20 周期後に重なる
+  uint32_t slow_id = 0x20U;
+  uint32_t fast_id = 0x21U;
+  bool ok = ExpectTrue(
+      can_scheduler_add(&scheduler, 100U, 40U, FillId, &slow_id) == 0 &&
+          can_scheduler_add(&scheduler, 2U, CAN_SCHEDULER_AUTO_PHASE, FillId,
+                            &fast_id) == 1,
+      "slots should be registered");
+  ok = ExpectTrue(scheduler.slots[1].phase == 1U,
+                  "auto phase should avoid slots with longer periods") &&
+       ok;
+
+  // 周期 6 と 10 は 30 tick で一巡する
+  can_scheduler_init(&scheduler, &bus);
+  can_scheduler_add(&scheduler, 10U, 0U, FillId, &slow_id);
+  can_scheduler_add(&scheduler, 6U, CAN_SCHEDULER_AUTO_PHASE, FillId,
+                    &fast_id);
+  for (int tick = 0; tick < 60; ++tick) {
+    if (!ExpectTrue(can_scheduler_tick(&scheduler) <= 1U,
+                    "mixed periods should never share a tick")) {
+      return false;
+    }
+  }
+  return ok;
+}
+
+bool TestBurstIsDeferred() {
+  FakeBus fake;
+  ::CanBus bus = MakeBus(&fake);
+  ::CanScheduler scheduler;
+  can_scheduler_init(&scheduler, &bus);
+
+  uint32_t ids[5] = {0x20U, 0x21U, 0x22U, 0x23U, 0x24U};
+  for (uint32_t& id : ids) {
+    can_scheduler_add(&scheduler, 10U, 0U, FillId, &id);
+  }
+
+  if (!ExpectTrue(can_scheduler_tick(&scheduler) == 3U,
+                  "one tick should not exceed the mailbox count")) {
+    return false;
+  }
+  if (!ExpectTrue(can_scheduler_tick(&scheduler) == 2U &&
+                      scheduler.deferred_count == 2U,
+                  "overflowing frames should go out on the next tick")) {
+    return false;
+  }
+
+  // 遅れて送ったスロットも元の位相に戻る
+  for (int tick = 2; tick < 10; ++tick) {
+    can_scheduler_tick(&scheduler);
+  }
+  return ExpectTrue(can_scheduler_tick(&scheduler) == 3U &&
+                        fake.written.size() == 8U,
+                    "deferred slots should keep their phase");
+}
+
+bool TestBusFullRetriesAndSkips() {
+  FakeBus fake;
+  fake.accept = 0U;
+  ::CanBus bus = MakeBus(&fake);
+  ::CanScheduler scheduler;
+  can_scheduler_init(&scheduler, &bus);
+
+  uint32_t id = 0x30U;
+  can_scheduler_add(&scheduler, 2U, 0U, FillId, &id);
+
+  can_scheduler_tick(&scheduler);  // tick 0: 送信失敗
+  can_scheduler_tick(&scheduler);  // tick 1: 再送も失敗
+  fake.accept = SIZE_MAX;
+  if (!ExpectTrue(can_scheduler_tick(&scheduler) == 1U,
+                  "frame should be retried until the bus accepts it")) {
+    return false;
+  }
+  if (!ExpectTrue(scheduler.skipped_count == 1U,
+                  "missed period should be counted once")) {
+    return false;
+  }
+  return ExpectTrue(can_scheduler_tick(&scheduler) == 0U &&
+                        can_scheduler_tick(&scheduler) == 1U,
+                    "slot should stay on its phase after a retry");
+}
+
+bool TestDisableAndInvalidSlots() {
+  FakeBus fake;
+  ::CanBus bus = MakeBus(&fake);
+  ::CanScheduler scheduler;
+  can_scheduler_init(&scheduler, &bus);
+
+  uint32_t id = 0x40U;
+  if (!ExpectTrue(can_scheduler_add(&scheduler, 0U, 0U, FillId, &id) < 0 &&
+                      can_scheduler_add(&scheduler, 4U, 4U, FillId, &id) < 0 &&
+                      can_scheduler_add(&scheduler, 4U, 0U, nullptr, &id) < 0,
+                  "invalid slots should be rejected")) {
+    return false;
+  }
+
+  int slot = can_scheduler_add(&scheduler, 1U, 0U, FillId, &id);
+  can_scheduler_set_enabled(&scheduler, slot, false);
+  can_scheduler_tick(&scheduler);
+  can_scheduler_set_enabled(&scheduler, slot, true);
+  can_scheduler_tick(&scheduler);
+  return ExpectTrue(fake.written.size() == 1U && scheduler.skipped_count == 0U,
+                    "disabled slot should not send or count as skipped");
+}
+
+bool TestRobomasSchedule() {
+  FakeBus fake;
+  ::CanBus bus = MakeBus(&fake);
+  ::CanScheduler scheduler;
+  can_scheduler_init(&scheduler, &bus);
+
+  Robomas rm = om_rm_init(nullptr);
+  om_rm_set_output(&rm, 1000, 1);
+  if (!ExpectTrue(om_rm_schedule(&rm, &scheduler, 2U),
+                  "Robomas should register two slots")) {
+    return false;
+  }
+
+  const std::size_t first = can_scheduler_tick(&scheduler);
+  const std::size_t second = can_scheduler_tick(&scheduler);
+  return ExpectTrue(first == 1U && second == 1U && fake.written.size() == 2U &&
+                        fake.written[0] == 0x200U && fake.written[1] == 0x1FFU,
+                    "Robomas groups should be sent on different ticks");
+}
+
+class CountingCppBus : public omuraisu::can::ICanBus {
+ public:
+  std::size_t writes = 0;
+
+  bool write(const omuraisu::can::CanMessage& msg) override {
+    (void)msg;
+    ++writes;
+    return true;
+  }
+
+  bool read(omuraisu::can::CanMessage& msg) override {
+    (void)msg;
+    return false;
+  }
+};
+
+bool TestCppSchedulerWithRobomas() {
+  CountingCppBus bus;
+  omuraisu::can::CanScheduler scheduler(bus);
+  omuraisu::dji::Robomas rm(bus);
+
+  if (!ExpectTrue(rm.schedule(scheduler, 5U),
+                  "C++ Robomas should register on the scheduler")) {
+    return false;
+  }
+  for (int tick = 0; tick < 10; ++tick) {
+    scheduler.tick();
+  }
+  return ExpectTrue(bus.writes == 4U && scheduler.deferred_count() == 0U,
+                    "two frames should be sent every period");
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+
+  ok = TestPhasesSpreadFrames() && ok;
+  ok = TestAutoPhaseAvoidsLongerPeriods() && ok;
+  ok = TestBurstIsDeferred() && ok;
+  ok = TestBusFullRetriesAndSkips() && ok;
+  ok = TestDisableAndInvalidSlots() && ok;
+  ok = TestRobomasSchedule() && ok;
+  ok = TestCppSchedulerWithRobomas() && ok;
+
+  if (!ok) {
+    std::cerr << "can_scheduler_cpp_test failed" << std::endl;
+    return 1;
+  }
+
+  std::cout << "can_scheduler_cpp_test passed" << std::endl;
+  return 0;
+}
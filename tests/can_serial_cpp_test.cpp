@@ -0,0 +1,263 @@
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <string>
+
+#include "can/can_serial.h"
+#include "can/can_serial.hpp"
+#include "can/can_virtual.h"
+#include "dji/robomas.h"
+#include "serial/serial_interface.hpp"
+
+namespace {
+
+bool ExpectTrue(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << message << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// 書いたバイト列を相手側の受信に積むだけのシリアルポート
+class PipeSerialPort : public omuraisu::serial::ISerialPort {
+ public:
+  void connect(PipeSerialPort& peer) { peer_ = &peer; }
+
+  bool open() override { return true; }
+  void close() override {}
+
+  bool write(const omuraisu::serial::SerialMessage& msg) override {
+    if (fail_writes || peer_ == nullptr) {
+      return false;
+    }
+    ++write_count;
+    for (uint16_t i = 0; i < msg.len; ++i) {
+      peer_->bytes.push_back(msg.data[i]);
+    }
+    return true;
+  }
+
+  // 受信は chunk バイトずつに分けて返す（パケット境界と揃わない）
+  bool read(omuraisu::serial::SerialMessage& msg) override {
+    if (bytes.empty()) {
+      return false;
+    }
+    msg.len = 0;
+    while (msg.len < chunk && !bytes.empty()) {
+      msg.data[msg.len++] = bytes.front();
+      bytes.pop_front();
+    }
+    return true;
+  }
+
+  void set_rx_callback(omuraisu::serial::SerialRxCallback callback,
+                       void* user_arg) override {
+    (void)callback;
+    (void)user_arg;
+  }
+
+  std::deque<uint8_t> bytes;
+  uint16_t chunk = 7U;
+  bool fail_writes = false;
+  std::size_t write_count = 0;
+
+ private:
+  PipeSerialPort* peer_ = nullptr;
+};
+
+::CanMessage MakeMessage(uint32_t id, uint8_t len, uint8_t seed) {
+  ::CanMessage msg = {};
+  msg.id = id;
+  msg.len = len;
+  for (uint8_t i = 0; i < len; ++i) {
+    msg.data[i] = static_cast<uint8_t>(seed + i);
+  }
+  return msg;
+}
+
+bool TestBatchesFramesPerSerialWrite() {
+  PipeSerialPort host_port;
+  PipeSerialPort mcu_port;
+  host_port.connect(mcu_port);
+  mcu_port.connect(host_port);
+  omuraisu::can::SerialCanBus host(host_port);
+  omuraisu::serial::CppSerialPortBridge mcu_bridge(mcu_port);
+  ::CanSerial mcu;
+  can_serial_init(&mcu, mcu_bridge.c_port());
+
+  ::CanMessage msgs[6];
+  for (uint8_t i = 0; i < 5U; ++i) {
+    msgs[i] = MakeMessage(0x200U + i, 8U, static_cast<uint8_t>(i * 16U));
+  }
+  msgs[5] = MakeMessage(0x18FF50E5U, 3U, 0x00U);
+
+  for (std::size_t i = 0; i < 5U; ++i) {
+    host.write(static_cast<const omuraisu::can::CanMessage&>(msgs[i]));
+  }
+  if (!ExpectTrue(host_port.write_count == 0U,
+                  "write should only buffer until flush")) {
+    return false;
+  }
+  host.poll();
+  if (!ExpectTrue(host_port.write_count == 1U &&
+                      mcu_port.bytes.size() <= SERIAL_MESSAGE_MAX_LEN,
+                  "five standard frames should fit in one serial write")) {
+    return false;
+  }
+
+  // バッファが一杯になると次のフレームの前に送る
+  for (std::size_t i = 0; i < 6U; ++i) {
+    can_bus_write(host.c_bus(), &msgs[i]);
+  }
+  host.flush();
+  if (!ExpectTrue(host_port.write_count == 3U,
+                  "sixth frame should start a new packet")) {
+    return false;
+  }
+
+  can_serial_poll(&mcu);
+  bool ok = true;
+  for (std::size_t round = 0; round < 2U; ++round) {
+    const std::size_t count = round == 0U ? 5U : 6U;
+    for (std::size_t i = 0; i < count; ++i) {
+      ::CanMessage rx = {};
+      ok = ok && can_bus_read(can_serial_bus(&mcu), &rx) &&
+           rx.id == msgs[i].id && rx.len == msgs[i].len &&
+           rx.data[rx.len - 1U] == msgs[i].data[msgs[i].len - 1U];
+    }
+  }
+  ::CanBusStats stats = {};
+  can_bus_get_stats(can_serial_bus(&mcu), &stats);
+  return ExpectTrue(ok && stats.rx_frames == 11U && mcu.rx_errors == 0U,
+                    "frames should arrive in order with ids intact");
+}
+
+bool TestRecoversFromCorruption() {
+  PipeSerialPort host_port;
+  PipeSerialPort mcu_port;
+  host_port.connect(mcu_port);
+  omuraisu::can::SerialCanBus host(host_port);
+  ::CanSerial mcu;
+  can_serial_init(&mcu, nullptr);
+
+  ::CanMessage msg = MakeMessage(0x201U, 8U, 1U);
+  can_bus_write(host.c_bus(), &msg);
+  host.flush();
+  mcu_port.bytes[3] ^= 0x5AU;
+  msg = MakeMessage(0x202U, 8U, 2U);
+  can_bus_write(host.c_bus(), &msg);
+  host.flush();
+
+  // 途中から受信し始めた場合（前のパケットの後半）
+  const uint8_t noise[] = {0x11U, 0x22U, 0x00U};
+  can_serial_feed(&mcu, noise, sizeof(noise));
+  while (!mcu_port.bytes.empty()) {
+    const uint8_t byte = mcu_port.bytes.front();
+    mcu_port.bytes.pop_front();
+    can_serial_feed(&mcu, &byte, 1U);
+  }
+
+  ::CanMessage rx = {};
+  const bool got = can_bus_read(can_serial_bus(&mcu), &rx);
+  return ExpectTrue(got && rx.id == 0x202U &&
+                        !can_bus_read(can_serial_bus(&mcu), &rx) &&
+                        mcu.rx_errors == 2U,
+                    "corrupt packets should be dropped and counted");
+}
+
+bool TestFailedWriteKeepsFrames() {
+  PipeSerialPort host_port;
+  PipeSerialPort mcu_port;
+  host_port.connect(mcu_port);
+  omuraisu::can::SerialCanBus host(host_port);
+
+  ::CanMessage msg = MakeMessage(0x1FFU, 8U, 0U);
+  host_port.fail_writes = true;
+  can_bus_write(host.c_bus(), &msg);
+  if (!ExpectTrue(!host.flush(), "flush should report the failed write")) {
+    return false;
+  }
+  host_port.fail_writes = false;
+  host.poll();
+
+  ::CanBusStats stats = {};
+  host.get_stats(stats);
+  return ExpectTrue(host_port.write_count == 1U && stats.tx_frames == 1U,
+                    "buffered frames should be sent on the next flush");
+}
+
+bool TestRobomasOverSerialLink() {
+  PipeSerialPort host_port;
+  PipeSerialPort mcu_port;
+  host_port.connect(mcu_port);
+  mcu_port.connect(host_port);
+  omuraisu::can::SerialCanBus host(host_port);
+  omuraisu::serial::CppSerialPortBridge mcu_bridge(mcu_port);
+  ::CanSerial mcu;
+  can_serial_init(&mcu, mcu_bridge.c_port());
+
+  ::CanVirtualMedium medium;
+  can_virtual_medium_init(&medium, 1000000U);
+  ::CanVirtualNode mcu_can;
+  ::CanVirtualNode motors;
+  can_virtual_node_init(&mcu_can, &medium);
+  can_virtual_node_init(&motors, &medium);
+
+  Robomas rm = om_rm_init(host.c_bus());
+  om_rm_set_output(&rm, 1000, 1);
+  om_rm_set_output(&rm, -500, 5);
+  om_rm_write(&rm);
+  host.poll();
+  if (!ExpectTrue(host_port.write_count == 1U,
+                  "both setpoint groups should share one serial write")) {
+    return false;
+  }
+
+  can_serial_relay(&mcu, can_virtual_node_bus(&mcu_can), 8U);
+  can_virtual_medium_run_until_idle(&medium);
+
+  ::CanMessage rx = {};
+  bool group1 = false;
+  bool group2 = false;
+  while (can_bus_read(can_virtual_node_bus(&motors), &rx)) {
+    group1 = group1 || (rx.id == 0x200U && rx.data[0] == 0x03U &&
+                        rx.data[1] == 0xE8U);
+    group2 = group2 || rx.id == 0x1FFU;
+  }
+  if (!ExpectTrue(group1 && group2, "setpoints should reach the motors")) {
+    return false;
+  }
+
+  ::CanMessage feedback = MakeMessage(0x203U, 8U, 0U);
+  feedback.data[0] = 0x12U;
+  feedback.data[1] = 0x34U;
+  can_bus_write(can_virtual_node_bus(&motors), &feedback);
+  can_virtual_medium_run_until_idle(&medium);
+  can_serial_relay(&mcu, can_virtual_node_bus(&mcu_can), 8U);
+
+  host.poll();
+  return ExpectTrue(om_rm_read_all(&rm) == 1 &&
+                        om_rm_get_angle(&rm, 3) == 0x1234U,
+                    "feedback should reach the host driver");
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+
+  ok = TestBatchesFramesPerSerialWrite() && ok;
+  ok = TestRecoversFromCorruption() && ok;
+  ok = TestFailedWriteKeepsFrames() && ok;
+  ok = TestRobomasOverSerialLink() && ok;
+
+  if (!ok) {
+    std::cerr << "can_serial_cpp_test failed" << std::endl;
+    return 1;
+  }
+
+  std::cout << "can_serial_cpp_test passed" << std::endl;
+  return 0;
+}
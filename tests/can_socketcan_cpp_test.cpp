@@ -0,0 +1,138 @@
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "can/can_socketcan.hpp"
+
+namespace {
+
+// ctest の SKIP_RETURN_CODE と合わせる
+constexpr int kSkipReturnCode = 77;
+
+bool ExpectTrue(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << message << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool TestClosedBusFails() {
+  omuraisu::can::SocketCanBus bus("omuraisu-none0");
+  if (!ExpectTrue(!bus.open(), "open should fail for unknown interface")) {
+    return false;
+  }
+  if (!ExpectTrue(!bus.is_open() && bus.fd() < 0,
+                  "bus should stay closed after failed open")) {
+    return false;
+  }
+
+  omuraisu::can::CanMessage msg;
+  if (!ExpectTrue(!bus.write(msg), "write on closed bus should fail")) {
+    return false;
+  }
+  if (!ExpectTrue(!bus.read(msg), "read on closed bus should fail")) {
+    return false;
+  }
+  if (!ExpectTrue(bus.write_batch(&msg, 1) == 0U &&
+                      bus.read_batch(&msg, 1) == 0U,
+                  "batch operations on closed bus should fail")) {
+    return false;
+  }
+  return ExpectTrue(!bus.set_filters(nullptr, 0U),
+                    "set_filters on closed bus should fail");
+}
+
+bool TestLoopbackOnVcan(omuraisu::can::SocketCanBus& tx,
+                        omuraisu::can::SocketCanBus& rx) {
+  omuraisu::can::CanMessage frames[40];
+  for (uint32_t i = 0; i < 40U; ++i) {
+    uint8_t data[8] = {static_cast<uint8_t>(i), 1, 2, 3, 4, 5, 6, 7};
+    uint32_t id = (i % 2U) == 0U ? 0x200U + i : 0x00000900U + i;
+    frames[i] = omuraisu::can::CanMessage(id, data, 8U);
+  }
+
+  if (!ExpectTrue(tx.write_batch(frames, 40U) == 40U,
+                  "write_batch should send all frames")) {
+    return false;
+  }
+
+  omuraisu::can::CanMessage received[40];
+  std::size_t count = 0;
+  for (int retry = 0; retry < 1000 && count < 40U; ++retry) {
+    count += rx.read_batch(&received[count], 40U - count);
+  }
+  if (!ExpectTrue(count == 40U, "read_batch should receive all frames")) {
+    return false;
+  }
+
+  for (std::size_t i = 0; i < count; ++i) {
+    if (!ExpectTrue(received[i].id == frames[i].id &&
+                        received[i].len == 8U &&
+                        received[i].data[0] == frames[i].data[0],
+                    "received frame should match sent frame")) {
+      return false;
+    }
+  }
+  return ExpectTrue(received[0].has_timestamp() && received[39].has_timestamp(),
+                    "received frames should carry SO_TIMESTAMP");
+}
+
+bool TestFiltersOnVcan(omuraisu::can::SocketCanBus& tx,
+                       omuraisu::can::SocketCanBus& rx) {
+  const ::CanFilter filter = {0x200U, 0x7F0U};
+  if (!ExpectTrue(rx.set_filters(&filter, 1U), "set_filters should succeed")) {
+    return false;
+  }
+
+  const uint8_t data[8] = {0};
+  omuraisu::can::CanMessage frames[3] = {
+      omuraisu::can::CanMessage(0x300U, data, 8U),
+      omuraisu::can::CanMessage(0x905U, data, 8U),
+      omuraisu::can::CanMessage(0x205U, data, 8U),
+  };
+  if (!ExpectTrue(tx.write_batch(frames) == 3U,
+                  "write_batch should send filter test frames")) {
+    return false;
+  }
+
+  omuraisu::can::CanMessage received[3];
+  std::size_t count = 0;
+  for (int retry = 0; retry < 1000 && count == 0U; ++retry) {
+    count = rx.read_batch(received);
+  }
+  const bool filtered = ExpectTrue(count == 1U && received[0].id == 0x205U,
+                                   "only the matching frame should pass");
+  rx.set_filters(nullptr, 0U);
+  return filtered;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+
+  ok = TestClosedBusFails() && ok;
+
+  omuraisu::can::SocketCanBus tx("vcan0");
+  omuraisu::can::SocketCanBus rx("vcan0");
+  if (!tx.open() || !rx.open()) {
+    if (!ok) {
+      std::cerr << "can_socketcan_cpp_test failed" << std::endl;
+      return 1;
+    }
+    std::cout << "vcan0 is not available, skipping loopback test" << std::endl;
+    return kSkipReturnCode;
+  }
+
+  ok = TestLoopbackOnVcan(tx, rx) && ok;
+  ok = TestFiltersOnVcan(tx, rx) && ok;
+
+  if (!ok) {
+    std::cerr << "can_socketcan_cpp_test failed" << std::endl;
+    return 1;
+  }
+
+  std::cout << "can_socketcan_cpp_test passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,276 @@
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "can/can_dispatch.h"
+#include "can/can_virtual.h"
+#include "can/can_virtual.hpp"
+#include "controller/controller_transport.h"
+#include "dji/robomas.h"
+#include "dji/robomas.hpp"
+#include "vesc/vesc_core.h"
+
+namespace {
+
+bool ExpectTrue(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << message << std::endl;
+    return false;
+  }
+  return true;
+}
+
+::CanMessage MakeMessage(uint32_t id) {
+  ::CanMessage msg = {};
+  msg.id = id;
+  msg.len = 8U;
+  return msg;
+}
+
+// 1Mbit/s での標準 ID 8 バイトフレームの長さ [us]
+constexpr uint32_t kStdFrameUs = 111U;
+
+bool TestArbitrationByLowestId() {
+  ::CanVirtualMedium medium;
+  can_virtual_medium_init(&medium, 1000000U);
+  ::CanVirtualNode a;
+  ::CanVirtualNode b;
+  ::CanVirtualNode listener;
+  can_virtual_node_init(&a, &medium);
+  can_virtual_node_init(&b, &medium);
+  can_virtual_node_init(&listener, &medium);
+
+  ::CanMessage msg = MakeMessage(0x300U);
+  can_bus_write(can_virtual_node_bus(&a), &msg);
+  msg = MakeMessage(0x100U);
+  can_bus_write(can_virtual_node_bus(&b), &msg);
+  msg = MakeMessage(0x200U);
+  can_bus_write(can_virtual_node_bus(&b), &msg);
+
+  if (!ExpectTrue(can_virtual_medium_run_until_idle(&medium) ==
+                      3U * kStdFrameUs,
+                  "frames should occupy the bus back to back")) {
+    return false;
+  }
+
+  const uint32_t expected[] = {0x100U, 0x200U, 0x300U};
+  for (std::size_t i = 0; i < 3U; ++i) {
+    ::CanMessage rx = {};
+    if (!ExpectTrue(can_bus_read(can_virtual_node_bus(&listener), &rx) &&
+                        rx.id == expected[i] &&
+                        rx.timestamp_us == (i + 1U) * kStdFrameUs,
+                    "lowest id should win arbitration")) {
+      return false;
+    }
+  }
+
+  ::CanMessage own = {};
+  const bool a_ok = can_bus_read(can_virtual_node_bus(&a), &own) &&
+                    own.id == 0x100U &&
+                    can_bus_read(can_virtual_node_bus(&a), &own) &&
+                    own.id == 0x200U &&
+                    !can_bus_read(can_virtual_node_bus(&a), &own);
+  const bool b_ok = can_bus_read(can_virtual_node_bus(&b), &own) &&
+                    own.id == 0x300U &&
+                    !can_bus_read(can_virtual_node_bus(&b), &own);
+  return ExpectTrue(a_ok && b_ok,
+                    "senders should only see frames from other nodes");
+}
+
+bool TestArbitrationMixesStandardAndExtended() {
+  ::CanVirtualMedium medium;
+  can_virtual_medium_init(&medium, 1000000U);
+  ::CanVirtualNode nodes[4];
+  ::CanVirtualNode listener;
+  // ベース ID 0 の拡張（VESC）、ベース ID 4 の標準と拡張、標準 0x200
+  const uint32_t ids[4] = {0x200U, 0x0901U, (0x004U << 18) | 0x1U, 0x004U};
+  for (std::size_t i = 0; i < 4U; ++i) {
+    can_virtual_node_init(&nodes[i], &medium);
+  }
+  can_virtual_node_init(&listener, &medium);
+  for (std::size_t i = 0; i < 4U; ++i) {
+    ::CanMessage msg = MakeMessage(ids[i]);
+    can_bus_write(can_virtual_node_bus(&nodes[i]), &msg);
+  }
+  can_virtual_medium_run_until_idle(&medium);
+
+  const uint32_t expected[] = {0x0901U, 0x004U, (0x004U << 18) | 0x1U,
+                               0x200U};
+  for (std::size_t i = 0; i < 4U; ++i) {
+    ::CanMessage rx = {};
+    if (!ExpectTrue(can_bus_read(can_virtual_node_bus(&listener), &rx) &&
+                        rx.id == expected[i],
+                    "arbitration should compare base ids before IDE")) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TestFramesArriveAfterBusTimeAndLatency() {
+  ::CanVirtualMedium medium;
+  can_virtual_medium_init(&medium, 1000000U);
+  can_virtual_medium_set_latency(&medium, 50U);
+  ::CanVirtualNode tx;
+  ::CanVirtualNode rx;
+  can_virtual_node_init(&tx, &medium);
+  can_virtual_node_init(&rx, &medium);
+
+  ::CanMessage msg = MakeMessage(0x10U);
+  can_bus_write(can_virtual_node_bus(&tx), &msg);
+
+  ::CanMessage out = {};
+  can_virtual_medium_advance(&medium, kStdFrameUs - 1U);
+  if (!ExpectTrue(!can_bus_read(can_virtual_node_bus(&rx), &out),
+                  "frame should not arrive before it is on the wire")) {
+    return false;
+  }
+  can_virtual_medium_advance(&medium, 1U);
+  if (!ExpectTrue(!can_bus_read(can_virtual_node_bus(&rx), &out),
+                  "latency should delay the frame")) {
+    return false;
+  }
+  can_virtual_medium_advance(&medium, 50U);
+  return ExpectTrue(can_bus_read(can_virtual_node_bus(&rx), &out) &&
+                        (out.flags & CAN_MSG_FLAG_TIMESTAMP) != 0U &&
+                        out.timestamp_us == kStdFrameUs,
+                    "frame should be readable after the latency");
+}
+
+uint32_t CountLost(uint32_t seed) {
+  ::CanVirtualMedium medium;
+  can_virtual_medium_init(&medium, 1000000U);
+  can_virtual_medium_set_loss(&medium, 500U, seed);
+  ::CanVirtualNode tx;
+  ::CanVirtualNode rx;
+  can_virtual_node_init(&tx, &medium);
+  can_virtual_node_init(&rx, &medium);
+
+  for (int i = 0; i < 100; ++i) {
+    ::CanMessage msg = MakeMessage(0x20U);
+    can_bus_write(can_virtual_node_bus(&tx), &msg);
+    can_virtual_medium_run_until_idle(&medium);
+    can_bus_read(can_virtual_node_bus(&rx), &msg);
+  }
+  return medium.lost_count;
+}
+
+bool TestLossIsReproducible() {
+  const uint32_t lost = CountLost(1234U);
+  return ExpectTrue(lost > 20U && lost < 80U && CountLost(1234U) == lost,
+                    "loss should follow the rate and repeat with the seed");
+}
+
+bool TestDriversShareSimulatedBus() {
+  ::CanVirtualMedium medium;
+  can_virtual_medium_init(&medium, 1000000U);
+  ::CanVirtualNode host_node;
+  ::CanVirtualNode devices;
+  can_virtual_node_init(&host_node, &medium);
+  can_virtual_node_init(&devices, &medium);
+
+  Robomas rm = om_rm_init(can_virtual_node_bus(&host_node));
+  VescCore vesc = om_vesc_core_init();
+  ControllerData controller = {};
+  ::CanDispatcher dispatcher;
+  can_dispatcher_init(&dispatcher);
+  om_rm_attach(&rm, &dispatcher);
+  om_vesc_core_attach(&vesc, &dispatcher);
+  om_ctrl_can_attach(&controller, &dispatcher);
+
+  // 1ms 周期で 4 モーター + VESC + コントローラが送り、ホストが指令を返す
+  std::size_t commands = 0;
+  for (int cycle = 0; cycle < 10; ++cycle) {
+    for (uint32_t id = 0x201U; id <= 0x204U; ++id) {
+      ::CanMessage fb = MakeMessage(id);
+      fb.data[1] = static_cast<uint8_t>(cycle);
+      can_bus_write(can_virtual_node_bus(&devices), &fb);
+    }
+    ::CanMessage status = MakeMessage((VESC_CAN_PACKET_STATUS << 8) | 7U);
+    status.data[3] = 100U;
+    can_bus_write(can_virtual_node_bus(&devices), &status);
+    ::CanMessage analog = MakeMessage(OM_CONTROLLER_CAN_ID_ANALOG);
+    analog.data[0] = 127U;
+    can_bus_write(can_virtual_node_bus(&devices), &analog);
+
+    can_virtual_medium_advance(&medium, 500U);
+    can_dispatcher_poll(&dispatcher, can_virtual_node_bus(&host_node));
+    om_rm_write(&rm);
+    can_virtual_medium_advance(&medium, 500U);
+
+    ::CanMessage cmd = {};
+    while (can_bus_read(can_virtual_node_bus(&devices), &cmd)) {
+      commands++;
+    }
+  }
+
+  if (!ExpectTrue(om_rm_get_angle(&rm, 4) == 9U &&
+                      om_vesc_core_get_rpm(&vesc, 7) == 100 &&
+                      controller.left_x == 1.0f,
+                  "every driver should see its own frames")) {
+    return false;
+  }
+  if (!ExpectTrue(commands == 20U, "host commands should reach the devices")) {
+    return false;
+  }
+
+  ::CanBusStats stats = {};
+  can_bus_get_stats(can_virtual_node_bus(&host_node), &stats);
+  // 8 標準 + 1 拡張フレーム / 1ms
+  return ExpectTrue(stats.rx_frames == 60U && stats.tx_frames == 20U &&
+                        stats.bus_load_percent > 90.0f &&
+                        stats.bus_load_percent < 95.0f,
+                    "stats should reflect simulated traffic and load");
+}
+
+bool TestCppBusWithRobomas() {
+  omuraisu::can::VirtualCanMedium medium(1000000U);
+  omuraisu::can::VirtualCanBus host(medium);
+  omuraisu::can::VirtualCanBus motors(medium);
+
+  omuraisu::dji::Robomas rm(host);
+  rm.set_output(500, 1);
+  if (!ExpectTrue(rm.write() && host.tx_pending() == 2U,
+                  "commands should wait for the bus")) {
+    return false;
+  }
+  medium.run_until_idle();
+
+  omuraisu::can::CanMessage cmd;
+  // 1 ノード内のフレームは書き込んだ順に送られる
+  if (!ExpectTrue(motors.read(cmd) && cmd.id == TX_ID_GROUP1,
+                  "frames from one node should keep their order")) {
+    return false;
+  }
+  if (!ExpectTrue(motors.read(cmd) && cmd.id == TX_ID_GROUP2 &&
+                      medium.delivered_count() == 2U,
+                  "both command frames should be delivered")) {
+    return false;
+  }
+
+  omuraisu::can::CanBusStats stats;
+  return ExpectTrue(motors.get_stats(stats) && stats.rx_frames == 2U,
+                    "C++ node should expose statistics");
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+
+  ok = TestArbitrationByLowestId() && ok;
+  ok = TestArbitrationMixesStandardAndExtended() && ok;
+  ok = TestFramesArriveAfterBusTimeAndLatency() && ok;
+  ok = TestLossIsReproducible() && ok;
+  ok = TestDriversShareSimulatedBus() && ok;
+  ok = TestCppBusWithRobomas() && ok;
+
+  if (!ok) {
+    std::cerr << "can_virtual_cpp_test failed" << std::endl;
+    return 1;
+  }
+
+  std::cout << "can_virtual_cpp_test passed" << std::endl;
+  return 0;
+}
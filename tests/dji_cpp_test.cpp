@@ -1,3 +1,4 @@
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
 #include <string>
@@ -48,6 +49,110 @@ class FakeCanBus : public omuraisu::can::ICanBus {
   }
 };
 
+class FakeBatchCanBus : public omuraisu::can::ICanBus {
+ public:
+  static constexpr std::size_t kMaxFrames = 16;
+
+  omuraisu::can::CanMessage frames[kMaxFrames];
+  std::size_t frame_count = 0;
+  std::size_t next_frame = 0;
+  int read_batch_calls = 0;
+
+  bool write(const omuraisu::can::CanMessage& msg) override {
+    (void)msg;
+    return true;
+  }
+
+  bool read(omuraisu::can::CanMessage& msg) override {
+    return read_batch(&msg, 1U) == 1U;
+  }
+
+  using omuraisu::can::ICanBus::read_batch;
+  std::size_t read_batch(omuraisu::can::CanMessage* msgs,
+                         std::size_t max_count) override {
+    ++read_batch_calls;
+    std::size_t count = 0;
+    while (count < max_count && next_frame < frame_count) {
+      msgs[count++] = frames[next_frame++];
+    }
+    return count;
+  }
+};
+
+bool TestRobomasReadAllDrainsBatches() {
+  FakeBatchCanBus bus;
+  omuraisu::dji::Robomas rm(bus);
+
+  for (uint8_t i = 0; i < 8U; ++i) {
+    const uint8_t raw[8] = {0x00, i, 0, 0, 0, 0, 0, 0};
+    bus.frames[bus.frame_count++] =
+        omuraisu::can::CanMessage(0x201U + i, raw, 8U);
+  }
+  const uint8_t other[8] = {0};
+  bus.frames[bus.frame_count++] = omuraisu::can::CanMessage(0x100U, other, 8U);
+  bus.frames[bus.frame_count++] = omuraisu::can::CanMessage(0x205U, other, 8U);
+
+  if (!ExpectTrue(rm.read_all() == 9,
+                  "read_all should parse every motor feedback frame")) {
+    return false;
+  }
+  if (!ExpectTrue(bus.read_batch_calls == 2,
+                  "read_all should drain the bus in batches")) {
+    return false;
+  }
+  if (!ExpectTrue(rm.get_angle(8) == 7U,
+                  "read_all should update the last motor")) {
+    return false;
+  }
+  return ExpectTrue(rm.get_angle(5) == 0U,
+                    "later frames should overwrite earlier ones");
+}
+
+bool TestCRobomasReadAllUsesBatchApi() {
+  FakeBatchCanBus bus;
+  const uint8_t raw[8] = {0x01, 0x02, 0, 0, 0, 0, 0, 0};
+  bus.frames[bus.frame_count++] = omuraisu::can::CanMessage(0x203U, raw, 8U);
+
+  omuraisu::can::CppCanBusBridge bridge(bus);
+  Robomas c_rm = om_rm_init(bridge.c_bus());
+
+  if (!ExpectTrue(om_rm_read_all(&c_rm) == 1,
+                  "om_rm_read_all should parse queued feedback")) {
+    return false;
+  }
+  if (!ExpectTrue(om_rm_get_angle(&c_rm, 3) == 0x0102U,
+                  "om_rm_read_all should update motor data")) {
+    return false;
+  }
+  return ExpectTrue(om_rm_read_all(&c_rm) == 0,
+                    "om_rm_read_all should return 0 on an empty bus");
+}
+
+bool TestRobomasKeepsFeedbackTimestamp() {
+  FakeBatchCanBus bus;
+  const uint8_t raw[8] = {0x01, 0x02, 0, 0, 0, 0, 0, 0};
+  omuraisu::can::CanMessage stamped(0x202U, raw, 8U);
+  stamped.flags = CAN_MSG_FLAG_TIMESTAMP;
+  stamped.timestamp_us = 123456U;
+  bus.frames[bus.frame_count++] = stamped;
+  bus.frames[bus.frame_count++] = omuraisu::can::CanMessage(0x203U, raw, 8U);
+
+  omuraisu::dji::Robomas rm(bus);
+  rm.read_all();
+  if (!ExpectTrue(rm.get_timestamp(2) == 123456U,
+                  "stamped feedback should record its receive time")) {
+    return false;
+  }
+
+  omuraisu::can::CppCanBusBridge bridge(bus);
+  Robomas c_rm = om_rm_init(bridge.c_bus());
+  bus.next_frame = 0;
+  om_rm_read_all(&c_rm);
+  return ExpectTrue(om_rm_get_timestamp(&c_rm, 2) == 123456U &&
+                        om_rm_get_timestamp(&c_rm, 3) == 0U,
+                    "unstamped feedback should leave the timestamp at 0");
+}
+
 bool TestRobomasReadParsesMotorData() {
   FakeCanBus bus;
   omuraisu::dji::Robomas rm(bus);
@@ -147,6 +252,9 @@ int main() {
   bool ok = true;
 
   ok = TestRobomasReadParsesMotorData() && ok;
+  ok = TestRobomasReadAllDrainsBatches() && ok;
+  ok = TestCRobomasReadAllUsesBatchApi() && ok;
+  ok = TestRobomasKeepsFeedbackTimestamp() && ok;
   ok = TestRobomasWriteSendsBothGroups() && ok;
   ok = TestSetMaxOutputInt16MinIsHandled() && ok;
   ok = TestGetDataConstOutOfRangeReturnsNull() && ok;
@@ -0,0 +1,237 @@
+#include <fcntl.h>
+#include <linux/can.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "event/event_loop.hpp"
+#include "serial/serial_posix.hpp"
+
+namespace {
+
+bool ExpectTrue(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << message << std::endl;
+    return false;
+  }
+  return true;
+}
+
+struct TimerState {
+  omuraisu::event::EventLoop* loop;
+  uint64_t expirations;
+};
+
+void OnTimer(uint64_t expirations, void* user_arg) {
+  TimerState* state = static_cast<TimerState*>(user_arg);
+  state->expirations += expirations;
+  if (state->expirations >= 3U) {
+    state->loop->stop();
+  }
+}
+
+struct PipeState {
+  omuraisu::event::EventLoop* loop;
+  int calls;
+  int remove_source;  // 呼ばれたときに削除するソース（-1 なら何もしない）
+};
+
+void OnPipeReadable(int fd, uint32_t events, void* user_arg) {
+  PipeState* state = static_cast<PipeState*>(user_arg);
+  uint8_t buffer[16];
+  while (read(fd, buffer, sizeof(buffer)) > 0) {
+  }
+  if ((events & EPOLLIN) != 0U) {
+    ++state->calls;
+  }
+  if (state->remove_source >= 0) {
+    state->loop->remove(state->remove_source);
+  }
+}
+
+struct CanState {
+  omuraisu::event::EventLoop* loop;
+  int source;
+  int calls;
+  int pipe_fd;     // 削除後に登録し直す fd（同じスロットを再利用させる）
+  int new_source;  // 登録し直したソース
+  PipeState pipe;
+};
+
+void OnCanFrame(const ::CanMessage* msg, void* user_arg) {
+  CanState* state = static_cast<CanState*>(user_arg);
+  (void)msg;
+  ++state->calls;
+  state->loop->remove(state->source);
+  state->new_source = state->loop->add_fd(state->pipe_fd, EPOLLIN,
+                                          OnPipeReadable, &state->pipe);
+}
+
+struct SerialState {
+  std::string received;
+};
+
+void OnSerial(const ::SerialMessage* msg, void* user_arg) {
+  SerialState* state = static_cast<SerialState*>(user_arg);
+  state->received.append(reinterpret_cast<const char*>(msg->data), msg->len);
+}
+
+bool TestPeriodicTimer() {
+  omuraisu::event::EventLoop loop;
+  TimerState state = {&loop, 0U};
+  if (!ExpectTrue(
+          loop.is_valid() && loop.add_timer(1000U, OnTimer, &state) >= 0,
+          "timer should be registered")) {
+    return false;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  loop.run();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return ExpectTrue(state.expirations >= 3U &&
+                        elapsed >= std::chrono::microseconds(2900),
+                    "timer should fire every period until stopped");
+}
+
+bool TestFdSourcesAndRemoval() {
+  int a[2];
+  int b[2];
+  if (pipe2(a, O_NONBLOCK | O_CLOEXEC) != 0 ||
+      pipe2(b, O_NONBLOCK | O_CLOEXEC) != 0) {
+    return ExpectTrue(false, "pipe2 failed");
+  }
+
+  omuraisu::event::EventLoop loop;
+  PipeState state_a = {&loop, 0, -1};
+  PipeState state_b = {&loop, 0, -1};
+  const int source_a = loop.add_fd(a[0], EPOLLIN, OnPipeReadable, &state_a);
+  const int source_b = loop.add_fd(b[0], EPOLLIN, OnPipeReadable, &state_b);
+
+  // 一方のコールバックがもう一方を削除しても、同じ回の残りは届かない
+  state_a.remove_source = source_b;
+  state_b.remove_source = source_a;
+  const uint8_t byte = 0x55U;
+  bool ok = write(a[1], &byte, 1) == 1 && write(b[1], &byte, 1) == 1;
+  const int dispatched = loop.run_once(100);
+  ok = ExpectTrue(ok && dispatched == 1 && state_a.calls + state_b.calls == 1,
+                  "removed source should not be dispatched") &&
+       ok;
+
+  // 残ったソースは引き続き届く
+  ok = ok && write(a[1], &byte, 1) == 1 && write(b[1], &byte, 1) == 1;
+  ok = ExpectTrue(ok && loop.run_once(100) == 1 &&
+                      state_a.calls + state_b.calls == 2 &&
+                      loop.remove(source_a) != loop.remove(source_b),
+                  "only the surviving source should stay registered") &&
+       ok;
+
+  close(a[0]);
+  close(a[1]);
+  close(b[0]);
+  close(b[1]);
+  return ok;
+}
+
+bool TestSocketCanRemovedInCallback() {
+  // CAN_RAW の代わりにデータグラムのソケットペアへ can_frame を流す
+  int sv[2];
+  int p[2];
+  if (socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, sv) !=
+          0 ||
+      pipe2(p, O_NONBLOCK | O_CLOEXEC) != 0) {
+    return ExpectTrue(false, "socketpair/pipe2 failed");
+  }
+  ::CanSocketCan socketcan;
+  can_socketcan_init(&socketcan);
+  socketcan.fd = sv[0];
+
+  omuraisu::event::EventLoop loop;
+  CanState state = {&loop, -1, 0, p[0], -1, {&loop, 0, -1}};
+  state.source =
+      event_loop_add_socketcan(loop.c_loop(), &socketcan, OnCanFrame, &state);
+
+  struct can_frame frame = {};
+  frame.can_id = 0x123U;
+  frame.can_dlc = 1U;
+  bool ok = state.source >= 0;
+  for (int i = 0; i < 3; ++i) {
+    ok = ok && write(sv[1], &frame, sizeof(frame)) == (ssize_t)sizeof(frame);
+  }
+
+  // 削除後は同じスロットが fd ソースになるので、残りのフレームは配らない
+  ok = ok && loop.run_once(100) == 1;
+  ok = ExpectTrue(ok && state.calls == 1 && state.pipe.calls == 0 &&
+                      state.new_source == state.source,
+                  "removed socketcan source should stop dispatching") &&
+       ok;
+
+  loop.remove(state.new_source);
+  close(sv[0]);
+  close(sv[1]);
+  close(p[0]);
+  close(p[1]);
+  return ok;
+}
+
+bool TestSerialOverPty() {
+  const int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+    return ExpectTrue(false, "pty should be available");
+  }
+  const std::string device = ptsname(master);
+
+  omuraisu::serial::PosixSerialPort bad_baud(device, 12345U);
+  omuraisu::serial::PosixSerialPort port(device, 115200U);
+  bool ok = ExpectTrue(!bad_baud.open() && port.open() && port.fd() >= 0,
+                       "pty should open at a standard baudrate");
+
+  omuraisu::event::EventLoop loop;
+  SerialState state;
+  ok = ok && loop.add_serial(port, OnSerial, &state) >= 0;
+
+  const char text[] = "omuraisu";
+  ok = ok && write(master, text, 8) == 8;
+  for (int i = 0; i < 10 && state.received.size() < 8U; ++i) {
+    loop.run_once(100);
+  }
+  ok = ExpectTrue(ok && state.received == "omuraisu",
+                  "tty bytes should reach the rx callback") &&
+       ok;
+
+  const uint8_t reply[] = {0x01U, 0x00U, 0xFFU};
+  omuraisu::serial::SerialMessage msg(reply, 3U);
+  uint8_t echoed[3] = {0U, 0U, 0U};
+  ok = ok && port.write(msg);
+  ok = ExpectTrue(ok && read(master, echoed, 3) == 3 && echoed[2] == 0xFFU,
+                  "tty writes should be raw bytes") &&
+       ok;
+
+  port.close();
+  close(master);
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+
+  ok = TestPeriodicTimer() && ok;
+  ok = TestFdSourcesAndRemoval() && ok;
+  ok = TestSocketCanRemovedInCallback() && ok;
+  ok = TestSerialOverPty() && ok;
+
+  if (!ok) {
+    std::cerr << "event_loop_cpp_test failed" << std::endl;
+    return 1;
+  }
+
+  std::cout << "event_loop_cpp_test passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,222 @@
+#include <fcntl.h>
+#include <linux/can.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "event/event_uring.h"
+#include "serial/serial_posix.h"
+
+namespace {
+
+// ctest の SKIP_RETURN_CODE と合わせる
+constexpr int kSkipReturnCode = 77;
+
+bool ExpectTrue(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << message << std::endl;
+    return false;
+  }
+  return true;
+}
+
+struct CanState {
+  std::vector<::CanMessage> frames;
+};
+
+void OnCan(const ::CanMessage* msg, void* user_arg) {
+  static_cast<CanState*>(user_arg)->frames.push_back(*msg);
+}
+
+struct SerialState {
+  std::string received;
+};
+
+void OnSerial(const ::SerialMessage* msg, void* user_arg) {
+  static_cast<SerialState*>(user_arg)->received.append(
+      reinterpret_cast<const char*>(msg->data), msg->len);
+}
+
+bool SendFrame(int fd, canid_t id, uint8_t seed) {
+  struct can_frame frame;
+  std::memset(&frame, 0, sizeof(frame));
+  frame.can_id = id;
+  frame.can_dlc = 8U;
+  for (uint8_t i = 0; i < 8U; ++i) {
+    frame.data[i] = static_cast<uint8_t>(seed + i);
+  }
+  return send(fd, &frame, sizeof(frame), 0) ==
+         static_cast<ssize_t>(sizeof(frame));
+}
+
+void RunUntil(::EventUring* uring, const CanState& state, std::size_t count) {
+  for (int i = 0; i < 100 && state.frames.size() < count; ++i) {
+    event_uring_run_once(uring, true);
+  }
+}
+
+// CAN_RAW の代わりに can_frame 単位で届く SEQPACKET のソケット対を使う
+bool TestCanReceiveWithoutPerFrameSyscalls(::EventUring* uring,
+                                           CanState& state, int fd, int peer) {
+  if (!ExpectTrue(event_uring_add_can(uring, fd, OnCan, &state) >= 0,
+                  "can source should be registered")) {
+    return false;
+  }
+  event_uring_run_once(uring, false);
+
+  const uint32_t enter_before = uring->enter_count;
+  bool ok = true;
+  for (uint8_t i = 0; i < 40U; ++i) {
+    const canid_t id = (i % 2U) == 0U ? 0x200U + i
+                                      : (0x18FF0000U + i) | CAN_EFF_FLAG;
+    ok = ok && SendFrame(peer, id, i);
+  }
+  ok = ok && SendFrame(peer, 0x123U | CAN_RTR_FLAG, 0U);
+  ok = ok && SendFrame(peer, 0x7FFU, 0xA0U);
+  RunUntil(uring, state, 41U);
+
+  ok = ExpectTrue(ok && state.frames.size() == 41U,
+                  "every data frame should be delivered") &&
+       ok;
+  ok = ExpectTrue(uring->enter_count - enter_before < 5U,
+                  "frames should be reaped without per-frame syscalls") &&
+       ok;
+  for (std::size_t i = 0; ok && i < 40U; ++i) {
+    const uint32_t expected =
+        (i % 2U) == 0U ? 0x200U + i : 0x18FF0000U + static_cast<uint32_t>(i);
+    ok = ExpectTrue(state.frames[i].id == expected &&
+                        state.frames[i].len == 8U &&
+                        state.frames[i].data[7] == i + 7U,
+                    "frames should keep order, id and data") &&
+         ok;
+  }
+  return ExpectTrue(ok && state.frames[40].id == 0x7FFU,
+                    "remote frames should be dropped");
+}
+
+bool TestCanBufferExhaustionRecovers(::EventUring* uring, CanState& state,
+                                     int peer) {
+  // 前のテストで登録したソースに受信バッファ数を超えて流し込む
+  state.frames.clear();
+  bool ok = true;
+  for (uint32_t i = 0; i < EVENT_URING_CAN_BUFFERS + 36U; ++i) {
+    ok = ok && SendFrame(peer, 0x100U + (i & 0xFFU), static_cast<uint8_t>(i));
+  }
+  RunUntil(uring, state, EVENT_URING_CAN_BUFFERS + 36U);
+
+  bool ordered = state.frames.size() == EVENT_URING_CAN_BUFFERS + 36U;
+  for (std::size_t i = 0; ordered && i < state.frames.size(); ++i) {
+    ordered = state.frames[i].data[0] == static_cast<uint8_t>(i);
+  }
+  return ExpectTrue(ok && ordered && uring->rx_overflows > 0U,
+                    "receiving should resume after the buffers run out");
+}
+
+bool TestCanTransmit(::EventUring* uring, int fd, int peer) {
+  ::CanMessage msgs[3] = {};
+  for (uint8_t i = 0; i < 3U; ++i) {
+    msgs[i].id = i == 2U ? 0x1ABCDEF0U : 0x300U + i;
+    msgs[i].len = 2U;
+    msgs[i].data[1] = i;
+  }
+  const uint32_t tx_before = uring->tx_count;
+  bool ok = event_uring_write_can(uring, fd, msgs, 3U) == 3U;
+  for (int i = 0; i < 10 && uring->tx_count - tx_before < 3U; ++i) {
+    event_uring_run_once(uring, true);
+  }
+
+  struct can_frame frames[3];
+  for (int i = 0; ok && i < 3; ++i) {
+    ok = recv(peer, &frames[i], sizeof(frames[i]), 0) ==
+         static_cast<ssize_t>(sizeof(frames[i]));
+  }
+  return ExpectTrue(
+      ok && frames[0].can_id == 0x300U && frames[1].data[1] == 1U &&
+          frames[2].can_id == (0x1ABCDEF0U | CAN_EFF_FLAG) &&
+          uring->tx_errors == 0U,
+      "queued frames should be sent as can_frame");
+}
+
+bool TestSerialOverPty(::EventUring* uring) {
+  const int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+    return ExpectTrue(false, "pty should be available");
+  }
+  ::SerialPosix tty;
+  serial_posix_init(&tty, ptsname(master), 115200U);
+  if (!ExpectTrue(serial_posix_open(&tty), "pty should open")) {
+    close(master);
+    return false;
+  }
+
+  SerialState state;
+  bool ok = event_uring_add_serial(uring, serial_posix_fd(&tty), OnSerial,
+                                   &state) >= 0;
+  event_uring_run_once(uring, false);
+  ok = ok && write(master, "io_uring", 8) == 8;
+  for (int i = 0; i < 100 && state.received.size() < 8U; ++i) {
+    event_uring_run_once(uring, true);
+  }
+  ok = ExpectTrue(ok && state.received == "io_uring",
+                  "tty bytes should land in SerialMessage buffers") &&
+       ok;
+
+  ::SerialMessage msg = {};
+  msg.data[0] = 0x00U;
+  msg.data[1] = 0x7EU;
+  msg.len = 2U;
+  uint8_t echoed[2] = {0xFFU, 0xFFU};
+  ok = ok && event_uring_write_serial(uring, serial_posix_fd(&tty), &msg);
+  event_uring_run_once(uring, false);
+  ok = ExpectTrue(ok && read(master, echoed, 2) == 2 && echoed[0] == 0x00U &&
+                      echoed[1] == 0x7EU,
+                  "serial writes should go out through the ring") &&
+       ok;
+
+  serial_posix_close(&tty);
+  close(master);
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  ::EventUring uring;
+  if (!event_uring_init(&uring)) {
+    std::cout << "io_uring is not available, skipping" << std::endl;
+    return kSkipReturnCode;
+  }
+
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK, 0, fds) != 0) {
+    event_uring_close(&uring);
+    return 1;
+  }
+
+  CanState can_state;
+  bool ok = true;
+  ok = TestCanReceiveWithoutPerFrameSyscalls(&uring, can_state, fds[0],
+                                             fds[1]) &&
+       ok;
+  ok = ok && TestCanBufferExhaustionRecovers(&uring, can_state, fds[1]);
+  ok = TestCanTransmit(&uring, fds[0], fds[1]) && ok;
+  ok = TestSerialOverPty(&uring) && ok;
+
+  event_uring_close(&uring);
+  close(fds[0]);
+  close(fds[1]);
+
+  if (!ok) {
+    std::cerr << "event_uring_cpp_test failed" << std::endl;
+    return 1;
+  }
+
+  std::cout << "event_uring_cpp_test passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,148 @@
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "profile/profile.h"
+#include "profile/profile.hpp"
+
+namespace {
+
+bool ExpectTrue(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << message << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool TestRecordStats() {
+  om_profile_init(10U);  // 10 tick = 1 µs
+
+  om_profile_record(OM_PROFILE_CAN_CUBE_RX, 5U);     // 0.5 µs
+  om_profile_record(OM_PROFILE_CAN_CUBE_RX, 10U);    // 1 µs
+  om_profile_record(OM_PROFILE_CAN_CUBE_RX, 35U);    // 3.5 µs
+  om_profile_record(OM_PROFILE_CAN_CUBE_RX, 1000000U);  // 100 ms
+
+  const ProfileRegion* region = om_profile_get(OM_PROFILE_CAN_CUBE_RX);
+  bool ok = ExpectTrue(region != nullptr && region->calls == 4U &&
+                           region->min_ticks == 5U &&
+                           region->max_ticks == 1000000U &&
+                           region->total_ticks == 1000050U,
+                       "calls, min, max and total should be tracked");
+  ok = ExpectTrue(region->hist[0] == 1U && region->hist[1] == 1U &&
+                      region->hist[2] == 1U &&
+                      region->hist[OM_PROFILE_HIST_BINS - 1] == 1U,
+                  "durations should fall into power-of-two µs bins") &&
+       ok;
+  return ExpectTrue(std::strcmp(region->name, "can_cube_rx") == 0 &&
+                        om_profile_ticks_to_us(35U) == 3.5F,
+                    "built-in regions should be named") &&
+         ok;
+}
+
+bool TestRegisterAndReset() {
+  om_profile_init(1U);
+
+  const int first = om_profile_register("control");
+  bool ok = ExpectTrue(first == OM_PROFILE_USER_FIRST,
+                       "user regions should follow the built-in ones");
+  int last = first;
+  while (last >= 0) {
+    last = om_profile_register("extra");
+  }
+  ok = ExpectTrue(om_profile_get(OM_PROFILE_MAX_REGIONS) == nullptr &&
+                      om_profile_get(OM_PROFILE_MAX_REGIONS - 1)->name !=
+                          nullptr,
+                  "registration should stop when the table is full") &&
+       ok;
+
+  om_profile_record(first, 7U);
+  om_profile_mark_period();
+  om_profile_reset();
+  const ProfileRegion* region = om_profile_get(first);
+  ok = ExpectTrue(region->calls == 0U && region->total_ticks == 0U &&
+                      om_profile_period_count() == 0U &&
+                      std::strcmp(region->name, "control") == 0,
+                  "reset should clear results but keep names") &&
+       ok;
+
+  om_profile_init(1U);
+  return ExpectTrue(om_profile_register("again") == OM_PROFILE_USER_FIRST,
+                    "init should drop user registrations") &&
+         ok;
+}
+
+bool TestFormatPerPeriod() {
+  om_profile_init(10U);
+  const int control = om_profile_register("control");
+
+  // 1 周期に control 20 µs と CAN 受信 2.5 µs を 2 回
+  for (int i = 0; i < 3; ++i) {
+    om_profile_record(control, 200U);
+    om_profile_record(OM_PROFILE_CAN_CUBE_RX, 25U);
+    om_profile_record(OM_PROFILE_CAN_CUBE_RX, 25U);
+    om_profile_mark_period();
+  }
+
+  char buf[512];
+  const std::size_t length = om_profile_format(buf, sizeof(buf));
+  const std::string text(buf, length);
+  bool ok = ExpectTrue(length == std::strlen(buf) &&
+                           text.find("us/period") != std::string::npos,
+                       "the report should have a header");
+  ok = ExpectTrue(text.find("can_cube_rx") != std::string::npos &&
+                      text.find("control") != std::string::npos &&
+                      text.find("can_cube_tx") == std::string::npos,
+                  "only recorded regions should be listed") &&
+       ok;
+  ok = ExpectTrue(text.find("20.00\n") != std::string::npos &&
+                      text.find(" 5.00\n") != std::string::npos &&
+                      text.find("25.00\n") != std::string::npos,
+                  "per-period averages and their total should be printed") &&
+       ok;
+
+  char small[16];
+  return ExpectTrue(om_profile_format(small, sizeof(small)) ==
+                        sizeof(small) - 1U &&
+                        small[sizeof(small) - 1U] == '\0',
+                    "a short buffer should be truncated and terminated") &&
+         ok;
+}
+
+bool TestScopes() {
+  om_profile_init(0U);
+  const int id = om_profile_register("scope");
+
+  {
+    OM_PROFILE_SCOPE(id);
+    OM_PROFILE_SCOPE(id);
+  }
+  OM_PROFILE_BEGIN(start);
+  OM_PROFILE_END(id, start);
+
+  const ProfileRegion* region = om_profile_get(id);
+  return ExpectTrue(region->calls == 3U &&
+                        region->min_ticks <= region->max_ticks &&
+                        om_profile_ticks_per_us() != 0U,
+                    "scopes and macros should record each pass");
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+
+  ok = TestRecordStats() && ok;
+  ok = TestRegisterAndReset() && ok;
+  ok = TestFormatPerPeriod() && ok;
+  ok = TestScopes() && ok;
+
+  if (!ok) {
+    std::cerr << "profile_cpp_test failed" << std::endl;
+    return 1;
+  }
+
+  std::cout << "profile_cpp_test passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,197 @@
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "can/can_cube.h"
+#include "ring/spsc_ring.h"
+
+namespace {
+
+bool ExpectTrue(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << message << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool TestRingFullAndEmpty() {
+  SpscRing ring;
+  spsc_ring_init(&ring, 4U);
+  uint32_t index = 0;
+
+  if (!ExpectTrue(!spsc_ring_read_slot(&ring, &index),
+                  "new ring should be empty")) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < 4U; ++i) {
+    if (!ExpectTrue(spsc_ring_write_slot(&ring, &index) && index == i,
+                    "write slot should advance sequentially")) {
+      return false;
+    }
+    spsc_ring_commit_write(&ring);
+  }
+
+  if (!ExpectTrue(!spsc_ring_write_slot(&ring, &index) &&
+                      spsc_ring_writable(&ring) == 0U,
+                  "ring should be full after capacity writes")) {
+    return false;
+  }
+  return ExpectTrue(spsc_ring_count(&ring) == 4U &&
+                        spsc_ring_readable(&ring) == 4U,
+                    "count should equal capacity");
+}
+
+bool TestRingWrapAround() {
+  SpscRing ring;
+  uint32_t storage[4] = {0};
+  spsc_ring_init(&ring, 4U);
+
+  // インデックスを折り返させながら 10 要素を通す
+  for (uint32_t value = 0; value < 10U; ++value) {
+    uint32_t index = 0;
+    if (!ExpectTrue(spsc_ring_write_slot(&ring, &index),
+                    "write should succeed")) {
+      return false;
+    }
+    storage[index] = value;
+    spsc_ring_commit_write(&ring);
+
+    if (!ExpectTrue(spsc_ring_read_slot(&ring, &index) &&
+                        storage[index] == value,
+                    "read should return written value in order")) {
+      return false;
+    }
+    spsc_ring_commit_read(&ring);
+  }
+  return ExpectTrue(spsc_ring_count(&ring) == 0U,
+                    "ring should be empty after draining");
+}
+
+bool TestRingConcurrentTransfer() {
+  constexpr uint32_t kCount = 200000U;
+  SpscRing ring;
+  uint32_t storage[64] = {0};
+  spsc_ring_init(&ring, 64U);
+
+  std::thread producer([&]() {
+    for (uint32_t value = 0; value < kCount;) {
+      uint32_t index = 0;
+      if (!spsc_ring_write_slot(&ring, &index)) {
+        std::this_thread::yield();
+        continue;
+      }
+      storage[index] = value++;
+      spsc_ring_commit_write(&ring);
+    }
+  });
+
+  bool ordered = true;
+  for (uint32_t expected = 0; expected < kCount;) {
+    uint32_t available = spsc_ring_readable(&ring);
+    if (available == 0U) {
+      std::this_thread::yield();
+      continue;
+    }
+    for (uint32_t i = 0; i < available; ++i) {
+      ordered = ordered &&
+                storage[spsc_ring_read_index(&ring, i)] == expected + i;
+    }
+    spsc_ring_commit_read_n(&ring, available);
+    expected += available;
+  }
+  producer.join();
+
+  return ExpectTrue(ordered, "consumer should observe values in order");
+}
+
+struct FakeCubeHal {
+  uint32_t next_id;
+  uint32_t pending;
+};
+
+bool FakeReadHw(void* hal_context, CanMessage* msg) {
+  FakeCubeHal* hal = static_cast<FakeCubeHal*>(hal_context);
+  if (hal->pending == 0U) {
+    return false;
+  }
+  hal->pending--;
+  *msg = CanMessage{};
+  msg->id = hal->next_id++;
+  msg->len = 1U;
+  return true;
+}
+
+bool TestCanCubeQueueOverflow() {
+  FakeCubeHal hal = {0x100U, CAN_CUBE_RX_QUEUE_SIZE + 3U};
+  CanCubeOps ops = {};
+  ops.read_hw = FakeReadHw;
+
+  CanCube cube;
+  can_cube_init(&cube, &hal, &ops);
+  can_cube_on_rx_pending(&cube);
+
+  if (!ExpectTrue(can_cube_get_rx_overflow_count(&cube) == 3U,
+                  "frames beyond queue size should be counted as overflow")) {
+    return false;
+  }
+
+  CanMessage msg;
+  uint32_t expected_id = 0x100U;
+  while (can_cube_poll(&cube, &msg)) {
+    if (!ExpectTrue(msg.id == expected_id++, "queue should keep FIFO order")) {
+      return false;
+    }
+  }
+  return ExpectTrue(expected_id == 0x100U + CAN_CUBE_RX_QUEUE_SIZE,
+                    "queue should hold exactly CAN_CUBE_RX_QUEUE_SIZE frames");
+}
+
+bool TestCanCubeReadBatch() {
+  FakeCubeHal hal = {0x200U, 5U};
+  CanCubeOps ops = {};
+  ops.read_hw = FakeReadHw;
+
+  CanCube cube;
+  can_cube_init(&cube, &hal, &ops);
+  can_cube_on_rx_pending(&cube);
+
+  CanMessage msgs[3];
+  if (!ExpectTrue(can_bus_read_batch(can_cube_bus(&cube), msgs, 3U) == 3U,
+                  "read_batch should fill the whole array")) {
+    return false;
+  }
+  if (!ExpectTrue(msgs[0].id == 0x200U && msgs[2].id == 0x202U,
+                  "read_batch should keep FIFO order")) {
+    return false;
+  }
+  if (!ExpectTrue(can_cube_poll_batch(&cube, msgs, 3U) == 2U,
+                  "poll_batch should return only the remaining frames")) {
+    return false;
+  }
+  return ExpectTrue(msgs[1].id == 0x204U &&
+                        can_cube_poll_batch(&cube, msgs, 3U) == 0U,
+                    "queue should be empty after draining");
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+
+  ok = TestRingFullAndEmpty() && ok;
+  ok = TestRingWrapAround() && ok;
+  ok = TestRingConcurrentTransfer() && ok;
+  ok = TestCanCubeQueueOverflow() && ok;
+  ok = TestCanCubeReadBatch() && ok;
+
+  if (!ok) {
+    std::cerr << "spsc_ring_cpp_test failed" << std::endl;
+    return 1;
+  }
+
+  std::cout << "spsc_ring_cpp_test passed" << std::endl;
+  return 0;
+}